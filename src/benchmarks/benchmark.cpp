@@ -0,0 +1,154 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "benchmark.h"
+
+bool Benchmark_Suite::should_run(const char *name)
+{
+	if (string_null_or_empty(filter)) {
+		return true;
+	}
+	String benchmark_name = name;
+	return benchmark_name.find(filter, 0, false) >= 0;
+}
+
+bool write_benchmark_results_to_csv(const char *full_path, Array<Benchmark_Result> *results)
+{
+	assert(full_path);
+	assert(results);
+
+	FILE *file = NULL;
+	if (fopen_s(&file, full_path, "w")) {
+		print("write_benchmark_results_to_csv: Failed to open {}.", full_path);
+		return false;
+	}
+	fputs("name,operation_count,seconds,ns_per_op\n", file);
+	for (u32 i = 0; i < results->count; i++) {
+		Benchmark_Result *result = &results->get(i);
+		fputc('"', file);
+		for (const char *c = result->name; *c; c++) {
+			if (*c == '"') {
+				fputc('"', file);
+			}
+			fputc(*c, file);
+		}
+		fprintf(file, "\",%llu,%.9f,%.3f\n", (unsigned long long)result->operation_count, result->seconds, result->nanoseconds_per_operation());
+	}
+	fclose(file);
+
+	print("write_benchmark_results_to_csv: {} results were written to {}.", results->count, full_path);
+	return true;
+}
+
+// Reads a name which may be quoted, the pointer is moved past the comma after the name.
+static bool read_csv_name(char **line, String *name)
+{
+	char *c = *line;
+	if (*c == '"') {
+		c++;
+		while (*c) {
+			if (*c == '"') {
+				if (*(c + 1) != '"') {
+					break;
+				}
+				c++;
+			}
+			name->append(*c);
+			c++;
+		}
+		if (*c != '"') {
+			return false;
+		}
+		c++;
+	} else {
+		while (*c && (*c != ',')) {
+			name->append(*c);
+			c++;
+		}
+	}
+	if (*c != ',') {
+		return false;
+	}
+	*line = c + 1;
+	return true;
+}
+
+bool load_benchmark_baseline(const char *full_path, Array<Benchmark_Baseline_Result> *baseline)
+{
+	assert(full_path);
+	assert(baseline);
+
+	FILE *file = NULL;
+	if (fopen_s(&file, full_path, "r")) {
+		print("load_benchmark_baseline: Failed to open {}.", full_path);
+		return false;
+	}
+	char line[1024];
+	u32 line_number = 0;
+	while (fgets(line, sizeof(line), file)) {
+		line_number++;
+		if (line_number == 1) {
+			continue;
+		}
+		char *c = line;
+		Benchmark_Baseline_Result result;
+		if (!read_csv_name(&c, &result.name)) {
+			print("load_benchmark_baseline: The line {} of {} has no name, it was skipped.", line_number, full_path);
+			continue;
+		}
+		// Only the last column is used, the count and the time are written for people who read the file.
+		char *last_comma = strrchr(c, ',');
+		if (!last_comma) {
+			print("load_benchmark_baseline: The line {} of {} has no time per operation, it was skipped.", line_number, full_path);
+			continue;
+		}
+		result.nanoseconds_per_operation = strtod(last_comma + 1, NULL);
+		baseline->push(result);
+	}
+	fclose(file);
+	return true;
+}
+
+u32 compare_benchmark_results_with_baseline(Array<Benchmark_Result> *results, Array<Benchmark_Baseline_Result> *baseline, double threshold_percent)
+{
+	assert(results);
+	assert(baseline);
+
+	print("Comparison with the baseline, the threshold is {}%:", threshold_percent);
+	u32 regression_count = 0;
+	for (u32 i = 0; i < results->count; i++) {
+		Benchmark_Result *result = &results->get(i);
+		Benchmark_Baseline_Result *baseline_result = NULL;
+		for (u32 j = 0; j < baseline->count; j++) {
+			if (baseline->get(j).name == result->name) {
+				baseline_result = &baseline->get(j);
+				break;
+			}
+		}
+		if (!baseline_result) {
+			print("  {}: no baseline", result->name);
+			continue;
+		}
+		if (baseline_result->nanoseconds_per_operation <= 0.0) {
+			continue;
+		}
+		double change_percent = ((result->nanoseconds_per_operation() / baseline_result->nanoseconds_per_operation) - 1.0) * 100.0;
+		if (change_percent > threshold_percent) {
+			print("  {}: {} ns/op -> {} ns/op, {}% REGRESSION", result->name, baseline_result->nanoseconds_per_operation, result->nanoseconds_per_operation(), change_percent);
+			regression_count++;
+		} else {
+			print("  {}: {} ns/op -> {} ns/op, {}%", result->name, baseline_result->nanoseconds_per_operation, result->nanoseconds_per_operation(), change_percent);
+		}
+	}
+	print("{} of {} benchmarks regressed.", regression_count, results->count);
+	return regression_count;
+}
+
+void run_core_benchmarks(Benchmark_Suite *suite)
+{
+	run_container_benchmarks(suite);
+	run_string_benchmarks(suite);
+	run_math_benchmarks(suite);
+	run_queue_benchmarks(suite);
+}
@@ -0,0 +1,116 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <chrono>
+
+#include "../sys/sys.h"
+#include "../libs/str.h"
+#include "../libs/number_types.h"
+#include "../libs/structures/array.h"
+
+// Minimal harness for microbenchmarks. A benchmark is run a few times
+// and the fastest run is reported, so one preempted run doesn't spoil the result.
+const u32 BENCHMARK_RUN_COUNT = 5;
+
+struct Benchmark_Result {
+	const char *name = NULL;
+	u64 operation_count = 0;
+	double seconds = 0.0;
+
+	double nanoseconds_per_operation();
+	double operations_per_second();
+};
+
+inline double Benchmark_Result::nanoseconds_per_operation()
+{
+	return (operation_count > 0) ? (seconds * 1e9) / (double)operation_count : 0.0;
+}
+
+inline double Benchmark_Result::operations_per_second()
+{
+	return (seconds > 0.0) ? (double)operation_count / seconds : 0.0;
+}
+
+inline double benchmark_seconds()
+{
+	using namespace std::chrono;
+	return duration<double>(steady_clock::now().time_since_epoch()).count();
+}
+
+// Benchmark_Procedure is called with no arguments and must do operation_count operations.
+template <typename Benchmark_Procedure>
+Benchmark_Result run_benchmark(const char *name, u64 operation_count, Benchmark_Procedure procedure)
+{
+	Benchmark_Result result;
+	result.name = name;
+	result.operation_count = operation_count;
+
+	for (u32 i = 0; i < BENCHMARK_RUN_COUNT; i++) {
+		double start = benchmark_seconds();
+		procedure();
+		double run_time = benchmark_seconds() - start;
+		if ((i == 0) || (run_time < result.seconds)) {
+			result.seconds = run_time;
+		}
+	}
+	return result;
+}
+
+inline void print_benchmark_result(Benchmark_Result *result)
+{
+	print("{}: {} ns/op, {} Mops/s", result->name, result->nanoseconds_per_operation(), result->operations_per_second() / 1e6);
+}
+
+// Keeps the compiler from throwing away a result which is computed only for a benchmark.
+template <typename T>
+inline void do_not_optimize(const T &value)
+{
+	volatile T sink = value;
+	(void)sink;
+}
+
+// Collects results of benchmarks from all groups, so they can be written to a file and compared with a baseline.
+// Names of benchmarks must be unique and live as long as the suite, a benchmark is run only if the filter
+// is a part of its name (case insensitive). A suite without a filter runs everything.
+struct Benchmark_Suite {
+	const char *filter = NULL;
+	Array<Benchmark_Result> results;
+
+	bool should_run(const char *name);
+
+	template <typename Benchmark_Procedure>
+	void run(const char *name, u64 operation_count, Benchmark_Procedure procedure);
+};
+
+template <typename Benchmark_Procedure>
+void Benchmark_Suite::run(const char *name, u64 operation_count, Benchmark_Procedure procedure)
+{
+	if (should_run(name)) {
+		results.push(run_benchmark(name, operation_count, procedure));
+		print_benchmark_result(&results.last());
+	}
+}
+
+struct Benchmark_Baseline_Result {
+	String name;
+	double nanoseconds_per_operation = 0.0;
+};
+
+// The CSV has a header and a row per result: name,operation_count,seconds,ns_per_op. Names are quoted.
+bool write_benchmark_results_to_csv(const char *full_path, Array<Benchmark_Result> *results);
+bool load_benchmark_baseline(const char *full_path, Array<Benchmark_Baseline_Result> *baseline);
+
+// Prints the change of the time per operation for every result which has a baseline.
+// Returns the number of results which got slower by more than threshold_percent.
+u32 compare_benchmark_results_with_baseline(Array<Benchmark_Result> *results, Array<Benchmark_Baseline_Result> *baseline, double threshold_percent);
+
+// Benchmarks of the core libraries, they don't need the renderer or the window and run in the standalone benchmark executable too.
+void run_core_benchmarks(Benchmark_Suite *suite);
+void run_queue_benchmarks(Benchmark_Suite *suite);
+void run_container_benchmarks(Benchmark_Suite *suite);
+void run_string_benchmarks(Benchmark_Suite *suite);
+void run_math_benchmarks(Benchmark_Suite *suite);
+
+void run_mesh_loader_benchmarks(Benchmark_Suite *suite, const char *model_file_name);
+
+#endif
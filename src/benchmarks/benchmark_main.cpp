@@ -0,0 +1,80 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "benchmark.h"
+#include "../sys/logger.h"
+
+// The entry point of the standalone benchmark executable. It is built only with the core libraries,
+// so it has no window and the engine's console and message boxes are replaced by stdout and stderr.
+//
+// Usage: hades_benchmarks [--filter <text>] [--csv <file>] [--baseline <file>] [--threshold <percent>]
+// With a baseline the exit code is 1 if any benchmark got slower than the baseline by more than the threshold.
+
+const double DEFAULT_REGRESSION_THRESHOLD_PERCENT = 10.0;
+
+void append_text_to_console_buffer(const char *text, bool move_to_next_line)
+{
+	fputs(text, stdout);
+	if (move_to_next_line) {
+		fputc('\n', stdout);
+	}
+	fflush(stdout);
+}
+
+void report_info(const char *info_message)
+{
+	fprintf(stdout, "%s\n", info_message);
+}
+
+void report_error(const char *error_message)
+{
+	fprintf(stderr, "%s\n", error_message);
+}
+
+static void print_usage()
+{
+	fputs("Usage: hades_benchmarks [--filter <text>] [--csv <file>] [--baseline <file>] [--threshold <percent>]\n", stderr);
+}
+
+int main(int argc, char **argv)
+{
+	Benchmark_Suite suite;
+	const char *csv_path = NULL;
+	const char *baseline_path = NULL;
+	double threshold_percent = DEFAULT_REGRESSION_THRESHOLD_PERCENT;
+
+	for (int i = 1; i < argc; i++) {
+		bool has_value = (i + 1) < argc;
+		if (!strcmp(argv[i], "--filter") && has_value) {
+			suite.filter = argv[++i];
+		} else if (!strcmp(argv[i], "--csv") && has_value) {
+			csv_path = argv[++i];
+		} else if (!strcmp(argv[i], "--baseline") && has_value) {
+			baseline_path = argv[++i];
+		} else if (!strcmp(argv[i], "--threshold") && has_value) {
+			threshold_percent = strtod(argv[++i], NULL);
+		} else {
+			print_usage();
+			return 2;
+		}
+	}
+
+	Array<Benchmark_Baseline_Result> baseline;
+	if (baseline_path && !load_benchmark_baseline(baseline_path, &baseline)) {
+		return 2;
+	}
+
+	init_logger(NULL);
+	run_core_benchmarks(&suite);
+
+	bool failed = false;
+	if (csv_path && !write_benchmark_results_to_csv(csv_path, &suite.results)) {
+		failed = true;
+	}
+	if (baseline_path && (compare_benchmark_results_with_baseline(&suite.results, &baseline, threshold_percent) > 0)) {
+		failed = true;
+	}
+	shutdown_logger();
+	return failed ? 1 : 0;
+}
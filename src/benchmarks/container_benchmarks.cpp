@@ -0,0 +1,158 @@
+#include "benchmark.h"
+#include "../libs/structures/array.h"
+#include "../libs/structures/hash_table.h"
+#include "../libs/memory/pool_allocator.h"
+
+const u32 CONTAINER_BENCHMARK_ITEM_COUNT = 1 << 16;
+const u32 CONTAINER_BENCHMARK_STRING_KEY_COUNT = 1 << 12;
+const u32 POOL_BENCHMARK_BATCH_SIZE = 256;
+
+struct Pool_Benchmark_Object {
+	u64 id;
+	float data[14];
+};
+
+// Keys like names of assets, they are made once so the string benchmarks measure only the table.
+static void make_string_keys(Array<String> *keys)
+{
+	char buffer[64];
+	for (u32 i = 0; i < CONTAINER_BENCHMARK_STRING_KEY_COUNT; i++) {
+		format_to(buffer, sizeof(buffer), "models/props/object_{}.gltf", i);
+		keys->push(String(buffer));
+	}
+}
+
+static void run_array_benchmarks(Benchmark_Suite *suite)
+{
+	suite->run("Array push", CONTAINER_BENCHMARK_ITEM_COUNT, []() {
+		Array<u32> array;
+		for (u32 i = 0; i < CONTAINER_BENCHMARK_ITEM_COUNT; i++) {
+			array.push(i);
+		}
+		do_not_optimize(array.count);
+	});
+	suite->run("Array push after reserve", CONTAINER_BENCHMARK_ITEM_COUNT, []() {
+		Array<u32> array;
+		array.reserve(CONTAINER_BENCHMARK_ITEM_COUNT);
+		array.reset();
+		for (u32 i = 0; i < CONTAINER_BENCHMARK_ITEM_COUNT; i++) {
+			array.push(i);
+		}
+		do_not_optimize(array.count);
+	});
+	// Grows the array in steps the way arrays of per frame data grow.
+	suite->run("Array resize", CONTAINER_BENCHMARK_ITEM_COUNT / 64, []() {
+		Array<u32> array;
+		for (u32 size = 64; size <= CONTAINER_BENCHMARK_ITEM_COUNT; size += 64) {
+			array.resize(size);
+		}
+		do_not_optimize(array.size);
+	});
+
+	Array<u32> source;
+	for (u32 i = 0; i < CONTAINER_BENCHMARK_ITEM_COUNT; i++) {
+		source.push(i);
+	}
+	suite->run("Array merge", CONTAINER_BENCHMARK_ITEM_COUNT, [&]() {
+		Array<u32> array;
+		merge(&array, &source);
+		do_not_optimize(array.count);
+	});
+}
+
+static void run_hash_table_benchmarks(Benchmark_Suite *suite)
+{
+	suite->run("Hash_Table<u32> set", CONTAINER_BENCHMARK_ITEM_COUNT, []() {
+		Hash_Table<u32, u32> table;
+		for (u32 i = 0; i < CONTAINER_BENCHMARK_ITEM_COUNT; i++) {
+			table.set(i, i);
+		}
+		do_not_optimize(table.count);
+	});
+
+	Hash_Table<u32, u32> integer_table;
+	for (u32 i = 0; i < CONTAINER_BENCHMARK_ITEM_COUNT; i++) {
+		integer_table.set(i, i);
+	}
+	suite->run("Hash_Table<u32> get", CONTAINER_BENCHMARK_ITEM_COUNT, [&]() {
+		u32 sum = 0;
+		u32 value = 0;
+		for (u32 i = 0; i < CONTAINER_BENCHMARK_ITEM_COUNT; i++) {
+			if (integer_table.get(i, value)) {
+				sum += value;
+			}
+		}
+		do_not_optimize(sum);
+	});
+
+	Array<String> keys;
+	make_string_keys(&keys);
+	suite->run("Hash_Table<String> set", CONTAINER_BENCHMARK_STRING_KEY_COUNT, [&]() {
+		Hash_Table<String, u32> table;
+		for (u32 i = 0; i < keys.count; i++) {
+			table.set(keys[i], i);
+		}
+		do_not_optimize(table.count);
+	});
+
+	Hash_Table<String, u32> string_table;
+	for (u32 i = 0; i < keys.count; i++) {
+		string_table.set(keys[i], i);
+	}
+	suite->run("Hash_Table<String> get", CONTAINER_BENCHMARK_STRING_KEY_COUNT, [&]() {
+		u32 sum = 0;
+		u32 value = 0;
+		for (u32 i = 0; i < keys.count; i++) {
+			if (string_table.get(keys[i], value)) {
+				sum += value;
+			}
+		}
+		do_not_optimize(sum);
+	});
+	suite->run("fast_hash", CONTAINER_BENCHMARK_STRING_KEY_COUNT, [&]() {
+		u32 hash = 0;
+		for (u32 i = 0; i < keys.count; i++) {
+			hash ^= fast_hash(keys[i]);
+		}
+		do_not_optimize(hash);
+	});
+}
+
+// Allocations and frees in batches, the pools are made by the first run and reused by the next ones.
+static void run_pool_allocator_benchmarks(Benchmark_Suite *suite)
+{
+	Pool_Allocator<Pool_Benchmark_Object> allocator;
+	allocator.init(CONTAINER_BENCHMARK_ITEM_COUNT);
+
+	Pool_Benchmark_Object *objects[POOL_BENCHMARK_BATCH_SIZE];
+	suite->run("Pool_Allocator allocate and free", CONTAINER_BENCHMARK_ITEM_COUNT, [&]() {
+		for (u32 i = 0; i < CONTAINER_BENCHMARK_ITEM_COUNT; i += POOL_BENCHMARK_BATCH_SIZE) {
+			for (u32 j = 0; j < POOL_BENCHMARK_BATCH_SIZE; j++) {
+				objects[j] = allocator.allocate();
+				objects[j]->id = i + j;
+			}
+			for (u32 j = 0; j < POOL_BENCHMARK_BATCH_SIZE; j++) {
+				allocator.free(objects[j]);
+			}
+		}
+	});
+	suite->run("new and delete", CONTAINER_BENCHMARK_ITEM_COUNT, [&]() {
+		for (u32 i = 0; i < CONTAINER_BENCHMARK_ITEM_COUNT; i += POOL_BENCHMARK_BATCH_SIZE) {
+			for (u32 j = 0; j < POOL_BENCHMARK_BATCH_SIZE; j++) {
+				objects[j] = new Pool_Benchmark_Object();
+				objects[j]->id = i + j;
+			}
+			for (u32 j = 0; j < POOL_BENCHMARK_BATCH_SIZE; j++) {
+				DELETE_PTR(objects[j]);
+			}
+		}
+	});
+}
+
+void run_container_benchmarks(Benchmark_Suite *suite)
+{
+	print("Container benchmarks, {} items:", CONTAINER_BENCHMARK_ITEM_COUNT);
+	run_array_benchmarks(suite);
+	run_hash_table_benchmarks(suite);
+	run_pool_allocator_benchmarks(suite);
+}
@@ -0,0 +1,300 @@
+#include "benchmark.h"
+#include "../libs/math/vector.h"
+#include "../libs/math/matrix.h"
+#include "../libs/math/quaternion.h"
+#include "../libs/math/functions.h"
+#include "../libs/math/transform_batch.h"
+#include "../libs/math/intersection_batch.h"
+#include "../render/mesh.h"
+#include "../collision/collision.h"
+
+const u32 MATH_BENCHMARK_ITEM_COUNT = 1 << 14;
+const u32 AABB_BENCHMARK_VERTEX_COUNT = 1 << 16;
+
+// A linear congruential generator, benchmark data must be the same in every run and on every platform.
+struct Benchmark_Random {
+	u32 state = 1;
+
+	float next(float min, float max)
+	{
+		state = state * 1664525u + 1013904223u;
+		return min + (max - min) * ((float)(state >> 8) / (float)(1 << 24));
+	}
+
+	Vector3 next_vector3(float min, float max)
+	{
+		float x = next(min, max);
+		float y = next(min, max);
+		float z = next(min, max);
+		return Vector3(x, y, z);
+	}
+};
+
+// Every element of the matrix is used so that the compiler can't drop a part of the work which made it.
+static void accumulate(Vector4 *sum, const Matrix4 &matrix)
+{
+	Simd_Matrix rows = simd_load(matrix);
+	*sum += Vector4(simd_add(simd_add(rows.rows[0], rows.rows[1]), simd_add(rows.rows[2], rows.rows[3])));
+}
+
+static void run_vector_benchmarks(Benchmark_Suite *suite, Array<Vector3> *vectors)
+{
+	suite->run("Vector3 dot", MATH_BENCHMARK_ITEM_COUNT, [vectors]() {
+		float sum = 0.0f;
+		for (u32 i = 1; i < vectors->count; i++) {
+			sum += dot(vectors->get(i - 1), vectors->get(i));
+		}
+		do_not_optimize(sum);
+	});
+	suite->run("Vector3 cross", MATH_BENCHMARK_ITEM_COUNT, [vectors]() {
+		Vector3 sum = Vector3::zero;
+		for (u32 i = 1; i < vectors->count; i++) {
+			sum += cross(vectors->get(i - 1), vectors->get(i));
+		}
+		do_not_optimize(sum.x);
+	});
+	suite->run("Vector3 normalize", MATH_BENCHMARK_ITEM_COUNT, [vectors]() {
+		Vector3 sum = Vector3::zero;
+		for (u32 i = 0; i < vectors->count; i++) {
+			sum += normalize(vectors->get(i));
+		}
+		do_not_optimize(sum.x);
+	});
+}
+
+static void run_matrix_benchmarks(Benchmark_Suite *suite, Array<Vector3> *vectors)
+{
+	Array<Matrix4> matrices;
+	for (u32 i = 0; i < vectors->count; i++) {
+		Vector3 *vector = &vectors->get(i);
+		matrices.push(make_scale_matrix(2.0f) * rotate(vector->x, vector->y, vector->z) * make_translation_matrix(vector));
+	}
+	// The multiplication of world matrices by a view projection matrix is done for every entity in every frame.
+	suite->run("Matrix4 multiply", MATH_BENCHMARK_ITEM_COUNT, [&]() {
+		float sum = 0.0f;
+		Matrix4 view_projection = make_look_at_matrix(Vector3(0.0f, 10.0f, -10.0f), Vector3::zero) * make_perspective_matrix(1.0f, 1.77f, 1.0f, 1000.0f);
+		for (u32 i = 0; i < matrices.count; i++) {
+			Matrix4 result = matrices[i] * view_projection;
+			sum += result._11 + result._44;
+		}
+		do_not_optimize(sum);
+	});
+	suite->run("Matrix4 inverse", MATH_BENCHMARK_ITEM_COUNT, [&]() {
+		Vector4 sum = Vector4(0.0f, 0.0f, 0.0f, 0.0f);
+		for (u32 i = 0; i < matrices.count; i++) {
+			accumulate(&sum, inverse(matrices[i]));
+		}
+		do_not_optimize(sum.x);
+	});
+	// World matrices have no projection, view matrices have no scaling either.
+	suite->run("Matrix4 affine inverse", MATH_BENCHMARK_ITEM_COUNT, [&]() {
+		Vector4 sum = Vector4(0.0f, 0.0f, 0.0f, 0.0f);
+		for (u32 i = 0; i < matrices.count; i++) {
+			accumulate(&sum, inverse_affine(matrices[i]));
+		}
+		do_not_optimize(sum.x);
+	});
+	Array<Matrix4> view_matrices;
+	for (u32 i = 0; i < vectors->count; i++) {
+		view_matrices.push(make_look_at_matrix(vectors->get(i), Vector3::zero));
+	}
+	suite->run("Matrix4 orthonormal inverse", MATH_BENCHMARK_ITEM_COUNT, [&]() {
+		Vector4 sum = Vector4(0.0f, 0.0f, 0.0f, 0.0f);
+		for (u32 i = 0; i < view_matrices.count; i++) {
+			accumulate(&sum, inverse_orthonormal(view_matrices[i]));
+		}
+		do_not_optimize(sum.x);
+	});
+	suite->run("Matrix4 transform Vector3", MATH_BENCHMARK_ITEM_COUNT, [&]() {
+		Vector3 sum = Vector3::zero;
+		for (u32 i = 0; i < matrices.count; i++) {
+			sum += vectors->get(i) * matrices[i];
+		}
+		do_not_optimize(sum.x);
+	});
+	suite->run("Scale, rotation and translation to Matrix4", MATH_BENCHMARK_ITEM_COUNT, [&]() {
+		float sum = 0.0f;
+		for (u32 i = 0; i < vectors->count; i++) {
+			Vector3 *vector = &vectors->get(i);
+			Matrix4 world_matrix = make_scale_matrix(vector) * rotate(vector->x, vector->y, vector->z) * make_translation_matrix(vector);
+			sum += world_matrix._11 + world_matrix._41;
+		}
+		do_not_optimize(sum);
+	});
+}
+
+static void run_quaternion_benchmarks(Benchmark_Suite *suite, Array<Vector3> *vectors)
+{
+	Array<Quaternion> orientations;
+	for (u32 i = 0; i < vectors->count; i++) {
+		Vector3 *vector = &vectors->get(i);
+		orientations.push(make_quaternion(vector->x, vector->y, vector->z));
+	}
+	suite->run("Quaternion multiply", MATH_BENCHMARK_ITEM_COUNT, [&]() {
+		Quaternion product = make_identity_quaternion();
+		for (u32 i = 0; i < orientations.count; i++) {
+			product *= orientations[i];
+		}
+		do_not_optimize(product.w);
+	});
+	suite->run("Quaternion slerp", MATH_BENCHMARK_ITEM_COUNT, [&]() {
+		float sum = 0.0f;
+		for (u32 i = 1; i < orientations.count; i++) {
+			sum += slerp(orientations[i - 1], orientations[i], 0.3f).w;
+		}
+		do_not_optimize(sum);
+	});
+	suite->run("Vector3 rotate by Quaternion", MATH_BENCHMARK_ITEM_COUNT, [&]() {
+		Vector3 sum = Vector3::zero;
+		for (u32 i = 0; i < orientations.count; i++) {
+			sum += vectors->get(i) * orientations[i];
+		}
+		do_not_optimize(sum.x);
+	});
+	// The same world matrices as the scale, rotation and translation benchmark above.
+	suite->run("Scale, orientation and translation to Matrix4", MATH_BENCHMARK_ITEM_COUNT, [&]() {
+		float sum = 0.0f;
+		for (u32 i = 0; i < orientations.count; i++) {
+			Vector3 *vector = &vectors->get(i);
+			Matrix4 world_matrix = make_world_matrix(*vector, orientations[i], *vector);
+			sum += world_matrix._11 + world_matrix._41;
+		}
+		do_not_optimize(sum);
+	});
+}
+
+// The kernel which makes world matrices of render entities, compared with the 4x4 multiplies in the benchmark above.
+static void run_transform_batch_benchmarks(Benchmark_Suite *suite, Array<Vector3> *vectors)
+{
+	Transform_Streams transforms;
+	transforms.resize(vectors->count);
+	for (u32 i = 0; i < vectors->count; i++) {
+		Vector3 *vector = &vectors->get(i);
+		transforms.set(i, *vector, make_quaternion(vector->x, vector->y, vector->z), Vector3(1.0f, 2.0f, 0.5f));
+	}
+	Array<Matrix4> matrices;
+	matrices.reserve(vectors->count);
+
+	Transform_Batch_Kernel best_kernel = get_best_transform_batch_kernel();
+	print("The best kernel for world matrices is {}.", get_transform_batch_kernel_name(best_kernel));
+
+	suite->run("World matrices, scalar kernel", vectors->count, [&]() {
+		make_world_matrices(&transforms, 0, transforms.count, matrices.items, TRANSFORM_BATCH_KERNEL_SCALAR);
+		do_not_optimize(matrices.last()._41);
+	});
+	if (best_kernel >= TRANSFORM_BATCH_KERNEL_SSE) {
+		suite->run("World matrices, SSE kernel", vectors->count, [&]() {
+			make_world_matrices(&transforms, 0, transforms.count, matrices.items, TRANSFORM_BATCH_KERNEL_SSE);
+			do_not_optimize(matrices.last()._41);
+		});
+	}
+	if (best_kernel >= TRANSFORM_BATCH_KERNEL_AVX2) {
+		suite->run("World matrices, AVX2 kernel", vectors->count, [&]() {
+			make_world_matrices(&transforms, 0, transforms.count, matrices.items, TRANSFORM_BATCH_KERNEL_AVX2);
+			do_not_optimize(matrices.last()._41);
+		});
+	}
+}
+
+static void run_collision_benchmarks(Benchmark_Suite *suite, Benchmark_Random *random)
+{
+	Triangle_Mesh mesh;
+	for (u32 i = 0; i < AABB_BENCHMARK_VERTEX_COUNT; i++) {
+		Vertex_PNTUV vertex;
+		vertex.position = random->next_vector3(-50.0f, 50.0f);
+		mesh.vertices.push(vertex);
+	}
+	suite->run("make_AABB", AABB_BENCHMARK_VERTEX_COUNT, [&]() {
+		AABB aabb = make_AABB(&mesh);
+		do_not_optimize(aabb.max.x);
+	});
+
+	// Boxes around the origin and rays from a camera, about a half of the rays hit their boxes.
+	Array<AABB> boxes;
+	Array<Ray> rays;
+	for (u32 i = 0; i < MATH_BENCHMARK_ITEM_COUNT; i++) {
+		Vector3 center = random->next_vector3(-20.0f, 20.0f);
+		Vector3 half_size = random->next_vector3(0.5f, 5.0f);
+		boxes.push({ center - half_size, center + half_size });
+
+		Vector3 target = center + random->next_vector3(-8.0f, 8.0f);
+		Vector3 origin = Vector3(0.0f, 10.0f, -60.0f);
+		rays.push(Ray(origin, normalize(target - origin)));
+	}
+	suite->run("Ray AABB intersection", MATH_BENCHMARK_ITEM_COUNT, [&]() {
+		u32 hit_count = 0;
+		Vector3 intersection_point;
+		for (u32 i = 0; i < boxes.count; i++) {
+			if (detect_intersection(&rays[i], &boxes[i], &intersection_point)) {
+				hit_count++;
+			}
+		}
+		do_not_optimize(hit_count);
+	});
+}
+
+// One picking ray against many boxes and triangles, the way the editor picks entities.
+static void run_intersection_batch_benchmarks(Benchmark_Suite *suite, Benchmark_Random *random)
+{
+	AABB_Streams boxes;
+	Triangle_Streams triangles;
+	boxes.resize(MATH_BENCHMARK_ITEM_COUNT);
+	triangles.resize(MATH_BENCHMARK_ITEM_COUNT);
+	for (u32 i = 0; i < MATH_BENCHMARK_ITEM_COUNT; i++) {
+		Vector3 center = random->next_vector3(-20.0f, 20.0f);
+		Vector3 half_size = random->next_vector3(0.5f, 5.0f);
+		boxes.set(i, center - half_size, center + half_size);
+		triangles.set(i, center + random->next_vector3(-2.0f, 2.0f), center + random->next_vector3(-2.0f, 2.0f), center + random->next_vector3(-2.0f, 2.0f));
+	}
+	Ray ray = Ray(Vector3(0.0f, 10.0f, -60.0f), Vector3(0.1f, -10.0f, 60.0f));
+	Batch_Ray batch_ray = make_batch_ray(ray.origin, ray.direction);
+	Array<float> distances;
+	distances.reserve(MATH_BENCHMARK_ITEM_COUNT);
+
+	suite->run("One ray AABB intersections, detect_intersection", MATH_BENCHMARK_ITEM_COUNT, [&]() {
+		u32 hit_count = 0;
+		for (u32 i = 0; i < boxes.count; i++) {
+			AABB box = { Vector3(boxes.streams[AABB_STREAM_MIN_X][i], boxes.streams[AABB_STREAM_MIN_Y][i], boxes.streams[AABB_STREAM_MIN_Z][i]),
+						 Vector3(boxes.streams[AABB_STREAM_MAX_X][i], boxes.streams[AABB_STREAM_MAX_Y][i], boxes.streams[AABB_STREAM_MAX_Z][i]) };
+			if (detect_intersection(&ray, &box)) {
+				hit_count++;
+			}
+		}
+		do_not_optimize(hit_count);
+	});
+
+	Intersection_Batch_Kernel best_kernel = get_best_intersection_batch_kernel();
+	print("The best kernel for intersections is {}.", get_intersection_batch_kernel_name(best_kernel));
+
+	const char *box_benchmark_names[] = { "One ray AABB intersections, scalar kernel", "One ray AABB intersections, SSE kernel", "One ray AABB intersections, AVX2 kernel" };
+	const char *triangle_benchmark_names[] = { "Nearest ray triangle intersection, scalar kernel", "Nearest ray triangle intersection, SSE kernel", "Nearest ray triangle intersection, AVX2 kernel" };
+	for (u32 i = INTERSECTION_BATCH_KERNEL_SCALAR; i <= (u32)best_kernel; i++) {
+		Intersection_Batch_Kernel kernel = (Intersection_Batch_Kernel)i;
+		suite->run(box_benchmark_names[i], MATH_BENCHMARK_ITEM_COUNT, [&]() {
+			bool hit = detect_intersections(&batch_ray, &boxes, 0, boxes.count, distances.items, kernel);
+			do_not_optimize(hit);
+		});
+		suite->run(triangle_benchmark_names[i], MATH_BENCHMARK_ITEM_COUNT, [&]() {
+			Triangle_Intersection intersection;
+			bool hit = find_nearest_intersection(&batch_ray, &triangles, 0, triangles.count, &intersection, kernel);
+			do_not_optimize(hit);
+		});
+	}
+}
+
+void run_math_benchmarks(Benchmark_Suite *suite)
+{
+	print("Math benchmarks, {} items, {} math backend:", MATH_BENCHMARK_ITEM_COUNT, get_simd_backend_name());
+
+	Benchmark_Random random;
+	Array<Vector3> vectors;
+	for (u32 i = 0; i < MATH_BENCHMARK_ITEM_COUNT; i++) {
+		vectors.push(random.next_vector3(-10.0f, 10.0f));
+	}
+	run_vector_benchmarks(suite, &vectors);
+	run_matrix_benchmarks(suite, &vectors);
+	run_quaternion_benchmarks(suite, &vectors);
+	run_transform_batch_benchmarks(suite, &vectors);
+	run_collision_benchmarks(suite, &random);
+	run_intersection_batch_benchmarks(suite, &random);
+}
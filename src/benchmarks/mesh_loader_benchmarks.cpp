@@ -0,0 +1,80 @@
+#include <assimp/scene.h>
+#include <assimp/Importer.hpp>
+#include <assimp/postprocess.h>
+
+#include "benchmark.h"
+#include "../sys/jobs.h"
+#include "../libs/mesh_loader.h"
+#include "../libs/os/path.h"
+#include "../libs/os/file.h"
+
+// The conversion which process_mesh did before vertices were converted in batches, it is kept to compare with.
+static void process_mesh_with_push(aiMesh *ai_mesh, Triangle_Mesh *mesh)
+{
+	for (u32 i = 0; i < ai_mesh->mNumVertices; i++) {
+		Vertex_PNTUV vertex;
+		vertex.position = Vector3(ai_mesh->mVertices[i].x, ai_mesh->mVertices[i].y, ai_mesh->mVertices[i].z);
+		if (ai_mesh->HasTextureCoords(0)) {
+			vertex.uv = Vector2(ai_mesh->mTextureCoords[0][i].x, ai_mesh->mTextureCoords[0][i].y);
+		}
+		if (ai_mesh->HasNormals()) {
+			vertex.normal = Vector3(ai_mesh->mNormals[i].x, ai_mesh->mNormals[i].y, ai_mesh->mNormals[i].z);
+		}
+		if (ai_mesh->HasTangentsAndBitangents()) {
+			vertex.tangent = Vector3(ai_mesh->mTangents[i].x, ai_mesh->mTangents[i].y, ai_mesh->mTangents[i].z);
+		}
+		mesh->vertices.push(vertex);
+	}
+	for (u32 i = 0; i < ai_mesh->mNumFaces; i++) {
+		aiFace *face = &ai_mesh->mFaces[i];
+		for (u32 j = 0; j < face->mNumIndices; j++) {
+			mesh->indices.push(face->mIndices[j]);
+		}
+	}
+}
+
+// Converts all meshes of a scene and reports the time per vertex. The meshes are made again in every run,
+// so allocating their arrays is a part of the result the same way it is a part of loading.
+void run_mesh_loader_benchmarks(Benchmark_Suite *suite, const char *model_file_name)
+{
+	String full_path;
+	build_full_path_to_model_file(model_file_name, full_path);
+	if (!file_exists(full_path)) {
+		print("run_mesh_loader_benchmarks: {} does not exist.", full_path);
+		return;
+	}
+	Assimp::Importer importer;
+	const aiScene *scene = importer.ReadFile(full_path, aiProcessPreset_TargetRealtime_Fast | aiProcess_ConvertToLeftHanded);
+	if (!scene) {
+		print("run_mesh_loader_benchmarks: Assimp can't load {}. {}", full_path, importer.GetErrorString());
+		return;
+	}
+	u32 mesh_count = scene->mNumMeshes;
+	u64 vertex_count = 0;
+	for (u32 i = 0; i < mesh_count; i++) {
+		vertex_count += scene->mMeshes[i]->mNumVertices;
+	}
+	print("run_mesh_loader_benchmarks: {} has {} meshes and {} vertices.", model_file_name, mesh_count, vertex_count);
+
+	suite->run("Vertex by vertex push", vertex_count, [&]() {
+		for (u32 i = 0; i < mesh_count; i++) {
+			Triangle_Mesh mesh;
+			process_mesh_with_push(scene->mMeshes[i], &mesh);
+			do_not_optimize(mesh.vertices.count);
+		}
+	});
+	suite->run("SIMD batches, meshes one by one", vertex_count, [&]() {
+		for (u32 i = 0; i < mesh_count; i++) {
+			Triangle_Mesh mesh;
+			process_mesh(scene->mMeshes[i], &mesh);
+			do_not_optimize(mesh.vertices.count);
+		}
+	});
+	suite->run("SIMD batches, meshes in parallel", vertex_count, [&]() {
+		parallel_for(mesh_count, 1, [&](u32 index) {
+			Triangle_Mesh mesh;
+			process_mesh(scene->mMeshes[index], &mesh);
+			do_not_optimize(mesh.vertices.count);
+		});
+	});
+}
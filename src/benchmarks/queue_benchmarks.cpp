@@ -0,0 +1,159 @@
+#include <mutex>
+#include <thread>
+
+#include "benchmark.h"
+#include "../libs/structures/queue.h"
+#include "../libs/structures/concurrent_queue.h"
+
+const u32 QUEUE_BENCHMARK_BATCH_SIZE = 512;
+const u32 QUEUE_BENCHMARK_CAPACITY = 1024;
+const u64 QUEUE_BENCHMARK_ITEM_COUNT = 1 << 20;
+const u32 QUEUE_BENCHMARK_PRODUCER_COUNT = 4;
+
+// Queue<T> is not thread safe, so in the threaded benchmarks it is guarded with a mutex
+// the same way it would have to be guarded in the engine.
+template <typename T>
+struct Locked_Queue {
+	std::mutex mutex;
+	Queue<T> queue;
+
+	bool push(const T &item)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		queue.push(item);
+		return true;
+	}
+
+	bool pop(T &item)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if (queue.empty()) {
+			return false;
+		}
+		item = queue.front();
+		queue.pop();
+		return true;
+	}
+};
+
+// Pushes and pops items in batches on one thread, it shows the cost of a queue without contention.
+template <typename Queue_Type>
+static void push_and_pop_in_batches(Queue_Type *queue)
+{
+	u64 sum = 0;
+	for (u64 i = 0; i < QUEUE_BENCHMARK_ITEM_COUNT; i += QUEUE_BENCHMARK_BATCH_SIZE) {
+		for (u32 j = 0; j < QUEUE_BENCHMARK_BATCH_SIZE; j++) {
+			queue->push(i + j);
+		}
+		u64 item = 0;
+		for (u32 j = 0; j < QUEUE_BENCHMARK_BATCH_SIZE; j++) {
+			queue->pop(item);
+			sum += item;
+		}
+	}
+	do_not_optimize(sum);
+}
+
+static void push_and_pop_in_batches(Queue<u64> *queue)
+{
+	u64 sum = 0;
+	for (u64 i = 0; i < QUEUE_BENCHMARK_ITEM_COUNT; i += QUEUE_BENCHMARK_BATCH_SIZE) {
+		for (u32 j = 0; j < QUEUE_BENCHMARK_BATCH_SIZE; j++) {
+			queue->push(i + j);
+		}
+		for (u32 j = 0; j < QUEUE_BENCHMARK_BATCH_SIZE; j++) {
+			sum += queue->front();
+			queue->pop();
+		}
+	}
+	do_not_optimize(sum);
+}
+
+// Producers push QUEUE_BENCHMARK_ITEM_COUNT items in total, the consumer pops them on the calling thread.
+template <typename Queue_Type>
+static void produce_and_consume(Queue_Type *queue, u32 producer_count)
+{
+	u64 items_per_producer = QUEUE_BENCHMARK_ITEM_COUNT / producer_count;
+
+	Array<std::thread *> producers;
+	for (u32 i = 0; i < producer_count; i++) {
+		producers.push(new std::thread([queue, items_per_producer]() {
+			for (u64 j = 0; j < items_per_producer; j++) {
+				while (!queue->push(j)) {
+					std::this_thread::yield();
+				}
+			}
+		}));
+	}
+
+	u64 sum = 0;
+	u64 item = 0;
+	u64 popped_item_count = 0;
+	while (popped_item_count < (items_per_producer * producer_count)) {
+		if (queue->pop(item)) {
+			sum += item;
+			popped_item_count++;
+		} else {
+			std::this_thread::yield();
+		}
+	}
+	for (u32 i = 0; i < producers.count; i++) {
+		producers[i]->join();
+		DELETE_PTR(producers[i]);
+	}
+	do_not_optimize(sum);
+}
+
+void run_queue_benchmarks(Benchmark_Suite *suite)
+{
+	print("Queue benchmarks, {} items:", QUEUE_BENCHMARK_ITEM_COUNT);
+	{
+		Queue<u64> queue;
+		suite->run("Single thread Queue", QUEUE_BENCHMARK_ITEM_COUNT, [&]() { push_and_pop_in_batches(&queue); });
+	}
+	{
+		SPSC_Queue<u64> queue;
+		queue.init(QUEUE_BENCHMARK_CAPACITY);
+		suite->run("Single thread SPSC_Queue", QUEUE_BENCHMARK_ITEM_COUNT, [&]() { push_and_pop_in_batches(&queue); });
+	}
+	{
+		MPMC_Queue<u64> queue;
+		queue.init(QUEUE_BENCHMARK_CAPACITY);
+		suite->run("Single thread MPMC_Queue", QUEUE_BENCHMARK_ITEM_COUNT, [&]() { push_and_pop_in_batches(&queue); });
+	}
+	{
+		MPSC_Queue<u64> queue;
+		suite->run("Single thread MPSC_Queue", QUEUE_BENCHMARK_ITEM_COUNT, [&]() { push_and_pop_in_batches(&queue); });
+	}
+	{
+		Locked_Queue<u64> queue;
+		suite->run("1 producer, 1 consumer, Queue + mutex", QUEUE_BENCHMARK_ITEM_COUNT, [&]() { produce_and_consume(&queue, 1); });
+	}
+	{
+		SPSC_Queue<u64> queue;
+		queue.init(QUEUE_BENCHMARK_CAPACITY);
+		suite->run("1 producer, 1 consumer, SPSC_Queue", QUEUE_BENCHMARK_ITEM_COUNT, [&]() { produce_and_consume(&queue, 1); });
+	}
+	{
+		MPMC_Queue<u64> queue;
+		queue.init(QUEUE_BENCHMARK_CAPACITY);
+		suite->run("1 producer, 1 consumer, MPMC_Queue", QUEUE_BENCHMARK_ITEM_COUNT, [&]() { produce_and_consume(&queue, 1); });
+	}
+	{
+		MPSC_Queue<u64> queue;
+		suite->run("1 producer, 1 consumer, MPSC_Queue", QUEUE_BENCHMARK_ITEM_COUNT, [&]() { produce_and_consume(&queue, 1); });
+	}
+	{
+		Locked_Queue<u64> queue;
+		suite->run("4 producers, 1 consumer, Queue + mutex", QUEUE_BENCHMARK_ITEM_COUNT, [&]() { produce_and_consume(&queue, QUEUE_BENCHMARK_PRODUCER_COUNT); });
+	}
+	{
+		MPMC_Queue<u64> queue;
+		queue.init(QUEUE_BENCHMARK_CAPACITY);
+		suite->run("4 producers, 1 consumer, MPMC_Queue", QUEUE_BENCHMARK_ITEM_COUNT, [&]() { produce_and_consume(&queue, QUEUE_BENCHMARK_PRODUCER_COUNT); });
+	}
+	{
+		MPSC_Queue<u64> queue;
+		suite->run("4 producers, 1 consumer, MPSC_Queue", QUEUE_BENCHMARK_ITEM_COUNT, [&]() { produce_and_consume(&queue, QUEUE_BENCHMARK_PRODUCER_COUNT); });
+	}
+}
@@ -0,0 +1,71 @@
+#include "benchmark.h"
+#include "../libs/str.h"
+#include "../libs/structures/array.h"
+
+const u32 STRING_BENCHMARK_OPERATION_COUNT = 1 << 14;
+const u32 SPLIT_BENCHMARK_WORD_COUNT = 1 << 12;
+
+void run_string_benchmarks(Benchmark_Suite *suite)
+{
+	print("String benchmarks, {} operations:", STRING_BENCHMARK_OPERATION_COUNT);
+
+	suite->run("String append char", STRING_BENCHMARK_OPERATION_COUNT, []() {
+		String string;
+		for (u32 i = 0; i < STRING_BENCHMARK_OPERATION_COUNT; i++) {
+			string.append('a');
+		}
+		do_not_optimize(string.len);
+	});
+	suite->run("String append string", STRING_BENCHMARK_OPERATION_COUNT, []() {
+		String string;
+		for (u32 i = 0; i < STRING_BENCHMARK_OPERATION_COUNT; i++) {
+			string.append("mesh_");
+		}
+		do_not_optimize(string.len);
+	});
+	// A path is built from parts the way paths to assets are built.
+	suite->run("String concatenation", STRING_BENCHMARK_OPERATION_COUNT, []() {
+		u32 len = 0;
+		String directory = "data/models/";
+		for (u32 i = 0; i < STRING_BENCHMARK_OPERATION_COUNT; i++) {
+			String path = directory + "props/" + "crate.gltf";
+			len += path.len;
+		}
+		do_not_optimize(len);
+	});
+
+	char buffer[256];
+	suite->run("format_to integers and floats", STRING_BENCHMARK_OPERATION_COUNT, [&]() {
+		u32 len = 0;
+		for (u32 i = 0; i < STRING_BENCHMARK_OPERATION_COUNT; i++) {
+			len += format_to(buffer, sizeof(buffer), "Entity {} at ({}, {}, {})", i, (float)i * 0.5f, 1.25f, -3.0f);
+		}
+		do_not_optimize(len);
+	});
+	suite->run("format_to strings", STRING_BENCHMARK_OPERATION_COUNT, [&]() {
+		u32 len = 0;
+		const char *name = "Sponza.gltf";
+		for (u32 i = 0; i < STRING_BENCHMARK_OPERATION_COUNT; i++) {
+			len += format_to(buffer, sizeof(buffer), "load_mesh: {} was loaded from {}.", name, "data/models");
+		}
+		do_not_optimize(len);
+	});
+	suite->run("format_string", STRING_BENCHMARK_OPERATION_COUNT, []() {
+		u32 len = 0;
+		for (u32 i = 0; i < STRING_BENCHMARK_OPERATION_COUNT; i++) {
+			String string = format_string("{}_{}", "mesh", i);
+			len += string.len;
+		}
+		do_not_optimize(len);
+	});
+
+	String text;
+	for (u32 i = 0; i < SPLIT_BENCHMARK_WORD_COUNT; i++) {
+		text.append("word ");
+	}
+	suite->run("split", SPLIT_BENCHMARK_WORD_COUNT, [&]() {
+		Array<String> words;
+		split(&text, " ", &words);
+		do_not_optimize(words.count);
+	});
+}
@@ -2,6 +2,7 @@
 
 #include "collision.h"
 #include "../libs/math/functions.h"
+#include "../libs/math/intersection_batch.h"
 
 AABB make_AABB(Triangle_Mesh *mesh)
 {
@@ -41,45 +42,16 @@ Bounding_Sphere make_bounding_sphere(const Vector3 &position, Triangle_Mesh *mes
 	return bounding_sphere;
 }
 
-#include <algorithm>
-
+// Boxes behind the ray origin are missed, the intersection point is the origin if it is inside the box.
 bool detect_intersection(Ray *ray, AABB *aabb, Vector3 *intersection_point)
 {
-	float tmin = (aabb->min.x - ray->origin.x) / ray->direction.x;
-	float tmax = (aabb->max.x - ray->origin.x) / ray->direction.x;
-
-	if (tmin > tmax) std::swap(tmin, tmax);
-
-	float tymin = (aabb->min.y - ray->origin.y) / ray->direction.y;
-	float tymax = (aabb->max.y - ray->origin.y) / ray->direction.y;
-
-	if (tymin > tymax) std::swap(tymin, tymax);
-
-	if ((tmin > tymax) || (tymin > tmax))
+	Batch_Ray batch_ray = make_batch_ray(ray->origin, ray->direction);
+	float distance;
+	if (!detect_intersection(&batch_ray, aabb->min, aabb->max, &distance)) {
 		return false;
-
-	if (tymin > tmin)
-		tmin = tymin;
-
-	if (tymax < tmax)
-		tmax = tymax;
-
-	float tzmin = (aabb->min.z - ray->origin.z) / ray->direction.z;
-	float tzmax = (aabb->max.z - ray->origin.z) / ray->direction.z;
-
-	if (tzmin > tzmax) std::swap(tzmin, tzmax);
-
-	if ((tmin > tzmax) || (tzmin > tmax))
-		return false;
-
-	if (tzmin > tmin)
-		tmin = tzmin;
-
-	if (tzmax < tmax)
-		tmax = tzmax;
-
+	}
 	if (intersection_point) {
-		*intersection_point = ray->origin + (Vector3)(ray->direction * tmin);
+		*intersection_point = ray->origin + ray->direction * distance;
 	}
 	return true;
 }
@@ -8,7 +8,7 @@ inline void init_entity(Entity *entity, Entity_Type type, const Vector3 &positio
 {
 	entity->type = type;
 	entity->scaling = Vector3(1.0f, 1.0f, 1.0f);
-	entity->rotation = Vector3(0.0f, 0.0f, 0.0f);
+	entity->orientation = make_identity_quaternion();
 	entity->position = position;
 }
 
@@ -16,19 +16,58 @@ inline void init_entity(Entity *entity, Entity_Type type, const Vector3 &scaling
 {
 	entity->type = type;
 	entity->scaling = scaling;
-	entity->rotation = rotation;
+	entity->orientation = make_quaternion(rotation.x, rotation.y, rotation.z);
 	entity->position = position;
 }
 
+template <typename T>
+inline Entity_Id add_entity(Array<T> &entity_list, Slot_Map &slot_map, T &entity)
+{
+	entity.idx = slot_map.add(&entity.generation);
+	entity_list.push(entity);
+	return get_entity_id(&entity);
+}
+
+template <typename T>
+inline T *find_entity(Array<T> &entity_list, Slot_Map &slot_map, Entity_Id entity_id)
+{
+	u32 dense_index;
+	if (slot_map.get(entity_id.index, entity_id.generation, &dense_index)) {
+		return &entity_list[dense_index];
+	}
+	return NULL;
+}
+
+template <typename T>
+inline bool remove_entity(Array<T> &entity_list, Slot_Map &slot_map, Entity_Id entity_id)
+{
+	u32 dense_index;
+	if (slot_map.remove(entity_id.index, entity_id.generation, &dense_index)) {
+		entity_list.swap_remove(dense_index);
+		return true;
+	}
+	return false;
+}
+
+template <typename T>
+inline void rebuild_slot_map(Array<T> &entity_list, Slot_Map &slot_map)
+{
+	slot_map.clear();
+	for (u32 i = 0; i < entity_list.count; i++) {
+		slot_map.restore(entity_list[i].idx, entity_list[i].generation);
+	}
+	slot_map.link_free_slots();
+}
+
 Entity *Game_World::get_entity(Entity_Id entity_id)
 {
 	switch (entity_id.type) {
 		case ENTITY_TYPE_ENTITY:
-			return &entities[entity_id.index];
+			return find_entity(entities, entity_slots, entity_id);
 		case ENTITY_TYPE_LIGHT:
-			return &lights[entity_id.index];
+			return find_entity(lights, light_slots, entity_id);
 		case ENTITY_TYPE_GEOMETRY:
-			return &geometry_entities[entity_id.index];
+			return find_entity(geometry_entities, geometry_entity_slots, entity_id);
 		case ENTITY_TYPE_CAMERA:
 			return get_camera(entity_id);
 	}
@@ -37,8 +76,9 @@ Entity *Game_World::get_entity(Entity_Id entity_id)
 
 Camera *Game_World::get_camera(Entity_Id entity_id)
 {
-	if ((entity_id.type == ENTITY_TYPE_CAMERA) && (entity_id.index < cameras.count)) {
-		return &cameras[entity_id.index];
+	Camera *camera = NULL;
+	if ((entity_id.type == ENTITY_TYPE_CAMERA) && (camera = find_entity(cameras, camera_slots, entity_id))) {
+		return camera;
 	}
 	print("Game_World::get_camera: Failed to get a camera. The entity id not valied.");
 	return NULL;
@@ -48,18 +88,14 @@ Entity_Id Game_World::make_entity(const Vector3 &position)
 {
 	Entity entity;
 	init_entity(&entity, ENTITY_TYPE_ENTITY, position);
-	entity.idx = entities.count;
-	entities.push(entity);
-	return get_entity_id(&entity);
+	return add_entity(entities, entity_slots, entity);
 }
 
 Entity_Id Game_World::make_entity(const Vector3 &scaling, const Vector3 &rotation, const Vector3 &position)
 {
 	Entity entity;
 	init_entity(&entity, ENTITY_TYPE_ENTITY, scaling, rotation, position);
-	entity.idx = entities.count;
-	entities.push(entity);
-	return get_entity_id(&entity);
+	return add_entity(entities, entity_slots, entity);
 }
 
 Entity_Id Game_World::make_camera(const Vector3 &position, const Vector3 &target)
@@ -68,9 +104,7 @@ Entity_Id Game_World::make_camera(const Vector3 &position, const Vector3 &target
 	init_entity(&camera, ENTITY_TYPE_CAMERA, position);
 	camera.up = Vector3::base_y;
 	camera.target = target;
-	camera.idx = cameras.count;
-	cameras.push(camera);
-	return get_entity_id(&camera);
+	return add_entity(cameras, camera_slots, camera);
 }
 
 Entity_Id Game_World::make_geometry_entity(const Vector3 &position, Geometry_Type geometry_type, void *data)
@@ -79,7 +113,6 @@ Entity_Id Game_World::make_geometry_entity(const Vector3 &position, Geometry_Typ
 	init_entity(&geometry_entity, ENTITY_TYPE_GEOMETRY, position);
 
 	geometry_entity.geometry_type = geometry_type;
-	geometry_entity.idx = geometry_entities.count;
 
 	if (geometry_type == GEOMETRY_TYPE_BOX) {
 		geometry_entity.box = *((Box *)data);
@@ -91,8 +124,7 @@ Entity_Id Game_World::make_geometry_entity(const Vector3 &position, Geometry_Typ
 		print("Game_World::make_geometry_entity: Was passed not existing Geometry Type argument.");
 		return Entity_Id();
 	}
-	geometry_entities.push(geometry_entity);
-	return get_entity_id(&geometry_entity);
+	return add_entity(geometry_entities, geometry_entity_slots, geometry_entity);
 }
 
 
@@ -102,11 +134,8 @@ Entity_Id Game_World::make_direction_light(const Vector3 &direction, const Vecto
 	init_entity(&light, ENTITY_TYPE_LIGHT, Vector3(0.0f, 100.0f, 0.0f));
 	light.direction = direction;
 	light.color = color;
-	light.light_type = DIRECTIONAL_LIGHT_TYPE;;
-	light.idx = lights.count;
-
-	lights.push(light);
-	return get_entity_id(&light);
+	light.light_type = DIRECTIONAL_LIGHT_TYPE;
+	return add_entity(lights, light_slots, light);
 }
 
 Entity_Id Game_World::make_point_light(const Vector3 &position, const Vector3 &color, float range)
@@ -116,10 +145,7 @@ Entity_Id Game_World::make_point_light(const Vector3 &position, const Vector3 &c
 	light.color = color;
 	light.light_type = POINT_LIGHT_TYPE;
 	light.range = range;
-	light.idx = lights.count;
-
-	lights.push(light);
-	return get_entity_id(&light);
+	return add_entity(lights, light_slots, light);
 }
 
 Entity_Id Game_World::make_spot_light(const Vector3 &position, const Vector3 &direction, const Vector3 &color, float radius)
@@ -130,10 +156,7 @@ Entity_Id Game_World::make_spot_light(const Vector3 &position, const Vector3 &di
 	light.color = color;
 	light.light_type = SPOT_LIGHT_TYPE;
 	light.radius = radius;
-	light.idx = lights.count;
-
-	lights.push(light);
-	return get_entity_id(&light);
+	return add_entity(lights, light_slots, light);
 }
 
 void Game_World::init()
@@ -146,45 +169,49 @@ void Game_World::release_all_resources()
 	cameras.clear();
 	lights.clear();
 	geometry_entities.clear();
+
+	entity_slots.clear();
+	camera_slots.clear();
+	light_slots.clear();
+	geometry_entity_slots.clear();
 }
 
-template <typename T>
-inline void update_entity_indices(u32 start_index, Array<T> &entity_list)
+// Entities read from a level file keep their ids, the slot maps are built again from them.
+void Game_World::rebuild_slot_maps()
 {
-	for (u32 i = start_index; i < entity_list.count; i++) {
-		Entity *entity = &entity_list[i];
-		assert(entity->idx > 0);
-		entity->idx--;
-	}
+	rebuild_slot_map(entities, entity_slots);
+	rebuild_slot_map(cameras, camera_slots);
+	rebuild_slot_map(lights, light_slots);
+	rebuild_slot_map(geometry_entities, geometry_entity_slots);
 }
 
 void Game_World::delete_entity(Entity_Id entity_id)
 {
+	bool result = false;
 	switch (entity_id.type) {
 		case ENTITY_TYPE_ENTITY: {
-			entities.remove(entity_id.index);
-			update_entity_indices(entity_id.index, entities);
+			result = remove_entity(entities, entity_slots, entity_id);
 			break;
 		}
 		case ENTITY_TYPE_LIGHT: {
-			lights.remove(entity_id.index);
-			update_entity_indices(entity_id.index, lights);
+			result = remove_entity(lights, light_slots, entity_id);
 			break;
 		}
 		case ENTITY_TYPE_GEOMETRY: {
-			geometry_entities.remove(entity_id.index);
-			update_entity_indices(entity_id.index, geometry_entities);
+			result = remove_entity(geometry_entities, geometry_entity_slots, entity_id);
 			break;
 		}
 		case ENTITY_TYPE_CAMERA: {
-			cameras.remove(entity_id.index);
-			update_entity_indices(entity_id.index, cameras);
+			result = remove_entity(cameras, camera_slots, entity_id);
 			break;
 		}
 		default: {
 			assert(false);
 		}
 	}
+	if (!result) {
+		print("Game_World::delete_entity: Failed to delete an entity. The entity id is not valid.");
+	}
 }
 
 void Game_World::attach_AABB(Entity_Id entity_id, AABB *bounding_box)
@@ -229,9 +256,10 @@ Entity_Id::Entity_Id()
 {
 	type = ENTITY_TYPE_UNKNOWN;
 	index = UINT32_MAX;
+	generation = 0;
 }
 
-Entity_Id::Entity_Id(Entity_Type type, u32 index) : type(type), index(index)
+Entity_Id::Entity_Id(Entity_Type type, u32 index, u32 generation) : type(type), index(index), generation(generation)
 {
 }
 
@@ -239,6 +267,7 @@ void Entity_Id::reset()
 {
 	type = ENTITY_TYPE_UNKNOWN;
 	index = UINT32_MAX;
+	generation = 0;
 }
 
 void Camera::handle_commands(Array<Entity_Command *> *entity_commands)
@@ -287,11 +316,11 @@ void Camera::handle_commands(Array<Entity_Command *> *entity_commands)
 			case ENTITY_COMMAND_ROTATE: {
 				Entity_Command_Rotate *rotate_command = static_cast<Entity_Command_Rotate *>(entity_command);
 
-				Matrix4 rotation_matrix = rotate_about_x(rotate_command->y_angle) * rotate_about_y(rotate_command->x_angle);
+				Quaternion rotation = make_quaternion(Vector3::base_x, rotate_command->y_angle) * make_quaternion(Vector3::base_y, rotate_command->x_angle);
 				//@Note: Why I just don't normalize target vector ?
 				Vector3 target_direction = target - position;
 				Vector3 normalized_target = normalize(&target_direction);
-				target = (normalized_target * rotation_matrix) + position;
+				target = (normalized_target * rotation) + position;
 				break;
 			}
 		}
@@ -300,7 +329,7 @@ void Camera::handle_commands(Array<Entity_Command *> *entity_commands)
 
 bool operator==(const Entity_Id &first, const Entity_Id &second)
 {
-	if ((first.type == second.type) && (first.index == second.index)) {
+	if ((first.type == second.type) && (first.index == second.index) && (first.generation == second.generation)) {
 		return true;
 	}
 	return false;
@@ -308,8 +337,5 @@ bool operator==(const Entity_Id &first, const Entity_Id &second)
 
 bool operator!=(const Entity_Id &first, const Entity_Id &second)
 {
-	if ((first.type != second.type) && (first.index != second.index)) {
-		return true;
-	}
-	return false;
+	return !(first == second);
 }
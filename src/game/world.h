@@ -6,8 +6,10 @@
 
 #include "../libs/geometry.h"
 #include "../libs/math/vector.h"
+#include "../libs/math/quaternion.h"
 #include "../libs/number_types.h"
 #include "../libs/structures/array.h"
+#include "../libs/structures/slot_map.h"
 #include "../collision/collision.h"
 
 
@@ -19,12 +21,15 @@ enum Entity_Type : u32 {
 	ENTITY_TYPE_CAMERA,
 };
 
+// The index is a slot in the entity slot map and the generation tells that the slot
+// still holds the same entity, so an id of a deleted entity never finds another one.
 struct Entity_Id {
 	Entity_Id();
-	Entity_Id(Entity_Type type, u32 index);
+	Entity_Id(Entity_Type type, u32 index, u32 generation);
 
 	Entity_Type type;
 	u32 index;
+	u32 generation;
 
 	void reset();
 };
@@ -35,10 +40,11 @@ bool operator!=(const Entity_Id &first, const Entity_Id &second);
 struct Entity {
 	Entity() { type = ENTITY_TYPE_ENTITY; bounding_box_type = BOUNDING_BOX_TYPE_UNKNOWN; }
 	u32 idx;
+	u32 generation = 0;
 	Entity_Type type;
 
 	Vector3 scaling;
-	Vector3 rotation;
+	Quaternion orientation;
 	Vector3 position;
 
 	//@Note: Why is this here ?
@@ -49,7 +55,12 @@ struct Entity {
 inline Entity_Id get_entity_id(Entity *entity)
 {
 	//@Note: Should entity_id field be in the Entity struct ?
-	return Entity_Id(entity->type, entity->idx);
+	return Entity_Id(entity->type, entity->idx, entity->generation);
+}
+
+inline u64 make_entity_key(Entity_Id entity_id)
+{
+	return ((u64)entity_id.type << 56) | ((u64)(entity_id.generation & 0xffffff) << 32) | (u64)entity_id.index;
 }
 
 inline bool valid_entity_id(Entity_Id entity_id)
@@ -145,8 +156,14 @@ struct Game_World {
 	Array<Light> lights;
 	Array<Geometry_Entity> geometry_entities;
 
+	Slot_Map entity_slots;
+	Slot_Map camera_slots;
+	Slot_Map light_slots;
+	Slot_Map geometry_entity_slots;
+
 	void init();
 	void release_all_resources();
+	void rebuild_slot_maps();
 
 	void delete_entity(Entity_Id entity_id);
 
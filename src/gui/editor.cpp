@@ -3,6 +3,7 @@
 
 #include "editor.h"
 #include "../sys/sys.h"
+#include "../sys/jobs.h"
 #include "../sys/utils.h"
 #include "../sys/engine.h"
 #include "../sys/commands.h"
@@ -18,6 +19,7 @@
 #include "../libs/math/3dmath.h"
 #include "../libs/math/functions.h"
 #include "../libs/math/structures.h"
+#include "../libs/math/intersection_batch.h"
 
 #include "../render/helpers.h"
 #include "../render/render_world.h"
@@ -91,55 +93,30 @@ inline void calculate_picking_ray(Vector3 &camera_position, Matrix4 &view_matrix
 	*ray = Ray(camera_position, to_vector3(mouse_point_in_world) - camera_position);
 }
 
-inline float find_triangle_area(const Vector3 &a, const Vector3 &b, const Vector3 &c)
-{
-	Vector3 area = cross(b - a, c - a); //  The magnitude of the cross-product can be interpreted as the area of the parallelogram
-	return length(area) * 0.5f;
-}
-
-struct Ray_Trinagle_Intersection_Result {
-	Vector3 a;
-	Vector3 b;
-	Vector3 c;
-	Vector3 intersection_point;
-};
-
-static bool detect_intersection(Matrix4 &entity_world_matrix, Ray *picking_ray, Vertex_PNTUV *vertices, u32 vertex_count, u32 *indices, u32 index_count, Ray_Trinagle_Intersection_Result *intersection_result = NULL)
+// The mesh is tested in its model space, the ray is moved there by the inverse of the world matrix instead of moving
+// every vertex to the world space. The world matrix is affine, so a distance along the moved ray is the same distance
+// along the picking ray.
+static bool detect_intersection(Matrix4 &entity_world_matrix, Ray *picking_ray, Vertex_PNTUV *vertices, u32 *indices, u32 index_count, float *distance)
 {
 	assert(picking_ray);
 	assert(vertices);
 	assert(indices);
+	assert(distance);
 	assert(index_count % 3 == 0);
 
-	for (u32 index = 0, i = 0; i < (index_count / 3); index += 3, i++) {
-		Vector3 a = vertices[indices[index + 0]].position * entity_world_matrix;
-		Vector3 b = vertices[indices[index + 1]].position * entity_world_matrix;
-		Vector3 c = vertices[indices[index + 2]].position * entity_world_matrix;
-		Vector3 plane_normal = normalize(vertices[indices[index]].normal * entity_world_matrix.to_matrix3());
-
-		float result = dot(picking_ray->direction, plane_normal);
-		if (result < 0.0f) {
-			Vector3 plane_origin = (a + b + c) / 3.0f;
-			float ray_length = dot(plane_origin - picking_ray->origin, plane_normal) / result;
-			if (ray_length > 0.0f) {
-				Vector3 ray_plane_intersection_point = picking_ray->origin + Vector3(picking_ray->direction * ray_length);
-
-				float triangle_area = find_triangle_area(a, b, c);
-				float u = find_triangle_area(c, a, ray_plane_intersection_point) / triangle_area;
-				float v = find_triangle_area(a, b, ray_plane_intersection_point) / triangle_area;
-				float w = find_triangle_area(b, c, ray_plane_intersection_point) / triangle_area;
-
-				if (in_range(0.0f, 1.1f, u + v + w)) {
-					if (result) {
-						intersection_result->a = a;
-						intersection_result->b = b;
-						intersection_result->c = c;
-						intersection_result->intersection_point = ray_plane_intersection_point;
-					}
-					return true;
-				}
-			}
-		}
+	Matrix4 inverse_world_matrix = inverse_affine(entity_world_matrix);
+	Batch_Ray ray = make_batch_ray(picking_ray->origin * inverse_world_matrix, picking_ray->direction * inverse_world_matrix.to_matrix3());
+
+	Triangle_Streams triangles;
+	triangles.resize(index_count / 3);
+	for (u32 index = 0, i = 0; i < triangles.count; index += 3, i++) {
+		triangles.set(i, vertices[indices[index + 0]].position, vertices[indices[index + 1]].position, vertices[indices[index + 2]].position);
+	}
+
+	Triangle_Intersection intersection;
+	if (find_nearest_intersection(&ray, &triangles, 0, triangles.count, &intersection)) {
+		*distance = intersection.distance;
+		return true;
 	}
 	return false;
 }
@@ -155,44 +132,83 @@ struct Ray_Entity_Intersection {
 
 bool Ray_Entity_Intersection::detect_intersection(Ray *picking_ray, Game_World *game_world, Render_World *render_world, Result *result)
 {
-	Array<Result> intersected_entities;
+	// The boxes of all entities are tested at once, only meshes in the hit boxes are tested triangle by triangle.
+	AABB_Streams boxes;
+	boxes.resize(render_world->game_render_entities.count);
+	Array<u32> box_render_entities;
+
 	for (u32 i = 0; i < render_world->game_render_entities.count; i++) {
-		Entity_Id entity_id = render_world->game_render_entities[i].entity_id;
-		Entity *entity = game_world->get_entity(entity_id);
+		Entity *entity = game_world->get_entity(render_world->game_render_entities[i].entity_id);
+		if (entity->bounding_box_type == BOUNDING_BOX_TYPE_AABB) {
+			boxes.set(box_render_entities.count, entity->AABB_box.min, entity->AABB_box.max);
+			box_render_entities.push(i);
+		}
+	}
+	boxes.resize(box_render_entities.count);
 
-		if (entity->bounding_box_type == BOUNDING_BOX_TYPE_UNKNOWN) {
-			continue;
+	Batch_Ray ray = make_batch_ray(picking_ray->origin, picking_ray->direction);
+	Array<float> box_distances;
+	box_distances.reserve(boxes.count);
+	if (!detect_intersections(&ray, &boxes, 0, boxes.count, box_distances.items)) {
+		return false;
+	}
+
+	struct Entity_Intersection {
+		bool intersected = false;
+		u32 render_entity_index = 0;
+		float box_distance = 0.0f;
+		Result result;
+	};
+	Array<Entity_Intersection> entity_intersections;
+	for (u32 i = 0; i < boxes.count; i++) {
+		if (box_distances[i] < FLT_MAX) {
+			Entity_Intersection entity_intersection;
+			entity_intersection.render_entity_index = box_render_entities[i];
+			entity_intersection.box_distance = box_distances[i];
+			entity_intersections.push(entity_intersection);
 		}
+	}
 
-		if (entity->bounding_box_type == BOUNDING_BOX_TYPE_AABB) {
-			Result intersection_result;
-			if (::detect_intersection(picking_ray, &entity->AABB_box, &intersection_result.intersection_point)) {
-				if (entity->type == ENTITY_TYPE_GEOMETRY) {
-					Geometry_Entity *geometry_entity = static_cast<Geometry_Entity *>(entity);
-					if (geometry_entity->geometry_type == GEOMETRY_TYPE_BOX) {
-						intersection_result.entity_id = entity_id;
-						intersection_result.render_entity_idx = i;
-						intersected_entities.push(intersection_result);
-					}
-				} else {
-					Mesh_Idx mesh_id = render_world->game_render_entities[i].mesh_idx;
-					Render_Model *render_model = render_world->model_storage.render_models[mesh_id];
+	// Meshes are tested on all job threads, every entity writes only its own intersection.
+	parallel_for(entity_intersections, [&](Entity_Intersection *entity_intersection, u32 i) {
+		u32 render_entity_index = entity_intersection->render_entity_index;
+		Render_Entity *render_entity = &render_world->game_render_entities[render_entity_index];
+		Entity *entity = game_world->get_entity(render_entity->entity_id);
+
+		Result intersection_result;
+		intersection_result.entity_id = render_entity->entity_id;
+		intersection_result.render_entity_idx = render_entity_index;
+
+		if (entity->type == ENTITY_TYPE_GEOMETRY) {
+			Geometry_Entity *geometry_entity = static_cast<Geometry_Entity *>(entity);
+			if (geometry_entity->geometry_type == GEOMETRY_TYPE_BOX) {
+				intersection_result.intersection_point = picking_ray->origin + picking_ray->direction * entity_intersection->box_distance;
+				entity_intersection->intersected = true;
+				entity_intersection->result = intersection_result;
+			}
+		} else {
+			Mesh_Idx mesh_id = render_entity->mesh_idx;
+			Render_Model *render_model = render_world->model_storage.render_models[mesh_id];
 
-					Vertex_PNTUV *vertices = render_model->mesh.vertices.items;
-					u32 *indices = render_model->mesh.indices.items;
+			Vertex_PNTUV *vertices = render_model->mesh.vertices.items;
+			u32 *indices = render_model->mesh.indices.items;
 
-					Matrix4 entity_world_matrix = get_world_matrix(entity);
+			Matrix4 entity_world_matrix = get_world_matrix(entity);
 
-					Ray_Trinagle_Intersection_Result ray_mesh_intersection_result;
-					if (::detect_intersection(entity_world_matrix, picking_ray, vertices, render_model->mesh.vertex_count(), indices, render_model->mesh.index_count(), &ray_mesh_intersection_result)) {
-						intersection_result.entity_id = entity_id;
-						intersection_result.render_entity_idx = i;
-						intersection_result.intersection_point = ray_mesh_intersection_result.intersection_point;
-						intersected_entities.push(intersection_result);
-					}
-				}
+			float mesh_distance;
+			if (::detect_intersection(entity_world_matrix, picking_ray, vertices, indices, render_model->mesh.index_count(), &mesh_distance)) {
+				intersection_result.intersection_point = picking_ray->origin + picking_ray->direction * mesh_distance;
+				entity_intersection->intersected = true;
+				entity_intersection->result = intersection_result;
 			}
 		}
+	});
+
+	Array<Result> intersected_entities;
+	for (u32 i = 0; i < entity_intersections.count; i++) {
+		if (entity_intersections[i].intersected) {
+			intersected_entities.push(entity_intersections[i].result);
+		}
 	}
 
 	if (!intersected_entities.is_empty()) {
@@ -344,7 +360,7 @@ void Entity_Window::draw()
 		str_entity_id = to_string(get_entity_id(entity));
 		if (editor->picked_entity != prev_entity_id) {
 			scaling = entity->scaling;
-			rotation = entity->rotation;
+			rotation = get_euler_angles(entity->orientation);
 			position = entity->position;
 			if (entity->type == ENTITY_TYPE_LIGHT) {
 				Light *light = static_cast<Light *>(entity);
@@ -365,7 +381,9 @@ void Entity_Window::draw()
 				if (gui::edit_field("Scaling", &scaling)) {
 					entity->scaling = scaling;
 				}
-				gui::edit_field("Rotation", &rotation);
+				if (gui::edit_field("Rotation", &rotation)) {
+					entity->orientation = make_quaternion(rotation.x, rotation.y, rotation.z);
+				}
 				if (gui::edit_field("Position", &position)) {
 					game_world->place_entity(entity, position);
 				}
@@ -410,7 +428,7 @@ void Entity_Tree_Window::draw_entity_list(Array<T> &entity_list, const char *nam
 						Silhouette_Pass *silhouette_pass = &render_system->passes.silhouette_pass;
 						silhouette_pass->reset_render_entity_indices();
 						u32 index = 0;
-						Render_Entity *render_entity = find_render_entity(&render_world->game_render_entities, entity_id, &index);
+						Render_Entity *render_entity = render_world->find_render_entity(entity_id, &index);
 						if (render_entity) {
 							editor->picked_entity = entity_id;
 							silhouette_pass->add_render_entity_index(index);
@@ -851,17 +869,16 @@ void Editor::handle_events()
 {
 	key_bindings.handle_events();
 	if (!gui::were_events_handled() && (editor_mode == EDITOR_MODE_COMMON)) {
-		//@Note: In the future here better to use linear allocator.
-		Array<Editor_Command> editor_commands;
-		Array<Entity_Command *> entity_commands;
+		// The commands live only during this frame, so they are placed in the frame arena.
+		Frame_Arena *frame_arena = Engine::get_frame_arena();
+		Array<Editor_Command> editor_commands(frame_arena);
+		Array<Entity_Command *> entity_commands(frame_arena);
 
 		convert_user_input_events_to_edtior_commands(&editor_commands);
 		convert_editor_commands_to_entity_commands(&editor_commands, &entity_commands);
 
 		Camera *camera = game_world->get_camera(editor_camera_id);
 		camera->handle_commands(&entity_commands);
-
-		free_memory(&entity_commands);
 	}
 }
 
@@ -979,9 +996,13 @@ void Editor::render_menus()
 		}
 		if (gui::menu_item("Delete")) {
 			game_world->delete_entity(picked_entity);
-			u32 render_entity_index = render_world->delete_render_entity(picked_entity);
-			Silhouette_Pass *silhouette_pass = &render_sys->passes.silhouette_pass;
-			silhouette_pass->delete_render_entity_index(render_entity_index);
+			u32 render_entity_index = 0;
+			u32 moved_render_entity_index = 0;
+			if (render_world->delete_render_entity(picked_entity, &render_entity_index, &moved_render_entity_index)) {
+				Silhouette_Pass *silhouette_pass = &render_sys->passes.silhouette_pass;
+				silhouette_pass->delete_render_entity_index(render_entity_index, moved_render_entity_index);
+			}
+			picked_entity.reset();
 		}
 		gui::end_menu();
 	}
@@ -1046,17 +1067,17 @@ void Editor::convert_user_input_events_to_edtior_commands(Array<Editor_Command>
 		Event *event = &node->item;
 
 		Editor_Command editor_command;
+		editor_command.command.allocator = editor_commands->allocator;
 		if (event->type == EVENT_TYPE_KEY) {
 			Find_Command_Result result = key_command_bindings.find_command(event->key_info.key, event->key_info.key_state, &editor_command.command);
 			if (result == COMMAND_FIND) {
-				editor_commands->push(editor_command);
+				editor_commands->push(std::move(editor_command));
 			}
 
 		} else if (event->type == EVENT_TYPE_MOUSE) {
-			Editor_Command rotate_camera_command;
 			editor_command.command = "rotate_camera";
 			editor_command.additional_info = (void *)&event->mouse_info;
-			editor_commands->push(editor_command);
+			editor_commands->push(std::move(editor_command));
 		}
 	}
 }
@@ -1066,6 +1087,7 @@ void Editor::convert_editor_commands_to_entity_commands(Array<Editor_Command> *e
 	static s32 last_x = 0;
 	static s32 last_y = 0;
 	static bool rotate_camera = false;
+	Frame_Arena *frame_arena = Engine::get_frame_arena();
 
 	for (u32 i = 0; i < editor_commands->count; i++) {
 		Editor_Command &editor_command = editor_commands->get(i);
@@ -1073,25 +1095,25 @@ void Editor::convert_editor_commands_to_entity_commands(Array<Editor_Command> *e
 		void *additional_info = editor_command.additional_info;
 
 		if (command == "move_camera_forward") {
-			Entity_Command_Move *move_command = new Entity_Command_Move;
+			Entity_Command_Move *move_command = frame_arena->make<Entity_Command_Move>();
 			move_command->move_direction = MOVE_DIRECTION_FORWARD;
 			move_command->distance = editor_settings.camera_speed;
 			entity_commands->push(move_command);
 
 		} else if (command == "move_camera_back") {
-			Entity_Command_Move *move_command = new Entity_Command_Move;
+			Entity_Command_Move *move_command = frame_arena->make<Entity_Command_Move>();
 			move_command->move_direction = MOVE_DIRECTION_BACK;
 			move_command->distance = editor_settings.camera_speed;
 			entity_commands->push(move_command);
 
 		} else if (command == "move_camera_left") {
-			Entity_Command_Move *move_command = new Entity_Command_Move;
+			Entity_Command_Move *move_command = frame_arena->make<Entity_Command_Move>();
 			move_command->move_direction = MOVE_DIRECTION_LEFT;
 			move_command->distance = editor_settings.camera_speed;
 			entity_commands->push(move_command);
 
 		} else if (command == "move_camera_right") {
-			Entity_Command_Move *move_command = new Entity_Command_Move;
+			Entity_Command_Move *move_command = frame_arena->make<Entity_Command_Move>();
 			move_command->move_direction = MOVE_DIRECTION_RIGHT;
 			move_command->distance = editor_settings.camera_speed;
 			entity_commands->push(move_command);
@@ -1112,7 +1134,7 @@ void Editor::convert_editor_commands_to_entity_commands(Array<Editor_Command> *e
 			float x_angle = degrees_to_radians((float)(mouse_info->x - last_x));
 			float y_angle = -degrees_to_radians((float)(mouse_info->y - last_y));
 
-			Entity_Command_Rotate *rotate_command = new Entity_Command_Rotate;
+			Entity_Command_Rotate *rotate_command = frame_arena->make<Entity_Command_Rotate>();
 			rotate_command->x_angle = x_angle * editor_settings.camera_rotation_speed;
 			rotate_command->y_angle = y_angle * editor_settings.camera_rotation_speed;
 
@@ -7,10 +7,11 @@
 #include "../libs/number_types.h"
 #include "../libs/structures/array.h"
 #include "../libs/structures/hash_table.h"
+#include "../libs/structures/dense_hash_table.h"
 
 template <typename Enum_Type>
 struct Enum_Helper {
-	Hash_Table<u32, String> index_str_table;
+	Dense_Hash_Table<u32, String> index_str_table;
 	Hash_Table<String, u32> str_index_table;
 
 	void get_string_enums(Array<String> *array);
@@ -251,6 +251,7 @@ struct Gui_Window {
 	bool display_vertical_scrollbar = false;
 	bool display_horizontal_scrollbar = false;
 	Gui_ID gui_id = 0;
+	String_Id name_id = EMPTY_STRING_ID;
 	u32 edit_field_count = 0;
 	u32 max_edit_field_number = 0;
 	s32 index_in_windows_array = -1;
@@ -849,10 +850,10 @@ Gui_Window *Gui_Manager::get_parent_window(Gui_Window *window)
 
 Gui_Window *Gui_Manager::find_window(const char *name, u32 *window_index)
 {
-	Gui_ID window_id = fast_hash(name);
+	String_Id window_name_id = make_string_id(name);
 
 	for (u32 i = 0; i < windows.count; i++) {
-		if (name == windows[i].name) {
+		if (window_name_id == windows[i].name_id) {
 			if (window_index) {
 				*window_index = i;
 			}
@@ -864,11 +865,11 @@ Gui_Window *Gui_Manager::find_window(const char *name, u32 *window_index)
 
 Gui_Window *Gui_Manager::find_window_in_order(const char *name, int *window_index)
 {
-	Gui_ID window_id = fast_hash(name);
+	String_Id window_name_id = make_string_id(name);
 
 	for (u32 i = 0; i < windows_order.count; i++) {
 		Gui_Window *window = get_window_by_index(&windows_order, i);
-		if (name == window->name) {
+		if (window_name_id == window->name_id) {
 			*window_index = i;
 			return window;
 		}
@@ -896,6 +897,7 @@ Gui_Window *Gui_Manager::create_window(const char *name, Window_Type window_type
 	Gui_Window window;
 	window.open = window_open;
 	window.name = name;
+	window.name_id = intern_string(name);
 	window.gui_id = fast_hash(name);
 	window.type = window_type;
 
@@ -1777,8 +1779,8 @@ bool Gui_Manager::begin_list(const char *name, Gui_List_Column columns[], u32 co
 	assert(name);
 	assert(columns_count > 0);
 
-	line_list.count = 0;
-	list_column_rect_list.count = 0;
+	line_list.reset();
+	list_column_rect_list.reset();
 
 	Gui_Window_Theme window_theme;
 	window_theme.background_color = list_theme.background_color;
@@ -1799,7 +1801,7 @@ bool Gui_Manager::begin_list(const char *name, Gui_List_Column columns[], u32 co
 	}
 
 	if (begin_child(name, WINDOW_SCROLL_BAR)) {
-		line_list.count = 0;
+		line_list.reset();
 		Gui_Window *window = get_window();
 
 		if (!list_theme.column_filter) {
@@ -1936,7 +1938,7 @@ void Gui_Manager::end_list()
 		Window_Context *window_context = static_cast<Window_Context *>(context);
 		Window_Placing_State window_placing_state = window_context->get_placing_state();
 
-		Array<Rect_s32> line_rects;
+		Small_Array<Rect_s32, 64> line_rects;
 		for (u32 i = 0; i < line_list.count; i++) {
 			Rect_s32 temp = { 0, 0, get_window_size().width, list_theme.line_height };
 			context->place_rect(&temp);
@@ -2133,7 +2135,7 @@ bool Gui_Manager::begin_line(Gui_List_Line_State *list_line_state)
 	list_line_debug_counter++;
 #endif
 	current_list_line.state = list_line_state;
-	current_list_line.columns.count = 0;
+	current_list_line.columns.reset();
 	return true;
 }
 
@@ -2153,7 +2155,7 @@ bool Gui_Manager::begin_column(const char *filter_name)
 	list_column_debug_counter++;
 #endif
 	current_list_column.name = filter_name;
-	current_list_column.rendering_data_list.count = 0;
+	current_list_column.rendering_data_list.reset();
 	return true;
 }
 
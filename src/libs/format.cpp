@@ -0,0 +1,275 @@
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+
+#include "format.h"
+
+Format_Buffer::Format_Buffer()
+{
+}
+
+Format_Buffer::Format_Buffer(char *buffer, u32 buffer_size)
+{
+	assert(buffer);
+	assert(buffer_size > 0);
+
+	fixed_size = true;
+	data = buffer;
+	capacity = buffer_size;
+}
+
+Format_Buffer::~Format_Buffer()
+{
+	if (!fixed_size && (data != inline_data)) {
+		delete[] data;
+	}
+}
+
+// One byte is always kept for the end char.
+bool Format_Buffer::reserve(u32 new_len)
+{
+	if ((new_len + 1) <= capacity) {
+		return true;
+	}
+	if (fixed_size) {
+		truncated = true;
+		return false;
+	}
+	u32 new_capacity = capacity * 2;
+	while (new_capacity < (new_len + 1)) {
+		new_capacity *= 2;
+	}
+	char *new_data = new char[new_capacity];
+	memcpy(new_data, data, len);
+	if (data != inline_data) {
+		delete[] data;
+	}
+	data = new_data;
+	capacity = new_capacity;
+	return true;
+}
+
+void Format_Buffer::append(const char *string, u32 string_len)
+{
+	if (!reserve(len + string_len)) {
+		string_len = capacity - 1 - len;
+	}
+	memcpy(data + len, string, string_len);
+	len += string_len;
+}
+
+const char *Format_Buffer::c_str()
+{
+	data[len] = '\0';
+	return data;
+}
+
+char *Format_Buffer::copy()
+{
+	char *string = new char[len + 1];
+	memcpy(string, data, len);
+	string[len] = '\0';
+	return string;
+}
+
+static void format_unsigned(Format_Buffer *buffer, u64 value, bool negative)
+{
+	char digits[24];
+	u32 index = sizeof(digits);
+	do {
+		digits[--index] = '0' + (char)(value % 10);
+		value /= 10;
+	} while (value > 0);
+
+	if (negative) {
+		digits[--index] = '-';
+	}
+	buffer->append(digits + index, sizeof(digits) - index);
+}
+
+static void format_signed(Format_Buffer *buffer, s64 value)
+{
+	// The negation is done in u64, so the minimal value doesn't overflow.
+	u64 magnitude = (value < 0) ? (0 - (u64)value) : (u64)value;
+	format_unsigned(buffer, magnitude, value < 0);
+}
+
+void format_value(Format_Buffer *buffer, bool value)
+{
+	if (value) {
+		buffer->append("true", 4);
+	} else {
+		buffer->append("false", 5);
+	}
+}
+
+void format_value(Format_Buffer *buffer, char value)
+{
+	buffer->append(value);
+}
+
+void format_value(Format_Buffer *buffer, signed char value)
+{
+	format_signed(buffer, value);
+}
+
+void format_value(Format_Buffer *buffer, unsigned char value)
+{
+	format_unsigned(buffer, value, false);
+}
+
+void format_value(Format_Buffer *buffer, short value)
+{
+	format_signed(buffer, value);
+}
+
+void format_value(Format_Buffer *buffer, unsigned short value)
+{
+	format_unsigned(buffer, value, false);
+}
+
+void format_value(Format_Buffer *buffer, int value)
+{
+	format_signed(buffer, value);
+}
+
+void format_value(Format_Buffer *buffer, unsigned int value)
+{
+	format_unsigned(buffer, value, false);
+}
+
+void format_value(Format_Buffer *buffer, long value)
+{
+	format_signed(buffer, value);
+}
+
+void format_value(Format_Buffer *buffer, unsigned long value)
+{
+	format_unsigned(buffer, value, false);
+}
+
+void format_value(Format_Buffer *buffer, long long value)
+{
+	format_signed(buffer, value);
+}
+
+void format_value(Format_Buffer *buffer, unsigned long long value)
+{
+	format_unsigned(buffer, value, false);
+}
+
+// Floats are written as to_string writes them ("%f").
+void format_value(Format_Buffer *buffer, float value)
+{
+	format_value(buffer, (double)value);
+}
+
+void format_value(Format_Buffer *buffer, double value)
+{
+	char string[64];
+	int string_len = snprintf(string, sizeof(string), "%f", value);
+	if (string_len > 0) {
+		buffer->append(string, ((u32)string_len < sizeof(string)) ? (u32)string_len : (u32)sizeof(string) - 1);
+	}
+}
+
+void format_value(Format_Buffer *buffer, const Vector2 *vector)
+{
+	format_to(buffer, "vec2({}, {})", vector->x, vector->y);
+}
+
+void format_value(Format_Buffer *buffer, const Vector3 *vector)
+{
+	format_to(buffer, "vec3({}, {}, {})", vector->x, vector->y, vector->z);
+}
+
+void format_value(Format_Buffer *buffer, const Vector4 *vector)
+{
+	format_to(buffer, "vec4({}, {}, {}, {})", vector->x, vector->y, vector->z, vector->w);
+}
+
+void format_value(Format_Buffer *buffer, const Matrix4 *matrix)
+{
+	format_to(buffer, "Matrix4(\n\t{}, {}, {}, {},\n\t{}, {}, {}, {},\n\t{}, {}, {}, {}\n\t{}, {}, {}, {})",
+		matrix->_11, matrix->_12, matrix->_13, matrix->_14,
+		matrix->_21, matrix->_22, matrix->_23, matrix->_24,
+		matrix->_31, matrix->_32, matrix->_33, matrix->_34,
+		matrix->_41, matrix->_42, matrix->_43, matrix->_44);
+}
+
+void format_value(Format_Buffer *buffer, const Rect_u32 *rect)
+{
+	format_to(buffer, "Rect_u32({}, {}, {}, {})", rect->x, rect->y, rect->width, rect->height);
+}
+
+void format_value(Format_Buffer *buffer, const Rect_s32 *rect)
+{
+	format_to(buffer, "Rect_s32({}, {}, {}, {})", rect->x, rect->y, rect->width, rect->height);
+}
+
+void format_value(Format_Buffer *buffer, const Rect_f32 *rect)
+{
+	format_to(buffer, "Rect_f32({}, {}, {}, {})", rect->x, rect->y, rect->width, rect->height);
+}
+
+void format_value(Format_Buffer *buffer, const Point_s32 *point)
+{
+	format_to(buffer, "Point_s32({}, {})", point->x, point->y);
+}
+
+void format_value(Format_Buffer *buffer, const String *string)
+{
+	if (string->data) {
+		buffer->append(string->data, string->len);
+	}
+}
+
+void Formatter::begin_argument()
+{
+	if (!format_tail) {
+		if (!first_argument) {
+			buffer->append(' ');
+		}
+		first_argument = false;
+	}
+}
+
+// Copies text up to the next {}. If there is no {} the whole string has been copied and the format string is finished.
+void Formatter::copy_until_placeholder(const char *string)
+{
+	const char *start = string;
+	while (*string) {
+		if ((string[0] == '{') && (string[1] == '}')) {
+			buffer->append(start, (u32)(string - start));
+			format_tail = string + 2;
+			return;
+		}
+		string++;
+	}
+	buffer->append(start, (u32)(string - start));
+	format_tail = NULL;
+}
+
+void Formatter::format_string_argument(const char *string)
+{
+	if (!string) {
+		string = "";
+	}
+	if (format_tail) {
+		buffer->append(string, (u32)strlen(string));
+		copy_until_placeholder(format_tail);
+	} else {
+		begin_argument();
+		copy_until_placeholder(string);
+	}
+}
+
+// There were fewer arguments than {} in the format string, the rest of the string is copied as it is.
+void Formatter::finish()
+{
+	if (format_tail) {
+		buffer->append(format_tail, (u32)strlen(format_tail));
+		format_tail = NULL;
+	}
+	buffer->c_str();
+}
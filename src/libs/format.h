@@ -0,0 +1,138 @@
+#ifndef FORMAT_H
+#define FORMAT_H
+
+#include <type_traits>
+
+#include "str.h"
+#include "number_types.h"
+#include "math/vector.h"
+#include "math/matrix.h"
+#include "math/structures.h"
+
+const u32 FORMAT_BUFFER_INLINE_SIZE = 512;
+
+// Text is written into the inline buffer and goes to the heap only if it doesn't fit.
+// A buffer made over caller's memory never allocates, text which doesn't fit is cut.
+struct Format_Buffer {
+	Format_Buffer();
+	Format_Buffer(char *buffer, u32 buffer_size);
+	~Format_Buffer();
+
+	bool fixed_size = false;
+	bool truncated = false;
+	u32 len = 0;
+	u32 capacity = FORMAT_BUFFER_INLINE_SIZE;
+	char *data = inline_data;
+	char inline_data[FORMAT_BUFFER_INLINE_SIZE];
+
+	Format_Buffer(const Format_Buffer &other) = delete;
+	Format_Buffer &operator=(const Format_Buffer &other) = delete;
+
+	void append(char c);
+	void append(const char *string, u32 string_len);
+	bool reserve(u32 new_len);
+	const char *c_str();
+	char *copy();
+};
+
+inline void Format_Buffer::append(char c)
+{
+	if (((len + 1) < capacity) || reserve(len + 1)) {
+		data[len++] = c;
+	}
+}
+
+void format_value(Format_Buffer *buffer, bool value);
+void format_value(Format_Buffer *buffer, char value);
+void format_value(Format_Buffer *buffer, signed char value);
+void format_value(Format_Buffer *buffer, unsigned char value);
+void format_value(Format_Buffer *buffer, short value);
+void format_value(Format_Buffer *buffer, unsigned short value);
+void format_value(Format_Buffer *buffer, int value);
+void format_value(Format_Buffer *buffer, unsigned int value);
+void format_value(Format_Buffer *buffer, long value);
+void format_value(Format_Buffer *buffer, unsigned long value);
+void format_value(Format_Buffer *buffer, long long value);
+void format_value(Format_Buffer *buffer, unsigned long long value);
+void format_value(Format_Buffer *buffer, float value);
+void format_value(Format_Buffer *buffer, double value);
+void format_value(Format_Buffer *buffer, const Vector2 *vector);
+void format_value(Format_Buffer *buffer, const Vector3 *vector);
+void format_value(Format_Buffer *buffer, const Vector4 *vector);
+void format_value(Format_Buffer *buffer, const Matrix4 *matrix);
+void format_value(Format_Buffer *buffer, const Rect_u32 *rect);
+void format_value(Format_Buffer *buffer, const Rect_s32 *rect);
+void format_value(Format_Buffer *buffer, const Rect_f32 *rect);
+void format_value(Format_Buffer *buffer, const Point_s32 *point);
+void format_value(Format_Buffer *buffer, const String *string);
+
+// Any other pointer would be converted to bool and printed as true, so it doesn't compile.
+template <typename T>
+void format_value(Format_Buffer *buffer, const T *pointer) = delete;
+
+// Arguments are separated with spaces. A string argument with {} is a format string,
+// the next arguments are placed in its {} instead of being separated.
+// The format string is scanned once: text is copied up to the next {} and the scan
+// goes on from there after the argument has been written.
+struct Formatter {
+	Formatter(Format_Buffer *_buffer) : buffer(_buffer) {}
+
+	bool first_argument = true;
+	const char *format_tail = NULL;
+	Format_Buffer *buffer = NULL;
+
+	void begin_argument();
+	void copy_until_placeholder(const char *string);
+	void format_string_argument(const char *string);
+	void finish();
+};
+
+template <typename T>
+inline void format_argument(Formatter *formatter, const T &value)
+{
+	if constexpr (std::is_convertible<const T &, const char *>::value) {
+		formatter->format_string_argument((const char *)value);
+	} else {
+		formatter->begin_argument();
+		format_value(formatter->buffer, value);
+		if (formatter->format_tail) {
+			formatter->copy_until_placeholder(formatter->format_tail);
+		}
+	}
+}
+
+template <typename... Args>
+inline void format_to(Format_Buffer *buffer, const Args &... args)
+{
+	Formatter formatter(buffer);
+	(format_argument(&formatter, args), ...);
+	formatter.finish();
+}
+
+// Writes into the caller's buffer, returns the length of the written text.
+template <typename... Args>
+inline u32 format_to(char *buffer, u32 buffer_size, const Args &... args)
+{
+	Format_Buffer format_buffer(buffer, buffer_size);
+	format_to(&format_buffer, args...);
+	format_buffer.c_str();
+	return format_buffer.len;
+}
+
+// The result must be freed with free_string.
+template <typename... Args>
+inline char *format(const Args &... args)
+{
+	Format_Buffer buffer;
+	format_to(&buffer, args...);
+	return buffer.copy();
+}
+
+template <typename... Args>
+inline String format_string(const Args &... args)
+{
+	Format_Buffer buffer;
+	format_to(&buffer, args...);
+	return String(buffer.c_str());
+}
+#endif
@@ -1,6 +1,7 @@
 #include <math.h>
 
 #include "geometry.h"
+#include "math/constants.h"
 
 void make_grid_mesh(Grid *grid, Triangle_Mesh *mesh)
 {
@@ -136,8 +137,8 @@ void make_sphere_mesh(Sphere *sphere, Triangle_Mesh *mesh)
 			Vector3 n = v.position;
 			v.normal = normalize(&n);
 
-			v.uv.x = theta / XM_2PI;
-			v.uv.y = phi / XM_PI;
+			v.uv.x = theta / (2.0f * PI);
+			v.uv.y = phi / PI;
 
 			mesh->vertices.push(v);
 		}
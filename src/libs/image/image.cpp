@@ -1,4 +1,10 @@
 #include <assert.h>
+#include "../memory/memory_tracking.h"
+
+// Images free their data with delete, so stb takes memory from the tracked heap as new does.
+#define STBI_MALLOC(size) allocate_tagged_memory(size, 0, MEMORY_TAG_ASSETS)
+#define STBI_REALLOC(memory, size) reallocate_tagged_memory(memory, size, 0)
+#define STBI_FREE(memory) free_tagged_memory(memory)
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
 
@@ -33,6 +39,7 @@ Image &Image::operator=(const Image &other)
 
 		if (data) { DELETE_PTR(data); }
 		u32 image_size = width * height * dxgi_format_size(format);
+		MEMORY_TAG_SCOPE(MEMORY_TAG_ASSETS);
 		data = new u8[image_size];
 		memcpy(data, other.data, image_size);
 	}
@@ -64,6 +71,7 @@ void Image::create(u32 image_width, u32 image_height, DXGI_FORMAT image_format,
 		name = image_name; 
 	}
 
+	MEMORY_TAG_SCOPE(MEMORY_TAG_ASSETS);
 	data = new u8[width * height * dxgi_format_size(image_format)];
 }
 
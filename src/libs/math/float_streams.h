@@ -0,0 +1,69 @@
+#ifndef MATH_FLOAT_STREAMS_H
+#define MATH_FLOAT_STREAMS_H
+
+#include <string.h>
+
+#include "../number_types.h"
+#include "../../sys/utils.h"
+
+// Arrays of floats which are indexed together, all streams are in one block and a stream takes capacity floats.
+// Batch kernels keep every component of their inputs in a stream of its own so that a SIMD register holds
+// one component of several inputs. The capacity is a multiple of 8, a full AVX2 register.
+template <u32 stream_count>
+struct Float_Streams {
+	Float_Streams() {}
+	~Float_Streams();
+
+	u32 count = 0;
+	u32 capacity = 0;
+	float *memory = NULL;
+	float *streams[stream_count] = {};
+
+	DELETE_COPING(Float_Streams)
+
+	void resize(u32 new_count);
+	void free();
+};
+
+template <u32 stream_count>
+Float_Streams<stream_count>::~Float_Streams()
+{
+	free();
+}
+
+// Existing items are kept, new ones are not initialized.
+template <u32 stream_count>
+void Float_Streams<stream_count>::resize(u32 new_count)
+{
+	if (new_count > capacity) {
+		u32 new_capacity = capacity + capacity / 2;
+		if (new_capacity < new_count) {
+			new_capacity = new_count;
+		}
+		new_capacity = (new_capacity + 7) & ~7u;
+
+		float *new_memory = new float[new_capacity * stream_count];
+		for (u32 i = 0; i < stream_count; i++) {
+			float *new_stream = new_memory + new_capacity * i;
+			if (count > 0) {
+				memcpy((void *)new_stream, (void *)streams[i], sizeof(float) * count);
+			}
+			streams[i] = new_stream;
+		}
+		DELETE_ARRAY(memory);
+		memory = new_memory;
+		capacity = new_capacity;
+	}
+	count = new_count;
+}
+
+template <u32 stream_count>
+void Float_Streams<stream_count>::free()
+{
+	DELETE_ARRAY(memory);
+	memset((void *)streams, 0, sizeof(streams));
+	count = 0;
+	capacity = 0;
+}
+
+#endif
@@ -0,0 +1,314 @@
+#include <float.h>
+
+#include "simd.h"
+#include "intersection_batch.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#define INTERSECTION_BATCH_SSE 1
+#include <emmintrin.h>
+#else
+#define INTERSECTION_BATCH_SSE 0
+#endif
+
+static float get_reciprocal(float value)
+{
+	float reciprocal = 1.0f / value;
+	if (reciprocal > FLT_MAX) {
+		return FLT_MAX;
+	}
+	if (reciprocal < -FLT_MAX) {
+		return -FLT_MAX;
+	}
+	return reciprocal;
+}
+
+Batch_Ray make_batch_ray(const Vector3 &origin, const Vector3 &direction)
+{
+	Batch_Ray ray;
+	ray.origin = origin;
+	ray.direction = direction;
+	ray.inverse_direction = Vector3(get_reciprocal(direction.x), get_reciprocal(direction.y), get_reciprocal(direction.z));
+	return ray;
+}
+
+// The same comparisons as minps and maxps do, so the scalar tests give the same distances as the SIMD kernels.
+inline float min_of(float first, float second)
+{
+	return first < second ? first : second;
+}
+
+inline float max_of(float first, float second)
+{
+	return first > second ? first : second;
+}
+
+bool detect_intersection(Batch_Ray *ray, const Vector3 &box_min, const Vector3 &box_max, float *distance)
+{
+	float min_x = (box_min.x - ray->origin.x) * ray->inverse_direction.x;
+	float min_y = (box_min.y - ray->origin.y) * ray->inverse_direction.y;
+	float min_z = (box_min.z - ray->origin.z) * ray->inverse_direction.z;
+	float max_x = (box_max.x - ray->origin.x) * ray->inverse_direction.x;
+	float max_y = (box_max.y - ray->origin.y) * ray->inverse_direction.y;
+	float max_z = (box_max.z - ray->origin.z) * ray->inverse_direction.z;
+
+	float enter = max_of(max_of(min_of(min_x, max_x), min_of(min_y, max_y)), max_of(min_of(min_z, max_z), 0.0f));
+	float exit = min_of(min_of(max_of(min_x, max_x), max_of(min_y, max_y)), max_of(min_z, max_z));
+	bool hit = enter <= exit;
+	*distance = hit ? enter : FLT_MAX;
+	return hit;
+}
+
+static bool detect_intersections_scalar(Batch_Ray *ray, AABB_Streams *boxes, u32 first_index, u32 last_index, float *distances)
+{
+	float **streams = boxes->streams;
+	bool hit_any_box = false;
+	for (u32 i = first_index; i < last_index; i++) {
+		Vector3 box_min = Vector3(streams[AABB_STREAM_MIN_X][i], streams[AABB_STREAM_MIN_Y][i], streams[AABB_STREAM_MIN_Z][i]);
+		Vector3 box_max = Vector3(streams[AABB_STREAM_MAX_X][i], streams[AABB_STREAM_MAX_Y][i], streams[AABB_STREAM_MAX_Z][i]);
+		hit_any_box |= detect_intersection(ray, box_min, box_max, &distances[i]);
+	}
+	return hit_any_box;
+}
+
+// Returns the distance to the triangle or FLT_MAX. A triangle which is parallel to the ray has a zero determinant,
+// u or v become NaN or infinite then and the comparisons fail without a separate check.
+inline float intersect_triangle(Batch_Ray *ray, float **streams, u32 i, float *u, float *v)
+{
+	float first_edge_x = streams[TRIANGLE_STREAM_FIRST_EDGE_X][i];
+	float first_edge_y = streams[TRIANGLE_STREAM_FIRST_EDGE_Y][i];
+	float first_edge_z = streams[TRIANGLE_STREAM_FIRST_EDGE_Z][i];
+	float second_edge_x = streams[TRIANGLE_STREAM_SECOND_EDGE_X][i];
+	float second_edge_y = streams[TRIANGLE_STREAM_SECOND_EDGE_Y][i];
+	float second_edge_z = streams[TRIANGLE_STREAM_SECOND_EDGE_Z][i];
+	const Vector3 &direction = ray->direction;
+
+	float p_x = direction.y * second_edge_z - direction.z * second_edge_y;
+	float p_y = direction.z * second_edge_x - direction.x * second_edge_z;
+	float p_z = direction.x * second_edge_y - direction.y * second_edge_x;
+	float inverse_determinant = 1.0f / ((first_edge_x * p_x + first_edge_y * p_y) + first_edge_z * p_z);
+
+	float s_x = ray->origin.x - streams[TRIANGLE_STREAM_VERTEX_X][i];
+	float s_y = ray->origin.y - streams[TRIANGLE_STREAM_VERTEX_Y][i];
+	float s_z = ray->origin.z - streams[TRIANGLE_STREAM_VERTEX_Z][i];
+	*u = ((s_x * p_x + s_y * p_y) + s_z * p_z) * inverse_determinant;
+
+	float q_x = s_y * first_edge_z - s_z * first_edge_y;
+	float q_y = s_z * first_edge_x - s_x * first_edge_z;
+	float q_z = s_x * first_edge_y - s_y * first_edge_x;
+	*v = ((direction.x * q_x + direction.y * q_y) + direction.z * q_z) * inverse_determinant;
+	float distance = ((second_edge_x * q_x + second_edge_y * q_y) + second_edge_z * q_z) * inverse_determinant;
+
+	if ((*u >= 0.0f) && (*v >= 0.0f) && ((*u + *v) <= 1.0f) && (distance >= 0.0f)) {
+		return distance;
+	}
+	return FLT_MAX;
+}
+
+inline void keep_nearest(float distance, u32 triangle_index, float *nearest_distance, u32 *nearest_triangle_index)
+{
+	if ((distance < *nearest_distance) || ((distance == *nearest_distance) && (triangle_index < *nearest_triangle_index))) {
+		*nearest_distance = distance;
+		*nearest_triangle_index = triangle_index;
+	}
+}
+
+static void find_nearest_intersections_scalar(Batch_Ray *ray, Triangle_Streams *triangles, u32 first_index, u32 last_index, float *distance, u32 *triangle_index)
+{
+	float u, v;
+	for (u32 i = first_index; i < last_index; i++) {
+		float triangle_distance = intersect_triangle(ray, triangles->streams, i, &u, &v);
+		if (triangle_distance < FLT_MAX) {
+			keep_nearest(triangle_distance, i, distance, triangle_index);
+		}
+	}
+}
+
+#if INTERSECTION_BATCH_SSE
+// One component of 4 boxes is in a register, the expressions are the ones of detect_intersection.
+static bool detect_intersections_sse(Batch_Ray *ray, AABB_Streams *boxes, u32 first_index, u32 last_index, float *distances)
+{
+	float **streams = boxes->streams;
+	__m128 origin_x = _mm_set1_ps(ray->origin.x);
+	__m128 origin_y = _mm_set1_ps(ray->origin.y);
+	__m128 origin_z = _mm_set1_ps(ray->origin.z);
+	__m128 inverse_direction_x = _mm_set1_ps(ray->inverse_direction.x);
+	__m128 inverse_direction_y = _mm_set1_ps(ray->inverse_direction.y);
+	__m128 inverse_direction_z = _mm_set1_ps(ray->inverse_direction.z);
+	__m128 miss_distance = _mm_set1_ps(FLT_MAX);
+	__m128 hits = _mm_setzero_ps();
+
+	u32 i = first_index;
+	for (; (i + 4) <= last_index; i += 4) {
+		__m128 min_x = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(&streams[AABB_STREAM_MIN_X][i]), origin_x), inverse_direction_x);
+		__m128 min_y = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(&streams[AABB_STREAM_MIN_Y][i]), origin_y), inverse_direction_y);
+		__m128 min_z = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(&streams[AABB_STREAM_MIN_Z][i]), origin_z), inverse_direction_z);
+		__m128 max_x = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(&streams[AABB_STREAM_MAX_X][i]), origin_x), inverse_direction_x);
+		__m128 max_y = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(&streams[AABB_STREAM_MAX_Y][i]), origin_y), inverse_direction_y);
+		__m128 max_z = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(&streams[AABB_STREAM_MAX_Z][i]), origin_z), inverse_direction_z);
+
+		__m128 enter = _mm_max_ps(_mm_max_ps(_mm_min_ps(min_x, max_x), _mm_min_ps(min_y, max_y)), _mm_max_ps(_mm_min_ps(min_z, max_z), _mm_setzero_ps()));
+		__m128 exit = _mm_min_ps(_mm_min_ps(_mm_max_ps(min_x, max_x), _mm_max_ps(min_y, max_y)), _mm_max_ps(min_z, max_z));
+		__m128 hit = _mm_cmple_ps(enter, exit);
+		_mm_storeu_ps(&distances[i], _mm_or_ps(_mm_and_ps(hit, enter), _mm_andnot_ps(hit, miss_distance)));
+		hits = _mm_or_ps(hits, hit);
+	}
+	bool hit_any_box = _mm_movemask_ps(hits) != 0;
+	return detect_intersections_scalar(ray, boxes, i, last_index, distances) || hit_any_box;
+}
+
+// Every lane keeps the nearest triangle of its own, the lanes are reduced to one triangle at the end.
+static void find_nearest_intersections_sse(Batch_Ray *ray, Triangle_Streams *triangles, u32 first_index, u32 last_index, float *distance, u32 *triangle_index)
+{
+	float **streams = triangles->streams;
+	__m128 origin_x = _mm_set1_ps(ray->origin.x);
+	__m128 origin_y = _mm_set1_ps(ray->origin.y);
+	__m128 origin_z = _mm_set1_ps(ray->origin.z);
+	__m128 direction_x = _mm_set1_ps(ray->direction.x);
+	__m128 direction_y = _mm_set1_ps(ray->direction.y);
+	__m128 direction_z = _mm_set1_ps(ray->direction.z);
+	__m128 zero = _mm_setzero_ps();
+	__m128 one = _mm_set1_ps(1.0f);
+	__m128 nearest_distances = _mm_set1_ps(FLT_MAX);
+	__m128i nearest_indices = _mm_setzero_si128();
+	__m128i indices = _mm_setr_epi32((int)first_index, (int)first_index + 1, (int)first_index + 2, (int)first_index + 3);
+	__m128i index_step = _mm_set1_epi32(4);
+
+	u32 i = first_index;
+	for (; (i + 4) <= last_index; i += 4) {
+		__m128 first_edge_x = _mm_loadu_ps(&streams[TRIANGLE_STREAM_FIRST_EDGE_X][i]);
+		__m128 first_edge_y = _mm_loadu_ps(&streams[TRIANGLE_STREAM_FIRST_EDGE_Y][i]);
+		__m128 first_edge_z = _mm_loadu_ps(&streams[TRIANGLE_STREAM_FIRST_EDGE_Z][i]);
+		__m128 second_edge_x = _mm_loadu_ps(&streams[TRIANGLE_STREAM_SECOND_EDGE_X][i]);
+		__m128 second_edge_y = _mm_loadu_ps(&streams[TRIANGLE_STREAM_SECOND_EDGE_Y][i]);
+		__m128 second_edge_z = _mm_loadu_ps(&streams[TRIANGLE_STREAM_SECOND_EDGE_Z][i]);
+
+		__m128 p_x = _mm_sub_ps(_mm_mul_ps(direction_y, second_edge_z), _mm_mul_ps(direction_z, second_edge_y));
+		__m128 p_y = _mm_sub_ps(_mm_mul_ps(direction_z, second_edge_x), _mm_mul_ps(direction_x, second_edge_z));
+		__m128 p_z = _mm_sub_ps(_mm_mul_ps(direction_x, second_edge_y), _mm_mul_ps(direction_y, second_edge_x));
+		__m128 determinant = _mm_add_ps(_mm_add_ps(_mm_mul_ps(first_edge_x, p_x), _mm_mul_ps(first_edge_y, p_y)), _mm_mul_ps(first_edge_z, p_z));
+		__m128 inverse_determinant = _mm_div_ps(one, determinant);
+
+		__m128 s_x = _mm_sub_ps(origin_x, _mm_loadu_ps(&streams[TRIANGLE_STREAM_VERTEX_X][i]));
+		__m128 s_y = _mm_sub_ps(origin_y, _mm_loadu_ps(&streams[TRIANGLE_STREAM_VERTEX_Y][i]));
+		__m128 s_z = _mm_sub_ps(origin_z, _mm_loadu_ps(&streams[TRIANGLE_STREAM_VERTEX_Z][i]));
+		__m128 u = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(s_x, p_x), _mm_mul_ps(s_y, p_y)), _mm_mul_ps(s_z, p_z)), inverse_determinant);
+
+		__m128 q_x = _mm_sub_ps(_mm_mul_ps(s_y, first_edge_z), _mm_mul_ps(s_z, first_edge_y));
+		__m128 q_y = _mm_sub_ps(_mm_mul_ps(s_z, first_edge_x), _mm_mul_ps(s_x, first_edge_z));
+		__m128 q_z = _mm_sub_ps(_mm_mul_ps(s_x, first_edge_y), _mm_mul_ps(s_y, first_edge_x));
+		__m128 v = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(direction_x, q_x), _mm_mul_ps(direction_y, q_y)), _mm_mul_ps(direction_z, q_z)), inverse_determinant);
+		__m128 triangle_distance = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(second_edge_x, q_x), _mm_mul_ps(second_edge_y, q_y)), _mm_mul_ps(second_edge_z, q_z)), inverse_determinant);
+
+		__m128 hit = _mm_and_ps(_mm_cmpge_ps(u, zero), _mm_cmpge_ps(v, zero));
+		hit = _mm_and_ps(hit, _mm_cmple_ps(_mm_add_ps(u, v), one));
+		hit = _mm_and_ps(hit, _mm_cmpge_ps(triangle_distance, zero));
+		// Lanes see their triangles in the order of indices, so a triangle at the same distance never replaces the nearest one.
+		hit = _mm_and_ps(hit, _mm_cmplt_ps(triangle_distance, nearest_distances));
+
+		nearest_distances = _mm_or_ps(_mm_and_ps(hit, triangle_distance), _mm_andnot_ps(hit, nearest_distances));
+		__m128i hit_mask = _mm_castps_si128(hit);
+		nearest_indices = _mm_or_si128(_mm_and_si128(hit_mask, indices), _mm_andnot_si128(hit_mask, nearest_indices));
+		indices = _mm_add_epi32(indices, index_step);
+	}
+
+	float lane_distances[4];
+	u32 lane_indices[4];
+	_mm_storeu_ps(lane_distances, nearest_distances);
+	_mm_storeu_si128((__m128i *)lane_indices, nearest_indices);
+	for (u32 lane = 0; lane < 4; lane++) {
+		if (lane_distances[lane] < FLT_MAX) {
+			keep_nearest(lane_distances[lane], lane_indices[lane], distance, triangle_index);
+		}
+	}
+	find_nearest_intersections_scalar(ray, triangles, i, last_index, distance, triangle_index);
+}
+#endif
+
+Intersection_Batch_Kernel get_best_intersection_batch_kernel()
+{
+	static Intersection_Batch_Kernel best_kernel = []() {
+		if (is_avx2_intersection_batch_kernels_compiled() && cpu_supports_avx2()) {
+			return INTERSECTION_BATCH_KERNEL_AVX2;
+		}
+		return INTERSECTION_BATCH_SSE ? INTERSECTION_BATCH_KERNEL_SSE : INTERSECTION_BATCH_KERNEL_SCALAR;
+	}();
+	return best_kernel;
+}
+
+const char *get_intersection_batch_kernel_name(Intersection_Batch_Kernel kernel)
+{
+	switch (kernel) {
+		case INTERSECTION_BATCH_KERNEL_SCALAR:
+			return "scalar";
+		case INTERSECTION_BATCH_KERNEL_SSE:
+			return "SSE";
+		case INTERSECTION_BATCH_KERNEL_AVX2:
+			return "AVX2";
+	}
+	return "unknown";
+}
+
+bool detect_intersections(Batch_Ray *ray, AABB_Streams *boxes, u32 first_index, u32 last_index, float *distances)
+{
+	return detect_intersections(ray, boxes, first_index, last_index, distances, get_best_intersection_batch_kernel());
+}
+
+// A kernel which the CPU or the build doesn't have falls back to the next slower one.
+bool detect_intersections(Batch_Ray *ray, AABB_Streams *boxes, u32 first_index, u32 last_index, float *distances, Intersection_Batch_Kernel kernel)
+{
+	assert(ray);
+	assert(boxes);
+	assert(distances);
+	assert(first_index <= last_index);
+	assert(last_index <= boxes->count);
+
+	if ((kernel == INTERSECTION_BATCH_KERNEL_AVX2) && (get_best_intersection_batch_kernel() == INTERSECTION_BATCH_KERNEL_AVX2)) {
+		return detect_intersections_avx2(ray, boxes, first_index, last_index, distances);
+	}
+#if INTERSECTION_BATCH_SSE
+	if (kernel != INTERSECTION_BATCH_KERNEL_SCALAR) {
+		return detect_intersections_sse(ray, boxes, first_index, last_index, distances);
+	}
+#endif
+	return detect_intersections_scalar(ray, boxes, first_index, last_index, distances);
+}
+
+bool find_nearest_intersection(Batch_Ray *ray, Triangle_Streams *triangles, u32 first_index, u32 last_index, Triangle_Intersection *intersection)
+{
+	return find_nearest_intersection(ray, triangles, first_index, last_index, intersection, get_best_intersection_batch_kernel());
+}
+
+bool find_nearest_intersection(Batch_Ray *ray, Triangle_Streams *triangles, u32 first_index, u32 last_index, Triangle_Intersection *intersection, Intersection_Batch_Kernel kernel)
+{
+	assert(ray);
+	assert(triangles);
+	assert(intersection);
+	assert(first_index <= last_index);
+	assert(last_index <= triangles->count);
+
+	float distance = FLT_MAX;
+	u32 triangle_index = UINT32_MAX;
+	find_nearest_intersections(ray, triangles, first_index, last_index, &distance, &triangle_index, kernel);
+	if (triangle_index == UINT32_MAX) {
+		return false;
+	}
+	// Only the nearest triangle needs the weights, the scalar test gives the same distance as the kernels.
+	intersection->triangle_index = triangle_index;
+	intersection->distance = intersect_triangle(ray, triangles->streams, triangle_index, &intersection->u, &intersection->v);
+	return true;
+}
+
+void find_nearest_intersections(Batch_Ray *ray, Triangle_Streams *triangles, u32 first_index, u32 last_index, float *distance, u32 *triangle_index, Intersection_Batch_Kernel kernel)
+{
+	if ((kernel == INTERSECTION_BATCH_KERNEL_AVX2) && (get_best_intersection_batch_kernel() == INTERSECTION_BATCH_KERNEL_AVX2)) {
+		find_nearest_intersections_avx2(ray, triangles, first_index, last_index, distance, triangle_index);
+		return;
+	}
+#if INTERSECTION_BATCH_SSE
+	if (kernel != INTERSECTION_BATCH_KERNEL_SCALAR) {
+		find_nearest_intersections_sse(ray, triangles, first_index, last_index, distance, triangle_index);
+		return;
+	}
+#endif
+	find_nearest_intersections_scalar(ray, triangles, first_index, last_index, distance, triangle_index);
+}
@@ -0,0 +1,120 @@
+#ifndef MATH_INTERSECTION_BATCH_H
+#define MATH_INTERSECTION_BATCH_H
+
+#include "vector.h"
+#include "float_streams.h"
+#include "../number_types.h"
+
+// A ray prepared for the batch kernels, the reciprocals of the direction are computed once for all boxes.
+// A zero direction component gets a reciprocal of +-FLT_MAX instead of an infinity, so a ray which lies in the plane
+// of a box side gives 0 in the slab test instead of NaN (0 * infinity). The direction doesn't have to be normalized,
+// distances are in lengths of the direction.
+struct Batch_Ray {
+	Vector3 origin;
+	Vector3 direction;
+	Vector3 inverse_direction;
+};
+
+Batch_Ray make_batch_ray(const Vector3 &origin, const Vector3 &direction);
+
+enum AABB_Stream {
+	AABB_STREAM_MIN_X,
+	AABB_STREAM_MIN_Y,
+	AABB_STREAM_MIN_Z,
+	AABB_STREAM_MAX_X,
+	AABB_STREAM_MAX_Y,
+	AABB_STREAM_MAX_Z,
+	AABB_STREAM_COUNT
+};
+
+struct AABB_Streams : Float_Streams<AABB_STREAM_COUNT> {
+	void set(u32 index, const Vector3 &min, const Vector3 &max);
+};
+
+enum Triangle_Stream {
+	TRIANGLE_STREAM_VERTEX_X,
+	TRIANGLE_STREAM_VERTEX_Y,
+	TRIANGLE_STREAM_VERTEX_Z,
+	TRIANGLE_STREAM_FIRST_EDGE_X,
+	TRIANGLE_STREAM_FIRST_EDGE_Y,
+	TRIANGLE_STREAM_FIRST_EDGE_Z,
+	TRIANGLE_STREAM_SECOND_EDGE_X,
+	TRIANGLE_STREAM_SECOND_EDGE_Y,
+	TRIANGLE_STREAM_SECOND_EDGE_Z,
+	TRIANGLE_STREAM_COUNT
+};
+
+// Triangles are kept as their first vertex and the two edges from it, the Möller–Trumbore test needs only them.
+struct Triangle_Streams : Float_Streams<TRIANGLE_STREAM_COUNT> {
+	void set(u32 index, const Vector3 &a, const Vector3 &b, const Vector3 &c);
+};
+
+struct Triangle_Intersection {
+	u32 triangle_index;
+	float distance;
+	// The weights of the second and the third vertex at the intersection point, the first one has 1 - u - v.
+	float u;
+	float v;
+};
+
+inline void AABB_Streams::set(u32 index, const Vector3 &min, const Vector3 &max)
+{
+	assert(index < count);
+
+	streams[AABB_STREAM_MIN_X][index] = min.x;
+	streams[AABB_STREAM_MIN_Y][index] = min.y;
+	streams[AABB_STREAM_MIN_Z][index] = min.z;
+	streams[AABB_STREAM_MAX_X][index] = max.x;
+	streams[AABB_STREAM_MAX_Y][index] = max.y;
+	streams[AABB_STREAM_MAX_Z][index] = max.z;
+}
+
+inline void Triangle_Streams::set(u32 index, const Vector3 &a, const Vector3 &b, const Vector3 &c)
+{
+	assert(index < count);
+
+	streams[TRIANGLE_STREAM_VERTEX_X][index] = a.x;
+	streams[TRIANGLE_STREAM_VERTEX_Y][index] = a.y;
+	streams[TRIANGLE_STREAM_VERTEX_Z][index] = a.z;
+	streams[TRIANGLE_STREAM_FIRST_EDGE_X][index] = b.x - a.x;
+	streams[TRIANGLE_STREAM_FIRST_EDGE_Y][index] = b.y - a.y;
+	streams[TRIANGLE_STREAM_FIRST_EDGE_Z][index] = b.z - a.z;
+	streams[TRIANGLE_STREAM_SECOND_EDGE_X][index] = c.x - a.x;
+	streams[TRIANGLE_STREAM_SECOND_EDGE_Y][index] = c.y - a.y;
+	streams[TRIANGLE_STREAM_SECOND_EDGE_Z][index] = c.z - a.z;
+}
+
+enum Intersection_Batch_Kernel {
+	INTERSECTION_BATCH_KERNEL_SCALAR,
+	INTERSECTION_BATCH_KERNEL_SSE,
+	INTERSECTION_BATCH_KERNEL_AVX2
+};
+
+// A slab test of one box with the same result as detect_intersections gives for it.
+bool detect_intersection(Batch_Ray *ray, const Vector3 &box_min, const Vector3 &box_max, float *distance);
+
+// Slab tests of the boxes in [first_index, last_index), 4 boxes at once with SSE and 8 with AVX2.
+// distances[i] gets the distance at which the ray enters the box i, 0 if the origin is inside it and FLT_MAX if the ray
+// misses it or the box is behind the origin. Returns true if the ray hits any of the boxes.
+bool detect_intersections(Batch_Ray *ray, AABB_Streams *boxes, u32 first_index, u32 last_index, float *distances);
+bool detect_intersections(Batch_Ray *ray, AABB_Streams *boxes, u32 first_index, u32 last_index, float *distances, Intersection_Batch_Kernel kernel);
+
+// Möller–Trumbore tests of the triangles in [first_index, last_index), 4 triangles at once with SSE and 8 with AVX2.
+// Both sides of triangles are hit. Finds the nearest triangle in front of the origin, of triangles at the same distance
+// the one with the smallest index, so all kernels find the same triangle.
+bool find_nearest_intersection(Batch_Ray *ray, Triangle_Streams *triangles, u32 first_index, u32 last_index, Triangle_Intersection *intersection);
+bool find_nearest_intersection(Batch_Ray *ray, Triangle_Streams *triangles, u32 first_index, u32 last_index, Triangle_Intersection *intersection, Intersection_Batch_Kernel kernel);
+
+Intersection_Batch_Kernel get_best_intersection_batch_kernel();
+const char *get_intersection_batch_kernel_name(Intersection_Batch_Kernel kernel);
+
+// The nearest triangle of the range replaces *distance and *triangle_index if it is nearer, find_nearest_intersection
+// starts with FLT_MAX and UINT32_MAX. The AVX2 kernels leave the triangles after the last full register to SSE with it.
+void find_nearest_intersections(Batch_Ray *ray, Triangle_Streams *triangles, u32 first_index, u32 last_index, float *distance, u32 *triangle_index, Intersection_Batch_Kernel kernel);
+
+// The AVX2 kernels are in a file of its own, the same as the transform batch AVX2 kernel.
+bool is_avx2_intersection_batch_kernels_compiled();
+bool detect_intersections_avx2(Batch_Ray *ray, AABB_Streams *boxes, u32 first_index, u32 last_index, float *distances);
+void find_nearest_intersections_avx2(Batch_Ray *ray, Triangle_Streams *triangles, u32 first_index, u32 last_index, float *distance, u32 *triangle_index);
+
+#endif
@@ -0,0 +1,129 @@
+#include <float.h>
+
+#include "intersection_batch.h"
+
+#if defined(_MSC_VER) || defined(__AVX2__)
+#include <immintrin.h>
+
+bool is_avx2_intersection_batch_kernels_compiled()
+{
+	return true;
+}
+
+// The expressions are the ones of detect_intersection and intersect_triangle in intersection_batch.cpp.
+bool detect_intersections_avx2(Batch_Ray *ray, AABB_Streams *boxes, u32 first_index, u32 last_index, float *distances)
+{
+	float **streams = boxes->streams;
+	__m256 origin_x = _mm256_set1_ps(ray->origin.x);
+	__m256 origin_y = _mm256_set1_ps(ray->origin.y);
+	__m256 origin_z = _mm256_set1_ps(ray->origin.z);
+	__m256 inverse_direction_x = _mm256_set1_ps(ray->inverse_direction.x);
+	__m256 inverse_direction_y = _mm256_set1_ps(ray->inverse_direction.y);
+	__m256 inverse_direction_z = _mm256_set1_ps(ray->inverse_direction.z);
+	__m256 miss_distance = _mm256_set1_ps(FLT_MAX);
+	__m256 hits = _mm256_setzero_ps();
+
+	u32 i = first_index;
+	for (; (i + 8) <= last_index; i += 8) {
+		__m256 min_x = _mm256_mul_ps(_mm256_sub_ps(_mm256_loadu_ps(&streams[AABB_STREAM_MIN_X][i]), origin_x), inverse_direction_x);
+		__m256 min_y = _mm256_mul_ps(_mm256_sub_ps(_mm256_loadu_ps(&streams[AABB_STREAM_MIN_Y][i]), origin_y), inverse_direction_y);
+		__m256 min_z = _mm256_mul_ps(_mm256_sub_ps(_mm256_loadu_ps(&streams[AABB_STREAM_MIN_Z][i]), origin_z), inverse_direction_z);
+		__m256 max_x = _mm256_mul_ps(_mm256_sub_ps(_mm256_loadu_ps(&streams[AABB_STREAM_MAX_X][i]), origin_x), inverse_direction_x);
+		__m256 max_y = _mm256_mul_ps(_mm256_sub_ps(_mm256_loadu_ps(&streams[AABB_STREAM_MAX_Y][i]), origin_y), inverse_direction_y);
+		__m256 max_z = _mm256_mul_ps(_mm256_sub_ps(_mm256_loadu_ps(&streams[AABB_STREAM_MAX_Z][i]), origin_z), inverse_direction_z);
+
+		__m256 enter = _mm256_max_ps(_mm256_max_ps(_mm256_min_ps(min_x, max_x), _mm256_min_ps(min_y, max_y)), _mm256_max_ps(_mm256_min_ps(min_z, max_z), _mm256_setzero_ps()));
+		__m256 exit = _mm256_min_ps(_mm256_min_ps(_mm256_max_ps(min_x, max_x), _mm256_max_ps(min_y, max_y)), _mm256_max_ps(min_z, max_z));
+		__m256 hit = _mm256_cmp_ps(enter, exit, _CMP_LE_OQ);
+		_mm256_storeu_ps(&distances[i], _mm256_blendv_ps(miss_distance, enter, hit));
+		hits = _mm256_or_ps(hits, hit);
+	}
+	bool hit_any_box = _mm256_movemask_ps(hits) != 0;
+	// Upper halves of AVX registers are cleared before SSE code runs, otherwise the SSE instructions are slow on older CPUs.
+	_mm256_zeroupper();
+	return detect_intersections(ray, boxes, i, last_index, distances, INTERSECTION_BATCH_KERNEL_SSE) || hit_any_box;
+}
+
+void find_nearest_intersections_avx2(Batch_Ray *ray, Triangle_Streams *triangles, u32 first_index, u32 last_index, float *distance, u32 *triangle_index)
+{
+	float **streams = triangles->streams;
+	__m256 origin_x = _mm256_set1_ps(ray->origin.x);
+	__m256 origin_y = _mm256_set1_ps(ray->origin.y);
+	__m256 origin_z = _mm256_set1_ps(ray->origin.z);
+	__m256 direction_x = _mm256_set1_ps(ray->direction.x);
+	__m256 direction_y = _mm256_set1_ps(ray->direction.y);
+	__m256 direction_z = _mm256_set1_ps(ray->direction.z);
+	__m256 zero = _mm256_setzero_ps();
+	__m256 one = _mm256_set1_ps(1.0f);
+	__m256 nearest_distances = _mm256_set1_ps(FLT_MAX);
+	__m256i nearest_indices = _mm256_setzero_si256();
+	__m256i indices = _mm256_add_epi32(_mm256_set1_epi32((int)first_index), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+	__m256i index_step = _mm256_set1_epi32(8);
+
+	u32 i = first_index;
+	for (; (i + 8) <= last_index; i += 8) {
+		__m256 first_edge_x = _mm256_loadu_ps(&streams[TRIANGLE_STREAM_FIRST_EDGE_X][i]);
+		__m256 first_edge_y = _mm256_loadu_ps(&streams[TRIANGLE_STREAM_FIRST_EDGE_Y][i]);
+		__m256 first_edge_z = _mm256_loadu_ps(&streams[TRIANGLE_STREAM_FIRST_EDGE_Z][i]);
+		__m256 second_edge_x = _mm256_loadu_ps(&streams[TRIANGLE_STREAM_SECOND_EDGE_X][i]);
+		__m256 second_edge_y = _mm256_loadu_ps(&streams[TRIANGLE_STREAM_SECOND_EDGE_Y][i]);
+		__m256 second_edge_z = _mm256_loadu_ps(&streams[TRIANGLE_STREAM_SECOND_EDGE_Z][i]);
+
+		__m256 p_x = _mm256_sub_ps(_mm256_mul_ps(direction_y, second_edge_z), _mm256_mul_ps(direction_z, second_edge_y));
+		__m256 p_y = _mm256_sub_ps(_mm256_mul_ps(direction_z, second_edge_x), _mm256_mul_ps(direction_x, second_edge_z));
+		__m256 p_z = _mm256_sub_ps(_mm256_mul_ps(direction_x, second_edge_y), _mm256_mul_ps(direction_y, second_edge_x));
+		__m256 determinant = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(first_edge_x, p_x), _mm256_mul_ps(first_edge_y, p_y)), _mm256_mul_ps(first_edge_z, p_z));
+		__m256 inverse_determinant = _mm256_div_ps(one, determinant);
+
+		__m256 s_x = _mm256_sub_ps(origin_x, _mm256_loadu_ps(&streams[TRIANGLE_STREAM_VERTEX_X][i]));
+		__m256 s_y = _mm256_sub_ps(origin_y, _mm256_loadu_ps(&streams[TRIANGLE_STREAM_VERTEX_Y][i]));
+		__m256 s_z = _mm256_sub_ps(origin_z, _mm256_loadu_ps(&streams[TRIANGLE_STREAM_VERTEX_Z][i]));
+		__m256 u = _mm256_mul_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(s_x, p_x), _mm256_mul_ps(s_y, p_y)), _mm256_mul_ps(s_z, p_z)), inverse_determinant);
+
+		__m256 q_x = _mm256_sub_ps(_mm256_mul_ps(s_y, first_edge_z), _mm256_mul_ps(s_z, first_edge_y));
+		__m256 q_y = _mm256_sub_ps(_mm256_mul_ps(s_z, first_edge_x), _mm256_mul_ps(s_x, first_edge_z));
+		__m256 q_z = _mm256_sub_ps(_mm256_mul_ps(s_x, first_edge_y), _mm256_mul_ps(s_y, first_edge_x));
+		__m256 v = _mm256_mul_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(direction_x, q_x), _mm256_mul_ps(direction_y, q_y)), _mm256_mul_ps(direction_z, q_z)), inverse_determinant);
+		__m256 triangle_distance = _mm256_mul_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(second_edge_x, q_x), _mm256_mul_ps(second_edge_y, q_y)), _mm256_mul_ps(second_edge_z, q_z)), inverse_determinant);
+
+		__m256 hit = _mm256_and_ps(_mm256_cmp_ps(u, zero, _CMP_GE_OQ), _mm256_cmp_ps(v, zero, _CMP_GE_OQ));
+		hit = _mm256_and_ps(hit, _mm256_cmp_ps(_mm256_add_ps(u, v), one, _CMP_LE_OQ));
+		hit = _mm256_and_ps(hit, _mm256_cmp_ps(triangle_distance, zero, _CMP_GE_OQ));
+		hit = _mm256_and_ps(hit, _mm256_cmp_ps(triangle_distance, nearest_distances, _CMP_LT_OQ));
+
+		nearest_distances = _mm256_blendv_ps(nearest_distances, triangle_distance, hit);
+		nearest_indices = _mm256_blendv_epi8(nearest_indices, indices, _mm256_castps_si256(hit));
+		indices = _mm256_add_epi32(indices, index_step);
+	}
+
+	float lane_distances[8];
+	u32 lane_indices[8];
+	_mm256_storeu_ps(lane_distances, nearest_distances);
+	_mm256_storeu_si256((__m256i *)lane_indices, nearest_indices);
+	_mm256_zeroupper();
+	for (u32 lane = 0; lane < 8; lane++) {
+		float lane_distance = lane_distances[lane];
+		u32 lane_index = lane_indices[lane];
+		if ((lane_distance < *distance) || ((lane_distance == *distance) && (lane_distance < FLT_MAX) && (lane_index < *triangle_index))) {
+			*distance = lane_distance;
+			*triangle_index = lane_index;
+		}
+	}
+	find_nearest_intersections(ray, triangles, i, last_index, distance, triangle_index, INTERSECTION_BATCH_KERNEL_SSE);
+}
+#else
+bool is_avx2_intersection_batch_kernels_compiled()
+{
+	return false;
+}
+
+bool detect_intersections_avx2(Batch_Ray *ray, AABB_Streams *boxes, u32 first_index, u32 last_index, float *distances)
+{
+	return detect_intersections(ray, boxes, first_index, last_index, distances, INTERSECTION_BATCH_KERNEL_SSE);
+}
+
+void find_nearest_intersections_avx2(Batch_Ray *ray, Triangle_Streams *triangles, u32 first_index, u32 last_index, float *distance, u32 *triangle_index)
+{
+	find_nearest_intersections(ray, triangles, first_index, last_index, distance, triangle_index, INTERSECTION_BATCH_KERNEL_SSE);
+}
+#endif
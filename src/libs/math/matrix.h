@@ -1,65 +1,82 @@
 #ifndef MATRIX_H
 #define MATRIX_H
 
-#include "vector.h"
-#include <DirectXMath.h>
-
-using namespace DirectX;
+#include <math.h>
 
-struct Matrix3 : XMFLOAT3X3 {
-	Matrix3() : XMFLOAT3X3(0.0f, 0.0f, 0.0f,
-						   0.0f, 0.0f, 0.0f,
-						   0.0f, 0.0f, 0.0f)
-	{
-	}
-	Matrix3(XMMATRIX matrix)
+#include "vector.h"
+#include "simd.h"
+
+// Row-major matrices for row vectors (v * M) in a left-handed coordinate system, the same layout and formulas
+// as DirectXMath so that matrices are sent to shaders as they are.
+struct Matrix3 {
+	Matrix3() : Matrix3(0.0f, 0.0f, 0.0f,
+						0.0f, 0.0f, 0.0f,
+						0.0f, 0.0f, 0.0f)
 	{
-		XMStoreFloat3x3(this, matrix);
 	}
+	Matrix3(const Simd_Matrix &matrix);
 
 	Matrix3(float m00, float m01, float m02,
 			float m10, float m11, float m12,
 			float m20, float m21, float m22) :
-		XMFLOAT3X3(m00, m01, m02,
-				   m10, m11, m12,
-				   m20, m21, m22)
+		_11(m00), _12(m01), _13(m02),
+		_21(m10), _22(m11), _23(m12),
+		_31(m20), _32(m21), _33(m22)
 	{
 	}
 
+	union {
+		struct {
+			float _11, _12, _13;
+			float _21, _22, _23;
+			float _31, _32, _33;
+		};
+		float m[3][3];
+	};
+
 	void set_row_0(const Vector3 &vector);
 	void set_row_1(const Vector3 &vector);
 	void set_row_2(const Vector3 &vector);
 };
 
+inline Simd_Matrix simd_load(const Matrix3 &matrix);
+
 inline Vector2 operator*(const Vector2 &vector, const Matrix3 &matrix);
 inline Vector3 operator*(const Vector3 &vector, const Matrix3 &matrix);
 
 inline Vector2 &operator*=(Vector2 &vector, const Matrix3 &matrix);
 inline Vector3 &operator*=(Vector3 &vector, const Matrix3 &matrix);
 
-struct Matrix4 : XMFLOAT4X4 {
-	Matrix4() : XMFLOAT4X4(0.0f, 0.0f, 0.0f, 0.0f,
-						   0.0f, 0.0f, 0.0f, 0.0f,
-						   0.0f, 0.0f, 0.0f, 0.0f,
-						   0.0f, 0.0f, 0.0f, 0.0f)
+struct Matrix4 {
+	Matrix4() : Matrix4(0.0f, 0.0f, 0.0f, 0.0f,
+						0.0f, 0.0f, 0.0f, 0.0f,
+						0.0f, 0.0f, 0.0f, 0.0f,
+						0.0f, 0.0f, 0.0f, 0.0f)
 	{
 	}
-	Matrix4(XMMATRIX matrix)
-	{
-		XMStoreFloat4x4(this, matrix);
-	}
+	Matrix4(const Simd_Matrix &matrix);
 
 	Matrix4(float m00, float m01, float m02, float m03,
 			float m10, float m11, float m12, float m13,
 			float m20, float m21, float m22, float m23,
 			float m30, float m31, float m32, float m33) :
-		XMFLOAT4X4(m00, m01, m02, m03,
-				   m10, m11, m12, m13,
-				   m20, m21, m22, m23,
-				   m30, m31, m32, m33)
+		_11(m00), _12(m01), _13(m02), _14(m03),
+		_21(m10), _22(m11), _23(m12), _24(m13),
+		_31(m20), _32(m21), _33(m22), _34(m23),
+		_41(m30), _42(m31), _43(m32), _44(m33)
 	{
 	}
 
+	union {
+		struct {
+			float _11, _12, _13, _14;
+			float _21, _22, _23, _24;
+			float _31, _32, _33, _34;
+			float _41, _42, _43, _44;
+		};
+		float m[4][4];
+	};
+
 	void set_row_0(const Vector4 &vector);
 	void set_row_1(const Vector4 &vector);
 	void set_row_2(const Vector4 &vector);
@@ -68,6 +85,8 @@ struct Matrix4 : XMFLOAT4X4 {
 	Matrix3 to_matrix3();
 };
 
+inline Simd_Matrix simd_load(const Matrix4 &matrix);
+
 inline Vector2 transform(Vector2 *vector, Matrix4 *transform_matrix);
 inline Vector3 transform(Vector3 *vector, Matrix4 *transform_matrix);
 inline Vector4 transform(Vector4 *vector, Matrix4 *transform_matrix);
@@ -80,6 +99,8 @@ inline Matrix4 rotate(float x_angle, float y_angle, float z_angle);
 
 inline Matrix4 inverse(const Matrix4 &matrix);
 inline Matrix4 inverse(Matrix4 *matrix);
+inline Matrix4 inverse_affine(const Matrix4 &matrix);
+inline Matrix4 inverse_orthonormal(const Matrix4 &matrix);
 inline Matrix4 transpose(Matrix4 *matrix);
 
 inline Matrix3 make_identity_matrix3();
@@ -94,6 +115,7 @@ inline Matrix4 make_look_at_matrix(const Vector3 &view_position, const Vector3 &
 inline Matrix4 make_look_to_matrix(const Vector3 &view_position, const Vector3 &view_direction, const Vector3 &up = Vector3(0.0f, 1.0f, 0.0f));
 inline Matrix4 make_perspective_matrix(float fov, float aspect_ratio, float near_plane, float far_plane);
 inline Matrix4 make_orthographic_matrix(float width, float height, float near_plane, float far_plane);
+inline Matrix4 make_orthographic_off_center_matrix(float left, float right, float bottom, float top, float near_plane, float far_plane);
 
 inline Matrix4 operator*(const Matrix3 &first_matrix, const Matrix4 second_matrix);
 inline Matrix4 operator*(const Matrix4 &first_matrix, const Matrix4 &second_matrix);
@@ -106,6 +128,14 @@ inline Vector2 &operator*=(Vector2 &vector, const Matrix4 &matrix);
 inline Vector3 &operator*=(Vector3 &vector, const Matrix4 &matrix);
 inline Vector4 &operator*=(Vector4 &vector, const Matrix4 &matrix);
 
+inline Matrix3::Matrix3(const Simd_Matrix &matrix)
+{
+	Vector3 rows[3] = { matrix.rows[0], matrix.rows[1], matrix.rows[2] };
+	set_row_0(rows[0]);
+	set_row_1(rows[1]);
+	set_row_2(rows[2]);
+}
+
 inline void Matrix3::set_row_0(const Vector3 &vector)
 {
 	m[0][0] = vector.x;
@@ -127,36 +157,50 @@ inline void Matrix3::set_row_2(const Vector3 &vector)
 	m[2][2] = vector.z;
 }
 
+// The rows get zero w and the fourth row is (0, 0, 0, 1).
+inline Simd_Matrix simd_load(const Matrix3 &matrix)
+{
+	Simd_Matrix result;
+	result.rows[0] = simd_load3(matrix.m[0]);
+	result.rows[1] = simd_load3(matrix.m[1]);
+	result.rows[2] = simd_load3(matrix.m[2]);
+	result.rows[3] = simd_set(0.0f, 0.0f, 0.0f, 1.0f);
+	return result;
+}
+
+// The vectors are transformed as points, a missing z is 0 and a missing w is 1.
 inline Vector2 operator*(const Vector2 &vector, const Matrix3 &matrix)
 {
-	XMVECTOR v = XMLoadFloat2(&vector);
-	XMMATRIX m = XMLoadFloat3x3(&matrix);
-	return XMVector2Transform(v, m);
+	return simd_transform(simd_set(vector.x, vector.y, 0.0f, 1.0f), simd_load(matrix));
 }
 
 inline Vector3 operator*(const Vector3 &vector, const Matrix3 &matrix)
 {
-	XMVECTOR v = XMLoadFloat3(&vector);
-	XMMATRIX m = XMLoadFloat3x3(&matrix);
-	return XMVector3Transform(v, m);
+	return simd_transform(simd_set(vector.x, vector.y, vector.z, 1.0f), simd_load(matrix));
 }
 
 inline Vector2 &operator*=(Vector2 &vector, const Matrix3 &matrix)
 {
-	XMVECTOR v = XMLoadFloat2(&vector);
-	XMMATRIX m = XMLoadFloat3x3(&matrix);
-	vector = XMVector2Transform(v, m);
+	vector = vector * matrix;
 	return vector;
 }
 
 inline Vector3 &operator*=(Vector3 &vector, const Matrix3 &matrix)
 {
-	XMVECTOR v = XMLoadFloat3(&vector);
-	XMMATRIX m = XMLoadFloat3x3(&matrix);
-	vector = XMVector3Transform(v, m);
+	vector = vector * matrix;
 	return vector;
 }
 
+inline Matrix4::Matrix4(const Simd_Matrix &matrix)
+{
+	simd_store_matrix(&_11, matrix);
+}
+
+inline Simd_Matrix simd_load(const Matrix4 &matrix)
+{
+	return simd_load_matrix(&matrix._11);
+}
+
 inline Matrix3 Matrix4::to_matrix3()
 {
 	return Matrix3(_11, _12, _13,
@@ -198,17 +242,32 @@ inline void Matrix4::set_row_3(const Vector4 &vector)
 
 inline Matrix4 rotate_about_x(float angle)
 {
-	return XMMatrixRotationX(angle);
+	float sine = sinf(angle);
+	float cosine = cosf(angle);
+	return Matrix4(1.0f, 0.0f, 0.0f, 0.0f,
+				   0.0f, cosine, sine, 0.0f,
+				   0.0f, -sine, cosine, 0.0f,
+				   0.0f, 0.0f, 0.0f, 1.0f);
 }
 
 inline Matrix4 rotate_about_y(float angle)
 {
-	return XMMatrixRotationY(angle);
+	float sine = sinf(angle);
+	float cosine = cosf(angle);
+	return Matrix4(cosine, 0.0f, -sine, 0.0f,
+				   0.0f, 1.0f, 0.0f, 0.0f,
+				   sine, 0.0f, cosine, 0.0f,
+				   0.0f, 0.0f, 0.0f, 1.0f);
 }
 
 inline Matrix4 rotate_about_z(float angle)
 {
-	return XMMatrixRotationZ(angle);
+	float sine = sinf(angle);
+	float cosine = cosf(angle);
+	return Matrix4(cosine, sine, 0.0f, 0.0f,
+				   -sine, cosine, 0.0f, 0.0f,
+				   0.0f, 0.0f, 1.0f, 0.0f,
+				   0.0f, 0.0f, 0.0f, 1.0f);
 }
 
 inline Matrix4 rotate(Vector3 *xyz_angles)
@@ -216,37 +275,133 @@ inline Matrix4 rotate(Vector3 *xyz_angles)
 	return rotate(xyz_angles->x, xyz_angles->y, xyz_angles->z);
 }
 
+// rotate_about_z(z_angle) * rotate_about_x(x_angle) * rotate_about_y(y_angle), the angles are roll, pitch and yaw.
 inline Matrix4 rotate(float x_angle, float y_angle, float z_angle)
 {
-	return XMMatrixRotationRollPitchYaw(x_angle, y_angle, z_angle);
+	float sin_x = sinf(x_angle);
+	float cos_x = cosf(x_angle);
+	float sin_y = sinf(y_angle);
+	float cos_y = cosf(y_angle);
+	float sin_z = sinf(z_angle);
+	float cos_z = cosf(z_angle);
+	return Matrix4(cos_z * cos_y + sin_z * sin_x * sin_y, sin_z * cos_x, sin_z * sin_x * cos_y - cos_z * sin_y, 0.0f,
+				   cos_z * sin_x * sin_y - sin_z * cos_y, cos_z * cos_x, sin_z * sin_y + cos_z * sin_x * cos_y, 0.0f,
+				   cos_x * sin_y, -sin_x, cos_x * cos_y, 0.0f,
+				   0.0f, 0.0f, 0.0f, 1.0f);
 }
 
+// The inverse by cofactors of 2x2 minors, a singular matrix gives infinities and NaNs.
 inline Matrix4 inverse(const Matrix4 &matrix)
 {
-	XMMATRIX temp = XMLoadFloat4x4(&matrix);
-	return XMMatrixInverse(NULL, temp);
+	const float (*a)[4] = matrix.m;
+	float s0 = a[0][0] * a[1][1] - a[1][0] * a[0][1];
+	float s1 = a[0][0] * a[1][2] - a[1][0] * a[0][2];
+	float s2 = a[0][0] * a[1][3] - a[1][0] * a[0][3];
+	float s3 = a[0][1] * a[1][2] - a[1][1] * a[0][2];
+	float s4 = a[0][1] * a[1][3] - a[1][1] * a[0][3];
+	float s5 = a[0][2] * a[1][3] - a[1][2] * a[0][3];
+
+	float c0 = a[2][0] * a[3][1] - a[3][0] * a[2][1];
+	float c1 = a[2][0] * a[3][2] - a[3][0] * a[2][2];
+	float c2 = a[2][0] * a[3][3] - a[3][0] * a[2][3];
+	float c3 = a[2][1] * a[3][2] - a[3][1] * a[2][2];
+	float c4 = a[2][1] * a[3][3] - a[3][1] * a[2][3];
+	float c5 = a[2][2] * a[3][3] - a[3][2] * a[2][3];
+
+	float determinant = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+	float d = 1.0f / determinant;
+
+	return Matrix4((a[1][1] * c5 - a[1][2] * c4 + a[1][3] * c3) * d,
+				   (-a[0][1] * c5 + a[0][2] * c4 - a[0][3] * c3) * d,
+				   (a[3][1] * s5 - a[3][2] * s4 + a[3][3] * s3) * d,
+				   (-a[2][1] * s5 + a[2][2] * s4 - a[2][3] * s3) * d,
+
+				   (-a[1][0] * c5 + a[1][2] * c2 - a[1][3] * c1) * d,
+				   (a[0][0] * c5 - a[0][2] * c2 + a[0][3] * c1) * d,
+				   (-a[3][0] * s5 + a[3][2] * s2 - a[3][3] * s1) * d,
+				   (a[2][0] * s5 - a[2][2] * s2 + a[2][3] * s1) * d,
+
+				   (a[1][0] * c4 - a[1][1] * c2 + a[1][3] * c0) * d,
+				   (-a[0][0] * c4 + a[0][1] * c2 - a[0][3] * c0) * d,
+				   (a[3][0] * s4 - a[3][1] * s2 + a[3][3] * s0) * d,
+				   (-a[2][0] * s4 + a[2][1] * s2 - a[2][3] * s0) * d,
+
+				   (-a[1][0] * c3 + a[1][1] * c1 - a[1][2] * c0) * d,
+				   (a[0][0] * c3 - a[0][1] * c1 + a[0][2] * c0) * d,
+				   (-a[3][0] * s3 + a[3][1] * s1 - a[3][2] * s0) * d,
+				   (a[2][0] * s3 - a[2][1] * s1 + a[2][2] * s0) * d);
 }
 
 inline Matrix4 inverse(Matrix4 *matrix)
 {
-	XMMATRIX temp = XMLoadFloat4x4(matrix);
-	return XMMatrixInverse(NULL, temp);
+	return inverse(*matrix);
+}
+
+// The translation of an inverse affine transform is the negated translation multiplied by the inverse 3x3 part.
+inline Simd_Matrix add_inverse_translation(Simd_Matrix inverse_rows, Simd_Vector translation)
+{
+	Simd_Vector negated_translation = simd_mul(translation, simd_set(-1.0f, -1.0f, -1.0f, 1.0f));
+	inverse_rows.rows[3] = simd_transform(negated_translation, inverse_rows);
+	return inverse_rows;
+}
+
+// For matrices whose last column is (0, 0, 0, 1), world matrices made of scaling, rotation and translation.
+// Only the 3x3 part is inverted by cofactors, the translation of the inverse is the negated translation
+// multiplied by the inverse 3x3 part.
+inline Matrix4 inverse_affine(const Matrix4 &matrix)
+{
+	const float (*a)[4] = matrix.m;
+	float c00 = a[1][1] * a[2][2] - a[1][2] * a[2][1];
+	float c01 = a[0][2] * a[2][1] - a[0][1] * a[2][2];
+	float c02 = a[0][1] * a[1][2] - a[0][2] * a[1][1];
+	float c10 = a[1][2] * a[2][0] - a[1][0] * a[2][2];
+	float c11 = a[0][0] * a[2][2] - a[0][2] * a[2][0];
+	float c12 = a[0][2] * a[1][0] - a[0][0] * a[1][2];
+	float c20 = a[1][0] * a[2][1] - a[1][1] * a[2][0];
+	float c21 = a[0][1] * a[2][0] - a[0][0] * a[2][1];
+	float c22 = a[0][0] * a[1][1] - a[0][1] * a[1][0];
+
+	float d = 1.0f / (a[0][0] * c00 + a[0][1] * c10 + a[0][2] * c20);
+	c00 *= d; c01 *= d; c02 *= d;
+	c10 *= d; c11 *= d; c12 *= d;
+	c20 *= d; c21 *= d; c22 *= d;
+
+	float x = a[3][0];
+	float y = a[3][1];
+	float z = a[3][2];
+	Simd_Matrix result;
+	result.rows[0] = simd_set(c00, c01, c02, 0.0f);
+	result.rows[1] = simd_set(c10, c11, c12, 0.0f);
+	result.rows[2] = simd_set(c20, c21, c22, 0.0f);
+	result.rows[3] = simd_set(-(x * c00 + y * c10 + z * c20), -(x * c01 + y * c11 + z * c21), -(x * c02 + y * c12 + z * c22), 1.0f);
+	return result;
+}
+
+// For rotations and translations without scaling, view matrices and camera world matrices.
+// The inverse of the rotation is its transpose.
+inline Matrix4 inverse_orthonormal(const Matrix4 &matrix)
+{
+	Simd_Matrix rows = simd_load(matrix);
+	Simd_Vector translation = rows.rows[3];
+	rows.rows[3] = simd_set(0.0f, 0.0f, 0.0f, 1.0f);
+	return add_inverse_translation(simd_transpose(rows), translation);
 }
 
 inline Matrix4 transpose(Matrix4 *matrix)
 {
-	XMMATRIX temp = XMLoadFloat4x4(matrix);
-	return XMMatrixTranspose(temp);
+	return simd_transpose(simd_load(*matrix));
 }
 
 inline Matrix3 make_identity_matrix3()
 {
-	return XMMatrixIdentity();
+	return Matrix3(1.0f, 0.0f, 0.0f,
+				   0.0f, 1.0f, 0.0f,
+				   0.0f, 0.0f, 1.0f);
 }
 
 inline Matrix4 make_identity_matrix()
 {
-	return XMMatrixIdentity();
+	return make_scale_matrix(1.0f, 1.0f, 1.0f);
 }
 
 inline Matrix4 make_scale_matrix(float scaling_value)
@@ -261,7 +416,10 @@ inline Matrix4 make_scale_matrix(Vector3 *scale_xyz)
 
 inline Matrix4 make_scale_matrix(float scale_x, float scale_y, float scale_z)
 {
-	return XMMatrixScaling(scale_x, scale_y, scale_z);
+	return Matrix4(scale_x, 0.0f, 0.0f, 0.0f,
+				   0.0f, scale_y, 0.0f, 0.0f,
+				   0.0f, 0.0f, scale_z, 0.0f,
+				   0.0f, 0.0f, 0.0f, 1.0f);
 }
 
 inline Matrix4 make_translation_matrix(Vector2 *vector)
@@ -270,110 +428,120 @@ inline Matrix4 make_translation_matrix(Vector2 *vector)
 	return make_translation_matrix(&temp);
 }
 
-Matrix4 make_translation_matrix(Vector3 *vector)
+inline Matrix4 make_translation_matrix(Vector3 *vector)
 {
-	return XMMatrixTranslation(vector->x, vector->y, vector->z);
+	return Matrix4(1.0f, 0.0f, 0.0f, 0.0f,
+				   0.0f, 1.0f, 0.0f, 0.0f,
+				   0.0f, 0.0f, 1.0f, 0.0f,
+				   vector->x, vector->y, vector->z, 1.0f);
 }
 
+// view_direction is a point the view looks at.
 inline Matrix4 make_look_at_matrix(const Vector3 &view_position, const Vector3 &view_direction, const Vector3 &up)
 {
-	return XMMatrixLookAtLH(XMLoadFloat3(&view_position), XMLoadFloat3(&view_direction), XMLoadFloat3(&up));
+	return make_look_to_matrix(view_position, view_direction - view_position, up);
 }
 
 inline Matrix4 make_look_to_matrix(const Vector3 &view_position, const Vector3 &view_direction, const Vector3 &up)
 {
-	return XMMatrixLookToLH(XMLoadFloat3(&view_position), XMLoadFloat3(&view_direction), XMLoadFloat3(&up));
+	Vector3 z_axis = normalize(view_direction);
+	Vector3 x_axis = normalize(cross(up, z_axis));
+	Vector3 y_axis = cross(z_axis, x_axis);
+	Vector3 position = -view_position;
+	return Matrix4(x_axis.x, y_axis.x, z_axis.x, 0.0f,
+				   x_axis.y, y_axis.y, z_axis.y, 0.0f,
+				   x_axis.z, y_axis.z, z_axis.z, 0.0f,
+				   dot(x_axis, position), dot(y_axis, position), dot(z_axis, position), 1.0f);
 }
 
+// The depth of the view frustum is mapped to [0, 1].
 inline Matrix4 make_perspective_matrix(float fov, float aspect_ratio, float near_plane, float far_plane)
 {
-	return XMMatrixPerspectiveFovLH(fov, aspect_ratio, near_plane, far_plane);
+	float height = cosf(0.5f * fov) / sinf(0.5f * fov);
+	float width = height / aspect_ratio;
+	float range = far_plane / (far_plane - near_plane);
+	return Matrix4(width, 0.0f, 0.0f, 0.0f,
+				   0.0f, height, 0.0f, 0.0f,
+				   0.0f, 0.0f, range, 1.0f,
+				   0.0f, 0.0f, -range * near_plane, 0.0f);
 }
 
 inline Matrix4 make_orthographic_matrix(float width, float height, float near_plane, float far_plane)
 {
-	return XMMatrixOrthographicLH(width, height, near_plane, far_plane);
+	float range = 1.0f / (far_plane - near_plane);
+	return Matrix4(2.0f / width, 0.0f, 0.0f, 0.0f,
+				   0.0f, 2.0f / height, 0.0f, 0.0f,
+				   0.0f, 0.0f, range, 0.0f,
+				   0.0f, 0.0f, -range * near_plane, 1.0f);
+}
+
+inline Matrix4 make_orthographic_off_center_matrix(float left, float right, float bottom, float top, float near_plane, float far_plane)
+{
+	float reciprocal_width = 1.0f / (right - left);
+	float reciprocal_height = 1.0f / (top - bottom);
+	float range = 1.0f / (far_plane - near_plane);
+	return Matrix4(reciprocal_width + reciprocal_width, 0.0f, 0.0f, 0.0f,
+				   0.0f, reciprocal_height + reciprocal_height, 0.0f, 0.0f,
+				   0.0f, 0.0f, range, 0.0f,
+				   -(left + right) * reciprocal_width, -(top + bottom) * reciprocal_height, -range * near_plane, 1.0f);
 }
 
 inline Matrix4 operator*(const Matrix3 &first_matrix, const Matrix4 second_matrix)
 {
-	XMMATRIX first = XMLoadFloat3x3(&first_matrix);
-	XMMATRIX second = XMLoadFloat4x4(&second_matrix);
-	return XMMatrixMultiply(first, second);
+	return simd_multiply(simd_load(first_matrix), simd_load(second_matrix));
 }
 
 inline Matrix4 operator*(const Matrix4 &first_matrix, const Matrix4 &second_matrix)
 {
-	XMMATRIX first = XMLoadFloat4x4(&first_matrix);
-	XMMATRIX second = XMLoadFloat4x4(&second_matrix);
-	return XMMatrixMultiply(first, second);
+	return simd_multiply(simd_load(first_matrix), simd_load(second_matrix));
 }
 
 inline Vector2 operator*(const Vector2 &vector, const Matrix4 &matrix)
 {
-	XMVECTOR v = XMLoadFloat2(&vector);
-	XMMATRIX m = XMLoadFloat4x4(&matrix);
-	return XMVector2Transform(v, m);
+	return simd_transform(simd_set(vector.x, vector.y, 0.0f, 1.0f), simd_load(matrix));
 }
 
 inline Vector3 operator*(const Vector3 &vector, const Matrix4 &matrix)
 {
-	XMVECTOR v = XMLoadFloat3(&vector);
-	XMMATRIX m = XMLoadFloat4x4(&matrix);
-	return XMVector3Transform(v, m);
+	return simd_transform(simd_set(vector.x, vector.y, vector.z, 1.0f), simd_load(matrix));
 }
 
 inline Vector4 operator*(const Vector4 &vector, const Matrix4 &matrix)
 {
-	XMVECTOR v = XMLoadFloat4(&vector);
-	XMMATRIX m = XMLoadFloat4x4(&matrix);
-	return XMVector4Transform(v, m);
+	return simd_transform(simd_load(vector), simd_load(matrix));
 }
 
 inline Vector2 &operator*=(Vector2 &vector, const Matrix4 &matrix)
 {
-	XMVECTOR v = XMLoadFloat2(&vector);
-	XMMATRIX m = XMLoadFloat4x4(&matrix);
-	vector = XMVector2Transform(v, m);
+	vector = vector * matrix;
 	return vector;
 }
 
 inline Vector3 &operator*=(Vector3 &vector, const Matrix4 &matrix)
 {
-	XMVECTOR v = XMLoadFloat3(&vector);
-	XMMATRIX m = XMLoadFloat4x4(&matrix);
-	vector = XMVector3Transform(v, m);
+	vector = vector * matrix;
 	return vector;
 }
 
 inline Vector4 &operator*=(Vector4 &vector, const Matrix4 &matrix)
 {
-	XMVECTOR v = XMLoadFloat4(&vector);
-	XMMATRIX m = XMLoadFloat4x4(&matrix);
-	vector = XMVector4Transform(v, m);
+	vector = vector * matrix;
 	return vector;
 }
 
 inline Vector2 transform(Vector2 *vector, Matrix4 *transform_matrix)
 {
-	XMVECTOR v = XMLoadFloat2(vector);
-	XMMATRIX m = XMLoadFloat4x4(transform_matrix);
-	return XMVector2Transform(v, m);
+	return *vector * *transform_matrix;
 }
 
 inline Vector3 transform(Vector3 *vector, Matrix4 *transform_matrix)
 {
-	Vector4 t = Vector4(*vector, 1.0f);
-	XMVECTOR v = XMLoadFloat4(&t);
-	XMMATRIX m = XMLoadFloat4x4(transform_matrix);
-	return XMVector3Transform(v, m);
+	return *vector * *transform_matrix;
 }
 
 inline Vector4 transform(Vector4 *vector, Matrix4 *transform_matrix)
 {
-	XMVECTOR v = XMLoadFloat4(vector);
-	XMMATRIX m = XMLoadFloat4x4(transform_matrix);
-	return XMVector4Transform(v, m);
+	return *vector * *transform_matrix;
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,197 @@
+#ifndef MATH_QUATERNION_H
+#define MATH_QUATERNION_H
+
+#include <math.h>
+
+#include "simd.h"
+#include "vector.h"
+#include "matrix.h"
+
+// A rotation, (x, y, z) is the axis multiplied by the sine of the half angle and w is the cosine of the half angle.
+// Quaternions are composed in the same order as matrices: first * second rotates by first and then by second.
+struct Quaternion {
+	Quaternion() {}
+	Quaternion(Simd_Vector vector);
+	Quaternion(float x, float y, float z, float w) : x(x), y(y), z(z), w(w) {}
+
+	float x, y, z, w;
+
+	Quaternion &operator=(Simd_Vector vector);
+	Quaternion &operator*=(const Quaternion &other);
+};
+
+inline Simd_Vector simd_load(const Quaternion &quaternion);
+
+inline Quaternion make_identity_quaternion();
+inline Quaternion make_quaternion(const Vector3 &axis, float angle);
+inline Quaternion make_quaternion(float x_angle, float y_angle, float z_angle);
+inline Vector3 get_euler_angles(const Quaternion &quaternion);
+
+inline float dot(const Quaternion &first_quaternion, const Quaternion &second_quaternion);
+inline Quaternion normalize(const Quaternion &quaternion);
+inline Quaternion conjugate(const Quaternion &quaternion);
+inline Quaternion slerp(const Quaternion &first_quaternion, const Quaternion &second_quaternion, float t);
+
+inline Quaternion operator*(const Quaternion &first_quaternion, const Quaternion &second_quaternion);
+inline Vector3 operator*(const Vector3 &vector, const Quaternion &quaternion);
+inline Vector3 &operator*=(Vector3 &vector, const Quaternion &quaternion);
+
+inline Matrix4 rotate(const Quaternion &quaternion);
+inline Matrix4 make_world_matrix(const Vector3 &scaling, const Quaternion &orientation, const Vector3 &position);
+
+inline Quaternion::Quaternion(Simd_Vector vector)
+{
+	simd_store4(&x, vector);
+}
+
+inline Quaternion &Quaternion::operator=(Simd_Vector vector)
+{
+	simd_store4(&x, vector);
+	return *this;
+}
+
+inline Quaternion &Quaternion::operator*=(const Quaternion &other)
+{
+	*this = *this * other;
+	return *this;
+}
+
+inline Simd_Vector simd_load(const Quaternion &quaternion)
+{
+	return simd_load4(&quaternion.x);
+}
+
+inline Quaternion make_identity_quaternion()
+{
+	return Quaternion(0.0f, 0.0f, 0.0f, 1.0f);
+}
+
+// The axis must be normalized.
+inline Quaternion make_quaternion(const Vector3 &axis, float angle)
+{
+	float sine = sinf(0.5f * angle);
+	return Quaternion(axis.x * sine, axis.y * sine, axis.z * sine, cosf(0.5f * angle));
+}
+
+// The same rotation as rotate(x_angle, y_angle, z_angle), about z, then about x, then about y.
+inline Quaternion make_quaternion(float x_angle, float y_angle, float z_angle)
+{
+	float sin_x = sinf(0.5f * x_angle);
+	float cos_x = cosf(0.5f * x_angle);
+	float sin_y = sinf(0.5f * y_angle);
+	float cos_y = cosf(0.5f * y_angle);
+	float sin_z = sinf(0.5f * z_angle);
+	float cos_z = cosf(0.5f * z_angle);
+	return Quaternion(sin_x * cos_y * cos_z + cos_x * sin_y * sin_z,
+					  cos_x * sin_y * cos_z - sin_x * cos_y * sin_z,
+					  cos_x * cos_y * sin_z - sin_x * sin_y * cos_z,
+					  cos_x * cos_y * cos_z + sin_x * sin_y * sin_z);
+}
+
+// The angles which make_quaternion and rotate take, the x angle is in [-pi/2, pi/2].
+inline Vector3 get_euler_angles(const Quaternion &quaternion)
+{
+	const Quaternion &q = quaternion;
+	float sin_x = -2.0f * (q.y * q.z - q.x * q.w);
+	sin_x = sin_x < -1.0f ? -1.0f : (sin_x > 1.0f ? 1.0f : sin_x);
+	float x_angle = asinf(sin_x);
+	float y_angle = atan2f(2.0f * (q.x * q.z + q.y * q.w), 1.0f - 2.0f * (q.x * q.x + q.y * q.y));
+	float z_angle = atan2f(2.0f * (q.x * q.y + q.z * q.w), 1.0f - 2.0f * (q.x * q.x + q.z * q.z));
+	return Vector3(x_angle, y_angle, z_angle);
+}
+
+inline float dot(const Quaternion &first_quaternion, const Quaternion &second_quaternion)
+{
+	return simd_dot4(simd_load(first_quaternion), simd_load(second_quaternion));
+}
+
+inline Quaternion normalize(const Quaternion &quaternion)
+{
+	Simd_Vector vector = simd_load(quaternion);
+	return simd_div(vector, simd_splat(sqrtf(simd_dot4(vector, vector))));
+}
+
+// The inverse rotation of a unit quaternion.
+inline Quaternion conjugate(const Quaternion &quaternion)
+{
+	return Quaternion(-quaternion.x, -quaternion.y, -quaternion.z, quaternion.w);
+}
+
+// Goes the shorter way around, close quaternions are interpolated linearly and normalized.
+inline Quaternion slerp(const Quaternion &first_quaternion, const Quaternion &second_quaternion, float t)
+{
+	Simd_Vector first = simd_load(first_quaternion);
+	Simd_Vector second = simd_load(second_quaternion);
+	float cosine = simd_dot4(first, second);
+	if (cosine < 0.0f) {
+		cosine = -cosine;
+		second = simd_negate(second);
+	}
+	if (cosine > 0.9995f) {
+		Simd_Vector result = simd_add(simd_scale(first, 1.0f - t), simd_scale(second, t));
+		return simd_div(result, simd_splat(sqrtf(simd_dot4(result, result))));
+	}
+	float angle = acosf(cosine);
+	float reciprocal_sine = 1.0f / sinf(angle);
+	float first_weight = sinf((1.0f - t) * angle) * reciprocal_sine;
+	float second_weight = sinf(t * angle) * reciprocal_sine;
+	return simd_add(simd_scale(first, first_weight), simd_scale(second, second_weight));
+}
+
+// The Hamilton product second_quaternion * first_quaternion, a sum of the first quaternion's lanes permuted
+// and with changed signs multiplied by each component of the second one.
+inline Quaternion operator*(const Quaternion &first_quaternion, const Quaternion &second_quaternion)
+{
+	Simd_Vector first = simd_load(first_quaternion);
+	Simd_Vector second = simd_load(second_quaternion);
+
+	Simd_Vector result = simd_mul(simd_permute<3, 3, 3, 3>(second), first);
+	result = simd_add(result, simd_mul(simd_permute<0, 0, 0, 0>(second), simd_mul(simd_permute<3, 2, 1, 0>(first), simd_set(1.0f, -1.0f, 1.0f, -1.0f))));
+	result = simd_add(result, simd_mul(simd_permute<1, 1, 1, 1>(second), simd_mul(simd_permute<2, 3, 0, 1>(first), simd_set(1.0f, 1.0f, -1.0f, -1.0f))));
+	return simd_add(result, simd_mul(simd_permute<2, 2, 2, 2>(second), simd_mul(simd_permute<1, 0, 3, 2>(first), simd_set(-1.0f, 1.0f, 1.0f, -1.0f))));
+}
+
+// Rotates the vector, the same as multiplying it by rotate(quaternion) but without making the matrix.
+inline Vector3 operator*(const Vector3 &vector, const Quaternion &quaternion)
+{
+	Simd_Vector v = simd_load(vector);
+	Simd_Vector axis = simd_load3(&quaternion.x);
+	Simd_Vector t = simd_scale(simd_cross3(axis, v), 2.0f);
+	return simd_add(simd_add(v, simd_scale(t, quaternion.w)), simd_cross3(axis, t));
+}
+
+inline Vector3 &operator*=(Vector3 &vector, const Quaternion &quaternion)
+{
+	vector = vector * quaternion;
+	return vector;
+}
+
+inline Matrix4 rotate(const Quaternion &quaternion)
+{
+	return make_world_matrix(Vector3(1.0f, 1.0f, 1.0f), quaternion, Vector3(0.0f, 0.0f, 0.0f));
+}
+
+// make_scale_matrix(scaling) * rotate(orientation) * make_translation_matrix(position) without multiplying matrices.
+// The transform batch kernels use the same expressions.
+inline Matrix4 make_world_matrix(const Vector3 &scaling, const Quaternion &orientation, const Vector3 &position)
+{
+	const Quaternion &q = orientation;
+	float x2 = q.x + q.x;
+	float y2 = q.y + q.y;
+	float z2 = q.z + q.z;
+	float xx = q.x * x2;
+	float yy = q.y * y2;
+	float zz = q.z * z2;
+	float xy = q.x * y2;
+	float xz = q.x * z2;
+	float yz = q.y * z2;
+	float wx = q.w * x2;
+	float wy = q.w * y2;
+	float wz = q.w * z2;
+	return Matrix4((1.0f - (yy + zz)) * scaling.x, (xy + wz) * scaling.x, (xz - wy) * scaling.x, 0.0f,
+				   (xy - wz) * scaling.y, (1.0f - (xx + zz)) * scaling.y, (yz + wx) * scaling.y, 0.0f,
+				   (xz + wy) * scaling.z, (yz - wx) * scaling.z, (1.0f - (xx + yy)) * scaling.z, 0.0f,
+				   position.x, position.y, position.z, 1.0f);
+}
+
+#endif
@@ -0,0 +1,591 @@
+#ifndef MATH_SIMD_H
+#define MATH_SIMD_H
+
+#include <math.h>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#endif
+
+// The backend of the math library, a register of 4 floats and a matrix of 4 such rows. The backend is picked
+// at compile time: SSE on x86 (SSE4.1 rounding and AVX2 matrix multiplication when the compiler targets them),
+// NEON on ARM64 and plain C++ on everything else. MATH_SIMD_SCALAR forces the scalar reference, it is the
+// implementation the others are checked against.
+// All backends do the same operations in the same order, there are no fused multiply-adds and horizontal sums
+// are always ((x + y) + z) + w, so the results are the same on every backend as long as the compiler doesn't
+// contract multiplies and adds itself (MSVC /fp:precise and GCC without -mfma don't).
+#if defined(MATH_SIMD_SCALAR)
+#elif defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#define MATH_SIMD_SSE
+#elif defined(_M_ARM64) || defined(__aarch64__)
+#define MATH_SIMD_NEON
+#else
+#define MATH_SIMD_SCALAR
+#endif
+
+#if defined(MATH_SIMD_SSE)
+#if defined(__SSE4_1__) || defined(__AVX__)
+#define MATH_SIMD_SSE4
+#include <smmintrin.h>
+#endif
+#if defined(__AVX2__)
+#define MATH_SIMD_AVX2
+#include <immintrin.h>
+#endif
+#include <emmintrin.h>
+
+typedef __m128 Simd_Vector;
+
+#elif defined(MATH_SIMD_NEON)
+#include <arm_neon.h>
+
+typedef float32x4_t Simd_Vector;
+
+#else
+
+struct Simd_Vector {
+	float lanes[4];
+};
+#endif
+
+// Rows of a row-major matrix, vectors are rows and are multiplied from the left (v * M).
+struct Simd_Matrix {
+	Simd_Vector rows[4];
+};
+
+inline const char *get_simd_backend_name()
+{
+#if defined(MATH_SIMD_AVX2)
+	return "AVX2";
+#elif defined(MATH_SIMD_SSE4)
+	return "SSE4";
+#elif defined(MATH_SIMD_SSE)
+	return "SSE2";
+#elif defined(MATH_SIMD_NEON)
+	return "NEON";
+#else
+	return "Scalar";
+#endif
+}
+
+// Batch kernels (transform_batch.h, intersection_batch.h) have AVX2 versions in files of their own which are picked
+// at run time, the rest of the engine doesn't depend on AVX2.
+inline bool cpu_supports_avx2()
+{
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+	int info[4];
+	__cpuid(info, 0);
+	if (info[0] < 7) {
+		return false;
+	}
+	__cpuid(info, 1);
+	bool os_saves_avx_registers = (info[2] & (1 << 27)) != 0;
+	bool avx = (info[2] & (1 << 28)) != 0;
+	__cpuidex(info, 7, 0);
+	bool avx2 = (info[1] & (1 << 5)) != 0;
+	return avx && avx2 && os_saves_avx_registers && ((_xgetbv(0) & 0x6) == 0x6);
+#elif defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+	return __builtin_cpu_supports("avx2");
+#else
+	return false;
+#endif
+}
+
+#if defined(MATH_SIMD_SSE)
+
+inline Simd_Vector simd_set(float x, float y, float z, float w)
+{
+	return _mm_set_ps(w, z, y, x);
+}
+
+inline Simd_Vector simd_splat(float value)
+{
+	return _mm_set1_ps(value);
+}
+
+inline Simd_Vector simd_load2(const float *memory)
+{
+	return _mm_castpd_ps(_mm_load_sd((const double *)memory));
+}
+
+inline Simd_Vector simd_load3(const float *memory)
+{
+	return _mm_movelh_ps(simd_load2(memory), _mm_load_ss(memory + 2));
+}
+
+inline Simd_Vector simd_load4(const float *memory)
+{
+	return _mm_loadu_ps(memory);
+}
+
+inline void simd_store2(float *memory, Simd_Vector vector)
+{
+	_mm_store_sd((double *)memory, _mm_castps_pd(vector));
+}
+
+inline void simd_store3(float *memory, Simd_Vector vector)
+{
+	simd_store2(memory, vector);
+	_mm_store_ss(memory + 2, _mm_movehl_ps(vector, vector));
+}
+
+inline void simd_store4(float *memory, Simd_Vector vector)
+{
+	_mm_storeu_ps(memory, vector);
+}
+
+inline float simd_get_x(Simd_Vector vector)
+{
+	return _mm_cvtss_f32(vector);
+}
+
+inline Simd_Vector simd_add(Simd_Vector first, Simd_Vector second)
+{
+	return _mm_add_ps(first, second);
+}
+
+inline Simd_Vector simd_sub(Simd_Vector first, Simd_Vector second)
+{
+	return _mm_sub_ps(first, second);
+}
+
+inline Simd_Vector simd_mul(Simd_Vector first, Simd_Vector second)
+{
+	return _mm_mul_ps(first, second);
+}
+
+inline Simd_Vector simd_div(Simd_Vector first, Simd_Vector second)
+{
+	return _mm_div_ps(first, second);
+}
+
+inline Simd_Vector simd_sqrt(Simd_Vector vector)
+{
+	return _mm_sqrt_ps(vector);
+}
+
+inline Simd_Vector simd_negate(Simd_Vector vector)
+{
+	return _mm_xor_ps(vector, _mm_set1_ps(-0.0f));
+}
+
+// Rounds halves to even like rintf in the default rounding mode.
+inline Simd_Vector simd_round(Simd_Vector vector)
+{
+#if defined(MATH_SIMD_SSE4)
+	return _mm_round_ps(vector, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+#else
+	// Adding and subtracting 2^23 drops the fraction, floats above 2^23 are whole numbers already.
+	// The sign is put back so that -0.3 becomes -0.0 as it does with _mm_round_ps.
+	__m128 sign = _mm_and_ps(vector, _mm_set1_ps(-0.0f));
+	__m128 magnitude = _mm_andnot_ps(_mm_set1_ps(-0.0f), vector);
+	__m128 magic = _mm_set1_ps(8388608.0f);
+	__m128 rounded = _mm_or_ps(_mm_sub_ps(_mm_add_ps(magnitude, magic), magic), sign);
+	__m128 fractional = _mm_cmplt_ps(magnitude, magic);
+	return _mm_or_ps(_mm_and_ps(fractional, rounded), _mm_andnot_ps(fractional, vector));
+#endif
+}
+
+inline Simd_Vector simd_floor(Simd_Vector vector)
+{
+#if defined(MATH_SIMD_SSE4)
+	return _mm_floor_ps(vector);
+#else
+	__m128 rounded = simd_round(vector);
+	return _mm_sub_ps(rounded, _mm_and_ps(_mm_cmpgt_ps(rounded, vector), _mm_set1_ps(1.0f)));
+#endif
+}
+
+inline float simd_sum3(Simd_Vector vector)
+{
+	__m128 sum = _mm_add_ss(vector, _mm_shuffle_ps(vector, vector, _MM_SHUFFLE(1, 1, 1, 1)));
+	return _mm_cvtss_f32(_mm_add_ss(sum, _mm_movehl_ps(vector, vector)));
+}
+
+inline float simd_sum4(Simd_Vector vector)
+{
+	__m128 sum = _mm_add_ss(vector, _mm_shuffle_ps(vector, vector, _MM_SHUFFLE(1, 1, 1, 1)));
+	sum = _mm_add_ss(sum, _mm_movehl_ps(vector, vector));
+	return _mm_cvtss_f32(_mm_add_ss(sum, _mm_shuffle_ps(vector, vector, _MM_SHUFFLE(3, 3, 3, 3))));
+}
+
+inline Simd_Vector simd_cross3(Simd_Vector first, Simd_Vector second)
+{
+	__m128 first_yzx = _mm_shuffle_ps(first, first, _MM_SHUFFLE(3, 0, 2, 1));
+	__m128 second_zxy = _mm_shuffle_ps(second, second, _MM_SHUFFLE(3, 1, 0, 2));
+	__m128 first_zxy = _mm_shuffle_ps(first, first, _MM_SHUFFLE(3, 1, 0, 2));
+	__m128 second_yzx = _mm_shuffle_ps(second, second, _MM_SHUFFLE(3, 0, 2, 1));
+	return _mm_sub_ps(_mm_mul_ps(first_yzx, second_zxy), _mm_mul_ps(first_zxy, second_yzx));
+}
+
+inline Simd_Vector simd_transform(Simd_Vector vector, const Simd_Matrix &matrix)
+{
+	__m128 result = _mm_mul_ps(_mm_shuffle_ps(vector, vector, _MM_SHUFFLE(0, 0, 0, 0)), matrix.rows[0]);
+	result = _mm_add_ps(result, _mm_mul_ps(_mm_shuffle_ps(vector, vector, _MM_SHUFFLE(1, 1, 1, 1)), matrix.rows[1]));
+	result = _mm_add_ps(result, _mm_mul_ps(_mm_shuffle_ps(vector, vector, _MM_SHUFFLE(2, 2, 2, 2)), matrix.rows[2]));
+	return _mm_add_ps(result, _mm_mul_ps(_mm_shuffle_ps(vector, vector, _MM_SHUFFLE(3, 3, 3, 3)), matrix.rows[3]));
+}
+
+// The lanes of the result are the lanes x, y, z and w of the vector.
+template <int x, int y, int z, int w>
+inline Simd_Vector simd_permute(Simd_Vector vector)
+{
+	return _mm_shuffle_ps(vector, vector, _MM_SHUFFLE(w, z, y, x));
+}
+
+inline Simd_Matrix simd_transpose(const Simd_Matrix &matrix)
+{
+	Simd_Matrix result = matrix;
+	_MM_TRANSPOSE4_PS(result.rows[0], result.rows[1], result.rows[2], result.rows[3]);
+	return result;
+}
+
+#elif defined(MATH_SIMD_NEON)
+
+inline Simd_Vector simd_set(float x, float y, float z, float w)
+{
+	float lanes[4] = { x, y, z, w };
+	return vld1q_f32(lanes);
+}
+
+inline Simd_Vector simd_splat(float value)
+{
+	return vdupq_n_f32(value);
+}
+
+inline Simd_Vector simd_load2(const float *memory)
+{
+	return vcombine_f32(vld1_f32(memory), vdup_n_f32(0.0f));
+}
+
+inline Simd_Vector simd_load3(const float *memory)
+{
+	return vcombine_f32(vld1_f32(memory), vld1_lane_f32(memory + 2, vdup_n_f32(0.0f), 0));
+}
+
+inline Simd_Vector simd_load4(const float *memory)
+{
+	return vld1q_f32(memory);
+}
+
+inline void simd_store2(float *memory, Simd_Vector vector)
+{
+	vst1_f32(memory, vget_low_f32(vector));
+}
+
+inline void simd_store3(float *memory, Simd_Vector vector)
+{
+	vst1_f32(memory, vget_low_f32(vector));
+	vst1q_lane_f32(memory + 2, vector, 2);
+}
+
+inline void simd_store4(float *memory, Simd_Vector vector)
+{
+	vst1q_f32(memory, vector);
+}
+
+inline float simd_get_x(Simd_Vector vector)
+{
+	return vgetq_lane_f32(vector, 0);
+}
+
+inline Simd_Vector simd_add(Simd_Vector first, Simd_Vector second)
+{
+	return vaddq_f32(first, second);
+}
+
+inline Simd_Vector simd_sub(Simd_Vector first, Simd_Vector second)
+{
+	return vsubq_f32(first, second);
+}
+
+inline Simd_Vector simd_mul(Simd_Vector first, Simd_Vector second)
+{
+	return vmulq_f32(first, second);
+}
+
+inline Simd_Vector simd_div(Simd_Vector first, Simd_Vector second)
+{
+	return vdivq_f32(first, second);
+}
+
+inline Simd_Vector simd_sqrt(Simd_Vector vector)
+{
+	return vsqrtq_f32(vector);
+}
+
+inline Simd_Vector simd_negate(Simd_Vector vector)
+{
+	return vnegq_f32(vector);
+}
+
+inline Simd_Vector simd_round(Simd_Vector vector)
+{
+	return vrndnq_f32(vector);
+}
+
+inline Simd_Vector simd_floor(Simd_Vector vector)
+{
+	return vrndmq_f32(vector);
+}
+
+inline float simd_sum3(Simd_Vector vector)
+{
+	return (vgetq_lane_f32(vector, 0) + vgetq_lane_f32(vector, 1)) + vgetq_lane_f32(vector, 2);
+}
+
+inline float simd_sum4(Simd_Vector vector)
+{
+	return ((vgetq_lane_f32(vector, 0) + vgetq_lane_f32(vector, 1)) + vgetq_lane_f32(vector, 2)) + vgetq_lane_f32(vector, 3);
+}
+
+inline Simd_Vector simd_cross3(Simd_Vector first, Simd_Vector second)
+{
+	// Lanes (y, z, x, w) and (z, x, y, w) of the both vectors.
+	float32x4_t first_yzx = vextq_f32(first, first, 1);
+	first_yzx = vsetq_lane_f32(vgetq_lane_f32(first, 0), first_yzx, 2);
+	first_yzx = vsetq_lane_f32(vgetq_lane_f32(first, 3), first_yzx, 3);
+	float32x4_t second_yzx = vextq_f32(second, second, 1);
+	second_yzx = vsetq_lane_f32(vgetq_lane_f32(second, 0), second_yzx, 2);
+	second_yzx = vsetq_lane_f32(vgetq_lane_f32(second, 3), second_yzx, 3);
+	float32x4_t first_zxy = vextq_f32(first_yzx, first_yzx, 1);
+	first_zxy = vsetq_lane_f32(vgetq_lane_f32(first, 1), first_zxy, 2);
+	first_zxy = vsetq_lane_f32(vgetq_lane_f32(first, 3), first_zxy, 3);
+	float32x4_t second_zxy = vextq_f32(second_yzx, second_yzx, 1);
+	second_zxy = vsetq_lane_f32(vgetq_lane_f32(second, 1), second_zxy, 2);
+	second_zxy = vsetq_lane_f32(vgetq_lane_f32(second, 3), second_zxy, 3);
+	return vsubq_f32(vmulq_f32(first_yzx, second_zxy), vmulq_f32(first_zxy, second_yzx));
+}
+
+inline Simd_Vector simd_transform(Simd_Vector vector, const Simd_Matrix &matrix)
+{
+	float32x4_t result = vmulq_laneq_f32(matrix.rows[0], vector, 0);
+	result = vaddq_f32(result, vmulq_laneq_f32(matrix.rows[1], vector, 1));
+	result = vaddq_f32(result, vmulq_laneq_f32(matrix.rows[2], vector, 2));
+	return vaddq_f32(result, vmulq_laneq_f32(matrix.rows[3], vector, 3));
+}
+
+template <int x, int y, int z, int w>
+inline Simd_Vector simd_permute(Simd_Vector vector)
+{
+	float32x4_t result = vdupq_n_f32(vgetq_lane_f32(vector, x));
+	result = vsetq_lane_f32(vgetq_lane_f32(vector, y), result, 1);
+	result = vsetq_lane_f32(vgetq_lane_f32(vector, z), result, 2);
+	return vsetq_lane_f32(vgetq_lane_f32(vector, w), result, 3);
+}
+
+inline Simd_Matrix simd_transpose(const Simd_Matrix &matrix)
+{
+	float32x4x2_t rows_01 = vtrnq_f32(matrix.rows[0], matrix.rows[1]);
+	float32x4x2_t rows_23 = vtrnq_f32(matrix.rows[2], matrix.rows[3]);
+	Simd_Matrix result;
+	result.rows[0] = vcombine_f32(vget_low_f32(rows_01.val[0]), vget_low_f32(rows_23.val[0]));
+	result.rows[1] = vcombine_f32(vget_low_f32(rows_01.val[1]), vget_low_f32(rows_23.val[1]));
+	result.rows[2] = vcombine_f32(vget_high_f32(rows_01.val[0]), vget_high_f32(rows_23.val[0]));
+	result.rows[3] = vcombine_f32(vget_high_f32(rows_01.val[1]), vget_high_f32(rows_23.val[1]));
+	return result;
+}
+
+#else
+
+inline Simd_Vector simd_set(float x, float y, float z, float w)
+{
+	Simd_Vector result = { { x, y, z, w } };
+	return result;
+}
+
+inline Simd_Vector simd_splat(float value)
+{
+	return simd_set(value, value, value, value);
+}
+
+inline Simd_Vector simd_load2(const float *memory)
+{
+	return simd_set(memory[0], memory[1], 0.0f, 0.0f);
+}
+
+inline Simd_Vector simd_load3(const float *memory)
+{
+	return simd_set(memory[0], memory[1], memory[2], 0.0f);
+}
+
+inline Simd_Vector simd_load4(const float *memory)
+{
+	return simd_set(memory[0], memory[1], memory[2], memory[3]);
+}
+
+inline void simd_store2(float *memory, Simd_Vector vector)
+{
+	memory[0] = vector.lanes[0];
+	memory[1] = vector.lanes[1];
+}
+
+inline void simd_store3(float *memory, Simd_Vector vector)
+{
+	memory[0] = vector.lanes[0];
+	memory[1] = vector.lanes[1];
+	memory[2] = vector.lanes[2];
+}
+
+inline void simd_store4(float *memory, Simd_Vector vector)
+{
+	memory[0] = vector.lanes[0];
+	memory[1] = vector.lanes[1];
+	memory[2] = vector.lanes[2];
+	memory[3] = vector.lanes[3];
+}
+
+inline float simd_get_x(Simd_Vector vector)
+{
+	return vector.lanes[0];
+}
+
+inline Simd_Vector simd_add(Simd_Vector first, Simd_Vector second)
+{
+	return simd_set(first.lanes[0] + second.lanes[0], first.lanes[1] + second.lanes[1], first.lanes[2] + second.lanes[2], first.lanes[3] + second.lanes[3]);
+}
+
+inline Simd_Vector simd_sub(Simd_Vector first, Simd_Vector second)
+{
+	return simd_set(first.lanes[0] - second.lanes[0], first.lanes[1] - second.lanes[1], first.lanes[2] - second.lanes[2], first.lanes[3] - second.lanes[3]);
+}
+
+inline Simd_Vector simd_mul(Simd_Vector first, Simd_Vector second)
+{
+	return simd_set(first.lanes[0] * second.lanes[0], first.lanes[1] * second.lanes[1], first.lanes[2] * second.lanes[2], first.lanes[3] * second.lanes[3]);
+}
+
+inline Simd_Vector simd_div(Simd_Vector first, Simd_Vector second)
+{
+	return simd_set(first.lanes[0] / second.lanes[0], first.lanes[1] / second.lanes[1], first.lanes[2] / second.lanes[2], first.lanes[3] / second.lanes[3]);
+}
+
+inline Simd_Vector simd_sqrt(Simd_Vector vector)
+{
+	return simd_set(sqrtf(vector.lanes[0]), sqrtf(vector.lanes[1]), sqrtf(vector.lanes[2]), sqrtf(vector.lanes[3]));
+}
+
+inline Simd_Vector simd_negate(Simd_Vector vector)
+{
+	return simd_set(-vector.lanes[0], -vector.lanes[1], -vector.lanes[2], -vector.lanes[3]);
+}
+
+inline Simd_Vector simd_round(Simd_Vector vector)
+{
+	return simd_set(rintf(vector.lanes[0]), rintf(vector.lanes[1]), rintf(vector.lanes[2]), rintf(vector.lanes[3]));
+}
+
+inline Simd_Vector simd_floor(Simd_Vector vector)
+{
+	return simd_set(floorf(vector.lanes[0]), floorf(vector.lanes[1]), floorf(vector.lanes[2]), floorf(vector.lanes[3]));
+}
+
+inline float simd_sum3(Simd_Vector vector)
+{
+	return (vector.lanes[0] + vector.lanes[1]) + vector.lanes[2];
+}
+
+inline float simd_sum4(Simd_Vector vector)
+{
+	return ((vector.lanes[0] + vector.lanes[1]) + vector.lanes[2]) + vector.lanes[3];
+}
+
+inline Simd_Vector simd_cross3(Simd_Vector first, Simd_Vector second)
+{
+	const float *a = first.lanes;
+	const float *b = second.lanes;
+	return simd_set(a[1] * b[2] - a[2] * b[1], a[2] * b[0] - a[0] * b[2], a[0] * b[1] - a[1] * b[0], a[3] * b[3] - a[3] * b[3]);
+}
+
+inline Simd_Vector simd_transform(Simd_Vector vector, const Simd_Matrix &matrix)
+{
+	Simd_Vector result = simd_mul(simd_splat(vector.lanes[0]), matrix.rows[0]);
+	result = simd_add(result, simd_mul(simd_splat(vector.lanes[1]), matrix.rows[1]));
+	result = simd_add(result, simd_mul(simd_splat(vector.lanes[2]), matrix.rows[2]));
+	return simd_add(result, simd_mul(simd_splat(vector.lanes[3]), matrix.rows[3]));
+}
+
+template <int x, int y, int z, int w>
+inline Simd_Vector simd_permute(Simd_Vector vector)
+{
+	return simd_set(vector.lanes[x], vector.lanes[y], vector.lanes[z], vector.lanes[w]);
+}
+
+inline Simd_Matrix simd_transpose(const Simd_Matrix &matrix)
+{
+	Simd_Matrix result;
+	for (int i = 0; i < 4; i++) {
+		result.rows[i] = simd_set(matrix.rows[0].lanes[i], matrix.rows[1].lanes[i], matrix.rows[2].lanes[i], matrix.rows[3].lanes[i]);
+	}
+	return result;
+}
+#endif
+
+inline Simd_Vector simd_scale(Simd_Vector vector, float value)
+{
+	return simd_mul(vector, simd_splat(value));
+}
+
+inline float simd_dot2(Simd_Vector first, Simd_Vector second)
+{
+	Simd_Vector product = simd_mul(first, second);
+	float lanes[4];
+	simd_store4(lanes, product);
+	return lanes[0] + lanes[1];
+}
+
+inline float simd_dot3(Simd_Vector first, Simd_Vector second)
+{
+	return simd_sum3(simd_mul(first, second));
+}
+
+inline float simd_dot4(Simd_Vector first, Simd_Vector second)
+{
+	return simd_sum4(simd_mul(first, second));
+}
+
+inline Simd_Matrix simd_load_matrix(const float *memory)
+{
+	Simd_Matrix result;
+	result.rows[0] = simd_load4(memory);
+	result.rows[1] = simd_load4(memory + 4);
+	result.rows[2] = simd_load4(memory + 8);
+	result.rows[3] = simd_load4(memory + 12);
+	return result;
+}
+
+inline void simd_store_matrix(float *memory, const Simd_Matrix &matrix)
+{
+	simd_store4(memory, matrix.rows[0]);
+	simd_store4(memory + 4, matrix.rows[1]);
+	simd_store4(memory + 8, matrix.rows[2]);
+	simd_store4(memory + 12, matrix.rows[3]);
+}
+
+inline Simd_Matrix simd_multiply(const Simd_Matrix &first, const Simd_Matrix &second)
+{
+	Simd_Matrix result;
+#if defined(MATH_SIMD_AVX2)
+	// Two rows of the result at once, the operations are the same as in simd_transform.
+	__m256 second_rows[4];
+	for (int i = 0; i < 4; i++) {
+		second_rows[i] = _mm256_insertf128_ps(_mm256_castps128_ps256(second.rows[i]), second.rows[i], 1);
+	}
+	for (int i = 0; i < 4; i += 2) {
+		__m256 rows = _mm256_insertf128_ps(_mm256_castps128_ps256(first.rows[i]), first.rows[i + 1], 1);
+		__m256 sum = _mm256_mul_ps(_mm256_shuffle_ps(rows, rows, _MM_SHUFFLE(0, 0, 0, 0)), second_rows[0]);
+		sum = _mm256_add_ps(sum, _mm256_mul_ps(_mm256_shuffle_ps(rows, rows, _MM_SHUFFLE(1, 1, 1, 1)), second_rows[1]));
+		sum = _mm256_add_ps(sum, _mm256_mul_ps(_mm256_shuffle_ps(rows, rows, _MM_SHUFFLE(2, 2, 2, 2)), second_rows[2]));
+		sum = _mm256_add_ps(sum, _mm256_mul_ps(_mm256_shuffle_ps(rows, rows, _MM_SHUFFLE(3, 3, 3, 3)), second_rows[3]));
+		result.rows[i] = _mm256_castps256_ps128(sum);
+		result.rows[i + 1] = _mm256_extractf128_ps(sum, 1);
+	}
+#else
+	for (int i = 0; i < 4; i++) {
+		result.rows[i] = simd_transform(first.rows[i], second);
+	}
+#endif
+	return result;
+}
+
+#endif
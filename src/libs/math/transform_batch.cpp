@@ -0,0 +1,130 @@
+#include "transform_batch.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#define TRANSFORM_BATCH_SSE 1
+#include <emmintrin.h>
+#else
+#define TRANSFORM_BATCH_SSE 0
+#endif
+
+static void make_world_matrices_scalar(Transform_Streams *transforms, u32 first_index, u32 last_index, Matrix4 *matrices)
+{
+	float **streams = transforms->streams;
+	for (u32 i = first_index; i < last_index; i++) {
+		Vector3 position = Vector3(streams[TRANSFORM_STREAM_POSITION_X][i], streams[TRANSFORM_STREAM_POSITION_Y][i], streams[TRANSFORM_STREAM_POSITION_Z][i]);
+		Quaternion orientation = Quaternion(streams[TRANSFORM_STREAM_ORIENTATION_X][i], streams[TRANSFORM_STREAM_ORIENTATION_Y][i], streams[TRANSFORM_STREAM_ORIENTATION_Z][i], streams[TRANSFORM_STREAM_ORIENTATION_W][i]);
+		Vector3 scaling = Vector3(streams[TRANSFORM_STREAM_SCALING_X][i], streams[TRANSFORM_STREAM_SCALING_Y][i], streams[TRANSFORM_STREAM_SCALING_Z][i]);
+		matrices[i] = make_world_matrix(scaling, orientation, position);
+	}
+}
+
+#if TRANSFORM_BATCH_SSE
+// Rows are made for 4 transforms at once, one component in a register, and transposed to 4 matrices before they are stored.
+// The expressions are the ones of make_world_matrix.
+static void make_world_matrices_sse(Transform_Streams *transforms, u32 first_index, u32 last_index, Matrix4 *matrices)
+{
+	float **streams = transforms->streams;
+	__m128 zero = _mm_setzero_ps();
+	__m128 one = _mm_set1_ps(1.0f);
+
+	u32 i = first_index;
+	for (; (i + 4) <= last_index; i += 4) {
+		__m128 x = _mm_loadu_ps(&streams[TRANSFORM_STREAM_ORIENTATION_X][i]);
+		__m128 y = _mm_loadu_ps(&streams[TRANSFORM_STREAM_ORIENTATION_Y][i]);
+		__m128 z = _mm_loadu_ps(&streams[TRANSFORM_STREAM_ORIENTATION_Z][i]);
+		__m128 w = _mm_loadu_ps(&streams[TRANSFORM_STREAM_ORIENTATION_W][i]);
+		__m128 x2 = _mm_add_ps(x, x);
+		__m128 y2 = _mm_add_ps(y, y);
+		__m128 z2 = _mm_add_ps(z, z);
+		__m128 xx = _mm_mul_ps(x, x2);
+		__m128 yy = _mm_mul_ps(y, y2);
+		__m128 zz = _mm_mul_ps(z, z2);
+		__m128 xy = _mm_mul_ps(x, y2);
+		__m128 xz = _mm_mul_ps(x, z2);
+		__m128 yz = _mm_mul_ps(y, z2);
+		__m128 wx = _mm_mul_ps(w, x2);
+		__m128 wy = _mm_mul_ps(w, y2);
+		__m128 wz = _mm_mul_ps(w, z2);
+		__m128 scaling_x = _mm_loadu_ps(&streams[TRANSFORM_STREAM_SCALING_X][i]);
+		__m128 scaling_y = _mm_loadu_ps(&streams[TRANSFORM_STREAM_SCALING_Y][i]);
+		__m128 scaling_z = _mm_loadu_ps(&streams[TRANSFORM_STREAM_SCALING_Z][i]);
+
+		__m128 rows[4][4];
+		rows[0][0] = _mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(yy, zz)), scaling_x);
+		rows[0][1] = _mm_mul_ps(_mm_add_ps(xy, wz), scaling_x);
+		rows[0][2] = _mm_mul_ps(_mm_sub_ps(xz, wy), scaling_x);
+		rows[0][3] = zero;
+		rows[1][0] = _mm_mul_ps(_mm_sub_ps(xy, wz), scaling_y);
+		rows[1][1] = _mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(xx, zz)), scaling_y);
+		rows[1][2] = _mm_mul_ps(_mm_add_ps(yz, wx), scaling_y);
+		rows[1][3] = zero;
+		rows[2][0] = _mm_mul_ps(_mm_add_ps(xz, wy), scaling_z);
+		rows[2][1] = _mm_mul_ps(_mm_sub_ps(yz, wx), scaling_z);
+		rows[2][2] = _mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(xx, yy)), scaling_z);
+		rows[2][3] = zero;
+		rows[3][0] = _mm_loadu_ps(&streams[TRANSFORM_STREAM_POSITION_X][i]);
+		rows[3][1] = _mm_loadu_ps(&streams[TRANSFORM_STREAM_POSITION_Y][i]);
+		rows[3][2] = _mm_loadu_ps(&streams[TRANSFORM_STREAM_POSITION_Z][i]);
+		rows[3][3] = one;
+
+		float *matrix = (float *)&matrices[i];
+		for (u32 row = 0; row < 4; row++) {
+			_MM_TRANSPOSE4_PS(rows[row][0], rows[row][1], rows[row][2], rows[row][3]);
+			for (u32 j = 0; j < 4; j++) {
+				_mm_storeu_ps(matrix + j * 16 + row * 4, rows[row][j]);
+			}
+		}
+	}
+	make_world_matrices_scalar(transforms, i, last_index, matrices);
+}
+#endif
+
+Transform_Batch_Kernel get_best_transform_batch_kernel()
+{
+	static Transform_Batch_Kernel best_kernel = []() {
+		if (is_avx2_transform_batch_kernel_compiled() && cpu_supports_avx2()) {
+			return TRANSFORM_BATCH_KERNEL_AVX2;
+		}
+		return TRANSFORM_BATCH_SSE ? TRANSFORM_BATCH_KERNEL_SSE : TRANSFORM_BATCH_KERNEL_SCALAR;
+	}();
+	return best_kernel;
+}
+
+const char *get_transform_batch_kernel_name(Transform_Batch_Kernel kernel)
+{
+	switch (kernel) {
+		case TRANSFORM_BATCH_KERNEL_SCALAR:
+			return "scalar";
+		case TRANSFORM_BATCH_KERNEL_SSE:
+			return "SSE";
+		case TRANSFORM_BATCH_KERNEL_AVX2:
+			return "AVX2";
+	}
+	return "unknown";
+}
+
+void make_world_matrices(Transform_Streams *transforms, u32 first_index, u32 last_index, Matrix4 *matrices)
+{
+	make_world_matrices(transforms, first_index, last_index, matrices, get_best_transform_batch_kernel());
+}
+
+// A kernel which the CPU or the build doesn't have falls back to the next slower one.
+void make_world_matrices(Transform_Streams *transforms, u32 first_index, u32 last_index, Matrix4 *matrices, Transform_Batch_Kernel kernel)
+{
+	assert(transforms);
+	assert(matrices);
+	assert(first_index <= last_index);
+	assert(last_index <= transforms->count);
+
+	if ((kernel == TRANSFORM_BATCH_KERNEL_AVX2) && (get_best_transform_batch_kernel() == TRANSFORM_BATCH_KERNEL_AVX2)) {
+		make_world_matrices_avx2(transforms, first_index, last_index, matrices);
+		return;
+	}
+#if TRANSFORM_BATCH_SSE
+	if (kernel != TRANSFORM_BATCH_KERNEL_SCALAR) {
+		make_world_matrices_sse(transforms, first_index, last_index, matrices);
+		return;
+	}
+#endif
+	make_world_matrices_scalar(transforms, first_index, last_index, matrices);
+}
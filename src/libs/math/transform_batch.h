@@ -0,0 +1,65 @@
+#ifndef MATH_TRANSFORM_BATCH_H
+#define MATH_TRANSFORM_BATCH_H
+
+#include "vector.h"
+#include "matrix.h"
+#include "quaternion.h"
+#include "float_streams.h"
+#include "../number_types.h"
+
+enum Transform_Stream {
+	TRANSFORM_STREAM_POSITION_X,
+	TRANSFORM_STREAM_POSITION_Y,
+	TRANSFORM_STREAM_POSITION_Z,
+	TRANSFORM_STREAM_ORIENTATION_X,
+	TRANSFORM_STREAM_ORIENTATION_Y,
+	TRANSFORM_STREAM_ORIENTATION_Z,
+	TRANSFORM_STREAM_ORIENTATION_W,
+	TRANSFORM_STREAM_SCALING_X,
+	TRANSFORM_STREAM_SCALING_Y,
+	TRANSFORM_STREAM_SCALING_Z,
+	TRANSFORM_STREAM_COUNT
+};
+
+// Positions, orientations (unit quaternions, the same as Entity::orientation) and scalings of many transforms.
+struct Transform_Streams : Float_Streams<TRANSFORM_STREAM_COUNT> {
+	void set(u32 index, const Vector3 &position, const Quaternion &orientation, const Vector3 &scaling);
+};
+
+inline void Transform_Streams::set(u32 index, const Vector3 &position, const Quaternion &orientation, const Vector3 &scaling)
+{
+	assert(index < count);
+
+	streams[TRANSFORM_STREAM_POSITION_X][index] = position.x;
+	streams[TRANSFORM_STREAM_POSITION_Y][index] = position.y;
+	streams[TRANSFORM_STREAM_POSITION_Z][index] = position.z;
+	streams[TRANSFORM_STREAM_ORIENTATION_X][index] = orientation.x;
+	streams[TRANSFORM_STREAM_ORIENTATION_Y][index] = orientation.y;
+	streams[TRANSFORM_STREAM_ORIENTATION_Z][index] = orientation.z;
+	streams[TRANSFORM_STREAM_ORIENTATION_W][index] = orientation.w;
+	streams[TRANSFORM_STREAM_SCALING_X][index] = scaling.x;
+	streams[TRANSFORM_STREAM_SCALING_Y][index] = scaling.y;
+	streams[TRANSFORM_STREAM_SCALING_Z][index] = scaling.z;
+}
+
+enum Transform_Batch_Kernel {
+	TRANSFORM_BATCH_KERNEL_SCALAR,
+	TRANSFORM_BATCH_KERNEL_SSE,
+	TRANSFORM_BATCH_KERNEL_AVX2
+};
+
+// Writes make_world_matrix(scaling, orientation, position) of the transforms in [first_index, last_index)
+// to matrices[first_index, last_index). All kernels give the same matrices as make_world_matrix. The fastest kernel
+// the CPU supports is used, ranges of one stream can be made on several threads at once.
+void make_world_matrices(Transform_Streams *transforms, u32 first_index, u32 last_index, Matrix4 *matrices);
+void make_world_matrices(Transform_Streams *transforms, u32 first_index, u32 last_index, Matrix4 *matrices, Transform_Batch_Kernel kernel);
+
+Transform_Batch_Kernel get_best_transform_batch_kernel();
+const char *get_transform_batch_kernel_name(Transform_Batch_Kernel kernel);
+
+// The AVX2 kernel is in a file of its own, GCC and Clang compile it with -mavx2. Without the flag the file has no kernel
+// and is_avx2_transform_batch_kernel_compiled returns false. MSVC compiles AVX2 intrinsics without /arch:AVX2.
+bool is_avx2_transform_batch_kernel_compiled();
+void make_world_matrices_avx2(Transform_Streams *transforms, u32 first_index, u32 last_index, Matrix4 *matrices);
+
+#endif
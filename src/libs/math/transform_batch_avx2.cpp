@@ -0,0 +1,94 @@
+#include "transform_batch.h"
+
+#if defined(_MSC_VER) || defined(__AVX2__)
+#include <immintrin.h>
+
+bool is_avx2_transform_batch_kernel_compiled()
+{
+	return true;
+}
+
+// Transposes 4 registers of 8 lanes within their 128 bit halves, the low halves become rows of the transforms
+// 0-3 and the high halves rows of the transforms 4-7.
+static inline void transpose_halves(__m256 *first, __m256 *second, __m256 *third, __m256 *fourth)
+{
+	__m256 low_01 = _mm256_unpacklo_ps(*first, *second);
+	__m256 high_01 = _mm256_unpackhi_ps(*first, *second);
+	__m256 low_23 = _mm256_unpacklo_ps(*third, *fourth);
+	__m256 high_23 = _mm256_unpackhi_ps(*third, *fourth);
+	*first = _mm256_shuffle_ps(low_01, low_23, _MM_SHUFFLE(1, 0, 1, 0));
+	*second = _mm256_shuffle_ps(low_01, low_23, _MM_SHUFFLE(3, 2, 3, 2));
+	*third = _mm256_shuffle_ps(high_01, high_23, _MM_SHUFFLE(1, 0, 1, 0));
+	*fourth = _mm256_shuffle_ps(high_01, high_23, _MM_SHUFFLE(3, 2, 3, 2));
+}
+
+void make_world_matrices_avx2(Transform_Streams *transforms, u32 first_index, u32 last_index, Matrix4 *matrices)
+{
+	float **streams = transforms->streams;
+	__m256 zero = _mm256_setzero_ps();
+	__m256 one = _mm256_set1_ps(1.0f);
+
+	u32 i = first_index;
+	for (; (i + 8) <= last_index; i += 8) {
+		__m256 x = _mm256_loadu_ps(&streams[TRANSFORM_STREAM_ORIENTATION_X][i]);
+		__m256 y = _mm256_loadu_ps(&streams[TRANSFORM_STREAM_ORIENTATION_Y][i]);
+		__m256 z = _mm256_loadu_ps(&streams[TRANSFORM_STREAM_ORIENTATION_Z][i]);
+		__m256 w = _mm256_loadu_ps(&streams[TRANSFORM_STREAM_ORIENTATION_W][i]);
+		__m256 x2 = _mm256_add_ps(x, x);
+		__m256 y2 = _mm256_add_ps(y, y);
+		__m256 z2 = _mm256_add_ps(z, z);
+		__m256 xx = _mm256_mul_ps(x, x2);
+		__m256 yy = _mm256_mul_ps(y, y2);
+		__m256 zz = _mm256_mul_ps(z, z2);
+		__m256 xy = _mm256_mul_ps(x, y2);
+		__m256 xz = _mm256_mul_ps(x, z2);
+		__m256 yz = _mm256_mul_ps(y, z2);
+		__m256 wx = _mm256_mul_ps(w, x2);
+		__m256 wy = _mm256_mul_ps(w, y2);
+		__m256 wz = _mm256_mul_ps(w, z2);
+		__m256 scaling_x = _mm256_loadu_ps(&streams[TRANSFORM_STREAM_SCALING_X][i]);
+		__m256 scaling_y = _mm256_loadu_ps(&streams[TRANSFORM_STREAM_SCALING_Y][i]);
+		__m256 scaling_z = _mm256_loadu_ps(&streams[TRANSFORM_STREAM_SCALING_Z][i]);
+
+		__m256 rows[4][4];
+		rows[0][0] = _mm256_mul_ps(_mm256_sub_ps(one, _mm256_add_ps(yy, zz)), scaling_x);
+		rows[0][1] = _mm256_mul_ps(_mm256_add_ps(xy, wz), scaling_x);
+		rows[0][2] = _mm256_mul_ps(_mm256_sub_ps(xz, wy), scaling_x);
+		rows[0][3] = zero;
+		rows[1][0] = _mm256_mul_ps(_mm256_sub_ps(xy, wz), scaling_y);
+		rows[1][1] = _mm256_mul_ps(_mm256_sub_ps(one, _mm256_add_ps(xx, zz)), scaling_y);
+		rows[1][2] = _mm256_mul_ps(_mm256_add_ps(yz, wx), scaling_y);
+		rows[1][3] = zero;
+		rows[2][0] = _mm256_mul_ps(_mm256_add_ps(xz, wy), scaling_z);
+		rows[2][1] = _mm256_mul_ps(_mm256_sub_ps(yz, wx), scaling_z);
+		rows[2][2] = _mm256_mul_ps(_mm256_sub_ps(one, _mm256_add_ps(xx, yy)), scaling_z);
+		rows[2][3] = zero;
+		rows[3][0] = _mm256_loadu_ps(&streams[TRANSFORM_STREAM_POSITION_X][i]);
+		rows[3][1] = _mm256_loadu_ps(&streams[TRANSFORM_STREAM_POSITION_Y][i]);
+		rows[3][2] = _mm256_loadu_ps(&streams[TRANSFORM_STREAM_POSITION_Z][i]);
+		rows[3][3] = one;
+
+		float *matrix = (float *)&matrices[i];
+		for (u32 row = 0; row < 4; row++) {
+			transpose_halves(&rows[row][0], &rows[row][1], &rows[row][2], &rows[row][3]);
+			for (u32 j = 0; j < 4; j++) {
+				_mm_storeu_ps(matrix + j * 16 + row * 4, _mm256_castps256_ps128(rows[row][j]));
+				_mm_storeu_ps(matrix + (j + 4) * 16 + row * 4, _mm256_extractf128_ps(rows[row][j], 1));
+			}
+		}
+	}
+	// Upper halves of AVX registers are cleared before SSE code runs, otherwise the SSE instructions are slow on older CPUs.
+	_mm256_zeroupper();
+	make_world_matrices(transforms, i, last_index, matrices, TRANSFORM_BATCH_KERNEL_SSE);
+}
+#else
+bool is_avx2_transform_batch_kernel_compiled()
+{
+	return false;
+}
+
+void make_world_matrices_avx2(Transform_Streams *transforms, u32 first_index, u32 last_index, Matrix4 *matrices)
+{
+	make_world_matrices(transforms, first_index, last_index, matrices, TRANSFORM_BATCH_KERNEL_SSE);
+}
+#endif
@@ -2,23 +2,25 @@
 #define VECTOR_H
 
 #include <assert.h>
-#include <DirectXMath.h>
+#include <math.h>
 
-using namespace DirectX;
+#include "simd.h"
 
-struct Vector2 : XMFLOAT2 {
+struct Vector2 {
 	Vector2() {}
-	Vector2(XMVECTOR vector);
-	Vector2(const Vector2 &other);
-	Vector2(float x, float y) : XMFLOAT2(x, y) {}
+	Vector2(Simd_Vector vector);
+	Vector2(const Vector2 &other) = default;
+	Vector2(float x, float y) : x(x), y(y) {}
+
+	float x, y;
 
 	static Vector2 one;
 	static Vector2 zero;
 	static Vector2 base_x;
 	static Vector2 base_y;
 
-	Vector2 &operator=(XMVECTOR vector);
-	Vector2 &operator=(const Vector2 &other);
+	Vector2 &operator=(Simd_Vector vector);
+	Vector2 &operator=(const Vector2 &other) = default;
 
 	Vector2 &operator+=(float value);
 	Vector2 &operator-=(float value);
@@ -31,9 +33,10 @@ struct Vector2 : XMFLOAT2 {
 	Vector2 &operator/=(const Vector2 &other);
 
 	operator float *();
-	operator XMVECTOR();
 };
 
+inline Simd_Vector simd_load(const Vector2 &vector);
+
 inline float dot(const Vector2 &first_vector, const Vector2 &second_vector);
 inline float length(const Vector2 &vector);
 inline float get_angle(Vector2 *first_vector2, Vector2 *second_vector2);
@@ -43,18 +46,26 @@ inline Vector2 normalize(Vector2 *vector);
 inline Vector2 normalize(const Vector2 &vector);
 inline Vector2 cross(const Vector2 &first_vector, const Vector2 &second_vector);
 inline Vector2 floor(const Vector2 &vector);
+inline Vector2 round(const Vector2 &vector);
 
 inline Vector2 operator+(const Vector2 &first_vector, const Vector2 &second_vector);
 inline Vector2 operator-(const Vector2 &first_vector, const Vector2 &second_vector);
 inline Vector2 operator*(const Vector2 &first_vector, const Vector2 &second_vector);
 inline Vector2 operator/(const Vector2 &first_vector, const Vector2 &second_vector);
 
-struct Vector3 : XMFLOAT3 {
+inline Vector2 operator-(const Vector2 &vector);
+inline Vector2 operator*(const Vector2 &vector, float value);
+inline Vector2 operator*(float value, const Vector2 &vector);
+inline Vector2 operator/(const Vector2 &vector, float value);
+
+struct Vector3 {
 	Vector3() {}
-	Vector3(XMVECTOR vector);
-	Vector3(const Vector2 &vec2, float z) : XMFLOAT3(vec2.x, vec2.y, z) {}
-	Vector3(const Vector3 &other);
-	Vector3(float x, float y, float z) : XMFLOAT3(x, y, z) {}
+	Vector3(Simd_Vector vector);
+	Vector3(const Vector2 &vec2, float z) : x(vec2.x), y(vec2.y), z(z) {}
+	Vector3(const Vector3 &other) = default;
+	Vector3(float x, float y, float z) : x(x), y(y), z(z) {}
+
+	float x, y, z;
 
 	static Vector3 one;
 	static Vector3 zero;
@@ -62,8 +73,8 @@ struct Vector3 : XMFLOAT3 {
 	static Vector3 base_y;
 	static Vector3 base_z;
 
-	Vector3 &operator=(XMVECTOR vector);
-	Vector3 &operator=(const Vector3 &other);
+	Vector3 &operator=(Simd_Vector vector);
+	Vector3 &operator=(const Vector3 &other) = default;
 
 	Vector3 &operator+=(float value);
 	Vector3 &operator-=(float value);
@@ -76,9 +87,10 @@ struct Vector3 : XMFLOAT3 {
 	Vector3 &operator/=(const Vector3 &other);
 
 	operator float *();
-	operator XMVECTOR();
 };
 
+inline Simd_Vector simd_load(const Vector3 &vector);
+
 inline float dot(const Vector3 &first_vector, const Vector3 &second_vector);
 inline float length(const Vector3 &vector);
 inline float get_angle(Vector3 *first_vector3, Vector3 *second_vector3);
@@ -88,22 +100,30 @@ inline Vector3 normalize(Vector3 *vector);
 inline Vector3 normalize(const Vector3 &vector);
 inline Vector3 cross(const Vector3 &first_vector, const Vector3 &second_vector);
 inline Vector3 floor(const Vector3 &vector);
+inline Vector3 round(const Vector3 &vector);
 
 inline Vector3 operator+(const Vector3 &first_vector, const Vector3 &second_vector);
 inline Vector3 operator-(const Vector3 &first_vector, const Vector3 &second_vector);
 inline Vector3 operator*(const Vector3 &first_vector, const Vector3 &second_vector);
 inline Vector3 operator/(const Vector3 &first_vector, const Vector3 &second_vector);
 
-struct Vector4 : XMFLOAT4 {
+inline Vector3 operator-(const Vector3 &vector);
+inline Vector3 operator*(const Vector3 &vector, float value);
+inline Vector3 operator*(float value, const Vector3 &vector);
+inline Vector3 operator/(const Vector3 &vector, float value);
+
+struct Vector4 {
 	Vector4() {}
-	Vector4(XMVECTOR vector);
-	Vector4(const Vector4 &other);
-	Vector4(float x, float y, float z, float w) : XMFLOAT4(x, y, z, w) {}
-	Vector4(const Vector3 &vector, float w) : XMFLOAT4(vector.x, vector.y, vector.z, w) {}
+	Vector4(Simd_Vector vector);
+	Vector4(const Vector4 &other) = default;
+	Vector4(float x, float y, float z, float w) : x(x), y(y), z(z), w(w) {}
+	Vector4(const Vector3 &vector, float w) : x(vector.x), y(vector.y), z(vector.z), w(w) {}
+
+	float x, y, z, w;
 
-	Vector4 &operator=(XMVECTOR vector);
+	Vector4 &operator=(Simd_Vector vector);
 	Vector4 &operator=(const Vector3 &vector);
-	Vector4 &operator=(const Vector4 &other);
+	Vector4 &operator=(const Vector4 &other) = default;
 
 	Vector4 &operator+=(float value);
 	Vector4 &operator-=(float value);
@@ -116,9 +136,10 @@ struct Vector4 : XMFLOAT4 {
 	Vector4 &operator/=(const Vector4 &other);
 
 	operator float *();
-	operator XMVECTOR();
 };
 
+inline Simd_Vector simd_load(const Vector4 &vector);
+
 inline float dot(const Vector4 &first_vector, const Vector4 &second_vector);
 inline float length(const Vector4 &vector);
 inline float get_angle(Vector4 *first_vector4, Vector4 *second_vector4);
@@ -129,107 +150,78 @@ inline Vector4 negate(Vector4 *vector);
 inline Vector4 normalize(Vector4 *vector);
 inline Vector4 cross(const Vector4 &first_vector, const Vector4 &second_vector, const Vector4 &third_vector);
 inline Vector4 floor(const Vector4 &vector);
+inline Vector4 round(const Vector4 &vector);
 
 inline Vector4 operator+(const Vector4 &first_vector, const Vector4 &second_vector);
 inline Vector4 operator-(const Vector4 &first_vector, const Vector4 &second_vector);
 inline Vector4 operator*(const Vector4 &first_vector, const Vector4 &second_vector);
 inline Vector4 operator/(const Vector4 &first_vector, const Vector4 &second_vector);
 
+inline Vector4 operator-(const Vector4 &vector);
+inline Vector4 operator*(const Vector4 &vector, float value);
+inline Vector4 operator*(float value, const Vector4 &vector);
+inline Vector4 operator/(const Vector4 &vector, float value);
+
 ///////////////////////////////
 //          Vector2          //
 ///////////////////////////////
 
-inline Vector2::Vector2(XMVECTOR vector)
-{
-	XMStoreFloat2(this, vector);
-}
-
-inline Vector2::Vector2(const Vector2 &other)
-{
-	x = other.x;
-	y = other.y;
-}
-
-inline Vector2 &Vector2::operator=(XMVECTOR vector)
+inline Vector2::Vector2(Simd_Vector vector)
 {
-	XMStoreFloat2(this, vector);
-	return *this;
+	simd_store2(&x, vector);
 }
 
-inline Vector2 &Vector2::operator=(const Vector2 &other)
+inline Vector2 &Vector2::operator=(Simd_Vector vector)
 {
-	if (this != &other) {
-		x = other.x;
-		y = other.y;
-	}
+	simd_store2(&x, vector);
 	return *this;
 }
 
 inline Vector2 &Vector2::operator+=(float value)
 {
-	Vector2 temp = Vector2(value, value);
-	XMVECTOR first = XMLoadFloat2(this);
-	XMVECTOR second = XMLoadFloat2(&temp);
-	*this = XMVectorAdd(first, second);
+	*this = simd_add(simd_load2(&x), simd_splat(value));
 	return *this;
 }
 
 inline Vector2 &Vector2::operator-=(float value)
 {
-	Vector2 temp = Vector2(value, value);
-	XMVECTOR first = XMLoadFloat2(this);
-	XMVECTOR second = XMLoadFloat2(&temp);
-	*this = XMVectorSubtract(first, second);
+	*this = simd_sub(simd_load2(&x), simd_splat(value));
 	return *this;
 }
 
 inline Vector2 &Vector2::operator*=(float value)
 {
-	Vector2 temp = Vector2(value, value);
-	XMVECTOR first = XMLoadFloat2(this);
-	XMVECTOR second = XMLoadFloat2(&temp);
-	*this = XMVectorMultiply(first, second);
+	*this = simd_mul(simd_load2(&x), simd_splat(value));
 	return *this;
 }
 
 inline Vector2 &Vector2::operator/=(float value)
 {
-	Vector2 temp = Vector2(value, value);
-	XMVECTOR first = XMLoadFloat2(this);
-	XMVECTOR second = XMLoadFloat2(&temp);
-	*this = XMVectorDivide(first, second);
+	*this = simd_div(simd_load2(&x), simd_splat(value));
 	return *this;
 }
 
 inline Vector2 &Vector2::operator+=(const Vector2 &other)
 {
-	XMVECTOR first = XMLoadFloat2(this);
-	XMVECTOR second = XMLoadFloat2(&other);
-	*this = XMVectorAdd(first, second);
+	*this = simd_add(simd_load2(&x), simd_load2(&other.x));
 	return *this;
 }
 
 inline Vector2 &Vector2::operator-=(const Vector2 &other)
 {
-	XMVECTOR first = XMLoadFloat2(this);
-	XMVECTOR second = XMLoadFloat2(&other);
-	*this = XMVectorSubtract(first, second);
+	*this = simd_sub(simd_load2(&x), simd_load2(&other.x));
 	return *this;
 }
 
 inline Vector2 &Vector2::operator*=(const Vector2 &other)
 {
-	XMVECTOR first = XMLoadFloat2(this);
-	XMVECTOR second = XMLoadFloat2(&other);
-	*this = XMVectorMultiply(first, second);
+	*this = simd_mul(simd_load2(&x), simd_load2(&other.x));
 	return *this;
 }
 
 inline Vector2 &Vector2::operator/=(const Vector2 &other)
 {
-	XMVECTOR first = XMLoadFloat2(this);
-	XMVECTOR second = XMLoadFloat2(&other);
-	*this = XMVectorDivide(first, second);
+	*this = simd_div(simd_load2(&x), simd_load2(&other.x));
 	return *this;
 }
 
@@ -238,193 +230,171 @@ inline Vector2::operator float *()
 	return &x;
 }
 
-inline Vector2::operator XMVECTOR()
+inline Simd_Vector simd_load(const Vector2 &vector)
 {
-	return XMVectorSet(x, y, 0.0f, 0.0f);
+	return simd_load2(&vector.x);
 }
 
 inline float length(const Vector2 &vector)
 {
-	XMVECTOR temp = XMLoadFloat2(&vector);
-	return XMVectorGetX(XMVector2Length(temp));
+	return sqrtf(dot(vector, vector));
 }
 
 inline float get_angle(Vector2 *first_vector2, Vector2 *second_vector2)
 {
-	XMVECTOR first = XMLoadFloat2(first_vector2);
-	XMVECTOR second = XMLoadFloat2(second_vector2);
-	return XMVectorGetX(XMVector2AngleBetweenVectors(first, second));
+	float reciprocal_lengths = (1.0f / length(*first_vector2)) * (1.0f / length(*second_vector2));
+	float cosine = dot(*first_vector2, *second_vector2) * reciprocal_lengths;
+	return acosf(cosine < -1.0f ? -1.0f : (cosine > 1.0f ? 1.0f : cosine));
 }
+
 inline float find_distance(const Vector2 &first_vector2, const Vector2 &second_vector2)
 {
-	XMVECTOR first = XMLoadFloat2(&first_vector2);
-	XMVECTOR second = XMLoadFloat2(&second_vector2);
-	XMVECTOR temp = XMVectorSubtract(first, second);
-	return XMVectorGetX(XMVector2Length(temp));
+	return length(first_vector2 - second_vector2);
 }
 
 inline Vector2 negate(Vector2 *vector2)
 {
-	XMVECTOR vector = XMLoadFloat2(vector2);
-	return XMVectorNegate(vector);
+	return simd_negate(simd_load2(&vector2->x));
 }
 
 inline Vector2 normalize(Vector2 *vector2)
 {
-	XMVECTOR vector = XMLoadFloat2(vector2);
-	return XMVector2Normalize(vector);
+	return normalize(*vector2);
 }
 
+// A zero vector stays zero.
 inline Vector2 normalize(const Vector2 &vector2)
 {
-	XMVECTOR vector = XMLoadFloat2(&vector2);
-	return XMVector2Normalize(vector);
+	float vector_length = length(vector2);
+	if (vector_length > 0.0f) {
+		return simd_div(simd_load2(&vector2.x), simd_splat(vector_length));
+	}
+	return simd_splat(0.0f);
 }
 
 inline float dot(const Vector2 &first_vector, const Vector2 &second_vector)
 {
-	XMVECTOR first = XMLoadFloat2(&first_vector);
-	XMVECTOR second = XMLoadFloat2(&second_vector);
-	return XMVectorGetX(XMVector2Dot(first, second));
+	return simd_dot2(simd_load2(&first_vector.x), simd_load2(&second_vector.x));
 }
+
+// The z component of the cross product of vectors in the xy plane, it is in both components of the result.
 inline Vector2 cross(const Vector2 &first_vector, const Vector2 &second_vector)
 {
-	XMVECTOR first = XMLoadFloat2(&first_vector);
-	XMVECTOR second = XMLoadFloat2(&second_vector);
-	return XMVector2Cross(first, second);
+	float z = first_vector.x * second_vector.y - first_vector.y * second_vector.x;
+	return Vector2(z, z);
 }
 
 inline Vector2 floor(const Vector2 &vector)
 {
-	XMVECTOR temp = XMLoadFloat2(&vector);
-	return XMVectorFloor(temp);
+	return simd_floor(simd_load2(&vector.x));
+}
+
+// Halves are rounded to even.
+inline Vector2 round(const Vector2 &vector)
+{
+	return simd_round(simd_load2(&vector.x));
 }
 
 inline Vector2 operator+(const Vector2 &first_vector, const Vector2 &second_vector)
 {
-	XMVECTOR first = XMLoadFloat2(&first_vector);
-	XMVECTOR second = XMLoadFloat2(&second_vector);
-	return XMVectorAdd(first, second);
+	return simd_add(simd_load2(&first_vector.x), simd_load2(&second_vector.x));
 }
 
 inline Vector2 operator-(const Vector2 &first_vector, const Vector2 &second_vector)
 {
-	XMVECTOR first = XMLoadFloat2(&first_vector);
-	XMVECTOR second = XMLoadFloat2(&second_vector);
-	return XMVectorSubtract(first, second);
+	return simd_sub(simd_load2(&first_vector.x), simd_load2(&second_vector.x));
 }
 
 inline Vector2 operator*(const Vector2 &first_vector, const Vector2 &second_vector)
 {
-	XMVECTOR first = XMLoadFloat2(&first_vector);
-	XMVECTOR second = XMLoadFloat2(&second_vector);
-	return XMVectorMultiply(first, second);
+	return simd_mul(simd_load2(&first_vector.x), simd_load2(&second_vector.x));
 }
 
 inline Vector2 operator/(const Vector2 &first_vector, const Vector2 &second_vector)
 {
-	XMVECTOR first = XMLoadFloat2(&first_vector);
-	XMVECTOR second = XMLoadFloat2(&second_vector);
-	return XMVectorDivide(first, second);
+	return simd_div(simd_load2(&first_vector.x), simd_load2(&second_vector.x));
 }
 
-///////////////////////////////
-//          Vector3          //
-///////////////////////////////
+inline Vector2 operator-(const Vector2 &vector)
+{
+	return simd_negate(simd_load2(&vector.x));
+}
 
-inline Vector3::Vector3(XMVECTOR vector)
+inline Vector2 operator*(const Vector2 &vector, float value)
 {
-	XMStoreFloat3(this, vector);
+	return simd_scale(simd_load2(&vector.x), value);
 }
 
-inline Vector3::Vector3(const Vector3 &other)
+inline Vector2 operator*(float value, const Vector2 &vector)
 {
-	x = other.x;
-	y = other.y;
-	z = other.z;
+	return simd_scale(simd_load2(&vector.x), value);
 }
 
-inline Vector3 &Vector3::operator=(XMVECTOR vector)
+inline Vector2 operator/(const Vector2 &vector, float value)
 {
-	XMStoreFloat3(this, vector);
-	return *this;
+	return simd_div(simd_load2(&vector.x), simd_splat(value));
+}
+
+///////////////////////////////
+//          Vector3          //
+///////////////////////////////
+
+inline Vector3::Vector3(Simd_Vector vector)
+{
+	simd_store3(&x, vector);
 }
 
-inline Vector3 &Vector3::operator=(const Vector3 &other)
+inline Vector3 &Vector3::operator=(Simd_Vector vector)
 {
-	if (this != &other) {
-		x = other.x;
-		y = other.y;
-		z = other.z;
-	}
+	simd_store3(&x, vector);
 	return *this;
 }
 
 inline Vector3 &Vector3::operator+=(float value)
 {
-	Vector3 temp = Vector3(value, value, value);
-	XMVECTOR first = XMLoadFloat3(this);
-	XMVECTOR second = XMLoadFloat3(&temp);
-	*this = XMVectorAdd(first, second);
+	*this = simd_add(simd_load3(&x), simd_splat(value));
 	return *this;
 }
 
 inline Vector3 &Vector3::operator-=(float value)
 {
-	Vector3 temp = Vector3(value, value, value);
-	XMVECTOR first = XMLoadFloat3(this);
-	XMVECTOR second = XMLoadFloat3(&temp);
-	*this = XMVectorSubtract(first, second);
+	*this = simd_sub(simd_load3(&x), simd_splat(value));
 	return *this;
 }
 
 inline Vector3 &Vector3::operator*=(float value)
 {
-	Vector3 temp = Vector3(value, value, value);
-	XMVECTOR first = XMLoadFloat3(this);
-	XMVECTOR second = XMLoadFloat3(&temp);
-	*this = XMVectorMultiply(first, second);
+	*this = simd_mul(simd_load3(&x), simd_splat(value));
 	return *this;
 }
 
 inline Vector3 &Vector3::operator/=(float value)
 {
-	Vector3 temp = Vector3(value, value, value);
-	XMVECTOR first = XMLoadFloat3(this);
-	XMVECTOR second = XMLoadFloat3(&temp);
-	*this = XMVectorDivide(first, second);
+	*this = simd_div(simd_load3(&x), simd_splat(value));
 	return *this;
 }
 
 inline Vector3 &Vector3::operator+=(const Vector3 &other)
 {
-	XMVECTOR first = XMLoadFloat3(this);
-	XMVECTOR second = XMLoadFloat3(&other);
-	*this = XMVectorAdd(first, second);
+	*this = simd_add(simd_load3(&x), simd_load3(&other.x));
 	return *this;
 }
 
 inline Vector3 &Vector3::operator-=(const Vector3 &other)
 {
-	XMVECTOR first = XMLoadFloat3(this);
-	XMVECTOR second = XMLoadFloat3(&other);
-	*this = XMVectorSubtract(first, second);
+	*this = simd_sub(simd_load3(&x), simd_load3(&other.x));
 	return *this;
 }
 
 inline Vector3 &Vector3::operator*=(const Vector3 &other)
 {
-	XMVECTOR first = XMLoadFloat3(this);
-	XMVECTOR second = XMLoadFloat3(&other);
-	*this = XMVectorMultiply(first, second);
+	*this = simd_mul(simd_load3(&x), simd_load3(&other.x));
 	return *this;
 }
 
 inline Vector3 &Vector3::operator/=(const Vector3 &other)
 {
-	XMVECTOR first = XMLoadFloat3(this);
-	XMVECTOR second = XMLoadFloat3(&other);
-	*this = XMVectorDivide(first, second);
+	*this = simd_div(simd_load3(&x), simd_load3(&other.x));
 	return *this;
 }
 
@@ -433,117 +403,121 @@ inline Vector3::operator float *()
 	return &x;
 }
 
-inline Vector3::operator XMVECTOR()
+inline Simd_Vector simd_load(const Vector3 &vector)
 {
-	return XMVectorSet(x, y, z, 0.0f);
+	return simd_load3(&vector.x);
 }
 
 inline float length(const Vector3 &vector)
 {
-	XMVECTOR temp = XMLoadFloat3(&vector);
-	return XMVectorGetX(XMVector3Length(temp));
+	return sqrtf(dot(vector, vector));
 }
 
 inline float get_angle(Vector3 *first_vector3, Vector3 *second_vector3)
 {
-	XMVECTOR first = XMLoadFloat3(first_vector3);
-	XMVECTOR second = XMLoadFloat3(second_vector3);
-	return XMVectorGetX(XMVector3AngleBetweenVectors(first, second));
+	float reciprocal_lengths = (1.0f / length(*first_vector3)) * (1.0f / length(*second_vector3));
+	float cosine = dot(*first_vector3, *second_vector3) * reciprocal_lengths;
+	return acosf(cosine < -1.0f ? -1.0f : (cosine > 1.0f ? 1.0f : cosine));
 }
+
 inline float find_distance(const Vector3 &first_vector3, const Vector3 &second_vector3)
 {
-	XMVECTOR first = XMLoadFloat3(&first_vector3);
-	XMVECTOR second = XMLoadFloat3(&second_vector3);
-	XMVECTOR temp = XMVectorSubtract(first, second);
-	return XMVectorGetX(XMVector3Length(temp));
+	return length(first_vector3 - second_vector3);
 }
 
 inline Vector3 negate(Vector3 *vector3)
 {
-	XMVECTOR vector = XMLoadFloat3(vector3);
-	return XMVectorNegate(vector);
+	return simd_negate(simd_load3(&vector3->x));
 }
 
 inline Vector3 normalize(Vector3 *vector3)
 {
-	XMVECTOR vector = XMLoadFloat3(vector3);
-	return XMVector3Normalize(vector);
+	return normalize(*vector3);
 }
 
+// A zero vector stays zero.
 inline Vector3 normalize(const Vector3 &vector3)
 {
-	XMVECTOR vector = XMLoadFloat3(&vector3);
-	return XMVector3Normalize(vector);
+	float vector_length = length(vector3);
+	if (vector_length > 0.0f) {
+		return simd_div(simd_load3(&vector3.x), simd_splat(vector_length));
+	}
+	return simd_splat(0.0f);
 }
 
 inline float dot(const Vector3 &first_vector, const Vector3 &second_vector)
 {
-	XMVECTOR first = XMLoadFloat3(&first_vector);
-	XMVECTOR second = XMLoadFloat3(&second_vector);
-	return XMVectorGetX(XMVector3Dot(first, second));
+	return simd_dot3(simd_load3(&first_vector.x), simd_load3(&second_vector.x));
 }
 
 inline Vector3 cross(const Vector3 &first_vector, const Vector3 &second_vector)
 {
-	XMVECTOR first = XMLoadFloat3(&first_vector);
-	XMVECTOR second = XMLoadFloat3(&second_vector);
-	return XMVector3Cross(first, second);
+	return simd_cross3(simd_load3(&first_vector.x), simd_load3(&second_vector.x));
 }
 
 inline Vector3 floor(const Vector3 &vector)
 {
-	XMVECTOR temp = XMLoadFloat3(&vector);
-	return XMVectorFloor(temp);
+	return simd_floor(simd_load3(&vector.x));
+}
+
+// Halves are rounded to even.
+inline Vector3 round(const Vector3 &vector)
+{
+	return simd_round(simd_load3(&vector.x));
 }
 
 inline Vector3 operator+(const Vector3 &first_vector, const Vector3 &second_vector)
 {
-	XMVECTOR first = XMLoadFloat3(&first_vector);
-	XMVECTOR second = XMLoadFloat3(&second_vector);
-	return XMVectorAdd(first, second);
+	return simd_add(simd_load3(&first_vector.x), simd_load3(&second_vector.x));
 }
 
 inline Vector3 operator-(const Vector3 &first_vector, const Vector3 &second_vector)
 {
-	XMVECTOR first = XMLoadFloat3(&first_vector);
-	XMVECTOR second = XMLoadFloat3(&second_vector);
-	return XMVectorSubtract(first, second);
+	return simd_sub(simd_load3(&first_vector.x), simd_load3(&second_vector.x));
 }
 
 inline Vector3 operator*(const Vector3 &first_vector, const Vector3 &second_vector)
 {
-	XMVECTOR first = XMLoadFloat3(&first_vector);
-	XMVECTOR second = XMLoadFloat3(&second_vector);
-	return XMVectorMultiply(first, second);
+	return simd_mul(simd_load3(&first_vector.x), simd_load3(&second_vector.x));
 }
 
 inline Vector3 operator/(const Vector3 &first_vector, const Vector3 &second_vector)
 {
-	XMVECTOR first = XMLoadFloat3(&first_vector);
-	XMVECTOR second = XMLoadFloat3(&second_vector);
-	return XMVectorDivide(first, second);
+	return simd_div(simd_load3(&first_vector.x), simd_load3(&second_vector.x));
 }
 
-///////////////////////////////
-//          Vector4          //
-///////////////////////////////
+inline Vector3 operator-(const Vector3 &vector)
+{
+	return simd_negate(simd_load3(&vector.x));
+}
+
+inline Vector3 operator*(const Vector3 &vector, float value)
+{
+	return simd_scale(simd_load3(&vector.x), value);
+}
 
-inline Vector4::Vector4(XMVECTOR vector)
+inline Vector3 operator*(float value, const Vector3 &vector)
 {
-	XMStoreFloat4(this, vector);
+	return simd_scale(simd_load3(&vector.x), value);
 }
 
-inline Vector4::Vector4(const Vector4 &other)
+inline Vector3 operator/(const Vector3 &vector, float value)
 {
-	x = other.x;
-	y = other.y;
-	z = other.z;
-	w = other.w;
+	return simd_div(simd_load3(&vector.x), simd_splat(value));
 }
 
-inline Vector4 &Vector4::operator=(XMVECTOR vector)
+///////////////////////////////
+//          Vector4          //
+///////////////////////////////
+
+inline Vector4::Vector4(Simd_Vector vector)
+{
+	simd_store4(&x, vector);
+}
+
+inline Vector4 &Vector4::operator=(Simd_Vector vector)
 {
-	XMStoreFloat4(this, vector);
+	simd_store4(&x, vector);
 	return *this;
 }
 
@@ -556,82 +530,51 @@ inline Vector4 &Vector4::operator=(const Vector3 &vector)
 	return *this;
 }
 
-inline Vector4 &Vector4::operator=(const Vector4 &other)
-{
-	if (this != &other) {
-		x = other.x;
-		y = other.y;
-		z = other.z;
-		w = other.w;
-	}
-	return *this;
-}
-
 inline Vector4 &Vector4::operator+=(float value)
 {
-	Vector4 temp = Vector4(value, value, value, value);
-	XMVECTOR first = XMLoadFloat4(this);
-	XMVECTOR second = XMLoadFloat4(&temp);
-	*this = XMVectorAdd(first, second);
+	*this = simd_add(simd_load4(&x), simd_splat(value));
 	return *this;
 }
 
 inline Vector4 &Vector4::operator-=(float value)
 {
-	Vector4 temp = Vector4(value, value, value, value);
-	XMVECTOR first = XMLoadFloat4(this);
-	XMVECTOR second = XMLoadFloat4(&temp);
-	*this = XMVectorSubtract(first, second);
+	*this = simd_sub(simd_load4(&x), simd_splat(value));
 	return *this;
 }
 
 inline Vector4 &Vector4::operator*=(float value)
 {
-	Vector4 temp = Vector4(value, value, value, value);
-	XMVECTOR first = XMLoadFloat4(this);
-	XMVECTOR second = XMLoadFloat4(&temp);
-	*this = XMVectorMultiply(first, second);
+	*this = simd_mul(simd_load4(&x), simd_splat(value));
 	return *this;
 }
 
 inline Vector4 &Vector4::operator/=(float value)
 {
-	Vector4 temp = Vector4(value, value, value, value);
-	XMVECTOR first = XMLoadFloat4(this);
-	XMVECTOR second = XMLoadFloat4(&temp);
-	*this = XMVectorDivide(first, second);
+	*this = simd_div(simd_load4(&x), simd_splat(value));
 	return *this;
 }
 
 inline Vector4 &Vector4::operator+=(const Vector4 &other)
 {
-	XMVECTOR first = XMLoadFloat4(this);
-	XMVECTOR second = XMLoadFloat4(&other);
-	*this = XMVectorAdd(first, second);
+	*this = simd_add(simd_load4(&x), simd_load4(&other.x));
 	return *this;
 }
 
 inline Vector4 &Vector4::operator-=(const Vector4 &other)
 {
-	XMVECTOR first = XMLoadFloat4(this);
-	XMVECTOR second = XMLoadFloat4(&other);
-	*this = XMVectorSubtract(first, second);
+	*this = simd_sub(simd_load4(&x), simd_load4(&other.x));
 	return *this;
 }
 
 inline Vector4 &Vector4::operator*=(const Vector4 &other)
 {
-	XMVECTOR first = XMLoadFloat4(this);
-	XMVECTOR second = XMLoadFloat4(&other);
-	*this = XMVectorMultiply(first, second);
+	*this = simd_mul(simd_load4(&x), simd_load4(&other.x));
 	return *this;
 }
 
 inline Vector4 &Vector4::operator/=(const Vector4 &other)
 {
-	XMVECTOR first = XMLoadFloat4(this);
-	XMVECTOR second = XMLoadFloat4(&other);
-	*this = XMVectorDivide(first, second);
+	*this = simd_div(simd_load4(&x), simd_load4(&other.x));
 	return *this;
 }
 
@@ -640,29 +583,26 @@ inline Vector4::operator float *()
 	return &x;
 }
 
-inline Vector4::operator XMVECTOR()
+inline Simd_Vector simd_load(const Vector4 &vector)
 {
-	return XMVectorSet(x, y, z, w);
+	return simd_load4(&vector.x);
 }
 
 inline float length(const Vector4 &vector)
 {
-	XMVECTOR temp = XMLoadFloat4(&vector);
-	return XMVectorGetX(XMVector4Length(temp));
+	return sqrtf(dot(vector, vector));
 }
 
 inline float get_angle(Vector4 *first_vector4, Vector4 *second_vector4)
 {
-	XMVECTOR first = XMLoadFloat4(first_vector4);
-	XMVECTOR second = XMLoadFloat4(second_vector4);
-	return XMVectorGetX(XMVector4AngleBetweenVectors(first, second));
+	float reciprocal_lengths = (1.0f / length(*first_vector4)) * (1.0f / length(*second_vector4));
+	float cosine = dot(*first_vector4, *second_vector4) * reciprocal_lengths;
+	return acosf(cosine < -1.0f ? -1.0f : (cosine > 1.0f ? 1.0f : cosine));
 }
+
 inline float find_distance(const Vector4 &first_vector4, const Vector4 &second_vector4)
 {
-	XMVECTOR first = XMLoadFloat4(&first_vector4);
-	XMVECTOR second = XMLoadFloat4(&second_vector4);
-	XMVECTOR temp = XMVectorSubtract(first, second);
-	return XMVectorGetX(XMVector4Length(temp));
+	return length(first_vector4 - second_vector4);
 }
 
 inline Vector3 to_vector3(const Vector4 &vector)
@@ -672,62 +612,85 @@ inline Vector3 to_vector3(const Vector4 &vector)
 
 inline Vector4 negate(Vector4 *vector4)
 {
-	XMVECTOR vector = XMLoadFloat4(vector4);
-	return XMVectorNegate(vector);
+	return simd_negate(simd_load4(&vector4->x));
 }
 
 inline Vector4 normalize(Vector4 *vector4)
 {
-	XMVECTOR vector = XMLoadFloat4(vector4);
-	return XMVector4Normalize(vector);
+	float vector_length = length(*vector4);
+	if (vector_length > 0.0f) {
+		return simd_div(simd_load4(&vector4->x), simd_splat(vector_length));
+	}
+	return simd_splat(0.0f);
 }
 
 inline float dot(const Vector4 &first_vector, const Vector4 &second_vector)
 {
-	XMVECTOR first = XMLoadFloat4(&first_vector);
-	XMVECTOR second = XMLoadFloat4(&second_vector);
-	return XMVectorGetX(XMVector4Dot(first, second));
+	return simd_dot4(simd_load4(&first_vector.x), simd_load4(&second_vector.x));
 }
 
+// The vector which is orthogonal to the three vectors in 4D.
 inline Vector4 cross(const Vector4 &first_vector, const Vector4 &second_vector, const Vector4 &third_vector)
 {
-	XMVECTOR first = XMLoadFloat4(&first_vector);
-	XMVECTOR second = XMLoadFloat4(&second_vector);
-	XMVECTOR third = XMLoadFloat4(&third_vector);
-	return XMVector4Cross(first, second, third);
+	const Vector4 &a = first_vector;
+	const Vector4 &b = second_vector;
+	const Vector4 &c = third_vector;
+	float x = (((b.z * c.w) - (b.w * c.z)) * a.y) - (((b.y * c.w) - (b.w * c.y)) * a.z) + (((b.y * c.z) - (b.z * c.y)) * a.w);
+	float y = (((b.w * c.z) - (b.z * c.w)) * a.x) - (((b.w * c.x) - (b.x * c.w)) * a.z) + (((b.z * c.x) - (b.x * c.z)) * a.w);
+	float z = (((b.y * c.w) - (b.w * c.y)) * a.x) - (((b.x * c.w) - (b.w * c.x)) * a.y) + (((b.x * c.y) - (b.y * c.x)) * a.w);
+	float w = (((b.z * c.y) - (b.y * c.z)) * a.x) - (((b.z * c.x) - (b.x * c.z)) * a.y) + (((b.y * c.x) - (b.x * c.y)) * a.z);
+	return Vector4(x, y, z, w);
 }
 
 inline Vector4 floor(const Vector4 &vector)
 {
-	XMVECTOR temp = XMLoadFloat4(&vector);
-	return XMVectorFloor(temp);
+	return simd_floor(simd_load4(&vector.x));
+}
+
+// Halves are rounded to even.
+inline Vector4 round(const Vector4 &vector)
+{
+	return simd_round(simd_load4(&vector.x));
 }
 
 inline Vector4 operator+(const Vector4 &first_vector, const Vector4 &second_vector)
 {
-	XMVECTOR first = XMLoadFloat4(&first_vector);
-	XMVECTOR second = XMLoadFloat4(&second_vector);
-	return XMVectorAdd(first, second);
+	return simd_add(simd_load4(&first_vector.x), simd_load4(&second_vector.x));
 }
 
 inline Vector4 operator-(const Vector4 &first_vector, const Vector4 &second_vector)
 {
-	XMVECTOR first = XMLoadFloat4(&first_vector);
-	XMVECTOR second = XMLoadFloat4(&second_vector);
-	return XMVectorSubtract(first, second);
+	return simd_sub(simd_load4(&first_vector.x), simd_load4(&second_vector.x));
 }
 
 inline Vector4 operator*(const Vector4 &first_vector, const Vector4 &second_vector)
 {
-	XMVECTOR first = XMLoadFloat4(&first_vector);
-	XMVECTOR second = XMLoadFloat4(&second_vector);
-	return XMVectorMultiply(first, second);
+	return simd_mul(simd_load4(&first_vector.x), simd_load4(&second_vector.x));
 }
 
 inline Vector4 operator/(const Vector4 &first_vector, const Vector4 &second_vector)
 {
-	XMVECTOR first = XMLoadFloat4(&first_vector);
-	XMVECTOR second = XMLoadFloat4(&second_vector);
-	return XMVectorDivide(first, second);
+	return simd_div(simd_load4(&first_vector.x), simd_load4(&second_vector.x));
+}
+
+inline Vector4 operator-(const Vector4 &vector)
+{
+	return simd_negate(simd_load4(&vector.x));
 }
-#endif
\ No newline at end of file
+
+inline Vector4 operator*(const Vector4 &vector, float value)
+{
+	return simd_scale(simd_load4(&vector.x), value);
+}
+
+inline Vector4 operator*(float value, const Vector4 &vector)
+{
+	return simd_scale(simd_load4(&vector.x), value);
+}
+
+inline Vector4 operator/(const Vector4 &vector, float value)
+{
+	return simd_div(simd_load4(&vector.x), simd_splat(value));
+}
+
+#endif
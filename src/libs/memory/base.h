@@ -2,7 +2,38 @@
 #define MEMORY_BASE_H
 
 #include <assert.h>
+#include <stdlib.h>
 #include "../number_types.h"
+#include "memory_tracking.h"
+
+const u32 CACHE_LINE_SIZE = 64;
+
+// Memory source which can be plugged into containers (Array, String).
+// A container without an allocator takes memory from the heap under the memory tag of the current thread.
+struct Allocator {
+	virtual void *allocate(u64 size, u64 alignment) = 0;
+	virtual void *reallocate(void *memory, u64 old_size, u64 new_size, u64 alignment) = 0;
+	virtual void free(void *memory) = 0;
+};
+
+inline void *allocate_memory(Allocator *allocator, u64 size, u64 alignment)
+{
+	return allocator ? allocator->allocate(size, alignment) : allocate_tagged_memory(size, alignment, get_current_memory_tag());
+}
+
+inline void *reallocate_memory(Allocator *allocator, void *memory, u64 old_size, u64 new_size, u64 alignment)
+{
+	return allocator ? allocator->reallocate(memory, old_size, new_size, alignment) : reallocate_tagged_memory(memory, new_size, alignment);
+}
+
+inline void free_memory(Allocator *allocator, void *memory)
+{
+	if (allocator) {
+		allocator->free(memory);
+	} else {
+		free_tagged_memory(memory);
+	}
+}
 
 template <typename T>
 inline T align_address(T address, T alignment)
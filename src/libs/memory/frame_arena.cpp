@@ -0,0 +1,140 @@
+#include <string.h>
+#include <stdlib.h>
+
+#include "frame_arena.h"
+
+const u64 ARENA_DEFAULT_ALIGNMENT = 16;
+
+Memory_Arena::~Memory_Arena()
+{
+	shutdown();
+}
+
+void Memory_Arena::init(u64 arena_size)
+{
+	assert(arena_size > 0);
+
+	shutdown();
+	size = arena_size;
+	memory = (u8 *)allocate_tagged_memory(size, 0, MEMORY_TAG_TEMP);
+	assert(memory);
+}
+
+void Memory_Arena::shutdown()
+{
+	reset();
+	free_tagged_memory(memory);
+	memory = NULL;
+	size = 0;
+}
+
+void Memory_Arena::reset()
+{
+	u64 total_used_bytes = used_bytes();
+	for (u32 i = 0; i < overflow_blocks.count; i++) {
+		free_tagged_memory(overflow_blocks[i]);
+	}
+	overflow_blocks.reset();
+
+	if ((total_used_bytes > size) && memory) {
+		// The arena was too small for the last frame, so it gets the size it needed.
+		size = align_address<u64>(total_used_bytes + total_used_bytes / 2, ARENA_DEFAULT_ALIGNMENT);
+		free_tagged_memory(memory);
+		memory = (u8 *)allocate_tagged_memory(size, 0, MEMORY_TAG_TEMP);
+		assert(memory);
+	}
+	overflow_bytes = 0;
+	offset = 0;
+	last_allocation_offset = UINT64_MAX;
+	allocation_count = 0;
+	overflow_allocation_count = 0;
+}
+
+void *Memory_Arena::allocate(u64 allocation_size, u64 alignment)
+{
+	alignment = (alignment > 0) ? alignment : ARENA_DEFAULT_ALIGNMENT;
+	allocation_count++;
+
+	if (memory) {
+		u64 aligned_offset = align_address<u64>(pointer_address(memory) + offset, alignment) - pointer_address(memory);
+		if ((aligned_offset + allocation_size) <= size) {
+			last_allocation_offset = aligned_offset;
+			offset = aligned_offset + allocation_size;
+			return (void *)(memory + aligned_offset);
+		}
+	}
+
+	overflow_allocation_count++;
+	overflow_bytes += allocation_size + alignment;
+
+	u8 *block = (u8 *)allocate_tagged_memory(allocation_size + alignment, 0, MEMORY_TAG_TEMP);
+	assert(block);
+	overflow_blocks.push((void *)block);
+	return (void *)align_address<u64>(pointer_address(block), alignment);
+}
+
+void *Memory_Arena::reallocate(void *allocated_memory, u64 old_size, u64 new_size, u64 alignment)
+{
+	if (!allocated_memory) {
+		return allocate(new_size, alignment);
+	}
+	// The last allocation can grow in place.
+	if ((last_allocation_offset != UINT64_MAX) && (allocated_memory == (void *)(memory + last_allocation_offset)) && ((last_allocation_offset + new_size) <= size)) {
+		offset = last_allocation_offset + new_size;
+		return allocated_memory;
+	}
+	void *new_memory = allocate(new_size, alignment);
+	memcpy(new_memory, allocated_memory, (old_size < new_size) ? old_size : new_size);
+	return new_memory;
+}
+
+void Memory_Arena::free(void *allocated_memory)
+{
+	// Memory is freed all at once by reset.
+}
+
+bool Memory_Arena::owns(void *allocated_memory)
+{
+	u8 *address = (u8 *)allocated_memory;
+	return (address >= memory) && (address < (memory + size));
+}
+
+u64 Memory_Arena::used_bytes()
+{
+	return offset + overflow_bytes;
+}
+
+void Frame_Arena::init(u64 arena_size)
+{
+	for (u32 i = 0; i < FRAME_ARENA_COUNT; i++) {
+		arenas[i].init(arena_size);
+	}
+	frame_index = 0;
+}
+
+void Frame_Arena::shutdown()
+{
+	for (u32 i = 0; i < FRAME_ARENA_COUNT; i++) {
+		arenas[i].shutdown();
+	}
+}
+
+void Frame_Arena::end_frame()
+{
+	frame_index++;
+	current_arena()->reset();
+}
+
+void *Frame_Arena::allocate(u64 allocation_size, u64 alignment)
+{
+	return current_arena()->allocate(allocation_size, alignment);
+}
+
+void *Frame_Arena::reallocate(void *allocated_memory, u64 old_size, u64 new_size, u64 alignment)
+{
+	return current_arena()->reallocate(allocated_memory, old_size, new_size, alignment);
+}
+
+void Frame_Arena::free(void *allocated_memory)
+{
+}
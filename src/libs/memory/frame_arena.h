@@ -0,0 +1,84 @@
+#ifndef FRAME_ARENA_H
+#define FRAME_ARENA_H
+
+#include <new>
+#include <utility>
+
+#include "base.h"
+#include "../number_types.h"
+#include "../structures/array.h"
+
+// Linear allocator. Memory is given out by bumping an offset and all of it is freed at once by reset.
+// If the block runs out, allocations go to overflow blocks and the next reset grows the block
+// to the peak usage, so in a steady state the arena doesn't touch the heap.
+struct Memory_Arena : Allocator {
+	Memory_Arena() {}
+	~Memory_Arena();
+
+	u8 *memory = NULL;
+	u64 size = 0;
+	u64 offset = 0;
+	u64 overflow_bytes = 0;
+	u64 last_allocation_offset = UINT64_MAX;
+	u32 allocation_count = 0;
+	u32 overflow_allocation_count = 0;
+	Array<void *> overflow_blocks;
+
+	void init(u64 arena_size);
+	void shutdown();
+	void reset();
+
+	void *allocate(u64 allocation_size, u64 alignment) override;
+	void *reallocate(void *allocated_memory, u64 old_size, u64 new_size, u64 alignment) override;
+	void free(void *allocated_memory) override;
+
+	bool owns(void *allocated_memory);
+	u64 used_bytes();
+};
+
+const u32 FRAME_ARENA_COUNT = 2;
+
+// Memory for data which lives no longer than a frame. There are two arenas:
+// the engine allocates from one while the other keeps the data of the previous frame,
+// which gives the render side one extra frame to read it. end_frame switches the arenas
+// and resets the one which becomes current.
+// Note: The arena is not thread safe, use it only from the main thread.
+struct Frame_Arena : Allocator {
+	u32 frame_index = 0;
+	Memory_Arena arenas[FRAME_ARENA_COUNT];
+
+	void init(u64 arena_size);
+	void shutdown();
+	void end_frame();
+
+	void *allocate(u64 allocation_size, u64 alignment) override;
+	void *reallocate(void *allocated_memory, u64 old_size, u64 new_size, u64 alignment) override;
+	void free(void *allocated_memory) override;
+
+	Memory_Arena *current_arena();
+	Memory_Arena *previous_arena();
+
+	template <typename T, typename... Args>
+	T *make(Args &&... args);
+};
+
+inline Memory_Arena *Frame_Arena::current_arena()
+{
+	return &arenas[frame_index % FRAME_ARENA_COUNT];
+}
+
+inline Memory_Arena *Frame_Arena::previous_arena()
+{
+	return &arenas[(frame_index + FRAME_ARENA_COUNT - 1) % FRAME_ARENA_COUNT];
+}
+
+// Destructors of objects made in the arena are never called.
+template <typename T, typename... Args>
+inline T *Frame_Arena::make(Args &&... args)
+{
+	static_assert(std::is_trivially_destructible<T>::value, "Frame_Arena::make: T must be trivially destructible.");
+
+	void *memory = allocate(sizeof(T), alignof(T));
+	return new (memory) T(std::forward<Args>(args)...);
+}
+#endif
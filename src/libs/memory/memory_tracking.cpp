@@ -0,0 +1,418 @@
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+#include <new>
+#include <immintrin.h>
+
+#include "base.h"
+#include "memory_tracking.h"
+#include "../../sys/sys.h"
+
+const u32 MEMORY_LEAK_REPORT_MAX_PRINTED_BLOCKS = 32;
+
+static const char *MEMORY_TAG_NAMES[MEMORY_TAG_COUNT] = { "Untagged", "Assets", "Render", "Gui", "World", "Strings", "Temp" };
+
+// Keeps memory after it aligned to 16 bytes as malloc does.
+struct alignas(16) Memory_Block_Header {
+#if MEMORY_LEAK_REPORT
+	Memory_Block_Header *previous = NULL;
+	Memory_Block_Header *next = NULL;
+	u64 frame_number = 0;
+#endif
+	u64 size = 0;
+	u32 offset = 0; // Bytes from the start of the heap block to the memory after the header.
+	Memory_Tag tag = MEMORY_TAG_UNTAGGED;
+	bool tracked_for_leaks = false;
+};
+
+// Counters of a tag are on their own cache line, so threads which allocate under different tags don't share it.
+struct alignas(CACHE_LINE_SIZE) Memory_Tag_Counters {
+	std::atomic<u64> live_bytes = 0;
+	std::atomic<u64> peak_bytes = 0;
+	std::atomic<u64> live_allocation_count = 0;
+	std::atomic<u64> frame_allocation_count = 0;
+
+	// Used only by the main thread.
+	u64 allocation_count = 0;
+	u64 last_frame_allocation_count = 0;
+	u64 budget_bytes = 0;
+	bool over_budget = false;
+};
+
+// Everything here is initialized as constants, so new can use it before main.
+thread_local Memory_Tag current_memory_tag = MEMORY_TAG_UNTAGGED;
+
+static Memory_Tag_Counters memory_tag_counters[MEMORY_TAG_COUNT];
+static std::atomic<u64> memory_frame_number = 0;
+static std::atomic<bool> leak_tracking = false;
+
+#if MEMORY_LEAK_REPORT
+// A spin lock instead of a mutex, a mutex is not guaranteed to be usable before its constructor runs.
+static std::atomic<bool> leak_list_locked = false;
+static Memory_Block_Header *first_tracked_block = NULL;
+
+static void lock_leak_list()
+{
+	while (leak_list_locked.exchange(true, std::memory_order_acquire)) {
+		while (leak_list_locked.load(std::memory_order_relaxed)) {
+			_mm_pause();
+		}
+	}
+}
+
+static void unlock_leak_list()
+{
+	leak_list_locked.store(false, std::memory_order_release);
+}
+
+static void link_block(Memory_Block_Header *header)
+{
+	lock_leak_list();
+	header->previous = NULL;
+	header->next = first_tracked_block;
+	if (first_tracked_block) {
+		first_tracked_block->previous = header;
+	}
+	first_tracked_block = header;
+	unlock_leak_list();
+}
+
+static void unlink_block(Memory_Block_Header *header)
+{
+	lock_leak_list();
+	if (header->previous) {
+		header->previous->next = header->next;
+	} else {
+		first_tracked_block = header->next;
+	}
+	if (header->next) {
+		header->next->previous = header->previous;
+	}
+	unlock_leak_list();
+}
+#endif
+
+inline Memory_Block_Header *get_block_header(void *memory)
+{
+	return (Memory_Block_Header *)((u8 *)memory - sizeof(Memory_Block_Header));
+}
+
+static void count_allocation(Memory_Tag tag, u64 size)
+{
+	Memory_Tag_Counters *counters = &memory_tag_counters[tag];
+	u64 live_bytes = counters->live_bytes.fetch_add(size, std::memory_order_relaxed) + size;
+	u64 peak_bytes = counters->peak_bytes.load(std::memory_order_relaxed);
+	while ((live_bytes > peak_bytes) && !counters->peak_bytes.compare_exchange_weak(peak_bytes, live_bytes, std::memory_order_relaxed)) {
+	}
+	counters->live_allocation_count.fetch_add(1, std::memory_order_relaxed);
+	counters->frame_allocation_count.fetch_add(1, std::memory_order_relaxed);
+}
+
+static void count_free(Memory_Tag tag, u64 size)
+{
+	Memory_Tag_Counters *counters = &memory_tag_counters[tag];
+	counters->live_bytes.fetch_sub(size, std::memory_order_relaxed);
+	counters->live_allocation_count.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void *allocate_tagged_memory(u64 size, u64 alignment, Memory_Tag tag)
+{
+	assert(tag < MEMORY_TAG_COUNT);
+
+	u64 alignment_padding = (alignment > alignof(Memory_Block_Header)) ? alignment : 0;
+	u8 *block = (u8 *)malloc(sizeof(Memory_Block_Header) + size + alignment_padding);
+	if (!block) {
+		return NULL;
+	}
+	u8 *memory = (u8 *)align_address<u64>((u64)(block + sizeof(Memory_Block_Header)), alignment_padding);
+
+	Memory_Block_Header *header = new (get_block_header(memory)) Memory_Block_Header();
+	header->size = size;
+	header->offset = (u32)(memory - block);
+	header->tag = tag;
+	count_allocation(tag, size);
+
+#if MEMORY_LEAK_REPORT
+	if (leak_tracking.load(std::memory_order_relaxed)) {
+		header->tracked_for_leaks = true;
+		header->frame_number = memory_frame_number.load(std::memory_order_relaxed);
+		link_block(header);
+	}
+#endif
+	return (void *)memory;
+}
+
+// Memory which is not aligned more than malloc aligns it and is not in the leak list is resized in place by realloc.
+void *reallocate_tagged_memory(void *memory, u64 new_size, u64 alignment)
+{
+	if (!memory) {
+		return allocate_tagged_memory(new_size, alignment, current_memory_tag);
+	}
+	Memory_Block_Header *header = get_block_header(memory);
+	Memory_Tag tag = header->tag;
+	u64 old_size = header->size;
+
+	if ((header->offset == sizeof(Memory_Block_Header)) && (alignment <= alignof(Memory_Block_Header)) && !header->tracked_for_leaks) {
+		u8 *block = (u8 *)realloc((u8 *)memory - header->offset, sizeof(Memory_Block_Header) + new_size);
+		if (!block) {
+			return NULL;
+		}
+		header = (Memory_Block_Header *)block;
+		header->size = new_size;
+		count_free(tag, old_size);
+		count_allocation(tag, new_size);
+		return (void *)(block + sizeof(Memory_Block_Header));
+	}
+	void *new_memory = allocate_tagged_memory(new_size, alignment, tag);
+	if (!new_memory) {
+		return NULL;
+	}
+	memcpy(new_memory, memory, (old_size < new_size) ? old_size : new_size);
+	free_tagged_memory(memory);
+	return new_memory;
+}
+
+void free_tagged_memory(void *memory)
+{
+	if (!memory) {
+		return;
+	}
+	Memory_Block_Header *header = get_block_header(memory);
+	assert(header->tag < MEMORY_TAG_COUNT);
+
+#if MEMORY_LEAK_REPORT
+	if (header->tracked_for_leaks) {
+		unlink_block(header);
+	}
+#endif
+	count_free(header->tag, header->size);
+	::free((u8 *)memory - header->offset);
+}
+
+const char *get_memory_tag_name(Memory_Tag tag)
+{
+	assert(tag < MEMORY_TAG_COUNT);
+	return MEMORY_TAG_NAMES[tag];
+}
+
+void get_memory_tag_stats(Memory_Tag tag, Memory_Tag_Stats *stats)
+{
+	assert(tag < MEMORY_TAG_COUNT);
+	assert(stats);
+
+	Memory_Tag_Counters *counters = &memory_tag_counters[tag];
+	stats->live_bytes = counters->live_bytes.load(std::memory_order_relaxed);
+	stats->peak_bytes = counters->peak_bytes.load(std::memory_order_relaxed);
+	stats->budget_bytes = counters->budget_bytes;
+	stats->live_allocation_count = counters->live_allocation_count.load(std::memory_order_relaxed);
+	stats->allocation_count = counters->allocation_count + counters->frame_allocation_count.load(std::memory_order_relaxed);
+	stats->last_frame_allocation_count = counters->last_frame_allocation_count;
+}
+
+void set_memory_tag_budget(Memory_Tag tag, u64 budget_bytes)
+{
+	assert(tag < MEMORY_TAG_COUNT);
+
+	memory_tag_counters[tag].budget_bytes = budget_bytes;
+	memory_tag_counters[tag].over_budget = false;
+}
+
+void end_memory_frame()
+{
+	for (u32 i = 0; i < MEMORY_TAG_COUNT; i++) {
+		Memory_Tag_Counters *counters = &memory_tag_counters[i];
+		counters->last_frame_allocation_count = counters->frame_allocation_count.exchange(0, std::memory_order_relaxed);
+		counters->allocation_count += counters->last_frame_allocation_count;
+
+		if (counters->budget_bytes > 0) {
+			u64 live_bytes = counters->live_bytes.load(std::memory_order_relaxed);
+			bool over_budget = live_bytes > counters->budget_bytes;
+			if (over_budget && !counters->over_budget) {
+				print("end_memory_frame: {} memory went over its budget, {} bytes are used and the budget is {} bytes.", MEMORY_TAG_NAMES[i], live_bytes, counters->budget_bytes);
+			}
+			counters->over_budget = over_budget;
+		}
+	}
+	memory_frame_number.fetch_add(1, std::memory_order_relaxed);
+}
+
+void print_memory_stats()
+{
+	print("Heap memory by tags (live KB / peak KB / budget KB, live allocations, allocations in the last frame):");
+	for (u32 i = 0; i < MEMORY_TAG_COUNT; i++) {
+		Memory_Tag_Stats stats;
+		get_memory_tag_stats((Memory_Tag)i, &stats);
+		print("  {}: {} / {} / {}, {}, {}", MEMORY_TAG_NAMES[i], stats.live_bytes / 1024, stats.peak_bytes / 1024, stats.budget_bytes / 1024, stats.live_allocation_count, stats.last_frame_allocation_count);
+	}
+}
+
+void start_memory_leak_tracking()
+{
+	leak_tracking.store(true, std::memory_order_relaxed);
+}
+
+void report_memory_leaks()
+{
+	leak_tracking.store(false, std::memory_order_relaxed);
+
+#if MEMORY_LEAK_REPORT
+	u64 leaked_bytes[MEMORY_TAG_COUNT];
+	u64 leaked_block_counts[MEMORY_TAG_COUNT];
+	for (u32 i = 0; i < MEMORY_TAG_COUNT; i++) {
+		leaked_bytes[i] = 0;
+		leaked_block_counts[i] = 0;
+	}
+
+	// The blocks are copied under the lock and printed after it, printing allocates memory.
+	u32 printed_block_count = 0;
+	Memory_Block_Header printed_blocks[MEMORY_LEAK_REPORT_MAX_PRINTED_BLOCKS];
+	void *printed_block_addresses[MEMORY_LEAK_REPORT_MAX_PRINTED_BLOCKS];
+
+	lock_leak_list();
+	for (Memory_Block_Header *header = first_tracked_block; header; header = header->next) {
+		leaked_bytes[header->tag] += header->size;
+		leaked_block_counts[header->tag]++;
+		if (printed_block_count < MEMORY_LEAK_REPORT_MAX_PRINTED_BLOCKS) {
+			printed_blocks[printed_block_count] = *header;
+			printed_block_addresses[printed_block_count] = (void *)((u8 *)header + sizeof(Memory_Block_Header));
+			printed_block_count++;
+		}
+	}
+	unlock_leak_list();
+
+	u64 total_block_count = 0;
+	for (u32 i = 0; i < MEMORY_TAG_COUNT; i++) {
+		total_block_count += leaked_block_counts[i];
+	}
+	if (total_block_count == 0) {
+		print("report_memory_leaks: No memory leaks were found.");
+		return;
+	}
+	print("report_memory_leaks: {} allocations made after the start of leak tracking are still alive.", total_block_count);
+	for (u32 i = 0; i < MEMORY_TAG_COUNT; i++) {
+		if (leaked_block_counts[i] > 0) {
+			print("  {}: {} bytes in {} allocations", MEMORY_TAG_NAMES[i], leaked_bytes[i], leaked_block_counts[i]);
+		}
+	}
+	for (u32 i = 0; i < printed_block_count; i++) {
+		print("  {} bytes at {} ({}), allocated in frame {}", printed_blocks[i].size, (u64)printed_block_addresses[i], MEMORY_TAG_NAMES[printed_blocks[i].tag], printed_blocks[i].frame_number);
+	}
+#else
+	print("report_memory_leaks: Leak tracking is off in this build, live allocations of all time by tags:");
+	for (u32 i = 0; i < MEMORY_TAG_COUNT; i++) {
+		Memory_Tag_Stats stats;
+		get_memory_tag_stats((Memory_Tag)i, &stats);
+		print("  {}: {} bytes in {} allocations", MEMORY_TAG_NAMES[i], stats.live_bytes, stats.live_allocation_count);
+	}
+#endif
+}
+
+// All heap memory taken by new goes through the tracking, so it is counted under the tag of the thread.
+void *operator new(size_t size)
+{
+	void *memory = allocate_tagged_memory(size, 0, current_memory_tag);
+	if (!memory) {
+		throw std::bad_alloc();
+	}
+	return memory;
+}
+
+void *operator new[](size_t size)
+{
+	return operator new(size);
+}
+
+void *operator new(size_t size, const std::nothrow_t &)
+{
+	return allocate_tagged_memory(size, 0, current_memory_tag);
+}
+
+void *operator new[](size_t size, const std::nothrow_t &)
+{
+	return allocate_tagged_memory(size, 0, current_memory_tag);
+}
+
+void *operator new(size_t size, std::align_val_t alignment)
+{
+	void *memory = allocate_tagged_memory(size, (u64)alignment, current_memory_tag);
+	if (!memory) {
+		throw std::bad_alloc();
+	}
+	return memory;
+}
+
+void *operator new[](size_t size, std::align_val_t alignment)
+{
+	return operator new(size, alignment);
+}
+
+void *operator new(size_t size, std::align_val_t alignment, const std::nothrow_t &)
+{
+	return allocate_tagged_memory(size, (u64)alignment, current_memory_tag);
+}
+
+void *operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t &)
+{
+	return allocate_tagged_memory(size, (u64)alignment, current_memory_tag);
+}
+
+void operator delete(void *memory) noexcept
+{
+	free_tagged_memory(memory);
+}
+
+void operator delete[](void *memory) noexcept
+{
+	free_tagged_memory(memory);
+}
+
+void operator delete(void *memory, size_t) noexcept
+{
+	free_tagged_memory(memory);
+}
+
+void operator delete[](void *memory, size_t) noexcept
+{
+	free_tagged_memory(memory);
+}
+
+void operator delete(void *memory, const std::nothrow_t &) noexcept
+{
+	free_tagged_memory(memory);
+}
+
+void operator delete[](void *memory, const std::nothrow_t &) noexcept
+{
+	free_tagged_memory(memory);
+}
+
+void operator delete(void *memory, std::align_val_t) noexcept
+{
+	free_tagged_memory(memory);
+}
+
+void operator delete[](void *memory, std::align_val_t) noexcept
+{
+	free_tagged_memory(memory);
+}
+
+void operator delete(void *memory, size_t, std::align_val_t) noexcept
+{
+	free_tagged_memory(memory);
+}
+
+void operator delete[](void *memory, size_t, std::align_val_t) noexcept
+{
+	free_tagged_memory(memory);
+}
+
+void operator delete(void *memory, std::align_val_t, const std::nothrow_t &) noexcept
+{
+	free_tagged_memory(memory);
+}
+
+void operator delete[](void *memory, std::align_val_t, const std::nothrow_t &) noexcept
+{
+	free_tagged_memory(memory);
+}
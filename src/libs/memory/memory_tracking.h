@@ -0,0 +1,73 @@
+#ifndef MEMORY_TRACKING_H
+#define MEMORY_TRACKING_H
+
+#include "../number_types.h"
+
+// Live allocations are linked in a list which report_memory_leaks prints. It costs a lock per allocation.
+#ifdef _DEBUG
+#define MEMORY_LEAK_REPORT 1
+#else
+#define MEMORY_LEAK_REPORT 0
+#endif
+
+enum Memory_Tag : u8 {
+	MEMORY_TAG_UNTAGGED,
+	MEMORY_TAG_ASSETS,
+	MEMORY_TAG_RENDER,
+	MEMORY_TAG_GUI,
+	MEMORY_TAG_WORLD,
+	MEMORY_TAG_STRINGS,
+	MEMORY_TAG_TEMP,
+	MEMORY_TAG_COUNT
+};
+
+struct Memory_Tag_Stats {
+	u64 live_bytes = 0;
+	u64 peak_bytes = 0;
+	u64 budget_bytes = 0; // 0 if the tag has no budget.
+	u64 live_allocation_count = 0;
+	u64 allocation_count = 0;
+	u64 last_frame_allocation_count = 0;
+};
+
+extern thread_local Memory_Tag current_memory_tag;
+
+// Heap memory which is taken without a tag of its own (containers without an allocator, new and delete) is counted
+// under the tag of the current thread. A thread starts untagged, a scope changes the tag until it ends.
+// Jobs are run under the tag of the thread which made them.
+inline Memory_Tag get_current_memory_tag()
+{
+	return current_memory_tag;
+}
+
+struct Memory_Tag_Scope {
+	Memory_Tag_Scope(Memory_Tag tag) : previous_tag(current_memory_tag) { current_memory_tag = tag; }
+	~Memory_Tag_Scope() { current_memory_tag = previous_tag; }
+
+	Memory_Tag previous_tag;
+};
+
+#define MEMORY_TAG_SCOPE_1(x, y) x##y
+#define MEMORY_TAG_SCOPE_2(x, y) MEMORY_TAG_SCOPE_1(x, y)
+#define MEMORY_TAG_SCOPE(tag) Memory_Tag_Scope MEMORY_TAG_SCOPE_2(_memory_tag_scope_, __COUNTER__)(tag)
+
+// Memory from these functions has a header with its size and tag, it must be freed with free_tagged_memory.
+// Reallocated memory keeps its tag. The functions never allocate anything else, so they can be used by new and delete.
+void *allocate_tagged_memory(u64 size, u64 alignment, Memory_Tag tag);
+void *reallocate_tagged_memory(void *memory, u64 new_size, u64 alignment);
+void free_tagged_memory(void *memory);
+
+const char *get_memory_tag_name(Memory_Tag tag);
+void get_memory_tag_stats(Memory_Tag tag, Memory_Tag_Stats *stats);
+void set_memory_tag_budget(Memory_Tag tag, u64 budget_bytes);
+
+// Called once a frame on the main thread. Moves the allocation counts of the frame to last_frame_allocation_count
+// and prints a warning when a tag goes over its budget.
+void end_memory_frame();
+void print_memory_stats();
+
+// Allocations made after start_memory_leak_tracking which are still alive are printed by report_memory_leaks.
+// Without MEMORY_LEAK_REPORT only the numbers of live allocations are printed.
+void start_memory_leak_tracking();
+void report_memory_leaks();
+#endif
@@ -1,21 +1,118 @@
 #ifndef MEMORY_POOL_ALLOCATOR_H
 #define MEMORY_POOL_ALLOCATOR_H
 
+#include <new>
+#include <mutex>
+#include <atomic>
+
 #include "base.h"
 #include "../../sys/sys.h"
 #include "../../sys/utils.h"
 #include "../number_types.h"
 #include "../structures/array.h"
-#ifdef _DEBUG
-#include "../structures/hash_table.h"
-#endif
 
+// A free chunk keeps the links in the memory of the object.
 template <typename T>
-struct Memory_Chunk {
-	Memory_Chunk *next = NULL;
+union Memory_Chunk {
+	Memory_Chunk() {}
+	~Memory_Chunk() {}
+
+	struct {
+		Memory_Chunk *next;
+		u32 batch_count;
+	} link;
 	T data;
 };
 
+// Debug builds mark allocated chunks in a bitmap, one bit per chunk.
+template <typename T>
+struct Memory_Pool {
+	u32 chunk_count = 0;
+	Memory_Chunk<T> *chunks = NULL;
+#ifdef _DEBUG
+	std::atomic<u64> *allocated_chunks = NULL;
+#endif
+
+	void init(u32 _chunk_count);
+	void free();
+	bool owns(Memory_Chunk<T> *chunk);
+	void mark_chunk(Memory_Chunk<T> *chunk, bool allocated);
+};
+
+template <typename T>
+inline void Memory_Pool<T>::init(u32 _chunk_count)
+{
+	assert(_chunk_count > 0);
+
+	chunk_count = _chunk_count;
+	chunks = new Memory_Chunk<T>[chunk_count];
+#ifdef _DEBUG
+	u32 word_count = (chunk_count + 63) / 64;
+	allocated_chunks = new std::atomic<u64>[word_count];
+	for (u32 i = 0; i < word_count; i++) {
+		allocated_chunks[i].store(0, std::memory_order_relaxed);
+	}
+#endif
+}
+
+template <typename T>
+inline void Memory_Pool<T>::free()
+{
+	DELETE_ARRAY(chunks);
+#ifdef _DEBUG
+	DELETE_ARRAY(allocated_chunks);
+#endif
+	chunk_count = 0;
+}
+
+template <typename T>
+inline bool Memory_Pool<T>::owns(Memory_Chunk<T> *chunk)
+{
+	return (chunk >= chunks) && (chunk < (chunks + chunk_count));
+}
+
+template <typename T>
+inline void Memory_Pool<T>::mark_chunk(Memory_Chunk<T> *chunk, bool allocated)
+{
+#ifdef _DEBUG
+	assert(owns(chunk));
+
+	u32 chunk_index = (u32)(chunk - chunks);
+	u64 bit = 1ull << (chunk_index % 64);
+	std::atomic<u64> *word = &allocated_chunks[chunk_index / 64];
+	if (allocated) {
+		u64 prev_bits = word->fetch_or(bit, std::memory_order_relaxed);
+		ASSERT_MSG(!(prev_bits & bit), "Memory_Pool::mark_chunk: Can't allocate memory. An memory chunk has already been allocated.");
+	} else {
+		u64 prev_bits = word->fetch_and(~bit, std::memory_order_relaxed);
+		ASSERT_MSG(prev_bits & bit, "Memory_Pool::mark_chunk: Can't free memory. An memory chunk has already been freed.");
+	}
+#else
+	(void)chunk;
+	(void)allocated;
+#endif
+}
+
+template <typename T>
+inline void mark_chunk_in_pools(Memory_Pool<T> *pools, u32 pool_count, Memory_Chunk<T> *chunk, bool allocated)
+{
+#ifdef _DEBUG
+	for (u32 i = 0; i < pool_count; i++) {
+		if (pools[i].owns(chunk)) {
+			pools[i].mark_chunk(chunk, allocated);
+			return;
+		}
+	}
+	ASSERT_MSG(false, "Pool_Allocator: The allocator doesn't own this chunk of memory.");
+#else
+	(void)pools;
+	(void)pool_count;
+	(void)chunk;
+	(void)allocated;
+#endif
+}
+
+// The allocator is not thread safe, use Concurrent_Pool_Allocator to share it between threads.
 template <typename T>
 struct Pool_Allocator {
 	Pool_Allocator();
@@ -24,11 +121,7 @@ struct Pool_Allocator {
 	u32 pool_size = 0;
 
 	Memory_Chunk<T> *head = NULL;
-	Array<Memory_Chunk<T> *> memory_pools;
-
-#ifdef _DEBUG
-	Hash_Table<u64, bool> memory_chunks_table;
-#endif
+	Array<Memory_Pool<T>> memory_pools;
 
 	void init(u32 _pool_size);
 	void free_memory();
@@ -62,13 +155,11 @@ template<typename T>
 void Pool_Allocator<T>::free_memory()
 {
 	pool_size = 0;
+	head = NULL;
 	for (u32 i = 0; i < memory_pools.count; i++) {
-		DELETE_ARRAY(memory_pools[i]);
+		memory_pools[i].free();
 	}
 	memory_pools.clear();
-#ifdef _DEBUG
-	memory_chunks_table.clear();
-#endif
 }
 
 template<typename T>
@@ -78,46 +169,22 @@ T *Pool_Allocator<T>::allocate()
 		head = allocate_new_pool();
 	}
 	Memory_Chunk<T> *memory_chunk = head;
-#ifdef _DEBUG
-	u64 address = pointer_address(memory_chunk);
-	bool memory_chunk_allocated = false;
-	if (memory_chunks_table.get(address, &memory_chunk_allocated)) {
-		if (!memory_chunk_allocated) {
-			memory_chunks_table[address] = true;
-		} else {
-			ASSERT_MSG(false, "Pool_Allocator::allocate: Can't allocate memory. An memory chunk has already been allocated.");
-		}
-	} else {
-		ASSERT_MSG(false, "Pool_Allocator::allocate: Can't allocate memory. An address of memory chunk has not been found in an address table.");
-	}
-#endif
-	head = head->next;
-	return &memory_chunk->data;
+	mark_chunk_in_pools(memory_pools.items, memory_pools.count, memory_chunk, true);
+
+	head = head->link.next;
+	return new (&memory_chunk->data) T();
 }
 
 template<typename T>
 void Pool_Allocator<T>::free(T *data)
 {
 	assert(data);
-	static const u64 POINTER_SIZE = sizeof(u8 *);
 
-	Memory_Chunk<T> *memory_chunk = (Memory_Chunk<T> *)(pointer_address(data) - POINTER_SIZE);
-#ifdef _DEBUG
-	u64 address = pointer_address(memory_chunk);
-	bool memory_chunk_allocated = false;
-	if (memory_chunks_table.get(address, &memory_chunk_allocated)) {
-		if (memory_chunk_allocated) {
-			memory_chunks_table[address] = false;
-		} else {
-			ASSERT_MSG(false, "Pool_Allocator::free: Can't free memory. An memory chunk has already been freed.");
-		}
-	} else {
-		ASSERT_MSG(false, "Pool_Allocator::free: Can't free memory. The allocator doesn't own this chunk of memory.");
-	}
-#endif
-	//memset((void *)&memory_chunk->data, 0, sizeof(T));
+	Memory_Chunk<T> *memory_chunk = (Memory_Chunk<T> *)data;
+	mark_chunk_in_pools(memory_pools.items, memory_pools.count, memory_chunk, false);
+
 	memory_chunk->data.~T();
-	memory_chunk->next = head;
+	memory_chunk->link.next = head;
 	head = memory_chunk;
 }
 
@@ -126,16 +193,337 @@ Memory_Chunk<T> *Pool_Allocator<T>::allocate_new_pool()
 {
 	assert(pool_size > 0);
 
-	Memory_Chunk<T> *new_pool = new Memory_Chunk<T>[pool_size];
+	Memory_Pool<T> *new_pool = &memory_pools[memory_pools.emplace()];
+	new_pool->init(pool_size);
+
+	Memory_Chunk<T> *chunks = new_pool->chunks;
 	for (u32 i = 0; i < pool_size - 1; i++) {
-		new_pool[i].next = &new_pool[i + 1];
+		chunks[i].link.next = &chunks[i + 1];
 	}
-#ifdef _DEBUG
-	for (u32 i = 0; i < pool_size; i++) {
-		memory_chunks_table.set(pointer_address(&new_pool[i]), false);
+	chunks[pool_size - 1].link.next = NULL;
+	return chunks;
+}
+
+const u32 POOL_MAGAZINE_SIZE = 32;
+const u32 POOL_MAX_THREADS = 64;
+const u32 POOL_MAX_POOLS = 32;
+const u32 POOL_MAX_GROWTH_SHIFT = 8;
+
+static_assert(POOL_MAX_THREADS <= 64, "Indices of pool threads are kept in one 64 bit mask.");
+
+// Every thread takes a free index when it touches a concurrent pool for the first time and gives it back
+// when it exits, so only threads which are alive at once count against POOL_MAX_THREADS.
+// Threads past POOL_MAX_THREADS don't have magazines and go to the global list directly.
+struct Pool_Thread_Index {
+	Pool_Thread_Index();
+	~Pool_Thread_Index();
+
+	u32 index = POOL_MAX_THREADS;
+};
+
+inline std::atomic<u64> *get_used_pool_thread_indices()
+{
+	static std::atomic<u64> used_indices = 0;
+	return &used_indices;
+}
+
+// The acquire pairs with the release of the exited thread, so the new owner of the index sees its magazines.
+inline Pool_Thread_Index::Pool_Thread_Index()
+{
+	std::atomic<u64> *used_indices = get_used_pool_thread_indices();
+	const u64 all_indices = (POOL_MAX_THREADS == 64) ? ~0ull : ((1ull << POOL_MAX_THREADS) - 1);
+	u64 indices = used_indices->load(std::memory_order_relaxed);
+	while (~indices & all_indices) {
+		u32 free_index = 0;
+		while (indices & (1ull << free_index)) {
+			free_index++;
+		}
+		if (used_indices->compare_exchange_weak(indices, indices | (1ull << free_index), std::memory_order_acquire, std::memory_order_relaxed)) {
+			index = free_index;
+			return;
+		}
 	}
-#endif
-	memory_pools.push(new_pool);
-	return new_pool;
+}
+
+inline Pool_Thread_Index::~Pool_Thread_Index()
+{
+	if (index < POOL_MAX_THREADS) {
+		get_used_pool_thread_indices()->fetch_and(~(1ull << index), std::memory_order_release);
+	}
+}
+
+inline u32 get_pool_thread_index()
+{
+	thread_local Pool_Thread_Index thread_index;
+	return thread_index.index;
+}
+
+// Free chunks live in two places. Every thread has a magazine with up to two batches
+// of POOL_MAGAZINE_SIZE chunks, so most of allocations and frees touch only the thread's own cache line.
+// Full batches are exchanged with the global lock-free list, a whole batch per one CAS.
+// New pools are allocated under the lock and every new pool is twice bigger than the previous one,
+// up to pool_size << POOL_MAX_GROWTH_SHIFT.
+// A thread popping a batch can read the link of a batch which another thread has already popped and is constructing
+// an object in, the CAS tag rejects the value but the read must not race with the object's bytes. So links between
+// batches are kept in arrays next to the pools, one atomic per chunk, and never in the memory of a chunk.
+// Note: A chunk may be freed on any thread. free_memory must be called when no threads use the allocator.
+template <typename T>
+struct Concurrent_Pool_Allocator {
+	Concurrent_Pool_Allocator();
+	~Concurrent_Pool_Allocator();
+
+	struct alignas(CACHE_LINE_SIZE) Magazine {
+		u32 count = 0;
+		u32 previous_count = 0;
+		Memory_Chunk<T> *head = NULL;
+		Memory_Chunk<T> *previous = NULL;
+	};
+
+	u32 pool_size = 0;
+	std::atomic<u32> pool_count = 0;
+
+	alignas(CACHE_LINE_SIZE) std::atomic<u64> global_batches = 0;
+	std::mutex pool_mutex;
+
+	Memory_Pool<T> memory_pools[POOL_MAX_POOLS];
+	std::atomic<Memory_Chunk<T> *> *next_batches[POOL_MAX_POOLS] = {};
+	Magazine magazines[POOL_MAX_THREADS];
+
+	void init(u32 _pool_size);
+	void free_memory();
+	void flush_thread_cache();
+	T *allocate();
+	void free(T *data);
+
+	void push_batch(Memory_Chunk<T> *batch, u32 batch_count);
+	Memory_Chunk<T> *pop_batch(u32 *batch_count);
+	Memory_Chunk<T> *allocate_new_pool(u32 *batch_count);
+	std::atomic<Memory_Chunk<T> *> *get_next_batch_link(Memory_Chunk<T> *batch);
+};
+
+// The upper 16 bits of x64 user space addresses are zero, a pointer to the top batch shares
+// a word with a tag which is incremented on every push, so CAS doesn't suffer from the ABA problem.
+const u64 POOL_POINTER_MASK = (1ull << 48) - 1;
+
+template <typename T>
+inline Memory_Chunk<T> *unpack_batch_pointer(u64 value)
+{
+	return (Memory_Chunk<T> *)(value & POOL_POINTER_MASK);
+}
+
+template <typename T>
+inline u64 pack_batch_pointer(Memory_Chunk<T> *batch, u64 tag)
+{
+	return (tag << 48) | ((u64)batch & POOL_POINTER_MASK);
+}
+
+template<typename T>
+Concurrent_Pool_Allocator<T>::Concurrent_Pool_Allocator()
+{
+}
+
+template<typename T>
+Concurrent_Pool_Allocator<T>::~Concurrent_Pool_Allocator()
+{
+	free_memory();
+}
+
+template<typename T>
+void Concurrent_Pool_Allocator<T>::init(u32 _pool_size)
+{
+	assert(_pool_size > 0);
+
+	free_memory();
+	// A pool is split into whole batches.
+	pool_size = align_address<u32>(_pool_size, POOL_MAGAZINE_SIZE);
+}
+
+template<typename T>
+void Concurrent_Pool_Allocator<T>::free_memory()
+{
+	u32 count = pool_count.load(std::memory_order_acquire);
+	for (u32 i = 0; i < count; i++) {
+		memory_pools[i].free();
+		DELETE_ARRAY(next_batches[i]);
+	}
+	for (u32 i = 0; i < POOL_MAX_THREADS; i++) {
+		magazines[i] = Magazine();
+	}
+	pool_size = 0;
+	pool_count.store(0, std::memory_order_release);
+	global_batches.store(0, std::memory_order_release);
+}
+
+// Gives the chunks cached by the calling thread back to the global list. If a thread exits without the call,
+// its chunks stay in its magazines until another thread gets its index.
+template<typename T>
+void Concurrent_Pool_Allocator<T>::flush_thread_cache()
+{
+	u32 thread_index = get_pool_thread_index();
+	if (thread_index >= POOL_MAX_THREADS) {
+		return;
+	}
+	Magazine *magazine = &magazines[thread_index];
+	if (magazine->head) {
+		push_batch(magazine->head, magazine->count);
+	}
+	if (magazine->previous) {
+		push_batch(magazine->previous, magazine->previous_count);
+	}
+	*magazine = Magazine();
+}
+
+template<typename T>
+T *Concurrent_Pool_Allocator<T>::allocate()
+{
+	Memory_Chunk<T> *memory_chunk = NULL;
+	u32 thread_index = get_pool_thread_index();
+
+	if (thread_index < POOL_MAX_THREADS) {
+		Magazine *magazine = &magazines[thread_index];
+		if (!magazine->head) {
+			if (magazine->previous) {
+				magazine->head = magazine->previous;
+				magazine->count = magazine->previous_count;
+				magazine->previous = NULL;
+				magazine->previous_count = 0;
+			} else {
+				magazine->head = pop_batch(&magazine->count);
+			}
+		}
+		memory_chunk = magazine->head;
+		magazine->head = memory_chunk->link.next;
+		magazine->count--;
+	} else {
+		u32 batch_count = 0;
+		memory_chunk = pop_batch(&batch_count);
+		if (memory_chunk->link.next) {
+			push_batch(memory_chunk->link.next, batch_count - 1);
+		}
+	}
+	mark_chunk_in_pools(memory_pools, pool_count.load(std::memory_order_acquire), memory_chunk, true);
+	return new (&memory_chunk->data) T();
+}
+
+template<typename T>
+void Concurrent_Pool_Allocator<T>::free(T *data)
+{
+	assert(data);
+
+	Memory_Chunk<T> *memory_chunk = (Memory_Chunk<T> *)data;
+	mark_chunk_in_pools(memory_pools, pool_count.load(std::memory_order_acquire), memory_chunk, false);
+	memory_chunk->data.~T();
+
+	u32 thread_index = get_pool_thread_index();
+	if (thread_index >= POOL_MAX_THREADS) {
+		memory_chunk->link.next = NULL;
+		push_batch(memory_chunk, 1);
+		return;
+	}
+	Magazine *magazine = &magazines[thread_index];
+	if (magazine->count == POOL_MAGAZINE_SIZE) {
+		if (magazine->previous) {
+			push_batch(magazine->previous, magazine->previous_count);
+		}
+		magazine->previous = magazine->head;
+		magazine->previous_count = magazine->count;
+		magazine->head = NULL;
+		magazine->count = 0;
+	}
+	memory_chunk->link.next = magazine->head;
+	magazine->head = memory_chunk;
+	magazine->count++;
+}
+
+template<typename T>
+void Concurrent_Pool_Allocator<T>::push_batch(Memory_Chunk<T> *batch, u32 batch_count)
+{
+	assert(batch);
+
+	batch->link.batch_count = batch_count;
+	std::atomic<Memory_Chunk<T> *> *next_batch = get_next_batch_link(batch);
+	u64 top = global_batches.load(std::memory_order_relaxed);
+	u64 new_top = 0;
+	do {
+		next_batch->store(unpack_batch_pointer<T>(top), std::memory_order_relaxed);
+		new_top = pack_batch_pointer(batch, (top >> 48) + 1);
+	} while (!global_batches.compare_exchange_weak(top, new_top, std::memory_order_release, std::memory_order_relaxed));
+}
+
+template<typename T>
+Memory_Chunk<T> *Concurrent_Pool_Allocator<T>::pop_batch(u32 *batch_count)
+{
+	u64 top = global_batches.load(std::memory_order_acquire);
+	while (true) {
+		Memory_Chunk<T> *batch = unpack_batch_pointer<T>(top);
+		if (!batch) {
+			return allocate_new_pool(batch_count);
+		}
+		// Pools are not freed while the allocator is in use, so reading the link of a stale batch is safe,
+		// the tag makes CAS fail in this case.
+		u64 new_top = pack_batch_pointer(get_next_batch_link(batch)->load(std::memory_order_relaxed), top >> 48);
+		if (global_batches.compare_exchange_weak(top, new_top, std::memory_order_acquire, std::memory_order_acquire)) {
+			*batch_count = batch->link.batch_count;
+			return batch;
+		}
+	}
+}
+
+template<typename T>
+Memory_Chunk<T> *Concurrent_Pool_Allocator<T>::allocate_new_pool(u32 *batch_count)
+{
+	assert(pool_size > 0);
+
+	std::lock_guard<std::mutex> lock(pool_mutex);
+
+	// Another thread could have made a new pool while this one was waiting for the lock.
+	u64 top = global_batches.load(std::memory_order_acquire);
+	while (unpack_batch_pointer<T>(top)) {
+		Memory_Chunk<T> *batch = unpack_batch_pointer<T>(top);
+		u64 new_top = pack_batch_pointer(get_next_batch_link(batch)->load(std::memory_order_relaxed), top >> 48);
+		if (global_batches.compare_exchange_weak(top, new_top, std::memory_order_acquire, std::memory_order_acquire)) {
+			*batch_count = batch->link.batch_count;
+			return batch;
+		}
+	}
+
+	u32 pool_index = pool_count.load(std::memory_order_relaxed);
+	ASSERT_MSG(pool_index < POOL_MAX_POOLS, "Concurrent_Pool_Allocator::allocate_new_pool: The allocator is out of pools.");
+
+	u32 chunk_count = pool_size << (pool_index < POOL_MAX_GROWTH_SHIFT ? pool_index : POOL_MAX_GROWTH_SHIFT);
+	Memory_Pool<T> *new_pool = &memory_pools[pool_index];
+	new_pool->init(chunk_count);
+	next_batches[pool_index] = new std::atomic<Memory_Chunk<T> *>[chunk_count];
+	pool_count.store(pool_index + 1, std::memory_order_release);
+
+	Memory_Chunk<T> *chunks = new_pool->chunks;
+	for (u32 i = 0; i < chunk_count; i += POOL_MAGAZINE_SIZE) {
+		for (u32 j = i; j < (i + POOL_MAGAZINE_SIZE - 1); j++) {
+			chunks[j].link.next = &chunks[j + 1];
+		}
+		chunks[i + POOL_MAGAZINE_SIZE - 1].link.next = NULL;
+	}
+	// The first batch goes to the caller, the others to the global list.
+	for (u32 i = POOL_MAGAZINE_SIZE; i < chunk_count; i += POOL_MAGAZINE_SIZE) {
+		push_batch(&chunks[i], POOL_MAGAZINE_SIZE);
+	}
+	*batch_count = POOL_MAGAZINE_SIZE;
+	return chunks;
+}
+
+// A batch was pushed after its pool had been published, so a thread which sees the batch sees the pool too.
+// Pools grow, the newest pool is checked first.
+template<typename T>
+std::atomic<Memory_Chunk<T> *> *Concurrent_Pool_Allocator<T>::get_next_batch_link(Memory_Chunk<T> *batch)
+{
+	u32 count = pool_count.load(std::memory_order_acquire);
+	for (u32 i = count; i > 0; i--) {
+		Memory_Pool<T> *pool = &memory_pools[i - 1];
+		if (pool->owns(batch)) {
+			return &next_batches[i - 1][batch - pool->chunks];
+		}
+	}
+	ASSERT_MSG(false, "Concurrent_Pool_Allocator::get_next_batch_link: The allocator doesn't own the batch.");
+	return NULL;
 }
 #endif
@@ -2,9 +2,14 @@
 #include "os/file.h"
 #include "mesh_loader.h"
 #include "../sys/sys.h"
+#include "../sys/jobs.h"
 #include "../win32/win_time.h"
+#include "../libs/math/simd.h"
+#include "../libs/math/functions.h"
 #include "../libs/structures/hash_table.h"
 
+#include <string.h>
+
 #include <assimp/scene.h>
 #include <assimp/Importer.hpp>
 #include <assimp/postprocess.h>
@@ -12,11 +17,16 @@
 #include <assimp/LogStream.hpp>
 #include <assimp/DefaultLogger.hpp>
 
-static s32 unknown_model_name_count = 0;
-static String current_file_name;
 static const char *FOUR_SPACES = "    ";
-static Loading_Models_Options loading_options;
-static Loading_Models_Info loading_info;
+static const u32 MESH_CONVERSION_BATCH_SIZE = 16384;
+
+// The state of loading one file. Every call of load_models_from_file has its own context, so files can be loaded at the same time.
+struct Loading_Context {
+	s32 unknown_model_name_count = 0;
+	String file_name;
+	Loading_Models_Options options;
+	Loading_Models_Info info;
+};
 
 struct Assimp_Logger : Assimp::LogStream {
 	void write(const char *message)
@@ -25,19 +35,6 @@ struct Assimp_Logger : Assimp::LogStream {
 	}
 };
 
-static void begin_load_models()
-{
-	unknown_model_name_count = 0;
-	current_file_name.free();
-	loading_options.scene_logging = false;
-	loading_options.assimp_logging = false;
-	loading_options.use_scaling_value = false;
-
-	loading_info.model_count = 0;
-	loading_info.total_vertex_count = 0;
-	loading_info.total_index_count = 0;
-}
-
 inline Vector3 to_vector3(aiVector3t<float> &vector)
 {
 	return Vector3(vector.x, vector.y, vector.z);
@@ -58,15 +55,15 @@ inline void print_texture_info(aiMaterial *material, aiTextureType texture_type,
 	assert(material);
 
 	u32 texture_count = material->GetTextureCount(texture_type);
-	print("{}            {}:", spaces, texture_label);
-	print("{}                Count: {}", spaces, texture_count);
+	print_verbose("{}            {}:", spaces, texture_label);
+	print_verbose("{}                Count: {}", spaces, texture_count);
 	for (u32 i = 0; i < texture_count; i++) {
 		aiString path;
 		material->GetTexture(texture_type, i, &path);
 
 		String texture_file_name;
 		extract_file_name(path.C_Str(), texture_file_name);
-		print("{}                File name: {}", spaces, texture_file_name);
+		print_verbose("{}                File name: {}", spaces, texture_file_name);
 	}
 }
 
@@ -97,42 +94,42 @@ void print_nodes(aiScene *scene, aiNode *node, const aiMatrix4x4 &parent_node_ma
 	Vector3 r1 = to_vector3(rotation);
 	Vector3 p1 = to_vector3(position);
 
-	print("{}aiNode:", spaces);
-	print("{}    Name:", spaces, node->mName.C_Str());
-	print("{}    Child nodes number:", spaces, node->mNumChildren);
-	print("{}    Meshes number:", spaces, node->mNumMeshes);
+	print_verbose("{}aiNode:", spaces);
+	print_verbose("{}    Name:", spaces, node->mName.C_Str());
+	print_verbose("{}    Child nodes number:", spaces, node->mNumChildren);
+	print_verbose("{}    Meshes number:", spaces, node->mNumMeshes);
 	
-	print("{}    Itself matrix", spaces);
-	print("{}    Scaling: {}", spaces, &s);
-	print("{}    Rotation: {}", spaces, &r);
-	print("{}    Position: {}", spaces, &p);
+	print_verbose("{}    Itself matrix", spaces);
+	print_verbose("{}    Scaling: {}", spaces, &s);
+	print_verbose("{}    Rotation: {}", spaces, &r);
+	print_verbose("{}    Position: {}", spaces, &p);
 
-	print("{}    Inherited matrix", spaces);
-	print("{}    Scaling: {}", spaces, &s1);
-	print("{}    Rotation: {}", spaces, &r1);
-	print("{}    Position: {}", spaces, &p1);
+	print_verbose("{}    Inherited matrix", spaces);
+	print_verbose("{}    Scaling: {}", spaces, &s1);
+	print_verbose("{}    Rotation: {}", spaces, &r1);
+	print_verbose("{}    Position: {}", spaces, &p1);
 
 	if (node->mNumMeshes > 0) {
 		for (u32 i = 0; i < node->mNumMeshes; i++) {
 			u32 mesh_index = node->mMeshes[i];;
 			aiMesh *mesh = scene->mMeshes[mesh_index];
-			print("{}    Mesh: {}", spaces, mesh->mName.C_Str());
-			print("{}        Vertices number:", spaces, mesh->mNumVertices);
+			print_verbose("{}    Mesh: {}", spaces, mesh->mName.C_Str());
+			print_verbose("{}        Vertices number:", spaces, mesh->mNumVertices);
 			if (scene->HasMaterials()) {
-				print("{}        Material info:", spaces);
+				print_verbose("{}        Material info:", spaces);
 				aiMaterial *material = scene->mMaterials[mesh->mMaterialIndex];
 				aiString name;
 				name.Append("Unknown material name");
 				material->Get(AI_MATKEY_NAME, name);
-				print("{}            Name: {}", spaces, name.C_Str());
+				print_verbose("{}            Name: {}", spaces, name.C_Str());
 
 				float shininess = 0.0f;
 				material->Get(AI_MATKEY_SHININESS, shininess);
-				print("{}            Shininess: {}", spaces, shininess);
+				print_verbose("{}            Shininess: {}", spaces, shininess);
 
 				float shininess_strength = 1.0f;
 				material->Get(AI_MATKEY_SHININESS_STRENGTH, shininess_strength);
-				print("{}            Shininess strength: {}", spaces, shininess_strength);
+				print_verbose("{}            Shininess strength: {}", spaces, shininess_strength);
 
 				print_texture_info(material, aiTextureType_AMBIENT,      "Ambient textures",      spaces.c_str());
 				print_texture_info(material, aiTextureType_EMISSIVE,     "Emissive textures",     spaces.c_str());
@@ -160,14 +157,15 @@ void print_nodes(aiScene *scene, aiNode *node, const aiMatrix4x4 &parent_node_ma
 	}
 }
 
-inline void decompose_matrix(aiMatrix4x4 &matrix, Vector3 &s, Vector3 &r, Vector3 &p)
+inline void decompose_matrix(Loading_Context *context, aiMatrix4x4 &matrix, Vector3 &s, Vector3 &r, Vector3 &p)
 {
 	aiVector3t<float> scaling;
 	aiVector3t<float> rotation;
 	aiVector3t<float> position;
 	matrix.Decompose(scaling, rotation, position);
 
-	s = loading_options.use_scaling_value ? Vector3(loading_options.scaling_value, loading_options.scaling_value, loading_options.scaling_value) : to_vector3(scaling);
+	Loading_Models_Options *options = &context->options;
+	s = options->use_scaling_value ? Vector3(options->scaling_value, options->scaling_value, options->scaling_value) : to_vector3(scaling);
 	r = to_vector3(rotation);
 	p = to_vector3(position);
 }
@@ -184,45 +182,105 @@ inline bool get_texture_file_name(aiMaterial *material, aiTextureType texture_ty
 	return false;
 }
 
-inline void process_mesh(aiMesh *ai_mesh, Triangle_Mesh *mesh)
-{
-	for (u32 i = 0; i < ai_mesh->mNumVertices; i++) {
-		Vertex_PNTUV vertex;
-		vertex.position.x = ai_mesh->mVertices[i].x;
-		vertex.position.y = ai_mesh->mVertices[i].y;
-		vertex.position.z = ai_mesh->mVertices[i].z;
-
-		if (ai_mesh->HasTextureCoords(0)) {
-			vertex.uv.x = (float)ai_mesh->mTextureCoords[0][i].x;
-			vertex.uv.y = (float)ai_mesh->mTextureCoords[0][i].y;
-		}
+static_assert(sizeof(aiVector3D) == (3 * sizeof(float)), "Vertex conversion expects Assimp vectors of 3 floats.");
+static_assert(sizeof(Vertex_PNTUV) == (11 * sizeof(float)), "Vertex conversion expects a vertex of 11 floats.");
 
-		if (ai_mesh->HasNormals()) {
-			vertex.normal.x = ai_mesh->mNormals[i].x;
-			vertex.normal.y = ai_mesh->mNormals[i].y;
-			vertex.normal.z = ai_mesh->mNormals[i].z;
-		}
-		if (ai_mesh->HasTangentsAndBitangents()) {
-			vertex.tangent.x = ai_mesh->mTangents[i].x;
-			vertex.tangent.y = ai_mesh->mTangents[i].y;
-			vertex.tangent.z = ai_mesh->mTangents[i].z;
-		}
+static const float ZERO_VERTEX_ATTRIBUTE[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
 
-		mesh->vertices.push(vertex);
+// Where an attribute of vertices is read from. A missing attribute is read from zeros with the zero stride,
+// so all vertices of all meshes are converted by the same code without checking which attributes a mesh has.
+struct Vertex_Attribute_Stream {
+	const float *data = ZERO_VERTEX_ATTRIBUTE;
+	u32 stride = 0; // In floats.
+};
+
+inline Vertex_Attribute_Stream make_vertex_attribute_stream(aiVector3D *vectors)
+{
+	Vertex_Attribute_Stream stream;
+	if (vectors) {
+		stream.data = (const float *)vectors;
+		stream.stride = 3;
 	}
+	return stream;
+}
 
-	for (u32 i = 0; i < ai_mesh->mNumFaces; i++) {
-		aiFace face = ai_mesh->mFaces[i];
+// A vertex is written with four unaligned stores of 4 floats at the float offsets 0, 3, 6 and 9. The stores at 0, 3 and 6
+// write one float more than the attribute has and the next store overwrites it. The store at 9 writes the uv and the first
+// two floats of the next vertex, which the next iteration overwrites. A load of 4 floats reads past the attribute of the vertex
+// too, so the last vertex of a range is copied without SIMD, a range never writes to vertices of another range and
+// the loads never read past the end of the streams.
+static void convert_vertices(Vertex_Attribute_Stream *streams, Vertex_PNTUV *vertices, u32 first_vertex, u32 last_vertex)
+{
+	const Vertex_Attribute_Stream &positions = streams[0];
+	const Vertex_Attribute_Stream &normals = streams[1];
+	const Vertex_Attribute_Stream &tangents = streams[2];
+	const Vertex_Attribute_Stream &uvs = streams[3];
+
+	u32 i = first_vertex;
+	for (; (i + 1) < last_vertex; i++) {
+		float *vertex = (float *)&vertices[i];
+		Simd_Vector position = simd_load4(positions.data + i * positions.stride);
+		Simd_Vector normal = simd_load4(normals.data + i * normals.stride);
+		Simd_Vector tangent = simd_load4(tangents.data + i * tangents.stride);
+		Simd_Vector uv = simd_load4(uvs.data + i * uvs.stride);
+
+		simd_store4(vertex, position);
+		simd_store4(vertex + 3, normal);
+		simd_store4(vertex + 6, tangent);
+		simd_store4(vertex + 9, uv);
+	}
+	for (; i < last_vertex; i++) {
+		float *vertex = (float *)&vertices[i];
+		memcpy(vertex, positions.data + i * positions.stride, sizeof(float) * 3);
+		memcpy(vertex + 3, normals.data + i * normals.stride, sizeof(float) * 3);
+		memcpy(vertex + 6, tangents.data + i * tangents.stride, sizeof(float) * 3);
+		memcpy(vertex + 9, uvs.data + i * uvs.stride, sizeof(float) * 2);
+	}
+}
 
-		assert(face.mNumIndices == 3);
-		for (u32 j = 0; j < face.mNumIndices; j++) {
-			mesh->indices.push(face.mIndices[j]);
-		}
+// Assimp keeps indices of every face in a separate array, faces are triangles because of aiProcess_Triangulate.
+static void convert_indices(aiFace *faces, u32 *indices, u32 first_face, u32 last_face)
+{
+	for (u32 i = first_face; i < last_face; i++) {
+		assert(faces[i].mNumIndices == 3);
+		const u32 *face_indices = faces[i].mIndices;
+		u32 *triangle = &indices[i * 3];
+		triangle[0] = face_indices[0];
+		triangle[1] = face_indices[1];
+		triangle[2] = face_indices[2];
 	}
+}
 
-	loading_info.model_count++;
-	loading_info.total_vertex_count += mesh->vertices.count;
-	loading_info.total_index_count += mesh->indices.count;
+// Vertices and indices are placed in arrays of the final size and converted in batches on the job threads.
+void process_mesh(aiMesh *ai_mesh, Triangle_Mesh *mesh)
+{
+	Vertex_Attribute_Stream streams[4];
+	streams[0] = make_vertex_attribute_stream(ai_mesh->mVertices);
+	streams[1] = make_vertex_attribute_stream(ai_mesh->mNormals);
+	streams[2] = make_vertex_attribute_stream(ai_mesh->mTangents);
+	streams[3] = make_vertex_attribute_stream(ai_mesh->mTextureCoords[0]);
+
+	u32 vertex_count = ai_mesh->mNumVertices;
+	u32 face_count = ai_mesh->mNumFaces;
+	mesh->vertices.reserve(vertex_count);
+	mesh->indices.reserve(face_count * 3);
+
+	Vertex_PNTUV *vertices = mesh->vertices.items;
+	u32 *indices = mesh->indices.items;
+	u32 vertex_batch_count = (vertex_count + MESH_CONVERSION_BATCH_SIZE - 1) / MESH_CONVERSION_BATCH_SIZE;
+	u32 face_batch_count = (face_count + MESH_CONVERSION_BATCH_SIZE - 1) / MESH_CONVERSION_BATCH_SIZE;
+
+	parallel_for(vertex_batch_count + face_batch_count, 1, [&](u32 batch_index) {
+		if (batch_index < vertex_batch_count) {
+			u32 first_vertex = batch_index * MESH_CONVERSION_BATCH_SIZE;
+			u32 last_vertex = math::min(first_vertex + MESH_CONVERSION_BATCH_SIZE, vertex_count);
+			convert_vertices(streams, vertices, first_vertex, last_vertex);
+		} else {
+			u32 first_face = (batch_index - vertex_batch_count) * MESH_CONVERSION_BATCH_SIZE;
+			u32 last_face = math::min(first_face + MESH_CONVERSION_BATCH_SIZE, face_count);
+			convert_indices(ai_mesh->mFaces, indices, first_face, last_face);
+		}
+	});
 }
 
 inline void process_material(aiMaterial *material, Loading_Model *loading_model)
@@ -241,7 +299,13 @@ inline void process_material(aiMaterial *material, Loading_Model *loading_model)
 	get_texture_file_name(material, aiTextureType_DISPLACEMENT, loading_model->displacement_texture_name);
 }
 
-inline void process_nodes(aiScene *scene, aiNode *node, const aiMatrix4x4 &parent_matrix, Array<Loading_Model *> &models, Hash_Table<String, Loading_Model *> &models_cache)
+struct Unprocessed_Mesh {
+	aiMesh *assimp_mesh = NULL;
+	Loading_Model *loading_model = NULL;
+};
+
+// Meshes are only collected here, they are converted later on the job threads because converting doesn't depend on other meshes.
+inline void process_nodes(Loading_Context *context, aiScene *scene, aiNode *node, const aiMatrix4x4 &parent_matrix, Array<Loading_Model *> &models, Hash_Table<String, Loading_Model *> &models_cache, Array<Unprocessed_Mesh> &unprocessed_meshes)
 {
 	aiMatrix4x4 transform_matrix = node->mTransformation * parent_matrix;
 
@@ -254,15 +318,15 @@ inline void process_nodes(aiScene *scene, aiNode *node, const aiMatrix4x4 &paren
 		if (assimp_mesh->mName.length > 0) {
 			mesh_name.move(get_unique_name(assimp_mesh));
 		} else {
-			char *temp = format("{}_{}_{}_{}_{}", current_file_name, assimp_mesh->mNumVertices, assimp_mesh->mNumFaces, assimp_mesh->mPrimitiveTypes, unknown_model_name_count++);
+			char *temp = format("{}_{}_{}_{}_{}", context->file_name, assimp_mesh->mNumVertices, assimp_mesh->mNumFaces, assimp_mesh->mPrimitiveTypes, context->unknown_model_name_count++);
 			mesh_name.move(temp);
 			print("process_nodes: A model doesn't have a name. A name was generated for it.");
 		}
 		
 		Loading_Model *loading_model = NULL;
 		if (!models_cache.get(mesh_name, loading_model)) {
-			loading_model = new Loading_Model(mesh_name, current_file_name);
-			process_mesh(assimp_mesh, &loading_model->mesh);
+			loading_model = new Loading_Model(mesh_name, context->file_name);
+			unprocessed_meshes.push({ assimp_mesh, loading_model });
 			
 			if (scene->HasMaterials()) {
 				aiMaterial *material = scene->mMaterials[assimp_mesh->mMaterialIndex];
@@ -273,71 +337,98 @@ inline void process_nodes(aiScene *scene, aiNode *node, const aiMatrix4x4 &paren
 			models.push(loading_model);
 		}		
 		Loading_Model::Transformation transformation;
-		decompose_matrix(transform_matrix, transformation.scaling, transformation.rotation, transformation.translation);
+		decompose_matrix(context, transform_matrix, transformation.scaling, transformation.rotation, transformation.translation);
 		loading_model->instances.push(transformation);	
 	}
 	
 	for (u32 i = 0; i < node->mNumChildren; i++) {
-		process_nodes(scene, node->mChildren[i], transform_matrix, models, models_cache);
+		process_nodes(context, scene, node->mChildren[i], transform_matrix, models, models_cache, unprocessed_meshes);
 	}
 }
 
-bool load_models_from_file(const char *full_path_to_model_file, Array<Loading_Model *> &models, Loading_Models_Info *loading_models_info, Loading_Models_Options *options)
+static bool load_models(Loading_Context *context, const char *full_path_to_model_file, Array<Loading_Model *> &models)
 {
 	s64 start = milliseconds_counter();
-	begin_load_models();
+	extract_file_name(full_path_to_model_file, context->file_name);
 
-	if (options) {
-		loading_options = *options;
-	}
-
-	String file_name;
-	extract_file_name(full_path_to_model_file, file_name);
-
-	print("load_models_from_file Started to load {}.", file_name);
+	print("load_models_from_file Started to load {}.", context->file_name);
 
 	if (!file_exists(full_path_to_model_file)) {
-		print("load_models_from_file Failed to load. {} does not exist in model folder.", file_name);
+		print("load_models_from_file Failed to load. {} does not exist in model folder.", context->file_name);
 		return false;
 	}
 
-	if (loading_options.assimp_logging) {
-		Assimp::DefaultLogger::create("", Assimp::Logger::VERBOSE);
-		Assimp::DefaultLogger::get()->attachStream(new Assimp_Logger(), Assimp::Logger::Debugging | Assimp::Logger::Info | Assimp::Logger::Err | Assimp::Logger::Warn);
-	}
 	Assimp::Importer importer;
 	aiScene *scene = (aiScene *)importer.ReadFile(full_path_to_model_file, aiProcessPreset_TargetRealtime_Fast | aiProcess_ConvertToLeftHanded);
 
-	bool result = true;
-	if (!scene) {
-		print("load_models_from_file Failed to load a scene from {}.", file_name);
-		result = false;
+	if (!scene || !scene->mRootNode) {
+		print("load_models_from_file Failed to load a scene from {}.", context->file_name);
+		return false;
 	}
-	
-	if (scene && !scene->mRootNode) {
-		print("load_models_from_file Failed to load a scene from {}.", file_name);
-		result = false;
+	if (context->options.scene_logging) {
+		print_nodes(scene, scene->mRootNode, aiMatrix4x4());
 	}
-	
-	if (result) {
-		if (loading_options.scene_logging) {
-			print_nodes(scene, scene->mRootNode, aiMatrix4x4());
-		}
+	models.resize(scene->mNumMeshes);
 
-		current_file_name = file_name;
-		models.resize(scene->mNumMeshes);
+	Hash_Table<String, Loading_Model *> model_cache;
+	Array<Unprocessed_Mesh> unprocessed_meshes;
+	process_nodes(context, scene, scene->mRootNode, aiMatrix4x4(), models, model_cache, unprocessed_meshes);
 
-		Hash_Table<String, Loading_Model *> model_cache;
-		process_nodes(scene, scene->mRootNode, aiMatrix4x4(), models, model_cache);
+	parallel_for(unprocessed_meshes, [](Unprocessed_Mesh *unprocessed_mesh, u32 index) {
+		process_mesh(unprocessed_mesh->assimp_mesh, &unprocessed_mesh->loading_model->mesh);
+	}, 1);
 
-		print("load_models_from_file {} was successfully loaded. Loading time is {}ms.", file_name, milliseconds_counter() - start);
+	Unprocessed_Mesh *unprocessed_mesh = NULL;
+	For(unprocessed_meshes, unprocessed_mesh) {
+		context->info.model_count++;
+		context->info.total_vertex_count += unprocessed_mesh->loading_model->mesh.vertices.count;
+		context->info.total_index_count += unprocessed_mesh->loading_model->mesh.indices.count;
 	}
+	print("load_models_from_file {} was successfully loaded. Loading time is {}ms.", context->file_name, milliseconds_counter() - start);
+	return true;
+}
 
-	if (loading_models_info) {
-		*loading_models_info = loading_info;
+// The Assimp logger is global, so it is created once for all files which are loaded at the same time.
+static void begin_assimp_logging(Loading_Models_Options *options)
+{
+	if (options && options->assimp_logging) {
+		Assimp::DefaultLogger::create("", Assimp::Logger::VERBOSE);
+		Assimp::DefaultLogger::get()->attachStream(new Assimp_Logger(), Assimp::Logger::Debugging | Assimp::Logger::Info | Assimp::Logger::Err | Assimp::Logger::Warn);
 	}
+}
 
+static void end_assimp_logging()
+{
 	Assimp::DefaultLogger::kill();
+}
+
+bool load_models_from_file(const char *full_path_to_model_file, Array<Loading_Model *> &models, Loading_Models_Info *loading_models_info, Loading_Models_Options *options)
+{
+	Loading_Context context;
+	if (options) {
+		context.options = *options;
+	}
+	begin_assimp_logging(options);
+	bool result = load_models(&context, full_path_to_model_file, models);
+	end_assimp_logging();
 
+	if (loading_models_info) {
+		*loading_models_info = context.info;
+	}
 	return result;
 }
+
+// Every file is loaded by its own job, meshes of a file are converted by nested jobs.
+void load_models_from_files(Array<Loading_Models_File> &files, Loading_Models_Options *options)
+{
+	begin_assimp_logging(options);
+	parallel_for(files, [options](Loading_Models_File *file, u32 index) {
+		Loading_Context context;
+		if (options) {
+			context.options = *options;
+		}
+		file->loaded = load_models(&context, file->full_path, file->models);
+		file->info = context.info;
+	}, 1);
+	end_assimp_logging();
+}
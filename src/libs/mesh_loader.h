@@ -5,6 +5,7 @@
 #include "../render/mesh.h"
 #include "structures/array.h"
 
+struct aiMesh;
 
 struct Loading_Models_Info {
 	u32 model_count = 0;
@@ -13,10 +14,17 @@ struct Loading_Models_Info {
 };
 
 struct Loading_Models_Options {
-	bool scene_logging;
-	bool assimp_logging;
-	bool use_scaling_value;
-	float scaling_value;
+	bool scene_logging = false;
+	bool assimp_logging = false;
+	bool use_scaling_value = false;
+	float scaling_value = 1.0f;
+};
+
+struct Loading_Models_File {
+	bool loaded = false;
+	String full_path;
+	Loading_Models_Info info;
+	Array<Loading_Model *> models;
 };
 
 struct Scene_Loader {
@@ -44,6 +52,8 @@ struct Scene_Loader {
 };
 
 bool load_models_from_file(const char *full_path_to_model_file, Array<Loading_Model *> &models, Loading_Models_Info *loading_models_info = NULL, Loading_Models_Options *options = NULL);
+void load_models_from_files(Array<Loading_Models_File> &files, Loading_Models_Options *options = NULL);
+void process_mesh(aiMesh *ai_mesh, Triangle_Mesh *mesh);
 
 #endif
 
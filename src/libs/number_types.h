@@ -1,19 +1,23 @@
 #ifndef NUMBER_TYPES_H
 #define NUMBER_TYPES_H
 
+#include <stdint.h>
+#ifdef _WIN32
 #include <windows.h>
+#endif
 
-typedef UINT8    u8;
-typedef UINT16   u16;
-typedef UINT32   u32;
-typedef UINT64   u64;
+// The same types as UINT8..INT64 of Windows, so the sizes and overloads don't depend on the platform.
+typedef unsigned char      u8;
+typedef unsigned short     u16;
+typedef unsigned int       u32;
+typedef unsigned long long u64;
 
-typedef INT8    s8;
-typedef INT16   s16;
-typedef INT32   s32;
-typedef INT64   s64;
+typedef signed char s8;
+typedef short       s16;
+typedef int         s32;
+typedef long long   s64;
 
 typedef float  float32;
 typedef double float64;
 
-#endif
\ No newline at end of file
+#endif
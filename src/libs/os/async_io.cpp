@@ -0,0 +1,332 @@
+#include <assert.h>
+#include <mutex>
+#include <thread>
+
+#include "async_io.h"
+#include "../structures/queue.h"
+#include "../../sys/sys.h"
+#include "../../sys/jobs.h"
+#include "../../sys/profiling.h"
+
+struct Async_IO_Service {
+	bool initialized = false;
+	HANDLE completion_port = NULL;
+	std::thread *thread = NULL;
+
+	std::mutex mutex;
+	bool stop = false;
+	Queue<Async_IO_Request *> pending_requests[ASYNC_IO_PRIORITY_COUNT];
+
+	u32 started_request_count = 0; // Used only by the I/O thread.
+	Job_Counter callback_counter;
+};
+
+static Async_IO_Service async_io;
+
+static void print_last_error(const char *function_name, const char *full_path)
+{
+	char *error_message = get_error_message_from_error_code(GetLastError());
+	print("{}: Failed to read or write {}. {}", function_name, full_path, error_message);
+	free_string(error_message);
+}
+
+// A thread waiting for the request sees the results of the callback.
+static void run_callback_job(void *data, u32 first_index, u32 last_index)
+{
+	Async_IO_Request *request = (Async_IO_Request *)data;
+	request->callback(request);
+	request->status.store(ASYNC_IO_STATUS_DONE, std::memory_order_release);
+}
+
+static void close_request(Async_IO_Request *request, bool succeeded)
+{
+	if (request->file_handle != INVALID_HANDLE_VALUE) {
+		CloseHandle(request->file_handle);
+		request->file_handle = INVALID_HANDLE_VALUE;
+	}
+	if (!succeeded && request->allocated_buffer) {
+		DELETE_ARRAY(request->buffer);
+		request->allocated_buffer = false;
+	}
+	request->failed = !succeeded;
+}
+
+static void finish_request(Async_IO_Request *request, bool succeeded)
+{
+	close_request(request, succeeded);
+	if (request->callback) {
+		run_job(run_callback_job, (void *)request, &async_io.callback_counter);
+	} else {
+		request->status.store(ASYNC_IO_STATUS_DONE, std::memory_order_release);
+	}
+}
+
+static HANDLE open_request_file(Async_IO_Request *request, DWORD flags)
+{
+	bool read = request->operation == ASYNC_IO_READ;
+	DWORD access = read ? GENERIC_READ : GENERIC_WRITE;
+	DWORD share_mode = read ? FILE_SHARE_READ : 0;
+	DWORD creation = read ? OPEN_EXISTING : CREATE_ALWAYS;
+	return CreateFile(request->full_path, access, share_mode, NULL, creation, FILE_ATTRIBUTE_NORMAL | flags, NULL);
+}
+
+// Allocates the buffer for the rest of the file from the offset if a read request has no buffer.
+static bool allocate_read_buffer(Async_IO_Request *request, const char *function_name)
+{
+	if ((request->operation == ASYNC_IO_READ) && !request->buffer) {
+		LARGE_INTEGER file_size;
+		if (!GetFileSizeEx(request->file_handle, &file_size) || ((u64)file_size.QuadPart < request->offset) || (((u64)file_size.QuadPart - request->offset) >= UINT32_MAX)) {
+			print("{}: Failed to get the size of {} or the file is too big to be read at once.", function_name, request->full_path);
+			return false;
+		}
+		request->size = (u32)((u64)file_size.QuadPart - request->offset);
+		request->buffer = new u8[request->size + 1];
+		request->buffer[request->size] = 0;
+		request->allocated_buffer = true;
+	}
+	assert(request->buffer || (request->size == 0));
+	return true;
+}
+
+// Requests are run this way when the service was not initialized or has been shut down.
+// The callback is run on the submitting thread and the request is done when the function returns.
+static void run_request_synchronously(Async_IO_Request *request)
+{
+	bool read = request->operation == ASYNC_IO_READ;
+	bool succeeded = false;
+
+	request->file_handle = open_request_file(request, 0);
+	if (request->file_handle == INVALID_HANDLE_VALUE) {
+		print_last_error("run_request_synchronously", request->full_path);
+	} else if (allocate_read_buffer(request, "run_request_synchronously")) {
+		LARGE_INTEGER offset;
+		offset.QuadPart = (LONGLONG)request->offset;
+		DWORD transferred_size = 0;
+		if (SetFilePointerEx(request->file_handle, offset, NULL, FILE_BEGIN)) {
+			if (read) {
+				succeeded = ReadFile(request->file_handle, request->buffer, request->size, &transferred_size, NULL) == TRUE;
+			} else {
+				succeeded = WriteFile(request->file_handle, request->buffer, request->size, &transferred_size, NULL) == TRUE;
+			}
+		}
+		if (!succeeded) {
+			print_last_error("run_request_synchronously", request->full_path);
+		}
+		request->transferred_size = (u32)transferred_size;
+	}
+	close_request(request, succeeded);
+	if (request->callback) {
+		request->callback(request);
+	}
+	request->status.store(ASYNC_IO_STATUS_DONE, std::memory_order_release);
+}
+
+static void start_request(Async_IO_Request *request)
+{
+	bool read = request->operation == ASYNC_IO_READ;
+
+	request->file_handle = open_request_file(request, FILE_FLAG_OVERLAPPED);
+	if (request->file_handle == INVALID_HANDLE_VALUE) {
+		print_last_error("start_request", request->full_path);
+		finish_request(request, false);
+		return;
+	}
+	if (!allocate_read_buffer(request, "start_request")) {
+		finish_request(request, false);
+		return;
+	}
+
+	if (!CreateIoCompletionPort(request->file_handle, async_io.completion_port, (ULONG_PTR)request, 0)) {
+		print_last_error("start_request", request->full_path);
+		finish_request(request, false);
+		return;
+	}
+	ZeroMemory(&request->overlapped, sizeof(OVERLAPPED));
+	request->overlapped.Offset = (DWORD)(request->offset & 0xffffffff);
+	request->overlapped.OffsetHigh = (DWORD)(request->offset >> 32);
+
+	// The completion port gets a completion packet even if the operation finishes at once.
+	BOOL result = FALSE;
+	if (read) {
+		result = ReadFile(request->file_handle, request->buffer, request->size, NULL, &request->overlapped);
+	} else {
+		result = WriteFile(request->file_handle, request->buffer, request->size, NULL, &request->overlapped);
+	}
+	if (!result) {
+		DWORD error_code = GetLastError();
+		if (error_code == ERROR_HANDLE_EOF) {
+			// The offset is past the end of the file, nothing was read.
+			finish_request(request, true);
+			return;
+		}
+		if (error_code != ERROR_IO_PENDING) {
+			print_last_error("start_request", request->full_path);
+			finish_request(request, false);
+			return;
+		}
+	}
+	async_io.started_request_count++;
+}
+
+static void complete_request(Async_IO_Request *request)
+{
+	DWORD transferred_size = 0;
+	BOOL result = GetOverlappedResult(request->file_handle, &request->overlapped, &transferred_size, FALSE);
+	if (!result && (GetLastError() == ERROR_HANDLE_EOF)) {
+		result = TRUE;
+	}
+	if (!result) {
+		print_last_error("complete_request", request->full_path);
+	}
+	request->transferred_size = (u32)transferred_size;
+	async_io.started_request_count--;
+	finish_request(request, result == TRUE);
+}
+
+// Requests are taken from the queues under the lock and started without it, so opening files doesn't block submitting threads.
+// Returns false if the service is stopping.
+static bool start_pending_requests()
+{
+	u32 request_count = 0;
+	Async_IO_Request *requests[ASYNC_IO_MAX_STARTED_REQUEST_COUNT];
+	{
+		std::lock_guard<std::mutex> lock(async_io.mutex);
+		if (async_io.stop) {
+			return false;
+		}
+		for (u32 priority = 0; priority < ASYNC_IO_PRIORITY_COUNT; priority++) {
+			Queue<Async_IO_Request *> *pending_requests = &async_io.pending_requests[priority];
+			while (!pending_requests->empty() && ((async_io.started_request_count + request_count) < ASYNC_IO_MAX_STARTED_REQUEST_COUNT)) {
+				requests[request_count++] = pending_requests->front();
+				pending_requests->pop();
+			}
+		}
+	}
+	for (u32 i = 0; i < request_count; i++) {
+		start_request(requests[i]);
+	}
+	return true;
+}
+
+// Completion packets without an overlapped structure only wake up the thread.
+static void run_async_io_thread()
+{
+	set_profile_thread_name("I/O thread");
+	if (!attach_job_thread()) {
+		print("run_async_io_thread: The I/O thread could not attach to the job system, callbacks will be run on the I/O thread.");
+	}
+	OVERLAPPED_ENTRY entries[ASYNC_IO_MAX_COMPLETION_BATCH_SIZE];
+	while (true) {
+		bool running = start_pending_requests();
+		if (!running && (async_io.started_request_count == 0)) {
+			break;
+		}
+		ULONG entry_count = 0;
+		if (!GetQueuedCompletionStatusEx(async_io.completion_port, entries, ASYNC_IO_MAX_COMPLETION_BATCH_SIZE, &entry_count, INFINITE, FALSE)) {
+			continue;
+		}
+		for (ULONG i = 0; i < entry_count; i++) {
+			if (entries[i].lpOverlapped) {
+				complete_request((Async_IO_Request *)entries[i].lpCompletionKey);
+			}
+		}
+	}
+	{
+		std::lock_guard<std::mutex> lock(async_io.mutex);
+		for (u32 priority = 0; priority < ASYNC_IO_PRIORITY_COUNT; priority++) {
+			Queue<Async_IO_Request *> *pending_requests = &async_io.pending_requests[priority];
+			while (!pending_requests->empty()) {
+				finish_request(pending_requests->front(), false);
+				pending_requests->pop();
+			}
+		}
+	}
+	wait_for_counter(&async_io.callback_counter);
+	detach_job_thread();
+}
+
+void init_async_io()
+{
+	assert(!async_io.initialized);
+
+	async_io.completion_port = CreateIoCompletionPort(INVALID_HANDLE_VALUE, NULL, 0, 1);
+	if (!async_io.completion_port) {
+		print("init_async_io: Failed to create an I/O completion port, requests will be run synchronously.");
+		return;
+	}
+	async_io.stop = false;
+	async_io.initialized = true;
+	async_io.thread = new std::thread(run_async_io_thread);
+}
+
+// Requests which were submitted but not started fail.
+void shutdown_async_io()
+{
+	if (!async_io.initialized) {
+		return;
+	}
+	{
+		std::lock_guard<std::mutex> lock(async_io.mutex);
+		async_io.stop = true;
+	}
+	PostQueuedCompletionStatus(async_io.completion_port, 0, 0, NULL);
+
+	async_io.thread->join();
+	DELETE_PTR(async_io.thread);
+	CloseHandle(async_io.completion_port);
+	async_io.completion_port = NULL;
+	async_io.initialized = false;
+}
+
+void submit_async_io(Async_IO_Request *request)
+{
+	submit_async_io(&request, 1);
+}
+
+static void reset_request(Async_IO_Request *request)
+{
+	assert(request->priority < ASYNC_IO_PRIORITY_COUNT);
+	assert(request->status.load(std::memory_order_relaxed) != ASYNC_IO_STATUS_PENDING);
+
+	request->failed = false;
+	request->transferred_size = 0;
+	request->allocated_buffer = false;
+	request->status.store(ASYNC_IO_STATUS_PENDING, std::memory_order_relaxed);
+}
+
+// Requests of a batch are queued under one lock and the I/O thread is woken up once.
+// Without the I/O thread the requests are run synchronously in the order of their priorities.
+void submit_async_io(Async_IO_Request **requests, u32 request_count)
+{
+	if (!async_io.initialized) {
+		for (u32 priority = 0; priority < ASYNC_IO_PRIORITY_COUNT; priority++) {
+			for (u32 i = 0; i < request_count; i++) {
+				if (requests[i]->priority == priority) {
+					reset_request(requests[i]);
+					run_request_synchronously(requests[i]);
+				}
+			}
+		}
+		return;
+	}
+	{
+		std::lock_guard<std::mutex> lock(async_io.mutex);
+		for (u32 i = 0; i < request_count; i++) {
+			reset_request(requests[i]);
+			async_io.pending_requests[requests[i]->priority].push(requests[i]);
+		}
+	}
+	PostQueuedCompletionStatus(async_io.completion_port, 0, 0, NULL);
+}
+
+// The waiting thread runs jobs until the request is done.
+void wait_for_async_io(Async_IO_Request *request)
+{
+	assert(request->status.load(std::memory_order_relaxed) != ASYNC_IO_STATUS_NOT_SUBMITTED);
+
+	while (!request->is_done()) {
+		if (!run_queued_job()) {
+			std::this_thread::yield();
+		}
+	}
+}
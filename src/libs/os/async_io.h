@@ -0,0 +1,88 @@
+#ifndef ASYNC_IO_H
+#define ASYNC_IO_H
+
+#include <atomic>
+#include <windows.h>
+
+#include "../str.h"
+#include "../number_types.h"
+#include "../../sys/utils.h"
+
+const u32 ASYNC_IO_MAX_STARTED_REQUEST_COUNT = 32;
+const u32 ASYNC_IO_MAX_COMPLETION_BATCH_SIZE = 16;
+
+enum Async_IO_Operation {
+	ASYNC_IO_READ,
+	ASYNC_IO_WRITE
+};
+
+enum Async_IO_Priority {
+	ASYNC_IO_PRIORITY_HIGH,
+	ASYNC_IO_PRIORITY_NORMAL,
+	ASYNC_IO_PRIORITY_LOW,
+	ASYNC_IO_PRIORITY_COUNT
+};
+
+enum Async_IO_Status : u32 {
+	ASYNC_IO_STATUS_NOT_SUBMITTED,
+	ASYNC_IO_STATUS_PENDING,
+	ASYNC_IO_STATUS_DONE
+};
+
+struct Async_IO_Request;
+typedef void (*Async_IO_Callback)(Async_IO_Request *request);
+
+// A request must stay alive until it is done. A read reads size bytes from offset into buffer. If buffer is NULL
+// the service allocates it with new[] for the rest of the file from offset and puts the zero at the end (like read_entire_file),
+// after the request is done the buffer belongs to the owner of the request. A write replaces the file with size bytes of buffer.
+struct Async_IO_Request {
+	Async_IO_Request() {}
+	~Async_IO_Request() {}
+
+	Async_IO_Operation operation = ASYNC_IO_READ;
+	Async_IO_Priority priority = ASYNC_IO_PRIORITY_NORMAL;
+	String full_path;
+	u64 offset = 0;
+	u8 *buffer = NULL;
+	u32 size = 0;
+
+	// Called on a job thread after the operation, the request is done when the callback returns.
+	Async_IO_Callback callback = NULL;
+	void *user_data = NULL;
+
+	// Set before the callback is called.
+	bool failed = false;
+	u32 transferred_size = 0;
+	std::atomic<u32> status = ASYNC_IO_STATUS_NOT_SUBMITTED;
+
+	// Used by the service.
+	bool allocated_buffer = false;
+	HANDLE file_handle = INVALID_HANDLE_VALUE;
+	OVERLAPPED overlapped;
+
+	DELETE_COPING(Async_IO_Request)
+
+	bool is_done();
+	bool succeeded();
+};
+
+inline bool Async_IO_Request::is_done()
+{
+	return status.load(std::memory_order_acquire) == ASYNC_IO_STATUS_DONE;
+}
+
+inline bool Async_IO_Request::succeeded()
+{
+	return is_done() && !failed;
+}
+
+// The I/O thread starts requests in the order of their priorities and waits for them on an I/O completion port,
+// no more than ASYNC_IO_MAX_STARTED_REQUEST_COUNT requests are started at once, so a request with a high priority
+// doesn't wait for a long batch with a lower priority. Callbacks are run on the job threads.
+// If the service failed to initialize or has been shut down, submit_async_io runs requests synchronously.
+void init_async_io();
+void shutdown_async_io();
+void submit_async_io(Async_IO_Request *request);
+void submit_async_io(Async_IO_Request **requests, u32 request_count);
+void wait_for_async_io(Async_IO_Request *request);
+#endif
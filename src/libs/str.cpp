@@ -13,18 +13,6 @@
 #define MAX_DIGITS_IN_INT 12
 #define MAX_DIGITS_IN_LONG_LONG 21
 
-#define bytes_of(type, count) (sizeof(type) * count)
-
-#define COPY_STRING_TO_CHAR_ARRAY(string, char_array) {\
-	u32 s_len = (u32)strlen(string); \
-	while ((char_array->size - char_array->count) < s_len) { \
-		char_array->resize(char_array->size * 2);\
-	} \
-	char *symbol = &char_array->get(char_array->count); \
-	memcpy(symbol, string, bytes_of(char, s_len));\
-	char_array->count += s_len; \
-}
-
 void free_string(const char *string)
 {
 	delete[] string;
@@ -36,12 +24,10 @@ void free_string(const wchar_t *string)
 	DELETE_ARRAY(string);
 }
 
-void format_(Array<char *> *array) {}
-
 void split(const char *string, const char *characters, Array<char *> *array)
 {
 	// string copy is needed so that char array don't point on the same memory location and don't free it 
-	char *string_copy = _strdup(string);
+	char *string_copy = to_string(string);
 	char *next = NULL;
 	array->clear();
 
@@ -111,63 +97,6 @@ bool is_alphabet(const char *string)
 	return true;
 }
 
-static void _format_string(const char *format_string, Array<char> *formatting_string, Array<char *> *vars)
-{
-	assert(format_string);
-	assert(formatting_string);
-	assert(vars);
-
-	u32 var_index = 0;
-	const char *f_string = format_string;
-
-	while (*f_string) {
-		if (*f_string == '}') {
-			f_string++;
-			continue;
-		}
-		if (*f_string == '{') {
-			if (!strcmp(vars->items[var_index], "")) {
-				var_index++;
-				f_string++;
-				continue;
-			}
-			COPY_STRING_TO_CHAR_ARRAY(vars->items[var_index], formatting_string);
-			var_index++;
-		} else {
-			formatting_string->push(*f_string);
-		}
-		f_string++;
-	}
-}
-
-char *__do_formatting(Array<char *> *strings)
-{
-	Array<char>   formatting_string;
-	Array<char *> vars_buffer;
-
-	for (u32 i = 0; i < strings->count; i++) {
-		char *string = strings->get(i);
-		int result = is_format_string(string);
-		if (result) {
-			assert(strings->count >= (u32)result);
-			int var_index = i + 1;
-			for (int j = 0; j < result; j++, i++) {
-				vars_buffer.push(strings->get(var_index++));
-			}
-			_format_string(string, &formatting_string, &vars_buffer);
-			vars_buffer.clear();
-			formatting_string.push(' ');
-		} else {
-			// Append string in buffer without needs for formatting
-			COPY_STRING_TO_CHAR_ARRAY(string, ((Array<char> *) & formatting_string));
-			formatting_string.push(' ');
-		}
-	}
-	// Rewrite last not needed space
-	formatting_string[formatting_string.count - 1] = '\0';
-	return _strdup(formatting_string.items);
-}
-
 char *concatenate_c_str(const char *str1, const char *str2)
 {
 	u32 str1_len = (s32)strlen(str1);
@@ -296,9 +225,15 @@ char *to_string(char c)
 	return str;
 }
 
+// Strings are freed by free_string, so the copy is made with new.
 char *to_string(const char *string)
 {
-	return _strdup(string);
+	assert(string);
+
+	size_t len = strlen(string);
+	char *str = new char[len + 1];
+	memcpy(str, string, len + 1);
+	return str;
 }
 
 wchar_t *to_wstring(const char *string)
@@ -376,33 +311,20 @@ char *to_string(Point_s32 *point)
 	return format("Point_s32({}, {})", point->x, point->y);
 }
 
-// Check the string has format braces if it has return number of braces 
-// if not return 0 and it means that this string is not format string 
-int is_format_string(const char *string)
+String::~String()
 {
-	assert(string);
-
-	int count = 0;
-	const char *str = string;
-
-	while (*str) {
-		if (*str == '{' && *(str + 1) == '}') {
-			count++;
-		}
-		str++;
-	}
-	return count;
+	free_chars();
 }
 
-String::~String()
+String::String(Allocator *_allocator)
 {
-	DELETE_ARRAY(data);
+	allocator = _allocator;
 }
 
 String::String(char _char)
 {
 	len = 1;
-	data = new char[2];
+	data = allocate_chars(2);
 	data[0] = _char;
 	data[1] = '\0';
 }
@@ -444,14 +366,25 @@ String::String(const String &string, u32 start, u32 end)
 
 String::String(const String *other)
 {
-	DELETE_ARRAY(data);
-	allocate_and_copy_string(other->data);
+	if (other->data) {
+		allocate_and_copy_string(other->data);
+	}
 }
 
 String::String(const String &other)
 {
-	DELETE_ARRAY(data);
-	allocate_and_copy_string(other.data);
+	if (other.data) {
+		allocate_and_copy_string(other.data);
+	}
+}
+
+String::String(String &&other)
+{
+	data = other.data;
+	len = other.len;
+	allocator = other.allocator;
+	other.data = NULL;
+	other.len = 0;
 }
 
 String &String::operator=(const char *string)
@@ -462,7 +395,7 @@ String &String::operator=(const char *string)
 		return *this;
 	}
 
-	DELETE_ARRAY(data);
+	free_chars();
 	allocate_and_copy_string(string);
 	return *this;
 }
@@ -478,17 +411,52 @@ String &String::operator=(const String &other)
 		return *this;
 	}
 
-	DELETE_ARRAY(data);
+	free_chars();
 	allocate_and_copy_string(other.data);
 	return *this;
 }
 
+String &String::operator=(String &&other)
+{
+	if (this == &other) {
+		return *this;
+	}
+	free_chars();
+	data = other.data;
+	len = other.len;
+	allocator = other.allocator;
+	other.data = NULL;
+	other.len = 0;
+	return *this;
+}
+
 void String::free()
 {
-	DELETE_ARRAY(data);
+	free_chars();
 	len = 0;
 }
 
+void String::free_chars()
+{
+	if (data) {
+		if (allocator) {
+			allocator->free(data);
+		} else {
+			delete[] data;
+		}
+		data = NULL;
+	}
+}
+
+char *String::allocate_chars(u32 char_count)
+{
+	if (allocator) {
+		return (char *)allocator->allocate(char_count, 1);
+	}
+	MEMORY_TAG_SCOPE(MEMORY_TAG_STRINGS);
+	return new char[char_count];
+}
+
 void String::print()
 {
 	::print(data);
@@ -523,9 +491,9 @@ void String::insert(u32 index, char c)
 
 	String *copied_str = copy();
 
-	DELETE_PTR(data);
+	free_chars();
 
-	data = new char[len + 2]; // allocate place for new char and \0
+	data = allocate_chars(len + 2); // allocate place for new char and \0
 
 	char *first_part_dest_str = data;
 	char *first_part_src_str = copied_str->data;
@@ -551,15 +519,15 @@ void String::remove(u32 index)
 
 	if (len == 1) {
 		len = 0;
-		data = NULL;
+		free_chars();
 		return;
 	}
 
 	String *copied_str = copy();
 
-	DELETE_PTR(data);
+	free_chars();
 
-	data = new char[len]; //decrease len of string on 1
+	data = allocate_chars(len); //decrease len of string on 1
 
 	char *first_part_dest_str = data;
 	char *first_part_src_str = copied_str->data;
@@ -618,13 +586,13 @@ void String::append(const char *string)
 	}
 
 	u32 new_len = len + (u32)strlen(string);
-	char *new_string = new char[new_len + 1];
+	char *new_string = allocate_chars(new_len + 1);
 
 	memset(new_string, 0, sizeof(char) * new_len + 1);
 	strcat_s(new_string, new_len + 1, data);
 	strcat_s(new_string, new_len + 1, string);
 
-	DELETE_ARRAY(data);
+	free_chars();
 
 	data = new_string;
 	len = new_len;
@@ -637,8 +605,8 @@ void String::append(const String &string)
 
 void String::allocate(u32 char_count)
 {
-	DELETE_ARRAY(data);
-	data = new char[char_count];
+	free_chars();
+	data = allocate_chars(char_count);
 	len = char_count;
 }
 
@@ -649,7 +617,7 @@ void String::allocate_and_copy_string(const char *string)
 
 	int string_len = (u32)strlen(string);
 	len = string_len;
-	data = new char[string_len + 1];
+	data = allocate_chars(string_len + 1);
 	memcpy(data, string, sizeof(char) * (string_len + 1));
 }
 
@@ -701,12 +669,12 @@ void String::copy(const String &string, u32 start, u32 end)
 {
 	u32 string_len = end - start;
 	if (string_len > 0) {
-		DELETE_ARRAY(data);
+		free_chars();
 		len = string_len;
 		const char *ptr = string.data;
 		ptr += start;
 
-		data = new char[string_len + 1];
+		data = allocate_chars(string_len + 1);
 		memcpy(data, ptr, sizeof(char) * string_len);
 		data[string_len] = '\0';
 	}
@@ -716,10 +684,16 @@ void String::move(char *string)
 {
 	assert(string);
 
-	DELETE_ARRAY(data);
+	free_chars();
 	len = 0;
 	u32 temp = (u32)strlen(string);
 	if (temp > 0) {
+		if (allocator) {
+			// The string was allocated with new, its characters have to be copied to the allocator memory.
+			allocate_and_copy_string(string);
+			free_string(string);
+			return;
+		}
 		data = string;
 		len = temp;
 	}
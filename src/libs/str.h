@@ -5,15 +5,20 @@
 #include "math/matrix.h"
 #include "math/structures.h"
 #include "structures/array.h"
+#include "memory/base.h"
+#include "string_id.h"
 
-typedef u32 String_Id;
-
+// If a string has an allocator its characters are taken from it, otherwise from the heap.
+// A copy of a string always goes to the heap, a moved string takes the allocator with its characters.
 struct String {
 	String() {}
 	~String();
 
 	char *data = NULL;
 	u32 len = 0;
+	Allocator *allocator = NULL;
+
+	explicit String(Allocator *_allocator);
 
 	explicit String(char _char);
 	explicit String(int number);
@@ -21,6 +26,7 @@ struct String {
 	String(const char *string);
 	String(const String *other);
 	String(const String &other);
+	String(String &&other);
 	String(const char *string, u32 start, u32 end);
 	String(const String &string, u32 start, u32 end);
 
@@ -29,8 +35,10 @@ struct String {
 
 	String &operator=(const char *string);
 	String &operator=(const String &other);
+	String &operator=(String &&other);
 
 	void free();
+	void free_chars();
 	void print();
 	void to_lower();
 	void pop_char();
@@ -43,6 +51,7 @@ struct String {
 	void append(const String &string);
 	void append(const String *string);
 	void allocate(u32 char_count);
+	char *allocate_chars(u32 char_count);
 	void allocate_and_copy_string(const char *string);
 	void place_end_char();
 	void copy(const String &string, u32 start, u32 end);
@@ -72,7 +81,6 @@ inline bool operator<=(const String &first, const String &second);
 void free_string(const char *string);
 void free_string(const wchar_t *string);
 
-void format_(Array<char *> *array);
 void split(const char *string, const char *characters, Array<char *> *array);
 void to_upper_first_letter(String *string);
 
@@ -112,35 +120,6 @@ char *to_string(Rect_f32 *rect);
 
 char *to_string(Point_s32 *point);
 
-int is_format_string(const char *string);
-
-template <typename First, typename... Args>
-void format_(Array<char *> *array, First first, Args... args)
-{
-	char *temp = to_string(first);
-	array->push(temp);
-	format_(array, args...);
-}
-
-char *__do_formatting(Array<char *> *strings);
-
-template <typename... Args>
-char *format(Args... args)
-{
-	Array<char *> strings;
-	format_(&strings, args...);
-	return __do_formatting(&strings);
-}
-
-template <typename... Args>
-String format_string(Args... args)
-{
-	Array<char *> strings;
-	format_(&strings, args...);
-	String string;
-	string.move(__do_formatting(&strings));
-	return string;
-}
 
 inline String::operator const char *()
 {
@@ -227,5 +206,7 @@ inline void String::append(const String *string)
 {
 	append(string->data);
 }
-#endif
 
+// The formatter needs String, so it is included after it.
+#include "format.h"
+#endif
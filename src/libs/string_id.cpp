@@ -0,0 +1,198 @@
+#include <string.h>
+#include <mutex>
+#include <shared_mutex>
+
+#include "string_id.h"
+#include "../sys/sys.h"
+#include "structures/array.h"
+#include "structures/hash_table.h"
+
+const u32 STRING_INTERN_SHARD_COUNT = 16;
+const u32 STRING_INTERN_BLOCK_SIZE = 64 * 1024;
+
+// FNV-1a with the MurmurHash3 64 bit finalizer on top.
+struct String_Id_Hasher {
+	u64 state = 0xcbf29ce484222325ull;
+
+	void add(const char *string, u32 len);
+	String_Id finish();
+};
+
+inline void String_Id_Hasher::add(const char *string, u32 len)
+{
+	for (u32 i = 0; i < len; i++) {
+		state ^= (u8)string[i];
+		state *= 0x100000001b3ull;
+	}
+}
+
+inline String_Id String_Id_Hasher::finish()
+{
+	u64 key = state;
+	key ^= key >> 33;
+	key *= 0xff51afd7ed558ccdull;
+	key ^= key >> 33;
+	key *= 0xc4ceb9fe1a85ec53ull;
+	key ^= key >> 33;
+	// The empty string id is reserved.
+	return (key != EMPTY_STRING_ID) ? key : 1;
+}
+
+// Strings are split between shards by ids, so threads interning different strings rarely wait for each other.
+// Characters are copied into big blocks which are never freed while the program runs,
+// so pointers returned by get_interned_string stay valid.
+struct String_Intern_Shard {
+	~String_Intern_Shard();
+
+	u32 block_offset = STRING_INTERN_BLOCK_SIZE;
+	std::shared_mutex mutex;
+	Array<char *> blocks;
+	Hash_Table<String_Id, const char *> strings;
+
+	char *copy_string(u32 len, const char **parts, u32 *part_lens, u32 part_count);
+};
+
+String_Intern_Shard::~String_Intern_Shard()
+{
+	for (u32 i = 0; i < blocks.count; i++) {
+		free_memory(NULL, blocks[i]);
+	}
+}
+
+char *String_Intern_Shard::copy_string(u32 len, const char **parts, u32 *part_lens, u32 part_count)
+{
+	char *string = NULL;
+	if ((len + 1) > STRING_INTERN_BLOCK_SIZE) {
+		string = (char *)allocate_memory(NULL, len + 1, 1);
+		blocks.push(string);
+		// The string fills its block, the next string starts a new one.
+		block_offset = STRING_INTERN_BLOCK_SIZE;
+	} else {
+		if ((block_offset + len + 1) > STRING_INTERN_BLOCK_SIZE) {
+			blocks.push((char *)allocate_memory(NULL, STRING_INTERN_BLOCK_SIZE, 1));
+			block_offset = 0;
+		}
+		string = blocks.last() + block_offset;
+		block_offset += len + 1;
+	}
+	u32 offset = 0;
+	for (u32 i = 0; i < part_count; i++) {
+		memcpy(string + offset, parts[i], part_lens[i]);
+		offset += part_lens[i];
+	}
+	string[len] = '\0';
+	return string;
+}
+
+static String_Intern_Shard *get_shard(String_Id string_id)
+{
+	static String_Intern_Shard shards[STRING_INTERN_SHARD_COUNT];
+	return &shards[(string_id >> 60) % STRING_INTERN_SHARD_COUNT];
+}
+
+static bool compare_parts(const char *string, const char **parts, u32 *part_lens, u32 part_count)
+{
+	for (u32 i = 0; i < part_count; i++) {
+		if (strncmp(string, parts[i], part_lens[i])) {
+			return false;
+		}
+		string += part_lens[i];
+	}
+	return *string == '\0';
+}
+
+static String_Id intern_parts(const char **parts, u32 *part_lens, u32 part_count)
+{
+	u32 len = 0;
+	String_Id_Hasher hasher;
+	for (u32 i = 0; i < part_count; i++) {
+		hasher.add(parts[i], part_lens[i]);
+		len += part_lens[i];
+	}
+	if (len == 0) {
+		return EMPTY_STRING_ID;
+	}
+	String_Id string_id = hasher.finish();
+	String_Intern_Shard *shard = get_shard(string_id);
+
+	const char *interned_string = NULL;
+	{
+		std::shared_lock<std::shared_mutex> lock(shard->mutex);
+		shard->strings.get(string_id, interned_string);
+	}
+	if (!interned_string) {
+		std::unique_lock<std::shared_mutex> lock(shard->mutex);
+		// Another thread could have interned the string while this one was waiting for the lock.
+		if (!shard->strings.get(string_id, interned_string)) {
+			MEMORY_TAG_SCOPE(MEMORY_TAG_STRINGS);
+			shard->strings.set(string_id, shard->copy_string(len, parts, part_lens, part_count));
+			return string_id;
+		}
+	}
+	if (!compare_parts(interned_string, parts, part_lens, part_count)) {
+		print("intern_string: Strings '{}' and '{}' have the same id {}.", parts[0], interned_string, string_id);
+		ASSERT_MSG(false, "intern_string: The string id collision.");
+	}
+	return string_id;
+}
+
+String_Id make_string_id(const char *string)
+{
+	return string ? make_string_id(string, (u32)strlen(string)) : EMPTY_STRING_ID;
+}
+
+String_Id make_string_id(const char *string, u32 len)
+{
+	if (!string || (len == 0)) {
+		return EMPTY_STRING_ID;
+	}
+	String_Id_Hasher hasher;
+	hasher.add(string, len);
+	return hasher.finish();
+}
+
+String_Id intern_string(const char *string)
+{
+	return string ? intern_string(string, (u32)strlen(string)) : EMPTY_STRING_ID;
+}
+
+String_Id intern_string(const char *string, u32 len)
+{
+	if (!string) {
+		return EMPTY_STRING_ID;
+	}
+	return intern_parts(&string, &len, 1);
+}
+
+// Interns first + separator + second without building the joined string,
+// characters are copied only when the string is interned the first time.
+String_Id intern_joined_string(const char *first, const char *separator, const char *second)
+{
+	const char *parts[3] = { first ? first : "", separator ? separator : "", second ? second : "" };
+	u32 part_lens[3] = { (u32)strlen(parts[0]), (u32)strlen(parts[1]), (u32)strlen(parts[2]) };
+	return intern_parts(parts, part_lens, 3);
+}
+
+const char *get_interned_string(String_Id string_id)
+{
+	if (string_id == EMPTY_STRING_ID) {
+		return "";
+	}
+	const char *interned_string = NULL;
+	String_Intern_Shard *shard = get_shard(string_id);
+
+	std::shared_lock<std::shared_mutex> lock(shard->mutex);
+	shard->strings.get(string_id, interned_string);
+	return interned_string;
+}
+
+u32 get_interned_string_count()
+{
+	u32 count = 0;
+	for (u32 i = 0; i < STRING_INTERN_SHARD_COUNT; i++) {
+		String_Intern_Shard *shard = get_shard((u64)i << 60);
+		std::shared_lock<std::shared_mutex> lock(shard->mutex);
+		count += shard->strings.count;
+	}
+	return count;
+}
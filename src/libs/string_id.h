@@ -0,0 +1,22 @@
+#ifndef STRING_ID_H
+#define STRING_ID_H
+
+#include "number_types.h"
+
+// An id of a string is a 64 bit hash of its characters, so it is the same between runs
+// and can be saved in files. The intern table keeps one copy of every interned string
+// and reports a collision when two different strings get the same id.
+typedef u64 String_Id;
+
+const String_Id EMPTY_STRING_ID = 0;
+
+String_Id make_string_id(const char *string);
+String_Id make_string_id(const char *string, u32 len);
+
+// The intern functions can be called from any thread.
+String_Id intern_string(const char *string);
+String_Id intern_string(const char *string, u32 len);
+String_Id intern_joined_string(const char *first, const char *separator, const char *second);
+const char *get_interned_string(String_Id string_id);
+u32 get_interned_string_count();
+#endif
@@ -1,28 +1,45 @@
 #ifndef ARRAY_H
 #define ARRAY_H
 
+#include <new>
+#include <utility>
+#include <type_traits>
 #include <assert.h>
 #include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include "../number_types.h"
+#include "../memory/base.h"
 
 #define ARRAY_SIZE(arr) (sizeof(arr) / sizeof((arr)[0]))
 
 #define For(array, ptr) for (u32 _i = 0; (_i < array.count ? array.set_pointer_to_item(&ptr, _i), true : false); _i++)
 
+const u32 ARRAY_MIN_CAPACITY = 8;
+
+// Items in the range [0, count) are constructed, the range [count, size) is raw memory.
+// A default constructed array doesn't allocate, memory is taken on the first push.
+// Trivially copyable types are grown with realloc and copied with memcpy.
+// Memory comes from the heap unless the array was given an allocator.
 template <typename T>
 struct Array {
-	Array(u32 _size = 8);
+	Array() {}
+	Array(u32 _size);
+	Array(Allocator *_allocator);
 	~Array();
 
 	T *items = NULL;
-	u32 count;
-	u32 size;
+	u32 count = 0;
+	u32 size = 0;
 	u32 stride = sizeof(T);
+	bool inline_storage = false;
+	Allocator *allocator = NULL;
 
 	Array(const Array<T> &other);
+	Array(Array<T> &&other);
 	Array<T> &operator=(const Array<T> &other);
+	Array<T> &operator=(Array<T> &&other);
 
 	T &operator[](u32 i);
 	const T &operator[](u32 i) const;
@@ -31,22 +48,45 @@ struct Array {
 	void reset();
 	void resize(u32 _size);
 	void remove(u32 index);
+	void swap_remove(u32 index);
 	void reserve(u32 _count, bool clear_array = false);
+	void shrink_to_fit();
 	void set_pointer_to_item(T* ptr, u32 index);
 	void set_pointer_to_item(T** ptr, u32 index);
 
 	void *to_void_ptr();
-	
+
 	bool is_empty();
 	bool find(const T &item);
 
 	u32 push(const T &item);
+	u32 push(T &&item);
 	u32 get_size();
 
-	T &pop();
+	template <typename... Args>
+	u32 emplace(Args &&... args);
+
+	T pop();
 	T &get(u32 index);
 	T &first();
 	T &last();
+
+	void grow();
+	void destroy_items(u32 first, u32 last);
+};
+
+// Array with N items of inline capacity. It doesn't touch the heap until the count goes above N.
+// Use it for short-lived local arrays; it must not be moved with memcpy (qsort, realloc) because items point into the object.
+template <typename T, u32 N>
+struct Small_Array : Array<T> {
+	Small_Array();
+	Small_Array(const Array<T> &other);
+	Small_Array(const Small_Array<T, N> &other);
+
+	Small_Array<T, N> &operator=(const Array<T> &other);
+	Small_Array<T, N> &operator=(const Small_Array<T, N> &other);
+
+	alignas(T) u8 inline_items[sizeof(T) * N];
 };
 
 template <typename T>
@@ -61,19 +101,25 @@ inline void zero_memory(Array<T> *array);
 template <typename T>
 Array<T>::Array(u32 _size)
 {
-	items = NULL;
-	count = 0;
-	size = _size;
-	resize(_size);
+	if (_size > 0) {
+		resize(_size);
+	}
+}
+
+template <typename T>
+Array<T>::Array(Allocator *_allocator)
+{
+	allocator = _allocator;
 }
 
 template <typename T>
 Array<T>::~Array()
 {
-	if (items) {
-		delete[] items;
-		items = NULL;
+	destroy_items(0, count);
+	if (!inline_storage) {
+		free_memory(allocator, items);
 	}
+	items = NULL;
 }
 
 template<typename T>
@@ -82,16 +128,67 @@ inline Array<T>::Array(const Array<T> &other)
 	*this = other;
 }
 
+template<typename T>
+inline Array<T>::Array(Array<T> &&other)
+{
+	*this = std::move(other);
+}
+
 template<typename T>
 inline Array<T> &Array<T>::operator=(const Array<T> &other)
 {
+	if (this == &other) {
+		return *this;
+	}
+	reset();
+	if (other.count > size) {
+		resize(other.count);
+	}
+	if constexpr (std::is_trivially_copyable<T>::value) {
+		if (other.count > 0) {
+			memcpy((void *)items, (void *)other.items, sizeof(T) * other.count);
+		}
+	} else {
+		for (u32 i = 0; i < other.count; i++) {
+			new (&items[i]) T(other.items[i]);
+		}
+	}
 	count = other.count;
-	size = other.size;
-	if (items) delete[] items, items = NULL;
-	items = new T[other.size];
-	for (u32 i = 0; i < count; i++) {
-		items[i] = other.items[i];
+	return *this;
+}
+
+template<typename T>
+inline Array<T> &Array<T>::operator=(Array<T> &&other)
+{
+	if (this == &other) {
+		return *this;
+	}
+	if (other.inline_storage) {
+		// Items live inside the other object, they can only be moved one by one.
+		reset();
+		if (other.count > size) {
+			resize(other.count);
+		}
+		for (u32 i = 0; i < other.count; i++) {
+			new (&items[i]) T(std::move(other.items[i]));
+		}
+		count = other.count;
+		other.reset();
+		return *this;
 	}
+	destroy_items(0, count);
+	if (!inline_storage) {
+		free_memory(allocator, items);
+	}
+	items = other.items;
+	count = other.count;
+	size = other.size;
+	inline_storage = false;
+	allocator = other.allocator;
+
+	other.items = NULL;
+	other.count = 0;
+	other.size = 0;
 	return *this;
 }
 
@@ -109,43 +206,81 @@ inline const T &Array<T>::operator[](u32 i) const
 	return items[i];
 }
 
+template<typename T>
+inline void Array<T>::destroy_items(u32 first, u32 last)
+{
+	if constexpr (!std::is_trivially_destructible<T>::value) {
+		for (u32 i = first; i < last; i++) {
+			items[i].~T();
+		}
+	}
+}
+
 template<typename T>
 inline void Array<T>::clear()
 {
-	if (items) {
-		delete[] items;
+	destroy_items(0, count);
+	count = 0;
+	if (!inline_storage) {
+		free_memory(allocator, items);
 		items = NULL;
+		size = 0;
 	}
-	count = 0;
-	size = 8;
-	resize(size);
 }
 
 template<typename T>
 inline void Array<T>::reset()
 {
+	destroy_items(0, count);
 	count = 0;
 }
 
 template <typename T>
 inline void Array<T>::resize(u32 new_size)
 {
-	assert(new_size > count);
+	assert(new_size >= count);
 
-	if (!items) {
-		items = new T[new_size];
+	if (new_size == size) {
 		return;
 	}
-
-	T *temp_array = items;
-	items = new T[new_size];
-
-	for (u32 i = 0; i < count; i++) {
-		items[i] = temp_array[i];
+	if (new_size == 0) {
+		clear();
+		return;
 	}
+	if constexpr (std::is_trivially_copyable<T>::value) {
+		if (!inline_storage) {
+			T *new_items = (T *)reallocate_memory(allocator, (void *)items, sizeof(T) * size, sizeof(T) * new_size, alignof(T));
+			assert(new_items);
+			items = new_items;
+			size = new_size;
+			return;
+		}
+	}
+	T *new_items = (T *)allocate_memory(allocator, sizeof(T) * new_size, alignof(T));
+	assert(new_items);
 
+	if constexpr (std::is_trivially_copyable<T>::value) {
+		if (count > 0) {
+			memcpy((void *)new_items, (void *)items, sizeof(T) * count);
+		}
+	} else {
+		for (u32 i = 0; i < count; i++) {
+			new (&new_items[i]) T(std::move(items[i]));
+			items[i].~T();
+		}
+	}
+	if (!inline_storage) {
+		free_memory(allocator, items);
+	}
+	items = new_items;
 	size = new_size;
-	delete[] temp_array;
+	inline_storage = false;
+}
+
+template<typename T>
+inline void Array<T>::grow()
+{
+	resize((size > 0) ? size * 2 : ARRAY_MIN_CAPACITY);
 }
 
 template<typename T>
@@ -154,9 +289,22 @@ inline void Array<T>::remove(u32 index)
 	if (index < count) {
 		u32 offset = index + 1;
 		for (; offset < count; offset++) {
-			items[offset - 1] = items[offset];
+			items[offset - 1] = std::move(items[offset]);
+		}
+		destroy_items(count - 1, count);
+		count -= 1;
+	}
+}
+
+// Moves the last item in place of the removed one, so the order of items is not kept.
+template <typename T>
+inline void Array<T>::swap_remove(u32 index)
+{
+	if (index < count) {
+		if (index != (count - 1)) {
+			items[index] = std::move(items[count - 1]);
 		}
-		memset((void *)&items[count - 1], 0, sizeof(T));
+		destroy_items(count - 1, count);
 		count -= 1;
 	}
 }
@@ -167,10 +315,27 @@ inline void Array<T>::reserve(u32 _count, bool clear_array)
 	if (clear_array && !is_empty()) {
 		clear();
 	}
-	resize(_count);
+	if (_count > size) {
+		resize(_count);
+	}
+	if (_count > count) {
+		for (u32 i = count; i < _count; i++) {
+			new (&items[i]) T();
+		}
+	} else {
+		destroy_items(_count, count);
+	}
 	count = _count;
 }
 
+template<typename T>
+inline void Array<T>::shrink_to_fit()
+{
+	if (!inline_storage && (count < size)) {
+		resize(count);
+	}
+}
+
 template <typename T>
 inline void Array<T>::set_pointer_to_item(T *ptr, u32 index)
 {
@@ -215,9 +380,37 @@ template <typename T>
 inline u32 Array<T>::push(const T &item)
 {
 	if (count >= size) {
-		resize(size * 2);
+		// The item can be a reference into this array.
+		T temp = item;
+		grow();
+		new (&items[count]) T(std::move(temp));
+		return count++;
+	}
+	new (&items[count]) T(item);
+	return count++;
+}
+
+template <typename T>
+inline u32 Array<T>::push(T &&item)
+{
+	if (count >= size) {
+		T temp = std::move(item);
+		grow();
+		new (&items[count]) T(std::move(temp));
+		return count++;
+	}
+	new (&items[count]) T(std::move(item));
+	return count++;
+}
+
+template<typename T>
+template<typename ...Args>
+inline u32 Array<T>::emplace(Args &&... args)
+{
+	if (count >= size) {
+		grow();
 	}
-	items[count] = item;
+	new (&items[count]) T(std::forward<Args>(args)...);
 	return count++;
 }
 
@@ -248,10 +441,47 @@ inline T &Array<T>::last()
 }
 
 template <typename T>
-inline T &Array<T>::pop()
+inline T Array<T>::pop()
 {
 	assert(count > 0);
-	return items[--count];
+	T item = std::move(items[count - 1]);
+	destroy_items(count - 1, count);
+	count -= 1;
+	return item;
+}
+
+template<typename T, u32 N>
+inline Small_Array<T, N>::Small_Array()
+{
+	this->items = (T *)inline_items;
+	this->size = N;
+	this->inline_storage = true;
+}
+
+template<typename T, u32 N>
+inline Small_Array<T, N>::Small_Array(const Array<T> &other) : Small_Array()
+{
+	Array<T>::operator=(other);
+}
+
+template<typename T, u32 N>
+inline Small_Array<T, N>::Small_Array(const Small_Array<T, N> &other) : Small_Array()
+{
+	Array<T>::operator=(other);
+}
+
+template<typename T, u32 N>
+inline Small_Array<T, N> &Small_Array<T, N>::operator=(const Array<T> &other)
+{
+	Array<T>::operator=(other);
+	return *this;
+}
+
+template<typename T, u32 N>
+inline Small_Array<T, N> &Small_Array<T, N>::operator=(const Small_Array<T, N> &other)
+{
+	Array<T>::operator=(other);
+	return *this;
 }
 
 template <typename T>
@@ -260,7 +490,15 @@ inline void merge(Array<T> *dst, Array<T> *src)
 	if ((dst->count + src->count) > dst->size) {
 		dst->resize(dst->count + src->count);
 	}
-	memcpy((void *)&dst->items[dst->count], (void *)src->items, sizeof(T) * src->count);
+	if constexpr (std::is_trivially_copyable<T>::value) {
+		if (src->count > 0) {
+			memcpy((void *)&dst->items[dst->count], (void *)src->items, sizeof(T) * src->count);
+		}
+	} else {
+		for (u32 i = 0; i < src->count; i++) {
+			new (&dst->items[dst->count + i]) T(src->items[i]);
+		}
+	}
 	dst->count += src->count;
 }
 
@@ -312,4 +550,4 @@ inline void zero_memory(Array<T> *array)
 		memset((void *)array->items, 0, sizeof(T) * array->size);
 	}
 }
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,353 @@
+#ifndef CONCURRENT_QUEUE_H
+#define CONCURRENT_QUEUE_H
+
+#include <atomic>
+#include <utility>
+#include <assert.h>
+
+#include "../number_types.h"
+#include "../memory/base.h"
+#include "../memory/pool_allocator.h"
+#include "../../sys/utils.h"
+
+// Queues for passing items between threads. The bounded queues keep items in a ring buffer
+// with a power of two capacity, push returns false if a queue is full and pop returns false if a queue is empty.
+// Counters which are written by different threads are placed in different cache lines.
+
+inline u32 round_up_to_power_of_two(u32 value)
+{
+	u32 result = 1;
+	while (result < value) {
+		result <<= 1;
+	}
+	return result;
+}
+
+// One producer thread and one consumer thread.
+// Each side keeps a copy of the other side's counter and reads the shared one only when the copy says the queue is full/empty.
+template <typename T>
+struct SPSC_Queue {
+	SPSC_Queue() {}
+	~SPSC_Queue();
+
+	T *items = NULL;
+	u32 capacity = 0;
+	u32 mask = 0;
+
+	alignas(CACHE_LINE_SIZE) std::atomic<u32> head = 0;
+	u32 cached_tail = 0;
+
+	alignas(CACHE_LINE_SIZE) std::atomic<u32> tail = 0;
+	u32 cached_head = 0;
+
+	DELETE_COPING(SPSC_Queue)
+
+	void init(u32 _capacity);
+	void free();
+	bool push(const T &item);
+	bool push(T &&item);
+	bool pop(T &item);
+	bool empty();
+	u32 count();
+};
+
+template <typename T>
+inline SPSC_Queue<T>::~SPSC_Queue()
+{
+	free();
+}
+
+template <typename T>
+inline void SPSC_Queue<T>::init(u32 _capacity)
+{
+	assert(_capacity > 0);
+
+	free();
+	capacity = round_up_to_power_of_two(_capacity);
+	mask = capacity - 1;
+	items = new T[capacity];
+}
+
+template <typename T>
+inline void SPSC_Queue<T>::free()
+{
+	DELETE_ARRAY(items);
+	capacity = 0;
+	mask = 0;
+	head.store(0, std::memory_order_relaxed);
+	tail.store(0, std::memory_order_relaxed);
+	cached_head = 0;
+	cached_tail = 0;
+}
+
+template <typename T>
+inline bool SPSC_Queue<T>::push(const T &item)
+{
+	T temp = item;
+	return push(std::move(temp));
+}
+
+template <typename T>
+inline bool SPSC_Queue<T>::push(T &&item)
+{
+	u32 current_tail = tail.load(std::memory_order_relaxed);
+	if ((current_tail - cached_head) == capacity) {
+		cached_head = head.load(std::memory_order_acquire);
+		if ((current_tail - cached_head) == capacity) {
+			return false;
+		}
+	}
+	items[current_tail & mask] = std::move(item);
+	tail.store(current_tail + 1, std::memory_order_release);
+	return true;
+}
+
+template <typename T>
+inline bool SPSC_Queue<T>::pop(T &item)
+{
+	u32 current_head = head.load(std::memory_order_relaxed);
+	if (current_head == cached_tail) {
+		cached_tail = tail.load(std::memory_order_acquire);
+		if (current_head == cached_tail) {
+			return false;
+		}
+	}
+	item = std::move(items[current_head & mask]);
+	head.store(current_head + 1, std::memory_order_release);
+	return true;
+}
+
+template <typename T>
+inline bool SPSC_Queue<T>::empty()
+{
+	return count() == 0;
+}
+
+// The result is exact only if the queue is not used by other threads at the moment.
+template <typename T>
+inline u32 SPSC_Queue<T>::count()
+{
+	return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire);
+}
+
+// Any number of producer and consumer threads (Dmitry Vyukov's bounded queue).
+// Every cell has a sequence number which tells whose turn it is: a producer waits for sequence == position,
+// a consumer for sequence == position + 1. Threads take positions with CAS, so there are no locks.
+template <typename T>
+struct MPMC_Queue {
+	MPMC_Queue() {}
+	~MPMC_Queue();
+
+	struct Cell {
+		std::atomic<u32> sequence;
+		T item;
+	};
+
+	Cell *cells = NULL;
+	u32 capacity = 0;
+	u32 mask = 0;
+
+	alignas(CACHE_LINE_SIZE) std::atomic<u32> head = 0;
+	alignas(CACHE_LINE_SIZE) std::atomic<u32> tail = 0;
+
+	DELETE_COPING(MPMC_Queue)
+
+	void init(u32 _capacity);
+	void free();
+	bool push(const T &item);
+	bool push(T &&item);
+	bool pop(T &item);
+	bool empty();
+	u32 count();
+};
+
+template <typename T>
+inline MPMC_Queue<T>::~MPMC_Queue()
+{
+	free();
+}
+
+template <typename T>
+inline void MPMC_Queue<T>::init(u32 _capacity)
+{
+	assert(_capacity > 1);
+
+	free();
+	capacity = round_up_to_power_of_two(_capacity);
+	mask = capacity - 1;
+	cells = new Cell[capacity];
+	for (u32 i = 0; i < capacity; i++) {
+		cells[i].sequence.store(i, std::memory_order_relaxed);
+	}
+}
+
+template <typename T>
+inline void MPMC_Queue<T>::free()
+{
+	DELETE_ARRAY(cells);
+	capacity = 0;
+	mask = 0;
+	head.store(0, std::memory_order_relaxed);
+	tail.store(0, std::memory_order_relaxed);
+}
+
+template <typename T>
+inline bool MPMC_Queue<T>::push(const T &item)
+{
+	T temp = item;
+	return push(std::move(temp));
+}
+
+template <typename T>
+inline bool MPMC_Queue<T>::push(T &&item)
+{
+	Cell *cell = NULL;
+	u32 position = tail.load(std::memory_order_relaxed);
+	while (true) {
+		cell = &cells[position & mask];
+		u32 sequence = cell->sequence.load(std::memory_order_acquire);
+		s32 difference = (s32)(sequence - position);
+		if (difference == 0) {
+			if (tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+				break;
+			}
+		} else if (difference < 0) {
+			return false;
+		} else {
+			position = tail.load(std::memory_order_relaxed);
+		}
+	}
+	cell->item = std::move(item);
+	cell->sequence.store(position + 1, std::memory_order_release);
+	return true;
+}
+
+template <typename T>
+inline bool MPMC_Queue<T>::pop(T &item)
+{
+	Cell *cell = NULL;
+	u32 position = head.load(std::memory_order_relaxed);
+	while (true) {
+		cell = &cells[position & mask];
+		u32 sequence = cell->sequence.load(std::memory_order_acquire);
+		s32 difference = (s32)(sequence - (position + 1));
+		if (difference == 0) {
+			if (head.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+				break;
+			}
+		} else if (difference < 0) {
+			return false;
+		} else {
+			position = head.load(std::memory_order_relaxed);
+		}
+	}
+	item = std::move(cell->item);
+	cell->sequence.store(position + mask + 1, std::memory_order_release);
+	return true;
+}
+
+template <typename T>
+inline bool MPMC_Queue<T>::empty()
+{
+	return count() == 0;
+}
+
+// The result is approximate if other threads use the queue at the moment.
+template <typename T>
+inline u32 MPMC_Queue<T>::count()
+{
+	u32 current_head = head.load(std::memory_order_acquire);
+	u32 current_tail = tail.load(std::memory_order_acquire);
+	return ((s32)(current_tail - current_head) > 0) ? (current_tail - current_head) : 0;
+}
+
+template <typename T>
+struct MPSC_Node {
+	std::atomic<MPSC_Node *> next = NULL;
+	T item;
+};
+
+// Any number of producer threads and one consumer thread, the queue is never full (Dmitry Vyukov's intrusive MPSC queue).
+// A producer makes one atomic exchange. Nodes come from Concurrent_Pool_Allocator,
+// producers allocate them and the consumer frees them.
+// Note: A producer which was stopped between the exchange and the link makes the queue look empty
+// to the consumer until the producer resumes.
+template <typename T>
+struct MPSC_Queue {
+	MPSC_Queue();
+	~MPSC_Queue();
+
+	alignas(CACHE_LINE_SIZE) std::atomic<MPSC_Node<T> *> head = NULL;
+	alignas(CACHE_LINE_SIZE) MPSC_Node<T> *tail = NULL;
+
+	Concurrent_Pool_Allocator<MPSC_Node<T>> node_allocator;
+
+	DELETE_COPING(MPSC_Queue)
+
+	bool push(const T &item);
+	bool push(T &&item);
+	bool pop(T &item);
+	bool empty();
+	void clear();
+};
+
+template <typename T>
+inline MPSC_Queue<T>::MPSC_Queue()
+{
+	node_allocator.init(256);
+	tail = node_allocator.allocate();
+	head.store(tail, std::memory_order_relaxed);
+}
+
+template <typename T>
+inline MPSC_Queue<T>::~MPSC_Queue()
+{
+	clear();
+	node_allocator.free(tail);
+}
+
+template <typename T>
+inline bool MPSC_Queue<T>::push(const T &item)
+{
+	T temp = item;
+	return push(std::move(temp));
+}
+
+template <typename T>
+inline bool MPSC_Queue<T>::push(T &&item)
+{
+	MPSC_Node<T> *node = node_allocator.allocate();
+	node->item = std::move(item);
+	MPSC_Node<T> *prev_node = head.exchange(node, std::memory_order_acq_rel);
+	prev_node->next.store(node, std::memory_order_release);
+	return true;
+}
+
+// The popped node becomes the new stub node and the old stub node is freed.
+template <typename T>
+inline bool MPSC_Queue<T>::pop(T &item)
+{
+	MPSC_Node<T> *next = tail->next.load(std::memory_order_acquire);
+	if (!next) {
+		return false;
+	}
+	item = std::move(next->item);
+	node_allocator.free(tail);
+	tail = next;
+	return true;
+}
+
+template <typename T>
+inline bool MPSC_Queue<T>::empty()
+{
+	return tail->next.load(std::memory_order_acquire) == NULL;
+}
+
+template <typename T>
+inline void MPSC_Queue<T>::clear()
+{
+	T item;
+	while (pop(item)) {
+	}
+}
+#endif
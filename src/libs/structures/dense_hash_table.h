@@ -0,0 +1,326 @@
+#ifndef DENSE_HASH_TABLE_H
+#define DENSE_HASH_TABLE_H
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "array.h"
+#include "hash_table.h"
+#include "../memory/base.h"
+#include "../number_types.h"
+
+// Hash table which keeps its entries contiguously in an array and puts Robin Hood index slots on the side.
+// Walking the table is a plain array walk, get_node(index) is O(1) and begin()/end() can be used in range based loops.
+// Removing moves the last entry into the hole, so the order of entries is the insertion order until something is removed.
+// Note: Pointers to entries are not stable across inserts and removes.
+template <typename _Key_, typename _Value_>
+struct Dense_Hash_Table {
+	typedef Hash_Node<_Key_, _Value_> Table_Entry;
+	typedef typename Hash_Function<_Key_>::Lookup_Key Lookup_Key;
+
+	struct Index_Slot {
+		u32 hash;
+		u32 node_index;
+	};
+
+	Dense_Hash_Table() {}
+	Dense_Hash_Table(const Dense_Hash_Table<_Key_, _Value_> &other);
+	~Dense_Hash_Table();
+
+	u32 count = 0;
+	u32 capacity = 0;
+	Index_Slot *slots = NULL;
+	Array<Table_Entry> nodes;
+
+	Dense_Hash_Table<_Key_, _Value_> &operator=(const Dense_Hash_Table<_Key_, _Value_> &other);
+
+	void clear();
+	void reserve(u32 entry_count);
+	void rehash(u32 new_capacity);
+
+	void set(const Lookup_Key &key, const _Value_ &value);
+
+	bool key_in_table(const Lookup_Key &key);
+	bool remove(const Lookup_Key &key);
+	bool get(const Lookup_Key &key, _Value_ &value);
+	bool get(const Lookup_Key &key, _Value_ *value);
+
+	u32 make_hash(const Lookup_Key &key);
+	u32 find_slot(const Lookup_Key &key, u32 key_hash);
+	u32 find_slot_by_node_index(u32 key_hash, u32 node_index);
+	u32 probe_distance(u32 key_hash, u32 slot_index);
+	void insert_slot(u32 key_hash, u32 node_index);
+	void remove_slot(u32 slot_index);
+
+	_Value_ &get_value(u32 index);
+	_Value_ &operator[](const Lookup_Key &key);
+
+	Table_Entry *begin();
+	Table_Entry *end();
+	Table_Entry *get_node(u32 index);
+	Table_Entry *get_table_entry(const Lookup_Key &key);
+};
+
+template<typename _Key_, typename _Value_>
+Dense_Hash_Table<_Key_, _Value_>::Dense_Hash_Table(const Dense_Hash_Table<_Key_, _Value_> &other)
+{
+	*this = other;
+}
+
+template<typename _Key_, typename _Value_>
+Dense_Hash_Table<_Key_, _Value_>::~Dense_Hash_Table()
+{
+	free_memory(NULL, slots);
+	slots = NULL;
+}
+
+template<typename _Key_, typename _Value_>
+Dense_Hash_Table<_Key_, _Value_> &Dense_Hash_Table<_Key_, _Value_>::operator=(const Dense_Hash_Table<_Key_, _Value_> &other)
+{
+	if (this == &other) {
+		return *this;
+	}
+	clear();
+	nodes = other.nodes;
+	count = other.count;
+	capacity = other.capacity;
+	if (capacity > 0) {
+		slots = (Index_Slot *)allocate_memory(NULL, sizeof(Index_Slot) * capacity, alignof(Index_Slot));
+		memcpy((void *)slots, (void *)other.slots, sizeof(Index_Slot) * capacity);
+	}
+	return *this;
+}
+
+template<typename _Key_, typename _Value_>
+u32 Dense_Hash_Table<_Key_, _Value_>::make_hash(const Lookup_Key &key)
+{
+	u32 key_hash = Hash_Function<_Key_>::hash(key);
+	return (key_hash == HASH_TABLE_EMPTY_SLOT) ? 1 : key_hash;
+}
+
+template<typename _Key_, typename _Value_>
+inline u32 Dense_Hash_Table<_Key_, _Value_>::probe_distance(u32 key_hash, u32 slot_index)
+{
+	return (slot_index + capacity - (key_hash & (capacity - 1))) & (capacity - 1);
+}
+
+template<typename _Key_, typename _Value_>
+u32 Dense_Hash_Table<_Key_, _Value_>::find_slot(const Lookup_Key &key, u32 key_hash)
+{
+	if (count == 0) {
+		return UINT32_MAX;
+	}
+	u32 mask = capacity - 1;
+	u32 index = key_hash & mask;
+
+	for (u32 distance = 0; distance < capacity; distance++) {
+		Index_Slot *slot = &slots[index];
+		if ((slot->hash == HASH_TABLE_EMPTY_SLOT) || (distance > probe_distance(slot->hash, index))) {
+			break;
+		}
+		if ((slot->hash == key_hash) && (nodes[slot->node_index].key == key)) {
+			return index;
+		}
+		index = (index + 1) & mask;
+	}
+	return UINT32_MAX;
+}
+
+template<typename _Key_, typename _Value_>
+u32 Dense_Hash_Table<_Key_, _Value_>::find_slot_by_node_index(u32 key_hash, u32 node_index)
+{
+	u32 mask = capacity - 1;
+	u32 index = key_hash & mask;
+	while (slots[index].node_index != node_index) {
+		index = (index + 1) & mask;
+	}
+	return index;
+}
+
+template<typename _Key_, typename _Value_>
+void Dense_Hash_Table<_Key_, _Value_>::insert_slot(u32 key_hash, u32 node_index)
+{
+	u32 mask = capacity - 1;
+	u32 index = key_hash & mask;
+	u32 distance = 0;
+	Index_Slot new_slot = { key_hash, node_index };
+
+	while (true) {
+		Index_Slot *slot = &slots[index];
+		if (slot->hash == HASH_TABLE_EMPTY_SLOT) {
+			*slot = new_slot;
+			return;
+		}
+		u32 slot_distance = probe_distance(slot->hash, index);
+		if (slot_distance < distance) {
+			Index_Slot temp = *slot;
+			*slot = new_slot;
+			new_slot = temp;
+			distance = slot_distance;
+		}
+		index = (index + 1) & mask;
+		distance++;
+	}
+}
+
+template<typename _Key_, typename _Value_>
+void Dense_Hash_Table<_Key_, _Value_>::remove_slot(u32 slot_index)
+{
+	u32 mask = capacity - 1;
+	u32 next_index = (slot_index + 1) & mask;
+	while ((slots[next_index].hash != HASH_TABLE_EMPTY_SLOT) && (probe_distance(slots[next_index].hash, next_index) > 0)) {
+		slots[slot_index] = slots[next_index];
+		slot_index = next_index;
+		next_index = (next_index + 1) & mask;
+	}
+	slots[slot_index].hash = HASH_TABLE_EMPTY_SLOT;
+}
+
+template<typename _Key_, typename _Value_>
+void Dense_Hash_Table<_Key_, _Value_>::clear()
+{
+	free_memory(NULL, slots);
+	slots = NULL;
+	count = 0;
+	capacity = 0;
+	nodes.clear();
+}
+
+template<typename _Key_, typename _Value_>
+void Dense_Hash_Table<_Key_, _Value_>::reserve(u32 entry_count)
+{
+	u32 new_capacity = HASH_TABLE_MIN_CAPACITY;
+	while ((entry_count * 8) > (new_capacity * 7)) {
+		new_capacity *= 2;
+	}
+	if (new_capacity > capacity) {
+		rehash(new_capacity);
+	}
+}
+
+template<typename _Key_, typename _Value_>
+void Dense_Hash_Table<_Key_, _Value_>::rehash(u32 new_capacity)
+{
+	assert((new_capacity & (new_capacity - 1)) == 0); // pwr of 2
+	assert(new_capacity > count);
+
+	u32 old_capacity = capacity;
+	Index_Slot *old_slots = slots;
+
+	capacity = new_capacity;
+	slots = (Index_Slot *)allocate_memory(NULL, sizeof(Index_Slot) * capacity, alignof(Index_Slot));
+	memset((void *)slots, 0, sizeof(Index_Slot) * capacity);
+
+	for (u32 i = 0; i < old_capacity; i++) {
+		if (old_slots[i].hash != HASH_TABLE_EMPTY_SLOT) {
+			insert_slot(old_slots[i].hash, old_slots[i].node_index);
+		}
+	}
+	free_memory(NULL, old_slots);
+}
+
+template<typename _Key_, typename _Value_>
+void Dense_Hash_Table<_Key_, _Value_>::set(const Lookup_Key &key, const _Value_ &value)
+{
+	(*this)[key] = value;
+}
+
+template<typename _Key_, typename _Value_>
+_Value_ &Dense_Hash_Table<_Key_, _Value_>::operator[](const Lookup_Key &key)
+{
+	u32 key_hash = make_hash(key);
+	u32 slot_index = find_slot(key, key_hash);
+	if (slot_index != UINT32_MAX) {
+		return nodes[slots[slot_index].node_index].value;
+	}
+	if (((count + 1) * 8) > (capacity * 7)) {
+		rehash(capacity > 0 ? capacity * 2 : HASH_TABLE_MIN_CAPACITY);
+	}
+	u32 node_index = nodes.push(Table_Entry(key, _Value_()));
+	insert_slot(key_hash, node_index);
+	count++;
+	return nodes[node_index].value;
+}
+
+template<typename _Key_, typename _Value_>
+bool Dense_Hash_Table<_Key_, _Value_>::remove(const Lookup_Key &key)
+{
+	u32 slot_index = find_slot(key, make_hash(key));
+	if (slot_index == UINT32_MAX) {
+		return false;
+	}
+	u32 node_index = slots[slot_index].node_index;
+	remove_slot(slot_index);
+
+	u32 last_node_index = nodes.count - 1;
+	if (node_index != last_node_index) {
+		// The last entry takes the freed place, its index slot has to point there now.
+		u32 last_slot_index = find_slot_by_node_index(make_hash(nodes[last_node_index].key), last_node_index);
+		slots[last_slot_index].node_index = node_index;
+		nodes[node_index] = nodes[last_node_index];
+	}
+	nodes.pop();
+	count--;
+	return true;
+}
+
+template<typename _Key_, typename _Value_>
+bool Dense_Hash_Table<_Key_, _Value_>::key_in_table(const Lookup_Key &key)
+{
+	return get_table_entry(key) != NULL;
+}
+
+template<typename _Key_, typename _Value_>
+bool Dense_Hash_Table<_Key_, _Value_>::get(const Lookup_Key &key, _Value_ &value)
+{
+	Table_Entry *entry = get_table_entry(key);
+	if (entry) {
+		value = entry->value;
+		return true;
+	}
+	return false;
+}
+
+template<typename _Key_, typename _Value_>
+bool Dense_Hash_Table<_Key_, _Value_>::get(const Lookup_Key &key, _Value_ *value)
+{
+	Table_Entry *entry = get_table_entry(key);
+	if (entry) {
+		*value = entry->value;
+		return true;
+	}
+	return false;
+}
+
+template<typename _Key_, typename _Value_>
+inline _Value_ &Dense_Hash_Table<_Key_, _Value_>::get_value(u32 index)
+{
+	return get_node(index)->value;
+}
+
+template<typename _Key_, typename _Value_>
+inline Hash_Node<_Key_, _Value_> *Dense_Hash_Table<_Key_, _Value_>::begin()
+{
+	return nodes.items;
+}
+
+template<typename _Key_, typename _Value_>
+inline Hash_Node<_Key_, _Value_> *Dense_Hash_Table<_Key_, _Value_>::end()
+{
+	return nodes.items + count;
+}
+
+template<typename _Key_, typename _Value_>
+inline Hash_Node<_Key_, _Value_> *Dense_Hash_Table<_Key_, _Value_>::get_node(u32 index)
+{
+	assert(count > index);
+	return &nodes[index];
+}
+
+template<typename _Key_, typename _Value_>
+Hash_Node<_Key_, _Value_> *Dense_Hash_Table<_Key_, _Value_>::get_table_entry(const Lookup_Key &key)
+{
+	u32 slot_index = find_slot(key, make_hash(key));
+	return (slot_index != UINT32_MAX) ? &nodes[slots[slot_index].node_index] : NULL;
+}
+#endif
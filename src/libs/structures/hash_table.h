@@ -1,47 +1,84 @@
 #ifndef HASH_TABLE_H
 #define HASH_TABLE_H
 
-#include <math.h>
+#include <new>
+#include <utility>
 #include <stdlib.h>
 #include <string.h>
 
 #include "../str.h"
+#include "../memory/base.h"
 #include "../number_types.h"
 #include "../../sys/utils.h"
 
 u32 fast_hash(const char *data);
 
-inline u32 hash(const char *string, int factor, int table_count)
+// Finalizers from MurmurHash3. They mix all bits of an integer key
+// so sequential keys don't land in sequential slots.
+inline u32 hash_u32(u32 key)
 {
-	unsigned long hash = 5381;
-	int c;
-
-	while (c = *string++) {
-		hash = factor * ((hash << 5) + hash) + c;
-	}
-	return (u32)(hash % table_count);
+	key ^= key >> 16;
+	key *= 0x85ebca6b;
+	key ^= key >> 13;
+	key *= 0xc2b2ae35;
+	key ^= key >> 16;
+	return key;
 }
 
-//inline u32 hash(int number, int table_count, int attempt)
-//{
-//	char *str = to_string(number);
-//	u32 h = hash(str, table_count, attempt);
-//	free_string(str);
-//	return h;
-//}
+inline u32 hash_u64(u64 key)
+{
+	key ^= key >> 33;
+	key *= 0xff51afd7ed558ccdull;
+	key ^= key >> 33;
+	key *= 0xc4ceb9fe1a85ec53ull;
+	key ^= key >> 33;
+	return (u32)key;
+}
 
-inline u32 hash(u64 number, int table_count, int attempt)
+inline u32 hash_string(const char *string)
 {
-	char *str = to_string(number);
-	u32 h = hash(str, table_count, attempt);
-	free_string(str);
-	return h;
+	return string ? fast_hash(string) : 0;
 }
 
+// Hash_Function<_Key_> tells the table how to hash a key and what type can be used for lookups.
+// String tables are searched by const char * so that a lookup never builds a temporary String.
+template <typename _Key_>
+struct Hash_Function;
+
+#define INTEGER_HASH_FUNCTION(type, hash_proc) \
+	template <> \
+	struct Hash_Function<type> { \
+		typedef type Lookup_Key; \
+		static u32 hash(type key) { return hash_proc(key); } \
+	}; \
+
+INTEGER_HASH_FUNCTION(char, hash_u32)
+INTEGER_HASH_FUNCTION(s8, hash_u32)
+INTEGER_HASH_FUNCTION(u8, hash_u32)
+INTEGER_HASH_FUNCTION(s16, hash_u32)
+INTEGER_HASH_FUNCTION(u16, hash_u32)
+INTEGER_HASH_FUNCTION(s32, hash_u32)
+INTEGER_HASH_FUNCTION(u32, hash_u32)
+INTEGER_HASH_FUNCTION(s64, hash_u64)
+INTEGER_HASH_FUNCTION(u64, hash_u64)
+
+template <>
+struct Hash_Function<String> {
+	typedef const char *Lookup_Key;
+	static u32 hash(const char *key) { return hash_string(key); }
+};
+
+template <>
+struct Hash_Function<const char *> {
+	typedef const char *Lookup_Key;
+	static u32 hash(const char *key) { return hash_string(key); }
+};
+
 template <typename _Key_, typename _Value_>
 struct Hash_Node {
 	_Key_ key;
 	_Value_ value;
+	Hash_Node() {}
 	Hash_Node(const _Key_ &key, const _Value_ &value) : key(key), value(value) {}
 	bool compare(const _Key_ &key2) { return key == key2; }
 };
@@ -50,6 +87,7 @@ template <typename _Value_>
 struct Hash_Node<const char *, _Value_> {
 	String key;
 	_Value_ value;
+	Hash_Node() {}
 	Hash_Node(const char *key, const _Value_ &value) : key(key), value(value) {}
 	bool compare(const String &key2) { return key == key2; }
 };
@@ -58,80 +96,171 @@ template <typename _Value_>
 struct Hash_Node<String, _Value_> {
 	String key;
 	_Value_ value;
+	Hash_Node() {}
 	Hash_Node(const String &key, const _Value_ &value) : key(key), value(value) {}
 	bool compare(const String key2) { return key == key2; }
 };
 
+// Open addressing hash table with Robin Hood probing.
+// Keys and values are stored inline in one slot array, so an insert or a lookup doesn't touch the heap
+// unless the table has to grow. Every slot keeps the full hash of its key (0 marks an empty slot),
+// that lets the table compare hashes before keys and rehash without recomputing them.
+// Removing uses backward shift deletion, the table never keeps tombstones.
+// Note: Inserting and removing move entries between slots, don't keep pointers to values across them.
 template <typename _Key_, typename _Value_>
 struct Hash_Table {
-	Hash_Table(int _size = 8);
-	~Hash_Table();
-
 	typedef Hash_Node<_Key_, _Value_> Table_Entry;
+	typedef typename Hash_Function<_Key_>::Lookup_Key Lookup_Key;
 
-	Array<Table_Entry *> nodes;
+	Hash_Table(u32 _capacity = 0);
+	Hash_Table(const Hash_Table<_Key_, _Value_> &other);
+	~Hash_Table();
 
-	u32 size = 0;
 	u32 count = 0;
-	u32 max_loop = 0;
-	u32 table_size = 0;
-	u32 hash_factor1 = 7;
-	u32 hash_facotr2 = 11;
+	u32 capacity = 0;
+	u32 *hashes = NULL;
+	Table_Entry *nodes = NULL;
+
+	Hash_Table<_Key_, _Value_> &operator=(const Hash_Table<_Key_, _Value_> &other);
 
 	void clear();
-	void rehash();
-	void insert_entry(Table_Entry *entry);
-	void free_table(Table_Entry **table, u32 _table_size);
+	void reserve(u32 entry_count);
+	void rehash(u32 new_capacity);
 
-	void set(const _Key_ &key, const _Value_ &value);
+	void set(const Lookup_Key &key, const _Value_ &value);
 
-	bool key_in_table(const _Key_ &key);
-	bool get(const _Key_ &key, _Value_ &value);
-	bool get(const _Key_ &key, _Value_ *value);
+	bool key_in_table(const Lookup_Key &key);
+	bool remove(const Lookup_Key &key);
+	bool get(const Lookup_Key &key, _Value_ &value);
+	bool get(const Lookup_Key &key, _Value_ *value);
 
-	u32 hash1(const _Key_ &key);
-	u32 hash2(const _Key_ &key);
+	u32 make_hash(const Lookup_Key &key);
+	u32 find_slot(const Lookup_Key &key, u32 key_hash);
+	u32 probe_distance(u32 key_hash, u32 slot_index);
+	u32 insert_entry(u32 key_hash, Table_Entry &entry);
 
 	_Value_ &get_value(u32 index);
-	_Value_ &operator[](const _Key_ &key);
+	_Value_ &operator[](const Lookup_Key &key);
 
 	Hash_Node<_Key_, _Value_> *get_node(u32 index);
-	Hash_Node<_Key_, _Value_> *get_table_entry(const _Key_ &key);
+	Hash_Node<_Key_, _Value_> *get_table_entry(const Lookup_Key &key);
 };
 
+const u32 HASH_TABLE_EMPTY_SLOT = 0;
+const u32 HASH_TABLE_MIN_CAPACITY = 8;
+
 template<typename _Key_, typename _Value_>
-Hash_Table<_Key_, _Value_>::Hash_Table(int _size)
+Hash_Table<_Key_, _Value_>::Hash_Table(u32 _capacity)
 {
-	rand();
-	hash_factor1 = rand();
-	hash_facotr2 = rand() % 256;
-	size = _size;
-	table_size = _size * 2;
-	max_loop = table_size;
-
-	nodes.resize(table_size);
+	if (_capacity > 0) {
+		reserve(_capacity);
+	}
+}
 
-	memset(nodes.items, 0, sizeof(Table_Entry *) * table_size);
+template<typename _Key_, typename _Value_>
+Hash_Table<_Key_, _Value_>::Hash_Table(const Hash_Table<_Key_, _Value_> &other)
+{
+	*this = other;
 }
 
 template<typename _Key_, typename _Value_>
 Hash_Table<_Key_, _Value_>::~Hash_Table()
 {
-	for (u32 i = 0; i < table_size; i++) {
-		delete nodes[i];
+	clear();
+}
+
+template<typename _Key_, typename _Value_>
+Hash_Table<_Key_, _Value_> &Hash_Table<_Key_, _Value_>::operator=(const Hash_Table<_Key_, _Value_> &other)
+{
+	if (this == &other) {
+		return *this;
+	}
+	clear();
+	if (other.capacity > 0) {
+		capacity = other.capacity;
+		count = other.count;
+		hashes = (u32 *)allocate_memory(NULL, sizeof(u32) * capacity, alignof(u32));
+		nodes = (Table_Entry *)allocate_memory(NULL, sizeof(Table_Entry) * capacity, alignof(Table_Entry));
+		memcpy((void *)hashes, (void *)other.hashes, sizeof(u32) * capacity);
+
+		for (u32 i = 0; i < capacity; i++) {
+			if (hashes[i] != HASH_TABLE_EMPTY_SLOT) {
+				new (&nodes[i]) Table_Entry(other.nodes[i]);
+			}
+		}
 	}
+	return *this;
 }
 
 template<typename _Key_, typename _Value_>
-u32 Hash_Table<_Key_, _Value_>::hash1(const _Key_ &key)
+u32 Hash_Table<_Key_, _Value_>::make_hash(const Lookup_Key &key)
 {
-	return (u32)hash((_Key_)key, hash_factor1, size);
+	u32 key_hash = Hash_Function<_Key_>::hash(key);
+	return (key_hash == HASH_TABLE_EMPTY_SLOT) ? 1 : key_hash;
 }
 
 template<typename _Key_, typename _Value_>
-u32 Hash_Table<_Key_, _Value_>::hash2(const _Key_ &key)
+inline u32 Hash_Table<_Key_, _Value_>::probe_distance(u32 key_hash, u32 slot_index)
 {
-	return (u32)hash((_Key_)key, hash_facotr2, size) + size;
+	return (slot_index + capacity - (key_hash & (capacity - 1))) & (capacity - 1);
+}
+
+template<typename _Key_, typename _Value_>
+u32 Hash_Table<_Key_, _Value_>::find_slot(const Lookup_Key &key, u32 key_hash)
+{
+	if (count == 0) {
+		return UINT32_MAX;
+	}
+	u32 mask = capacity - 1;
+	u32 index = key_hash & mask;
+
+	for (u32 distance = 0; distance < capacity; distance++) {
+		u32 slot_hash = hashes[index];
+		// A slot with a shorter probe distance means the key would have been placed before it.
+		if ((slot_hash == HASH_TABLE_EMPTY_SLOT) || (distance > probe_distance(slot_hash, index))) {
+			break;
+		}
+		if ((slot_hash == key_hash) && (nodes[index].key == key)) {
+			return index;
+		}
+		index = (index + 1) & mask;
+	}
+	return UINT32_MAX;
+}
+
+template<typename _Key_, typename _Value_>
+u32 Hash_Table<_Key_, _Value_>::insert_entry(u32 key_hash, Table_Entry &entry)
+{
+	if (((count + 1) * 8) > (capacity * 7)) {
+		rehash(capacity > 0 ? capacity * 2 : HASH_TABLE_MIN_CAPACITY);
+	}
+	u32 mask = capacity - 1;
+	u32 index = key_hash & mask;
+	u32 distance = 0;
+	u32 entry_index = UINT32_MAX;
+
+	while (true) {
+		u32 slot_hash = hashes[index];
+		if (slot_hash == HASH_TABLE_EMPTY_SLOT) {
+			hashes[index] = key_hash;
+			new (&nodes[index]) Table_Entry(std::move(entry));
+			count++;
+			return (entry_index == UINT32_MAX) ? index : entry_index;
+		}
+
+		u32 slot_distance = probe_distance(slot_hash, index);
+		if (slot_distance < distance) {
+			// The rich entry gives its slot to the poor one and continues probing instead of it.
+			std::swap(hashes[index], key_hash);
+			std::swap(nodes[index], entry);
+			distance = slot_distance;
+			if (entry_index == UINT32_MAX) {
+				entry_index = index;
+			}
+		}
+		index = (index + 1) & mask;
+		distance++;
+	}
 }
 
 template<typename _Key_, typename _Value_>
@@ -142,15 +271,15 @@ _Value_ &Hash_Table<_Key_, _Value_>::get_value(u32 index)
 }
 
 template<typename _Key_, typename _Value_>
-_Value_ &Hash_Table<_Key_, _Value_>::operator[](const _Key_ &key)
+_Value_ &Hash_Table<_Key_, _Value_>::operator[](const Lookup_Key &key)
 {
-	Table_Entry *entry = get_table_entry(key);
-	if (!entry) {
-		_Value_ value;
-		entry = new Table_Entry(key, value);
-		insert_entry(entry);
+	u32 key_hash = make_hash(key);
+	u32 index = find_slot(key, key_hash);
+	if (index == UINT32_MAX) {
+		Table_Entry entry(key, _Value_());
+		index = insert_entry(key_hash, entry);
 	}
-	return entry->value;
+	return nodes[index].value;
 }
 
 template<typename _Key_, typename _Value_>
@@ -159,14 +288,12 @@ Hash_Node<_Key_, _Value_> *Hash_Table<_Key_, _Value_>::get_node(u32 index)
 	assert(count > index);
 
 	u32 node_count = 0;
-	for (u32 i = 0; i < table_size; i++) {
-		Hash_Node<_Key_, _Value_> *node = nodes[i];
-		if ((node != NULL) && (node_count == index)) {
-			return node;
-		} else {
-			if (node != NULL) {
-				node_count += 1;
+	for (u32 i = 0; i < capacity; i++) {
+		if (hashes[i] != HASH_TABLE_EMPTY_SLOT) {
+			if (node_count == index) {
+				return &nodes[i];
 			}
+			node_count += 1;
 		}
 	}
 	assert(false);
@@ -174,136 +301,114 @@ Hash_Node<_Key_, _Value_> *Hash_Table<_Key_, _Value_>::get_node(u32 index)
 }
 
 template<typename _Key_, typename _Value_>
-Hash_Node<_Key_, _Value_> *Hash_Table<_Key_, _Value_>::get_table_entry(const _Key_ &key)
+Hash_Node<_Key_, _Value_> *Hash_Table<_Key_, _Value_>::get_table_entry(const Lookup_Key &key)
 {
-	u32 _hash1 = hash1(key);
-	u32 _hash2 = hash2(key);
-
-	if ((nodes[_hash1] != NULL) && (nodes[_hash1]->key == key)) {
-		return nodes[_hash1];
-	}
-
-	if ((nodes[_hash2] != NULL) && (nodes[_hash2]->key == key)) {
-		return nodes[_hash2];
-	}
-	return NULL;
+	u32 index = find_slot(key, make_hash(key));
+	return (index != UINT32_MAX) ? &nodes[index] : NULL;
 }
 
 template<typename _Key_, typename _Value_>
-inline void Hash_Table<_Key_, _Value_>::clear()
+void Hash_Table<_Key_, _Value_>::clear()
 {
-	Table_Entry *table_entry = NULL;
-	For(nodes, table_entry)
-	{
-		if (table_entry) {
-			DELETE_PTR(table_entry);
+	for (u32 i = 0; i < capacity; i++) {
+		if (hashes[i] != HASH_TABLE_EMPTY_SLOT) {
+			nodes[i].~Table_Entry();
 		}
 	}
-	nodes.clear();
-
-	rand();
+	free_memory(NULL, hashes);
+	free_memory(NULL, nodes);
+	hashes = NULL;
+	nodes = NULL;
 	count = 0;
-	size = 8;
-	hash_factor1 = rand();
-	hash_facotr2 = rand() % 256;
-	table_size = size * 2;
-	max_loop = table_size;
-
-	nodes.resize(table_size);
-
-	memset(nodes.items, 0, sizeof(Table_Entry *) * table_size);
+	capacity = 0;
 }
 
 template<typename _Key_, typename _Value_>
-void Hash_Table<_Key_, _Value_>::rehash()
+void Hash_Table<_Key_, _Value_>::reserve(u32 entry_count)
 {
-	u32 old_table_size = table_size;
-	u32 _size = size * 2;
-
-	hash_factor1 = rand();
-	hash_facotr2 = rand() % 256;
-	size = _size;
-	count = 0;
-	table_size = table_size * 2;
-	max_loop = table_size;
-
-	Table_Entry **old_nodes = nodes.items;
-
-	nodes.items = new Table_Entry * [table_size];
-	nodes.size = table_size;
-	memset(nodes.items, 0, sizeof(Table_Entry *) * table_size);
-
-	for (u32 i = 0; i < old_table_size; i++) {
-		Table_Entry *entry = old_nodes[i];
-		if (entry != NULL) {
-			insert_entry(entry);
-		}
+	u32 new_capacity = HASH_TABLE_MIN_CAPACITY;
+	while ((entry_count * 8) > (new_capacity * 7)) {
+		new_capacity *= 2;
+	}
+	if (new_capacity > capacity) {
+		rehash(new_capacity);
 	}
-	delete[] old_nodes;
-}
-
-template<typename _Key_, typename _Value_>
-void Hash_Table<_Key_, _Value_>::free_table(Table_Entry **table, u32 _table_size)
-{
-	delete[] table;
-	table = NULL;
 }
 
 template<typename _Key_, typename _Value_>
-void Hash_Table<_Key_, _Value_>::insert_entry(Table_Entry *entry)
+void Hash_Table<_Key_, _Value_>::rehash(u32 new_capacity)
 {
-	_Key_ _key = entry->key;
-
-	Table_Entry *inserting_entry = entry;
-	Table_Entry **existing_entry = NULL;
-
-	for (u32 i = 0; i < max_loop; i++) {
-		u32 hashies[] = { hash1(_key), hash2(_key) };
+	assert((new_capacity & (new_capacity - 1)) == 0); // pwr of 2
+	assert(new_capacity > count);
 
-		u32 index = hashies[i % 2];
+	u32 old_capacity = capacity;
+	u32 *old_hashes = hashes;
+	Table_Entry *old_nodes = nodes;
 
-		if (nodes[index] == NULL) {
-			nodes[index] = inserting_entry;
-			break;
-		}
-		Table_Entry *temp = nodes[index];
-		nodes[index] = inserting_entry;
-		inserting_entry = temp;
-		_key = temp->key;
-
-		if ((i + 1) >= max_loop) {
-			rehash();
-			i = 0;
+	count = 0;
+	capacity = new_capacity;
+	hashes = (u32 *)allocate_memory(NULL, sizeof(u32) * capacity, alignof(u32));
+	nodes = (Table_Entry *)allocate_memory(NULL, sizeof(Table_Entry) * capacity, alignof(Table_Entry));
+	memset((void *)hashes, 0, sizeof(u32) * capacity);
+
+	for (u32 i = 0; i < old_capacity; i++) {
+		if (old_hashes[i] != HASH_TABLE_EMPTY_SLOT) {
+			insert_entry(old_hashes[i], old_nodes[i]);
+			old_nodes[i].~Table_Entry();
 		}
 	}
-	count++;
+	free_memory(NULL, old_hashes);
+	free_memory(NULL, old_nodes);
 }
 
 template<typename _Key_, typename _Value_>
-void Hash_Table<_Key_, _Value_>::set(const _Key_ &key, const _Value_ &value)
+void Hash_Table<_Key_, _Value_>::set(const Lookup_Key &key, const _Value_ &value)
 {
-	Table_Entry *entry = get_table_entry(key);
-	if (entry) {
-		entry->value = value;
+	u32 key_hash = make_hash(key);
+	u32 index = find_slot(key, key_hash);
+	if (index != UINT32_MAX) {
+		nodes[index].value = value;
 		return;
 	}
-
-	Table_Entry *new_entry = new Table_Entry(key, value);
-	insert_entry(new_entry);
+	Table_Entry entry(key, value);
+	insert_entry(key_hash, entry);
 }
 
 template<typename _Key_, typename _Value_>
-bool Hash_Table<_Key_, _Value_>::key_in_table(const _Key_ &key)
+bool Hash_Table<_Key_, _Value_>::remove(const Lookup_Key &key)
 {
-	Table_Entry *entry = get_table_entry(key);
-	if (entry) {
-		return true;
+	u32 index = find_slot(key, make_hash(key));
+	if (index == UINT32_MAX) {
+		return false;
 	}
-	return false;
+	nodes[index].~Table_Entry();
+	hashes[index] = HASH_TABLE_EMPTY_SLOT;
+
+	// Shift the following entries of the cluster back by one slot
+	// until an empty slot or an entry sitting in its home slot is found.
+	u32 mask = capacity - 1;
+	u32 next_index = (index + 1) & mask;
+	while ((hashes[next_index] != HASH_TABLE_EMPTY_SLOT) && (probe_distance(hashes[next_index], next_index) > 0)) {
+		new (&nodes[index]) Table_Entry(std::move(nodes[next_index]));
+		nodes[next_index].~Table_Entry();
+		hashes[index] = hashes[next_index];
+		hashes[next_index] = HASH_TABLE_EMPTY_SLOT;
+
+		index = next_index;
+		next_index = (next_index + 1) & mask;
+	}
+	count--;
+	return true;
+}
+
+template<typename _Key_, typename _Value_>
+bool Hash_Table<_Key_, _Value_>::key_in_table(const Lookup_Key &key)
+{
+	return get_table_entry(key) != NULL;
 }
 
 template<typename _Key_, typename _Value_>
-bool Hash_Table<_Key_, _Value_>::get(const _Key_ &key, _Value_ &value)
+bool Hash_Table<_Key_, _Value_>::get(const Lookup_Key &key, _Value_ &value)
 {
 	Table_Entry *entry = get_table_entry(key);
 	if (entry) {
@@ -314,7 +419,7 @@ bool Hash_Table<_Key_, _Value_>::get(const _Key_ &key, _Value_ &value)
 }
 
 template<typename _Key_, typename _Value_>
-bool Hash_Table<_Key_, _Value_>::get(const _Key_ &key, _Value_ *value)
+bool Hash_Table<_Key_, _Value_>::get(const Lookup_Key &key, _Value_ *value)
 {
 	Table_Entry *entry = get_table_entry(key);
 	if (entry) {
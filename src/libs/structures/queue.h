@@ -15,7 +15,9 @@ struct Queue_Node {
 	Queue_Node(const T &item, Queue_Node *next) : item(item), next(next) {}
 };
 
-template <typename T>
+// Node_Allocator may be Concurrent_Pool_Allocator if nodes are freed on other threads,
+// the queue itself still must be guarded by the user.
+template <typename T, template <typename> class Node_Allocator = Pool_Allocator>
 struct Queue {
 	Queue();
 	~Queue();
@@ -23,7 +25,7 @@ struct Queue {
 	Queue_Node<T> *first = NULL;
 	Queue_Node<T> *last = NULL;
 
-	Pool_Allocator<Queue_Node<T>> pool_allocator;
+	Node_Allocator<Queue_Node<T>> pool_allocator;
 
 	void push(const T& item);
 	void clear();
@@ -33,27 +35,27 @@ struct Queue {
 	T &back();
 };
 
-template<typename T>
-Queue<T>::Queue()
+template <typename T, template <typename> class Node_Allocator>
+Queue<T, Node_Allocator>::Queue()
 {
 	pool_allocator.init(16);
 }
 
-template<typename T>
-Queue<T>::~Queue()
+template <typename T, template <typename> class Node_Allocator>
+Queue<T, Node_Allocator>::~Queue()
 {
 	clear();
 	pool_allocator.free_memory();
 }
 
-template <typename T>
-bool Queue<T>::empty()
+template <typename T, template <typename> class Node_Allocator>
+bool Queue<T, Node_Allocator>::empty()
 {
 	return first == NULL;
 }
 
-template <typename T>
-void Queue<T>::push(const T& item)
+template <typename T, template <typename> class Node_Allocator>
+void Queue<T, Node_Allocator>::push(const T& item)
 {
 	Queue_Node<T> *node = pool_allocator.allocate();
 	node->item = item;
@@ -66,8 +68,8 @@ void Queue<T>::push(const T& item)
 	last = node;
 }
 
-template<typename T>
-void Queue<T>::clear()
+template <typename T, template <typename> class Node_Allocator>
+void Queue<T, Node_Allocator>::clear()
 {
 	Queue_Node<T>* node = NULL;
 	while (first) {
@@ -80,8 +82,8 @@ void Queue<T>::clear()
 	last = NULL;
 }
 
-template <typename T>
-void Queue<T>::pop()
+template <typename T, template <typename> class Node_Allocator>
+void Queue<T, Node_Allocator>::pop()
 {
 	Queue_Node<T>* node = first;
 	if (node) {
@@ -94,15 +96,15 @@ void Queue<T>::pop()
 	}
 }
 
-template<typename T>
-T &Queue<T>::front()
+template <typename T, template <typename> class Node_Allocator>
+T &Queue<T, Node_Allocator>::front()
 {
 	assert(!empty());
 	return first->item;
 }
 
-template<typename T>
-T &Queue<T>::back()
+template <typename T, template <typename> class Node_Allocator>
+T &Queue<T, Node_Allocator>::back()
 {
 	assert(!empty());
 	return last->item;
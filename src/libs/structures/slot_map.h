@@ -0,0 +1,109 @@
+#ifndef SLOT_MAP_H
+#define SLOT_MAP_H
+
+#include <assert.h>
+
+#include "array.h"
+#include "../number_types.h"
+
+const u32 SLOT_MAP_INVALID_INDEX = UINT32_MAX;
+
+// Maps stable handles (slot index + generation) to indices of items in a dense array which is kept by the user.
+// When an item is removed, the user moves the last item in its place (Array::swap_remove),
+// so the dense array stays packed, and the generation of the slot is incremented,
+// so old handles to the slot become invalid instead of pointing to a new item.
+struct Slot_Map {
+	struct Slot {
+		u32 dense_index = SLOT_MAP_INVALID_INDEX; // The next free slot if the slot is free.
+		u32 generation = 1;
+	};
+
+	u32 free_slot = SLOT_MAP_INVALID_INDEX;
+	Array<Slot> slots;
+	Array<u32> dense_slots;
+
+	u32 add(u32 *generation);
+	bool get(u32 slot_index, u32 generation, u32 *dense_index);
+	bool remove(u32 slot_index, u32 generation, u32 *dense_index);
+	void clear();
+
+	void restore(u32 slot_index, u32 generation);
+	void link_free_slots();
+};
+
+// Returns a slot index for an item which will be pushed to the end of the dense array.
+inline u32 Slot_Map::add(u32 *generation)
+{
+	u32 slot_index = free_slot;
+	if (slot_index != SLOT_MAP_INVALID_INDEX) {
+		free_slot = slots[slot_index].dense_index;
+	} else {
+		slot_index = slots.push(Slot());
+	}
+	Slot *slot = &slots[slot_index];
+	slot->dense_index = dense_slots.push(slot_index);
+	*generation = slot->generation;
+	return slot_index;
+}
+
+inline bool Slot_Map::get(u32 slot_index, u32 generation, u32 *dense_index)
+{
+	if ((slot_index < slots.count) && (slots[slot_index].generation == generation)) {
+		*dense_index = slots[slot_index].dense_index;
+		return true;
+	}
+	return false;
+}
+
+// Returns an index of the item which must be removed from the dense array with swap_remove.
+inline bool Slot_Map::remove(u32 slot_index, u32 generation, u32 *dense_index)
+{
+	if (!get(slot_index, generation, dense_index)) {
+		return false;
+	}
+	u32 moved_slot_index = dense_slots.last();
+	dense_slots[*dense_index] = moved_slot_index;
+	slots[moved_slot_index].dense_index = *dense_index;
+	dense_slots.pop();
+
+	Slot *slot = &slots[slot_index];
+	slot->generation++;
+	slot->dense_index = free_slot;
+	free_slot = slot_index;
+	return true;
+}
+
+inline void Slot_Map::clear()
+{
+	free_slot = SLOT_MAP_INVALID_INDEX;
+	slots.clear();
+	dense_slots.clear();
+}
+
+// Restores a slot for an item which is pushed to the end of the dense array.
+// It is used to rebuild the map for items read from a file. link_free_slots must be called after all items are restored.
+inline void Slot_Map::restore(u32 slot_index, u32 generation)
+{
+	while (slots.count <= slot_index) {
+		slots.push(Slot());
+	}
+	Slot *slot = &slots[slot_index];
+	assert(slot->dense_index == SLOT_MAP_INVALID_INDEX);
+
+	slot->dense_index = dense_slots.push(slot_index);
+	slot->generation = generation;
+}
+
+inline void Slot_Map::link_free_slots()
+{
+	free_slot = SLOT_MAP_INVALID_INDEX;
+	for (u32 i = slots.count; i > 0; i--) {
+		Slot *slot = &slots[i - 1];
+		if ((slot->dense_index >= dense_slots.count) || (dense_slots[slot->dense_index] != (i - 1))) {
+			slot->generation++;
+			slot->dense_index = free_slot;
+			free_slot = i - 1;
+		}
+	}
+}
+#endif
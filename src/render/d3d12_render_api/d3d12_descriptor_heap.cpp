@@ -261,31 +261,37 @@ Descriptor_Heap_Pool::~Descriptor_Heap_Pool()
 
 D3D12_GPU_Descriptor Descriptor_Heap_Pool::allocate_cb_descriptor(D3D12_Resource *resource)
 {
+	std::lock_guard<std::mutex> lock(mutex);
 	return cbsrua_descriptor_heap.place_cb_descriptor(cbsrua_descriptor_indices.pop(), resource);
 }
 
 D3D12_GPU_Descriptor Descriptor_Heap_Pool::allocate_sr_descriptor(D3D12_Resource *resource, u32 mipmap_level)
 {
+	std::lock_guard<std::mutex> lock(mutex);
 	return cbsrua_descriptor_heap.place_sr_descriptor(cbsrua_descriptor_indices.pop(), resource, mipmap_level);
 }
 
 D3D12_GPU_Descriptor Descriptor_Heap_Pool::allocate_ua_descriptor(D3D12_Resource *resource, u32 mipmap_level)
 {
+	std::lock_guard<std::mutex> lock(mutex);
 	return cbsrua_descriptor_heap.place_ua_descriptor(cbsrua_descriptor_indices.pop(), resource, mipmap_level);
 }
 
 D3D12_CPU_Descriptor Descriptor_Heap_Pool::allocate_rt_descriptor(D3D12_Resource *resource)
 {
+	std::lock_guard<std::mutex> lock(mutex);
 	return rt_descriptor_heap.place_descriptor(rt_descriptor_indices.pop(), resource);
 }
 
 D3D12_CPU_Descriptor Descriptor_Heap_Pool::allocate_ds_descriptor(D3D12_Resource *resource)
 {
+	std::lock_guard<std::mutex> lock(mutex);
 	return ds_descriptor_heap.place_descriptor(rt_descriptor_indices.pop(), resource);
 }
 
 D3D12_GPU_Descriptor Descriptor_Heap_Pool::allocate_sampler_descriptor(D3D12_Sampler *sampler)
 {
+	std::lock_guard<std::mutex> lock(mutex);
 	return sampler_descriptor_heap.place_descriptor(sampler_descriptor_indices.pop(), sampler);
 }
 
@@ -326,6 +332,7 @@ void Descriptor_Heap_Pool::free(GPU_Descriptor *descriptor)
 
 	if (descriptor->valid()) {
 		assert(static_cast<u8>(d3d12_descriptor->type) < 4);
+		std::lock_guard<std::mutex> lock(mutex);
 		descriptor_indices[d3d12_descriptor->type]->push(d3d12_descriptor->index_in_heap);
 	}
 }
@@ -342,6 +349,7 @@ void Descriptor_Heap_Pool::free(CPU_Descriptor *descriptor)
 
 	if (descriptor->valid()) {
 		assert(static_cast<u8>(d3d12_descriptor->type) < 4);
+		std::lock_guard<std::mutex> lock(mutex);
 		descriptor_indices[d3d12_descriptor->type]->push(d3d12_descriptor->index_in_heap);
 	}
 }
\ No newline at end of file
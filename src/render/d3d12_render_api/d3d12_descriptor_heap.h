@@ -1,6 +1,7 @@
 #ifndef D3D12_DESCRIPTOR_HEAP_H
 #define D3D12_DESCRIPTOR_HEAP_H
 
+#include <mutex>
 #include <d3d12.h>
 #include <wrl/client.h>
 
@@ -65,10 +66,14 @@ struct Sampler_Descriptor_Heap : Descriptor_Heap {
 	D3D12_GPU_Descriptor place_descriptor(u32 descriptor_index, D3D12_Sampler *sampler);
 };
 
+// Resources create their descriptors when they are used first time, it can happen on the render thread,
+// so allocations and frees are done under the lock.
 struct Descriptor_Heap_Pool {
 	Descriptor_Heap_Pool();
 	~Descriptor_Heap_Pool();
 
+	std::mutex mutex;
+
 	Array<u32> rt_descriptor_indices;
 	Array<u32> ds_descriptor_indices;
 	Array<u32> cbsrua_descriptor_indices;
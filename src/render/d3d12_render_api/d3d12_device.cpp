@@ -369,7 +369,8 @@ void D3D12_Command_List::close()
 	command_list->Close();
 }
 
-u8 color_index = 0;
+// Command lists are recorded on several threads.
+static thread_local u8 color_index = 0;
 
 void D3D12_Command_List::begin_event(const char *name)
 {
@@ -616,9 +617,15 @@ void  D3D12_Command_List::set_index_buffer(Buffer *buffer)
 }
 
 void D3D12_Command_List::set_graphics_constant_buffer(u32 shader_register, u32 shader_space, Buffer *constant_buffer)
+{
+	set_graphics_constant_buffer(shader_register, shader_space, constant_buffer->gpu_virtual_address());
+}
+
+// An upload buffer changes its GPU address every frame, the address of the frame being recorded can be passed directly.
+void D3D12_Command_List::set_graphics_constant_buffer(u32 shader_register, u32 shader_space, u64 gpu_virtual_address)
 {
 	u32 parameter_index = last_set_root_signature->get_parameter_index(shader_register, shader_space, CONSTANT_BUFFER_REGISTER);
-	command_list->SetGraphicsRootConstantBufferView(parameter_index, constant_buffer->gpu_virtual_address());
+	command_list->SetGraphicsRootConstantBufferView(parameter_index, gpu_virtual_address);
 }
 
 void D3D12_Command_List::set_graphics_constants(u32 shader_register, u32 shader_space, u32 data_size, void *data)
@@ -738,6 +745,21 @@ void D3D12_Command_Queue::execute_command_list(Command_List *command_list)
 	d3d12_command_queue->ExecuteCommandLists(1, command_lists);
 }
 
+// The command lists are executed in the order of the array, as if they were one command list.
+void D3D12_Command_Queue::execute_command_lists(Command_List **command_lists, u32 command_list_count)
+{
+	const u32 MAX_BATCH_SIZE = 32;
+	ID3D12CommandList *d3d12_command_lists[MAX_BATCH_SIZE];
+
+	for (u32 first_index = 0; first_index < command_list_count; first_index += MAX_BATCH_SIZE) {
+		u32 batch_size = ((command_list_count - first_index) > MAX_BATCH_SIZE) ? MAX_BATCH_SIZE : (command_list_count - first_index);
+		for (u32 i = 0; i < batch_size; i++) {
+			d3d12_command_lists[i] = static_cast<D3D12_Command_List *>(command_lists[first_index + i])->get();
+		}
+		d3d12_command_queue->ExecuteCommandLists(batch_size, d3d12_command_lists);
+	}
+}
+
 ID3D12CommandQueue *D3D12_Command_Queue::get()
 {
 	return d3d12_command_queue.Get();
@@ -141,6 +141,7 @@ struct D3D12_Command_List : Graphics_Command_List {
 	void set_index_buffer(Buffer *buffer);
 
 	void set_graphics_constant_buffer(u32 shader_register, u32 shader_space, Buffer *constant_buffer);
+	void set_graphics_constant_buffer(u32 shader_register, u32 shader_space, u64 gpu_virtual_address);
 
 	void set_graphics_constants(u32 shader_register, u32 shader_space, u32 data_size, void *data);
 	void set_graphics_descriptor_table(u32 shader_register, u32 shader_space, Shader_Register register_type, GPU_Descriptor *base_descriptor);
@@ -173,6 +174,7 @@ struct D3D12_Command_Queue : Command_Queue {
 	void signal(Fence *fence);
 	void wait(Fence *fence);
 	void execute_command_list(Command_List *command_list);
+	void execute_command_lists(Command_List **command_lists, u32 command_list_count);
 	ID3D12CommandQueue *get();
 };
 
@@ -10,14 +10,14 @@ u32 dxgi_format_size(DXGI_FORMAT format);
 bool check_tearing_support();
 
 template <typename... Args>
-inline void set_name(ID3D12Object *object, Args... args)
+inline void set_name(ID3D12Object *object, const Args &... args)
 {
-	char *formatted_string = format(args...);
-	wchar_t *wstring = to_wstring(formatted_string);
+	Format_Buffer buffer;
+	format_to(&buffer, args...);
+	wchar_t *wstring = to_wstring(buffer.c_str());
 
 	object->SetName(wstring);
 
-	free_string(formatted_string);
 	free_string(wstring);
 }
 #endif
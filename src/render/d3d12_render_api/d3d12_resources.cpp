@@ -314,6 +314,12 @@ D3D12_Buffer::~D3D12_Buffer()
 		completed_upload_buffer.pop();
 		DELETE_PTR(upload_buffer);
 	}
+	for (u32 i = 0; i < render_device->buffers.count; i++) {
+		if (render_device->buffers[i] == this) {
+			render_device->buffers.swap_remove(i);
+			break;
+		}
+	}
 }
 
 void D3D12_Buffer::begin_frame()
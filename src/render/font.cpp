@@ -127,6 +127,13 @@ u32 Font_Char::get_index()
 	return (u32)character;
 }
 
+Font_Manager::~Font_Manager()
+{
+	for (u32 i = 0; i < font_table.count; i++) {
+		DELETE_PTR(font_table.get_node(i)->value);
+	}
+}
+
 void Font_Manager::init()
 {
 	CHAR path[MAX_PATH];
@@ -164,9 +171,9 @@ bool Font_Manager::load_font(const char *name, u32 font_size)
 	}
 
 	char *font_name = format("{}_{}", name, font_size);
-	Font font;
-	font.name = font_name;
-	font.font_size = font_size;
+	Font *font = new Font();
+	font->name = font_name;
+	font->font_size = font_size;
 
 	for (u8 c = 0; c < MAX_CHARACTERS; c++) {
 		if (FT_Load_Char(face, c, FT_LOAD_RENDER)) {
@@ -183,15 +190,15 @@ bool Font_Manager::load_font(const char *name, u32 font_size)
 		u32 *data = r8_to_rgba32((u8 *)face->glyph->bitmap.buffer, face->glyph->bitmap.width, face->glyph->bitmap.rows);
 		font_char.bitmap = data;
 
-		font.characters[font_char.get_index()] = font_char;
+		font->characters[font_char.get_index()] = font_char;
 
-		font.max_symbol_height = math::max(font.max_symbol_height, font_char.size.height);
+		font->max_symbol_height = math::max(font->max_symbol_height, font_char.size.height);
 
 		if (isalpha(c)) {
-			font.max_alphabet_height = math::max(font.max_alphabet_height, font_char.size.height);
+			font->max_alphabet_height = math::max(font->max_alphabet_height, font_char.size.height);
 		}
 		if (isdigit(c)) {
-			font.max_number_height = math::max(font.max_alphabet_height, font_char.size.height);
+			font->max_number_height = math::max(font->max_alphabet_height, font_char.size.height);
 		}
 	}
 	font_table.set(font_name, font);
@@ -212,7 +219,8 @@ Font *Font_Manager::get_font(const char *name, u32 font_size)
 		}
 
 	}
-	Font *font = &font_table[font_name];
+	Font *font = NULL;
+	font_table.get(font_name, &font);
 	free_string(font_name);
 	return font;
 }
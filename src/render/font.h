@@ -9,7 +9,7 @@
 #include "../libs/number_types.h"
 #include "../libs/math/structures.h"
 #include "../libs/structures/array.h"
-#include "../libs/structures/hash_table.h"
+#include "../libs/structures/dense_hash_table.h"
 
 const u32 MAX_CHARACTERS = 128;
 const u32 CONTORL_CHARACTERS = 32;
@@ -59,7 +59,9 @@ struct Font {
 
 struct Font_Manager {
 	String path_to_font_dir;
-	Hash_Table<String, Font> font_table;
+	Dense_Hash_Table<String, Font *> font_table;
+
+	~Font_Manager();
 
 	void init();
 	bool load_font(const char *name, u32 font_size);
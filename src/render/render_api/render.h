@@ -174,6 +174,7 @@ struct Graphics_Command_List : Compute_Command_List {
 	virtual void set_index_buffer(Buffer *buffer) = 0;
 	
 	virtual void set_graphics_constant_buffer(u32 shader_register, u32 shader_space, Buffer *constant_buffer) = 0;
+	virtual void set_graphics_constant_buffer(u32 shader_register, u32 shader_space, u64 gpu_virtual_address) = 0;
 
 	template <typename T>
 	void set_graphics_constants(u32 shader_register, u32 shader_space, T *data);
@@ -225,6 +226,7 @@ struct Command_Queue {
 	virtual void signal(Fence *fence) = 0;
 	virtual void wait(Fence *fence) = 0;
 	virtual void execute_command_list(Command_List *command_list) = 0;
+	virtual void execute_command_lists(Command_List **command_lists, u32 command_list_count) = 0;
 };
 
 struct GPU_Heap {
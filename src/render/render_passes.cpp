@@ -1,3 +1,4 @@
+#include <assert.h>
 #include <limits.h>
 
 #include "../sys/sys.h"
@@ -49,6 +50,17 @@ void Render_Pass::schedule_resources(Pipeline_Resource_Manager *resource_manager
 {
 }
 
+u32 Render_Pass::get_part_count(void *context)
+{
+	return 1;
+}
+
+void Render_Pass::render_part(Graphics_Command_List *graphics_command_list, void *context, void *args, u32 part_index, u32 part_count)
+{
+	assert(part_count == 1);
+	render(graphics_command_list, context, args);
+}
+
 void Shadows_Pass::init(Render_Device *device, Shader_Manager *shader_manager, Pipeline_Resource_Manager *resource_manager)
 {
 	Render_Pass::init("Shadows", device, shader_manager, resource_manager);
@@ -96,12 +108,29 @@ void Shadows_Pass::setup_pipeline(Render_Device *render_device, Shader_Manager *
 
 void Shadows_Pass::render(Graphics_Command_List *graphics_command_list, void *context, void *args)
 {
-	Render_World *render_world = (Render_World *)context;
+	render_part(graphics_command_list, context, args, 0, 1);
+}
+
+// Draws of all shadow maps are split in parts of about the same size.
+u32 Shadows_Pass::get_part_count(void *context)
+{
+	Render_Frame *frame = (Render_Frame *)context;
+	u32 draw_count = frame->shadow_maps.count * frame->render_entities.count;
+	u32 part_count = (draw_count + SHADOWS_PASS_DRAWS_PER_PART - 1) / SHADOWS_PASS_DRAWS_PER_PART;
+	return math::clamp(part_count, 1u, SHADOWS_PASS_MAX_PART_COUNT);
+}
+
+void Shadows_Pass::render_part(Graphics_Command_List *graphics_command_list, void *context, void *args, u32 part_index, u32 part_count)
+{
+	Render_Frame *frame = (Render_Frame *)context;
 	Render_System *render_sys = (Render_System *)args;
 
 	graphics_command_list->begin_event("Shadows mapping");
 
-	graphics_command_list->clear_depth_stencil(shadow_atlas);
+	// The first part is executed before the others, so only it clears the atlas.
+	if (part_index == 0) {
+		graphics_command_list->clear_depth_stencil(shadow_atlas);
+	}
 	graphics_command_list->set_render_target(NULL, shadow_atlas);
 
 	graphics_command_list->apply(pipeline_state);
@@ -112,31 +141,34 @@ void Shadows_Pass::render(Graphics_Command_List *graphics_command_list, void *co
 	graphics_command_list->set_graphics_descriptor_table(0, 10, SAMPLER_REGISTER, render_sys->render_device->base_sampler_descriptor());
 
 	graphics_command_list->set_graphics_constant_buffer(0, 10, pipeline_resource_manager->global_buffer);
-	graphics_command_list->set_graphics_constant_buffer(1, 10, pipeline_resource_manager->frame_info_buffer);
+	graphics_command_list->set_graphics_constant_buffer(1, 10, frame->frame_info_buffer_address);
 
-	graphics_command_list->set_graphics_descriptor_table(0, 0, SHADER_RESOURCE_REGISTER, render_world->world_matrices_buffer->shader_resource_descriptor());
-	graphics_command_list->set_graphics_descriptor_table(1, 0, SHADER_RESOURCE_REGISTER, render_world->model_storage.mesh_instance_buffer->shader_resource_descriptor());
-	graphics_command_list->set_graphics_descriptor_table(2, 0, SHADER_RESOURCE_REGISTER, render_world->model_storage.unified_vertex_buffer->shader_resource_descriptor());
-	graphics_command_list->set_graphics_descriptor_table(3, 0, SHADER_RESOURCE_REGISTER, render_world->model_storage.unified_index_buffer->shader_resource_descriptor());
+	graphics_command_list->set_graphics_descriptor_table(0, 0, SHADER_RESOURCE_REGISTER, frame->world_matrices_buffer->shader_resource_descriptor());
+	graphics_command_list->set_graphics_descriptor_table(1, 0, SHADER_RESOURCE_REGISTER, frame->mesh_instance_buffer->shader_resource_descriptor());
+	graphics_command_list->set_graphics_descriptor_table(2, 0, SHADER_RESOURCE_REGISTER, frame->unified_vertex_buffer->shader_resource_descriptor());
+	graphics_command_list->set_graphics_descriptor_table(3, 0, SHADER_RESOURCE_REGISTER, frame->unified_index_buffer->shader_resource_descriptor());
 	
 	Depth_Map_Pass_Data pass_data;
 
-	Cascaded_Shadows *cascaded_shadows = NULL;
-	For(render_world->cascaded_shadows_list, cascaded_shadows) {
-		Cascaded_Shadow_Map *cascaded_shadow_map = NULL;
-		For(cascaded_shadows->cascaded_shadow_maps, cascaded_shadow_map) {
-			graphics_command_list->set_viewport(cascaded_shadow_map->viewport);
-
-			Render_Entity *render_entity = NULL;
-			For(render_world->game_render_entities, render_entity) {
-				pass_data.mesh_idx = render_entity->mesh_idx;
-				pass_data.world_matrix_idx = render_entity->world_matrix_idx;
-				pass_data.view_projection_matrix = cascaded_shadow_map->view_projection_matrix;
-
-				graphics_command_list->set_graphics_constants(0, 0, sizeof(Depth_Map_Pass_Data), (void *)&pass_data);
-				graphics_command_list->draw(render_world->model_storage.render_models[render_entity->mesh_idx]->mesh.index_count());
-			}
+	// Draw i draws render entity (i % render entity count) in shadow map (i / render entity count).
+	u32 render_entity_count = frame->render_entities.count;
+	u32 draw_count = frame->shadow_maps.count * render_entity_count;
+	u32 first_draw = (u32)(((u64)draw_count * part_index) / part_count);
+	u32 last_draw = (u32)(((u64)draw_count * (part_index + 1)) / part_count);
+
+	u32 shadow_map_index = UINT32_MAX;
+	for (u32 i = first_draw; i < last_draw; i++) {
+		if ((i / render_entity_count) != shadow_map_index) {
+			shadow_map_index = i / render_entity_count;
+			graphics_command_list->set_viewport(frame->shadow_maps[shadow_map_index].viewport);
+			pass_data.view_projection_matrix = frame->shadow_maps[shadow_map_index].view_projection_matrix;
 		}
+		Render_Entity_Draw *render_entity = &frame->render_entities[i % render_entity_count];
+		pass_data.mesh_idx = render_entity->mesh_idx;
+		pass_data.world_matrix_idx = render_entity->world_matrix_idx;
+
+		graphics_command_list->set_graphics_constants(0, 0, sizeof(Depth_Map_Pass_Data), (void *)&pass_data);
+		graphics_command_list->draw(render_entity->index_count);
 	}
 	graphics_command_list->end_event();
 }
@@ -205,7 +237,7 @@ inline Viewport make_viewport_from_texture(Texture *texture)
 
 void Forward_Pass::render(Graphics_Command_List *graphics_command_list, void *context, void *args)
 {
-	Render_World *render_world = (Render_World *)context;
+	Render_Frame *frame = (Render_Frame *)context;
 	Render_System *render_sys = (Render_System *)args;
 
 	graphics_command_list->begin_event("Forward rendering");
@@ -222,43 +254,43 @@ void Forward_Pass::render(Graphics_Command_List *graphics_command_list, void *co
 	graphics_command_list->set_graphics_descriptor_table(0, 10, SHADER_RESOURCE_REGISTER, render_sys->render_device->base_shader_resource_descriptor());
 
 	graphics_command_list->set_graphics_constant_buffer(0, 10, pipeline_resource_manager->global_buffer);
-	graphics_command_list->set_graphics_constant_buffer(1, 10, pipeline_resource_manager->frame_info_buffer);
+	graphics_command_list->set_graphics_constant_buffer(1, 10, frame->frame_info_buffer_address);
 
 	graphics_command_list->set_viewport(make_viewport_from_texture(render_sys->swap_chain->get_back_buffer()));
 	
 	graphics_command_list->transition_resource_barrier(shadow_atlas, RESOURCE_STATE_DEPTH_WRITE, RESOURCE_STATE_ALL_SHADER_RESOURCE);
 
-	graphics_command_list->set_graphics_descriptor_table(0, 0, SHADER_RESOURCE_REGISTER, render_world->world_matrices_buffer->shader_resource_descriptor());
-	graphics_command_list->set_graphics_descriptor_table(1, 0, SHADER_RESOURCE_REGISTER, render_world->model_storage.mesh_instance_buffer->shader_resource_descriptor());
-	graphics_command_list->set_graphics_descriptor_table(2, 0, SHADER_RESOURCE_REGISTER, render_world->model_storage.unified_vertex_buffer->shader_resource_descriptor());
-	graphics_command_list->set_graphics_descriptor_table(3, 0, SHADER_RESOURCE_REGISTER, render_world->model_storage.unified_index_buffer->shader_resource_descriptor());
+	graphics_command_list->set_graphics_descriptor_table(0, 0, SHADER_RESOURCE_REGISTER, frame->world_matrices_buffer->shader_resource_descriptor());
+	graphics_command_list->set_graphics_descriptor_table(1, 0, SHADER_RESOURCE_REGISTER, frame->mesh_instance_buffer->shader_resource_descriptor());
+	graphics_command_list->set_graphics_descriptor_table(2, 0, SHADER_RESOURCE_REGISTER, frame->unified_vertex_buffer->shader_resource_descriptor());
+	graphics_command_list->set_graphics_descriptor_table(3, 0, SHADER_RESOURCE_REGISTER, frame->unified_index_buffer->shader_resource_descriptor());
 	
-	graphics_command_list->set_graphics_descriptor_table(4, 0, SHADER_RESOURCE_REGISTER, render_world->lights_buffer->shader_resource_descriptor());
+	graphics_command_list->set_graphics_descriptor_table(4, 0, SHADER_RESOURCE_REGISTER, frame->lights_buffer->shader_resource_descriptor());
 	graphics_command_list->set_graphics_descriptor_table(0, 2, SHADER_RESOURCE_REGISTER, shadow_atlas->shader_resource_descriptor());
-	graphics_command_list->set_graphics_descriptor_table(1, 2, SHADER_RESOURCE_REGISTER, render_world->jittering_samples->shader_resource_descriptor());
-	graphics_command_list->set_graphics_descriptor_table(2, 2, SHADER_RESOURCE_REGISTER, render_world->cascaded_shadows_info_buffer->shader_resource_descriptor());
-	graphics_command_list->set_graphics_descriptor_table(3, 2, SHADER_RESOURCE_REGISTER, render_world->casded_view_projection_matrices_buffer->shader_resource_descriptor());
+	graphics_command_list->set_graphics_descriptor_table(1, 2, SHADER_RESOURCE_REGISTER, frame->jittering_samples->shader_resource_descriptor());
+	graphics_command_list->set_graphics_descriptor_table(2, 2, SHADER_RESOURCE_REGISTER, frame->cascaded_shadows_info_buffer->shader_resource_descriptor());
+	graphics_command_list->set_graphics_descriptor_table(3, 2, SHADER_RESOURCE_REGISTER, frame->cascaded_view_projection_matrices_buffer->shader_resource_descriptor());
 
 	Shadow_Atlas shadow_atlas_info;
 	shadow_atlas_info.atlas_size = SHADOW_ATLAS_SIZE;
 	shadow_atlas_info.cascade_size = CASCADE_SIZE;
 
 	Jittering_Filter filter;
-	filter.tile_size = render_world->jittering_tile_size;
-	filter.filter_size = render_world->jittering_filter_size;
-	filter.scaling = render_world->jittering_scaling;
+	filter.tile_size = frame->jittering_tile_size;
+	filter.filter_size = frame->jittering_filter_size;
+	filter.scaling = frame->jittering_scaling;
 	
 	graphics_command_list->set_graphics_constants(0, 2, &shadow_atlas_info);
 	graphics_command_list->set_graphics_constants(1, 2, &filter);
 
 	Pass_Data pass_data;
-	Render_Entity *render_entity = NULL;
-	For(render_world->game_render_entities, render_entity) {
+	Render_Entity_Draw *render_entity = NULL;
+	For(frame->render_entities, render_entity) {
 		pass_data.parameter0 = render_entity->mesh_idx;
 		pass_data.parameter1 = render_entity->world_matrix_idx;
 		graphics_command_list->set_graphics_constants(0, 0, &pass_data);
 
-		graphics_command_list->draw(render_world->model_storage.render_models[render_entity->mesh_idx]->mesh.index_count());
+		graphics_command_list->draw(render_entity->index_count);
 	}
 
 	graphics_command_list->transition_resource_barrier(shadow_atlas, RESOURCE_STATE_ALL_SHADER_RESOURCE, RESOURCE_STATE_DEPTH_WRITE);
@@ -323,11 +355,11 @@ void Render_2D_Pass::setup_pipeline(Render_Device *render_device, Shader_Manager
 
 void Render_2D_Pass::render(Graphics_Command_List *graphics_command_list, void *context, void *args)
 {
-	Render_2D *render_2d = (Render_2D *)context;
+	Render_Frame *frame = (Render_Frame *)context;
 	Render_System *render_sys = (Render_System *)args;
 	Render_Device *render_device = render_sys->render_device;
 
-	if ((render_2d->total_vertex_count == 0) || !render_2d->initialized) {
+	if (frame->draws_2d.is_empty() || !frame->vertex_buffer_2d || !frame->index_buffer_2d) {
 		return;
 	}
 	graphics_command_list->begin_event("Rendering 2D");
@@ -343,35 +375,25 @@ void Render_2D_Pass::render(Graphics_Command_List *graphics_command_list, void *
 	graphics_command_list->set_graphics_descriptor_table(0, 10, SHADER_RESOURCE_REGISTER, render_sys->render_device->base_shader_resource_descriptor());
 
 	graphics_command_list->set_graphics_constant_buffer(0, 10, pipeline_resource_manager->global_buffer);
-	graphics_command_list->set_graphics_constant_buffer(1, 10, pipeline_resource_manager->frame_info_buffer);
+	graphics_command_list->set_graphics_constant_buffer(1, 10, frame->frame_info_buffer_address);
 	
-	graphics_command_list->set_vertex_buffer(render_2d->vertex_buffer);
-	graphics_command_list->set_index_buffer(render_2d->index_buffer);
+	graphics_command_list->set_vertex_buffer(frame->vertex_buffer_2d);
+	graphics_command_list->set_index_buffer(frame->index_buffer_2d);
 
 	Render_2D_Info cb_render_info;
 
-	Render_Primitive_List *list = NULL;
-	For(render_2d->draw_list, list) {
-		Render_Primitive_2D *render_primitive = NULL;
-		For(list->render_primitives, render_primitive) {
-
-			graphics_command_list->set_clip_rect(render_primitive->clip_rect);
-			cb_render_info.orthographics_matrix = render_primitive->transform_matrix * render_sys->window_view_plane.orthographic_matrix;
+	Render_2D_Draw *draw = NULL;
+	For(frame->draws_2d, draw) {
+		graphics_command_list->set_clip_rect(draw->clip_rect);
+		cb_render_info.orthographics_matrix = draw->transform_matrix * render_sys->window_view_plane.orthographic_matrix;
 
-			cb_render_info.primitive_color = render_primitive->color.value;
-			graphics_command_list->set_graphics_constants(0, 0, &cb_render_info);
-			graphics_command_list->set_graphics_descriptor_table(0, 0, SHADER_RESOURCE_REGISTER, render_primitive->texture->shader_resource_descriptor());
+		cb_render_info.primitive_color = draw->color.value;
+		graphics_command_list->set_graphics_constants(0, 0, &cb_render_info);
+		graphics_command_list->set_graphics_descriptor_table(0, 0, SHADER_RESOURCE_REGISTER, draw->texture_descriptor);
 
-			Primitive_2D *primitive = render_primitive->primitive;
-			graphics_command_list->draw_indexed(primitive->indices.count, primitive->index_offset, primitive->vertex_offset);
-		}
+		graphics_command_list->draw_indexed(draw->index_count, draw->index_offset, draw->vertex_offset);
 	}
 	graphics_command_list->end_event();
-	
-	For(render_2d->draw_list, list) {
-		list->render_primitives.reset();
-	}
-	render_2d->draw_list.reset();
 }
 
 void Silhouette_Pass::add_render_entity_index(u32 entity_index)
@@ -379,12 +401,18 @@ void Silhouette_Pass::add_render_entity_index(u32 entity_index)
 	render_entity_indices.push(entity_index);
 }
 
-void Silhouette_Pass::delete_render_entity_index(u32 entity_index)
+// The render world moves the render entity from moved_entity_index to entity_index when it deletes a render entity.
+void Silhouette_Pass::delete_render_entity_index(u32 entity_index, u32 moved_entity_index)
 {
-	for (u32 i = 0; i < render_entity_indices.count; i++) {
+	for (u32 i = 0; i < render_entity_indices.count;) {
 		if (render_entity_indices[i] == entity_index) {
-			render_entity_indices.remove(i);
+			render_entity_indices.swap_remove(i);
+			continue;
+		}
+		if (render_entity_indices[i] == moved_entity_index) {
+			render_entity_indices[i] = entity_index;
 		}
+		i++;
 	}
 }
 
@@ -439,7 +467,7 @@ void Silhouette_Pass::setup_pipeline(Render_Device *render_device, Shader_Manage
 
 void Silhouette_Pass::render(Graphics_Command_List *graphics_command_list, void *context, void *args)
 {
-	Render_World *render_world = (Render_World *)context;
+	Render_Frame *frame = (Render_Frame *)context;
 	Render_System *render_sys = (Render_System *)args;
 
 	u32 back_buffer_index = render_sys->swap_chain->get_current_back_buffer_index();
@@ -457,28 +485,27 @@ void Silhouette_Pass::render(Graphics_Command_List *graphics_command_list, void
 	Pipeline_Resource_Manager *pipeline_resource_manager = &render_sys->pipeline_resource_manager;
 
 	graphics_command_list->set_graphics_constant_buffer(0, 10, pipeline_resource_manager->global_buffer);
-	graphics_command_list->set_graphics_constant_buffer(1, 10, pipeline_resource_manager->frame_info_buffer);
+	graphics_command_list->set_graphics_constant_buffer(1, 10, frame->frame_info_buffer_address);
 
 	graphics_command_list->set_viewport(make_viewport_from_texture(render_sys->swap_chain->get_back_buffer()));
 	
-	graphics_command_list->set_graphics_descriptor_table(0, 0, SHADER_RESOURCE_REGISTER, render_world->world_matrices_buffer->shader_resource_descriptor());
-	graphics_command_list->set_graphics_descriptor_table(1, 0, SHADER_RESOURCE_REGISTER, render_world->model_storage.mesh_instance_buffer->shader_resource_descriptor());
-	graphics_command_list->set_graphics_descriptor_table(2, 0, SHADER_RESOURCE_REGISTER, render_world->model_storage.unified_vertex_buffer->shader_resource_descriptor());
-	graphics_command_list->set_graphics_descriptor_table(3, 0, SHADER_RESOURCE_REGISTER, render_world->model_storage.unified_index_buffer->shader_resource_descriptor());
+	graphics_command_list->set_graphics_descriptor_table(0, 0, SHADER_RESOURCE_REGISTER, frame->world_matrices_buffer->shader_resource_descriptor());
+	graphics_command_list->set_graphics_descriptor_table(1, 0, SHADER_RESOURCE_REGISTER, frame->mesh_instance_buffer->shader_resource_descriptor());
+	graphics_command_list->set_graphics_descriptor_table(2, 0, SHADER_RESOURCE_REGISTER, frame->unified_vertex_buffer->shader_resource_descriptor());
+	graphics_command_list->set_graphics_descriptor_table(3, 0, SHADER_RESOURCE_REGISTER, frame->unified_index_buffer->shader_resource_descriptor());
 
 	Pass_Data pass_data;
 
-	Render_Entity *render_entity = NULL;
-	for (u32 i = 0; i < render_entity_indices.count; i++) {
-		u32 index = render_entity_indices[i];
-		Render_Entity *render_entity = &render_world->game_render_entities[index];
+	for (u32 i = 0; i < frame->silhouette_entity_indices.count; i++) {
+		u32 index = frame->silhouette_entity_indices[i];
+		Render_Entity_Draw *render_entity = &frame->render_entities[index];
 
 		pass_data.parameter0 = render_entity->mesh_idx;
 		pass_data.parameter1 = render_entity->world_matrix_idx;
 		pass_data.parameter2 = i + 1;
 
 		graphics_command_list->set_graphics_constants(0, 0, &pass_data);
-		graphics_command_list->draw(render_world->model_storage.render_models[render_entity->mesh_idx]->mesh.index_count());
+		graphics_command_list->draw(render_entity->index_count);
 	}	
 	graphics_command_list->end_event();
 }
@@ -531,7 +558,7 @@ void Outlining_Pass::setup_pipeline(Render_Device *render_device, Shader_Manager
 
 void Outlining_Pass::render(Graphics_Command_List *graphics_command_list, void *context, void *args)
 {
-	Render_World *render_world = (Render_World *)context;
+	Render_Frame *frame = (Render_Frame *)context;
 	Render_System *render_sys = (Render_System *)args;
 
 	graphics_command_list->begin_event("Outlining");
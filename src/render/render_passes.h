@@ -31,8 +31,16 @@ struct Render_Pass {
 	virtual void schedule_resources(Pipeline_Resource_Manager *resource_manager);
 	virtual void setup_pipeline(Render_Device *device, Shader_Manager *shader_manager) = 0;
 	virtual void render(Graphics_Command_List *graphics_command_list, void *context, void *args = NULL) = 0;
+
+	// A pass can split its work in several parts. Every part is recorded in its own command list, parts of all passes
+	// are recorded at the same time on the job threads and executed in order, so a part must set all state it uses.
+	virtual u32 get_part_count(void *context);
+	virtual void render_part(Graphics_Command_List *graphics_command_list, void *context, void *args, u32 part_index, u32 part_count);
 };
 
+const u32 SHADOWS_PASS_DRAWS_PER_PART = 2048;
+const u32 SHADOWS_PASS_MAX_PART_COUNT = 8;
+
 struct Shadows_Pass : Render_Pass {
 	Texture *shadow_atlas = NULL;
 
@@ -41,6 +49,9 @@ struct Shadows_Pass : Render_Pass {
 	void setup_root_signature(Render_Device *device);
 	void setup_pipeline(Render_Device *device, Shader_Manager *shader_manager);
 	void render(Graphics_Command_List *graphics_command_list, void *context, void *args = NULL);
+
+	u32 get_part_count(void *context);
+	void render_part(Graphics_Command_List *graphics_command_list, void *context, void *args, u32 part_index, u32 part_count);
 };
 
 struct Forward_Pass : Render_Pass {
@@ -67,7 +78,7 @@ struct Silhouette_Pass : Render_Pass {
 	
 	Array<u32> render_entity_indices;
 	void add_render_entity_index(u32 entity_index);
-	void delete_render_entity_index(u32 entity_index);
+	void delete_render_entity_index(u32 entity_index, u32 moved_entity_index);
 	void reset_render_entity_indices();
 
 	void init(Render_Device *device, Shader_Manager *shader_manager, Pipeline_Resource_Manager *resource_manager);
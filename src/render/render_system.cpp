@@ -1,9 +1,12 @@
 #include <assert.h>
+#include <chrono>
 
 #include "font.h"
 #include "render_system.h"
 
 #include "../sys/sys.h"
+#include "../sys/jobs.h"
+#include "../sys/profiling.h"
 #include "../sys/vars.h"
 #include "../sys/engine.h"
 #include "../libs/os/path.h"
@@ -23,8 +26,8 @@ void View_Plane::update(u32 _fov, u32 _width, u32 _height, float _near_plane, fl
 	fov = degrees_to_radians((float)_fov);
 	near_plane = _near_plane;
 	far_plane = _far_plane;
-	perspective_matrix = XMMatrixPerspectiveFovLH(fov, ratio, near_plane, far_plane);
-	orthographic_matrix = XMMatrixOrthographicOffCenterLH(0.0f, (float)width, (float)height, 0.0f, near_plane, far_plane);
+	perspective_matrix = make_perspective_matrix(fov, ratio, near_plane, far_plane);
+	orthographic_matrix = make_orthographic_off_center_matrix(0.0f, (float)width, (float)height, 0.0f, near_plane, far_plane);
 }
 
 Command_List_Allocator::Command_List_Allocator()
@@ -110,17 +113,23 @@ void Render_System::init(Win32_Window *win32_window, Variable_Service *variable_
 	back_buffer_texture_desc.format = DXGI_FORMAT_R8G8B8A8_UNORM;
 
 	pipeline_resource_manager.init(render_device, &back_buffer_texture_desc);
-	command_list_allocator.init(render_device, back_buffer_count);
+
+	command_list_allocator_count = get_job_thread_count() + JOB_MAX_ATTACHED_THREAD_COUNT + 1;
+	command_list_allocators = new Command_List_Allocator[command_list_allocator_count];
+	for (u32 i = 0; i < command_list_allocator_count; i++) {
+		command_list_allocators[i].init(render_device, back_buffer_count);
+	}
 
 	render_2d.init(this);
 
 	init_passes();
+
+	render_thread = new std::thread(&Render_System::run_render_thread, this);
 }
 
 void Render_System::init_passes()
 {
 	Shader_Manager *shader_manager = &Engine::get_instance()->shader_manager;
-	Render_World *render_world = Engine::get_render_world();
 
 	passes.shadows_pass.init(render_device, shader_manager, &pipeline_resource_manager);
 	passes.forward_pass.init(render_device, shader_manager, &pipeline_resource_manager);
@@ -128,11 +137,28 @@ void Render_System::init_passes()
 	passes.outlining_pass.init(render_device, shader_manager, &pipeline_resource_manager);
 	passes.render2d_pass.init(render_device, shader_manager, &pipeline_resource_manager);
 
-	render_pass_submissions.push({ &passes.shadows_pass,  (void *)render_world, (void *)this });
-	render_pass_submissions.push({ &passes.forward_pass,  (void *)render_world, (void *)this });
-	render_pass_submissions.push({ &passes.silhouette_pass,  (void *)render_world, (void *)this });
-	render_pass_submissions.push({ &passes.outlining_pass,  (void *)render_world, (void *)this });
-	render_pass_submissions.push({ &passes.render2d_pass, (void *)&render_2d,   (void *)this });
+	render_pass_submissions.push({ &passes.shadows_pass, (void *)this });
+	render_pass_submissions.push({ &passes.forward_pass, (void *)this });
+	render_pass_submissions.push({ &passes.silhouette_pass, (void *)this });
+	render_pass_submissions.push({ &passes.outlining_pass, (void *)this });
+	render_pass_submissions.push({ &passes.render2d_pass, (void *)this });
+}
+
+void Render_System::shutdown()
+{
+	flush();
+	{
+		std::lock_guard<std::mutex> lock(render_thread_mutex);
+		stop_render_thread = true;
+	}
+	render_thread_condition.notify_all();
+	
+	if (render_thread) {
+		render_thread->join();
+		DELETE_PTR(render_thread);
+	}
+	DELETE_ARRAY(command_list_allocators);
+	command_list_allocator_count = 0;
 }
 
 void Render_System::resize(u32 window_width, u32 window_height)
@@ -141,12 +167,14 @@ void Render_System::resize(u32 window_width, u32 window_height)
 	}
 }
 
+// Waits until the render thread and the GPU have finished all submitted frames.
 void Render_System::flush()
 {
-	/*Fence fence;
-	fence.create(gpu_device, 1);
-	graphics_queue.signal(fence);
-	fence.wait_for_gpu();*/
+	wait_for_render_thread();
+
+	graphics_queue->signal(frame_fence);
+	frame_fence->wait_for_gpu();
+	frame_fence->increment_expected_value();
 }
 
 void Render_System::notify_start_frame()
@@ -155,9 +183,7 @@ void Render_System::notify_start_frame()
 
 void Render_System::notify_end_frame()
 {
-	command_list_allocator.finish_frame(frame_fence->expected_value - 1);
-
-	render_device->finish_frame(frame_fence->expected_value - 1);
+	render_device->finish_frame(completed_gpu_frame);
 }
 
 //void wait_for_gpu(Fence *fence, u64 expected_value)
@@ -169,31 +195,112 @@ void Render_System::notify_end_frame()
 //	}
 //}
 
+// Called on the main thread at the end of a frame. The render world and the 2D renderer are copied in a free
+// render frame, then the main thread waits for the render thread to finish the previous frame. The render device
+// is changed only by the main thread, so everything which uploads data or advances the device frame
+// is done while the render thread is idle, after that the render thread gets the new frame.
 void Render_System::render()
 {
 	notify_start_frame();
-	
+
+	Render_Frame *frame = &render_frames[render_frame_index];
+	render_frame_index = (render_frame_index + 1) % RENDER_FRAME_COUNT;
+
+	Engine::get_render_world()->make_render_frame(frame);
+	render_2d.make_render_frame(frame);
+
+	frame->silhouette_entity_indices.reset();
+	for (u32 i = 0; i < passes.silhouette_pass.render_entity_indices.count; i++) {
+		frame->silhouette_entity_indices.push(passes.silhouette_pass.render_entity_indices[i]);
+	}
+
+	wait_for_render_thread();
+	last_frame_timings = recorded_frame_timings;
+
+	{
+		std::lock_guard<std::mutex> lock(deleted_buffers_mutex);
+		Buffer *buffer = NULL;
+		For(deleted_buffers, buffer) {
+			DELETE_PTR(buffer);
+		}
+		deleted_buffers.reset();
+	}
+
 	render_2d.prepare_for_rendering(render_device);
+	frame->vertex_buffer_2d = render_2d.vertex_buffer;
+	frame->index_buffer_2d = render_2d.index_buffer;
 
 	pipeline_resource_manager.update_common_constant_buffers();
+	frame->frame_info_buffer_address = pipeline_resource_manager.frame_info_buffer->gpu_virtual_address();
 
 	Fence *uploading_fence = render_device->execute_uploading();
+	graphics_queue->wait(uploading_fence);
 
-	Graphics_Command_List *graphics_command_list = static_cast<Graphics_Command_List *>(command_list_allocator.allocate_command_list(COMMAND_LIST_TYPE_DIRECT));
-	graphics_command_list->reset();
+	notify_end_frame();
 
-	graphics_command_list->transition_resource_barrier(swap_chain->get_back_buffer(), RESOURCE_STATE_PRESENT, RESOURCE_STATE_RENDER_TARGET);
-	
+	{
+		std::lock_guard<std::mutex> lock(render_thread_mutex);
+		submitted_render_frame = frame;
+	}
+	render_thread_condition.notify_all();
+}
+
+// Called on the render thread. Parts of the render passes are recorded on the job threads, every part in its own
+// command list from the allocator of the thread which records it. The command lists are executed in the order of the passes.
+void Render_System::render_frame(Render_Frame *frame)
+{
+	PROFILE_SCOPE("Render frame");
+	u64 frame_start_ticks = profile_ticks();
+	float milliseconds_per_tick = 1000.0f / (float)profile_ticks_per_second();
+
+	Graphics_Command_List *begin_command_list = static_cast<Graphics_Command_List *>(get_command_list_allocator()->allocate_command_list(COMMAND_LIST_TYPE_DIRECT));
+	begin_command_list->reset();
+	begin_command_list->transition_resource_barrier(swap_chain->get_back_buffer(), RESOURCE_STATE_PRESENT, RESOURCE_STATE_RENDER_TARGET);
+	begin_command_list->close();
+
+	render_pass_parts.reset();
 	for (u32 i = 0; i < render_pass_submissions.count; i++) {
-		Render_Pass_Submission render_pass_submission = render_pass_submissions[i];
-		render_pass_submission.render_pass->render(graphics_command_list, render_pass_submission.context, render_pass_submission.args);
+		u32 part_count = render_pass_submissions[i].render_pass->get_part_count((void *)frame);
+		for (u32 j = 0; j < part_count; j++) {
+			render_pass_parts.push({ i, j, part_count, 0.0f, NULL });
+		}
 	}
+	parallel_for(render_pass_parts, [this, frame](Render_Pass_Part *part, u32 index) {
+		Render_Pass_Submission *render_pass_submission = &render_pass_submissions[part->submission_index];
+		PROFILE_SCOPE(render_pass_submission->render_pass->name);
+
+		u64 start_ticks = profile_ticks();
+		Graphics_Command_List *graphics_command_list = static_cast<Graphics_Command_List *>(get_command_list_allocator()->allocate_command_list(COMMAND_LIST_TYPE_DIRECT));
+		graphics_command_list->reset();
+		render_pass_submission->render_pass->render_part(graphics_command_list, (void *)frame, render_pass_submission->args, part->part_index, part->part_count);
+		graphics_command_list->close();
+
+		part->command_list = graphics_command_list;
+		part->recording_time = (float)(profile_ticks() - start_ticks) * milliseconds_per_tick;
+	}, 1);
+
+	Graphics_Command_List *end_command_list = static_cast<Graphics_Command_List *>(get_command_list_allocator()->allocate_command_list(COMMAND_LIST_TYPE_DIRECT));
+	end_command_list->reset();
+	end_command_list->transition_resource_barrier(swap_chain->get_back_buffer(), RESOURCE_STATE_RENDER_TARGET, RESOURCE_STATE_PRESENT);
+	end_command_list->close();
+
+	frame_command_lists.reset();
+	frame_command_lists.push(begin_command_list);
+	for (u32 i = 0; i < render_pass_parts.count; i++) {
+		frame_command_lists.push(render_pass_parts[i].command_list);
+	}
+	frame_command_lists.push(end_command_list);
 
-	graphics_command_list->transition_resource_barrier(swap_chain->get_back_buffer(), RESOURCE_STATE_RENDER_TARGET, RESOURCE_STATE_PRESENT);
-	graphics_command_list->close();
+	recorded_frame_timings.recording_time = (float)(profile_ticks() - frame_start_ticks) * milliseconds_per_tick;
+	recorded_frame_timings.pass_times.reset();
+	for (u32 i = 0; i < render_pass_submissions.count; i++) {
+		recorded_frame_timings.pass_times.push(0.0f);
+	}
+	for (u32 i = 0; i < render_pass_parts.count; i++) {
+		recorded_frame_timings.pass_times[render_pass_parts[i].submission_index] += render_pass_parts[i].recording_time;
+	}
 
-	graphics_queue->wait(uploading_fence);
-	graphics_queue->execute_command_list(graphics_command_list);
+	graphics_queue->execute_command_lists(frame_command_lists.items, frame_command_lists.count);
 	
 	swap_chain->present(sync_interval, present_flags);
 
@@ -201,9 +308,76 @@ void Render_System::render()
 
 	frame_fence->wait_for_gpu(frame_fence->expected_value - 1);
 
-	notify_end_frame();
+	// The recording jobs have finished, so the allocators of other threads can be used here.
+	for (u32 i = 0; i < command_list_allocator_count; i++) {
+		command_list_allocators[i].finish_frame(frame_fence->expected_value - 1);
+	}
+	completed_gpu_frame = frame_fence->expected_value - 1;
 
 	frame_fence->increment_expected_value();
+	recorded_frame_timings.frame_time = (float)(profile_ticks() - frame_start_ticks) * milliseconds_per_tick;
+}
+
+void Render_System::run_render_thread()
+{
+	set_profile_thread_name("Render thread");
+	MEMORY_TAG_SCOPE(MEMORY_TAG_RENDER);
+	if (!attach_job_thread()) {
+		print("Render_System::run_render_thread: The render thread could not attach to the job system, render passes will be recorded on the render thread.");
+	}
+	while (true) {
+		Render_Frame *frame = NULL;
+		{
+			std::unique_lock<std::mutex> lock(render_thread_mutex);
+			render_thread_condition.wait(lock, [this]() { return submitted_render_frame || stop_render_thread; });
+			if (!submitted_render_frame) {
+				break;
+			}
+			frame = submitted_render_frame;
+		}
+		render_frame(frame);
+		{
+			std::lock_guard<std::mutex> lock(render_thread_mutex);
+			submitted_render_frame = NULL;
+		}
+		render_thread_condition.notify_all();
+	}
+	detach_job_thread();
+}
+
+// The swap chain presents to the window of the main thread and can send messages to it,
+// so the main thread processes sent messages while it waits for the render thread.
+void Render_System::wait_for_render_thread()
+{
+	MSG msg;
+	std::unique_lock<std::mutex> lock(render_thread_mutex);
+	while (submitted_render_frame) {
+		render_thread_condition.wait_for(lock, std::chrono::milliseconds(1));
+		lock.unlock();
+		PeekMessage(&msg, NULL, 0, 0, PM_NOREMOVE);
+		lock.lock();
+	}
+}
+
+// A buffer which can be used by the frame which the render thread records is deleted
+// when the render thread is idle. Can be called from any thread.
+void Render_System::safe_delete(Buffer *buffer)
+{
+	if (buffer) {
+		std::lock_guard<std::mutex> lock(deleted_buffers_mutex);
+		deleted_buffers.push(buffer);
+	}
+}
+
+// Every thread records command lists from its own allocator, a thread which doesn't belong to the job system uses the last one.
+Command_List_Allocator *Render_System::get_command_list_allocator()
+{
+	u32 thread_index = get_job_thread_index();
+	if (thread_index == JOB_INVALID_THREAD_INDEX) {
+		return &command_list_allocators[command_list_allocator_count - 1];
+	}
+	assert(thread_index < (command_list_allocator_count - 1));
+	return &command_list_allocators[thread_index];
 }
 
 Size_u32 Render_System::get_window_size()
@@ -2,6 +2,9 @@
 #define RENDER_SYSTEM_H
 
 #include <stdlib.h>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
 
 #include "../libs/number_types.h"
 #include "../libs/structures/array.h"
@@ -98,10 +101,74 @@ struct Command_List_Allocator {
 
 struct Render_Pass_Submission {
 	Render_Pass *render_pass = NULL;
-	void *context = NULL;
 	void *args = NULL;
 };
 
+struct Render_Pass_Part {
+	u32 submission_index = 0;
+	u32 part_index = 0;
+	u32 part_count = 0;
+	float recording_time = 0.0f; // Milliseconds.
+	Command_List *command_list = NULL;
+};
+
+// CPU times of a frame on the render thread in milliseconds.
+struct Render_Frame_Timings {
+	float frame_time = 0.0f; // Recording, presenting and waiting for the GPU to finish the frame before.
+	float recording_time = 0.0f;
+	Array<float> pass_times; // The recording time of every render pass submission, the sum of the times of its parts.
+};
+
+const u32 RENDER_FRAME_COUNT = 2;
+
+struct Render_Entity_Draw {
+	u32 mesh_idx = 0;
+	u32 world_matrix_idx = 0;
+	u32 index_count = 0;
+};
+
+struct Shadow_Map_Draw {
+	Viewport viewport;
+	Matrix4 view_projection_matrix;
+};
+
+struct Render_2D_Draw {
+	u32 index_count = 0;
+	u32 index_offset = 0;
+	u32 vertex_offset = 0;
+	Color color;
+	Rect_s32 clip_rect;
+	Matrix4 transform_matrix;
+	GPU_Descriptor *texture_descriptor = NULL;
+};
+
+// Everything the render passes read about a frame. The main thread copies it from the render world and
+// the 2D renderer at the end of a frame, the render thread records command lists from the copy
+// while the main thread updates the next frame. Passes get a render frame as their context.
+struct Render_Frame {
+	u32 jittering_tile_size = 0;
+	u32 jittering_filter_size = 0;
+	u32 jittering_scaling = 0;
+	u64 frame_info_buffer_address = 0;
+
+	Texture *jittering_samples = NULL;
+
+	Buffer *world_matrices_buffer = NULL;
+	Buffer *mesh_instance_buffer = NULL;
+	Buffer *unified_vertex_buffer = NULL;
+	Buffer *unified_index_buffer = NULL;
+	Buffer *lights_buffer = NULL;
+	Buffer *cascaded_shadows_info_buffer = NULL;
+	Buffer *cascaded_view_projection_matrices_buffer = NULL;
+	Buffer *vertex_buffer_2d = NULL;
+	Buffer *index_buffer_2d = NULL;
+
+	Array<Render_Entity_Draw> render_entities;
+	Array<u32> silhouette_entity_indices; // Indices in render_entities.
+	Array<Shadow_Map_Draw> shadow_maps;
+	Array<Render_2D_Draw> draws_2d;
+};
+
 struct Render_System {
 	struct Window {
 		bool vsync = false;
@@ -131,14 +198,35 @@ struct Render_System {
 	} passes;
 	
 	Array<Render_Pass_Submission> render_pass_submissions;
+	Array<Render_Pass_Part> render_pass_parts;
+	Array<Command_List *> frame_command_lists;
 
-	Command_List_Allocator command_list_allocator;
+	// An allocator for every job thread and one for the render thread if it could not attach to the job system.
+	u32 command_list_allocator_count = 0;
+	Command_List_Allocator *command_list_allocators = NULL;
 	Pipeline_Resource_Manager pipeline_resource_manager;
 
 	Render_2D render_2d;
 
+	u32 render_frame_index = 0;
+	u64 completed_gpu_frame = 0;
+	Render_Frame render_frames[RENDER_FRAME_COUNT];
+
+	bool stop_render_thread = false;
+	Render_Frame *submitted_render_frame = NULL; // The frame which the render thread records, NULL when the thread is idle.
+	std::thread *render_thread = NULL;
+	std::mutex render_thread_mutex;
+	std::condition_variable render_thread_condition;
+
+	Render_Frame_Timings recorded_frame_timings; // Written by the render thread.
+	Render_Frame_Timings last_frame_timings; // The timings of the last frame which the render thread finished, copied while it is idle.
+
+	std::mutex deleted_buffers_mutex;
+	Array<Buffer *> deleted_buffers;
+
 	void init(Win32_Window *win32_window, Variable_Service *variable_service);
 	void init_passes();
+	void shutdown();
 
 	void resize(u32 window_width, u32 window_height);
 	void flush();
@@ -146,6 +234,13 @@ struct Render_System {
 	void notify_start_frame();
 	void notify_end_frame();
 	void render();
+	void render_frame(Render_Frame *frame);
+	void run_render_thread();
+	void wait_for_render_thread();
+
+	void safe_delete(Buffer *buffer);
+
+	Command_List_Allocator *get_command_list_allocator();
 
 	Size_u32 get_window_size();
 };
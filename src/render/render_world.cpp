@@ -6,6 +6,7 @@
 #include "render_world.h"
 
 #include "../sys/sys.h"
+#include "../sys/jobs.h"
 #include "../sys/engine.h"
 
 #include "../libs/os/path.h"
@@ -19,10 +20,9 @@ Matrix4 get_world_matrix(Entity *entity)
 {
 	if (entity->type == ENTITY_TYPE_CAMERA) {
 		Camera *camera = static_cast<Camera *>(entity);
-		Matrix4 view_matrix = make_look_at_matrix(camera->position, camera->target);
-		return inverse(&view_matrix);
+		return inverse_orthonormal(make_look_at_matrix(camera->position, camera->target));
 	}
-	return make_scale_matrix(&entity->scaling) * rotate(&entity->rotation) * make_translation_matrix(&entity->position);
+	return make_world_matrix(entity->scaling, entity->orientation, entity->position);
 }
 
 template <typename T>
@@ -66,26 +66,13 @@ static void make_jittering_sampling_filters(u32 tile_size, u32 filter_size, Arra
 	}
 }
 
-Render_Entity *find_render_entity(Array<Render_Entity> *render_entities, Entity_Id entity_id, u32 *index)
-{
-	for (u32 i = 0; i < render_entities->count; i++) {
-		if (render_entities->get(i).entity_id == entity_id) {
-			if (index) {
-				*index = i;
-			}
-			return &render_entities->get(i);
-		}
-	}
-	return NULL;
-}
-
 void Rendering_View::update(Game_World *game_world)
 {
 	Camera *camera = game_world->get_camera(camera_id);
 	position = camera->position;
 	direction = normalize(camera->target - camera->position);
 	view_matrix = make_look_at_matrix(position, camera->target);
-	inverse_view_matrix = inverse(&view_matrix);
+	inverse_view_matrix = inverse_orthonormal(view_matrix);
 }
 
 bool Rendering_View::is_entity_camera_set()
@@ -123,6 +110,7 @@ void Shadow_Cascade_Ranges::add_range(u32 start, u32 end)
 
 void Model_Storage::init()
 {
+	MEMORY_TAG_SCOPE(MEMORY_TAG_ASSETS);
 	u32 width = 256;
 	u32 height = 256;
 
@@ -163,14 +151,14 @@ void Model_Storage::release_all_resources()
 bool validate_model_name_and_get_string_id(String_Id *model_string_id, Loading_Model *model)
 {
 	if (!model->name.is_empty() && !model->file_name.is_empty()) {
-		*model_string_id = fast_hash(model->file_name + "_" + model->name);
+		*model_string_id = intern_joined_string(model->file_name, "_", model->name);
 		return true;
 	} else if (exclusive_or(model->name.is_empty(), model->file_name.is_empty())) {
 		if (model->name.is_empty()) {
-			*model_string_id = fast_hash(model->file_name);
+			*model_string_id = intern_string(model->file_name);
 			print("[Mesh storage] Warning: A tringle mesh contains only a file name '{}' it's possible to get the collision.", model->file_name);
 		} else {
-			*model_string_id = fast_hash(model->name);
+			*model_string_id = intern_string(model->name);
 			print("[Mesh storage] Warning: A tringle mesh contains only a name '{}' it's possible to get the collision.", model->name);
 		}
 		return true;
@@ -182,29 +170,14 @@ bool validate_model_name_and_get_string_id(String_Id *model_string_id, Loading_M
 void move(Triangle_Mesh *dest, Triangle_Mesh *source)
 {
 	if (!source->empty()) {
-		if (!dest->vertices.is_empty()) { DELETE_ARRAY(dest->vertices.items); };
-		if (!dest->indices.is_empty()) { DELETE_ARRAY(dest->indices.items); };
-
-		dest->vertices.items = source->vertices.items;
-		dest->vertices.count = source->vertices.count;
-		dest->vertices.size = source->vertices.size;
-
-		dest->indices.items = source->indices.items;
-		dest->indices.count = source->indices.count;
-		dest->indices.size = source->indices.size;
-
-		source->vertices.items = NULL;
-		source->vertices.count = 0;
-		source->vertices.size = 0;
-		
-		source->indices.items = NULL;
-		source->indices.count = 0;
-		source->indices.size = 0;
+		dest->vertices = std::move(source->vertices);
+		dest->indices = std::move(source->indices);
 	}
 }
 
 void Model_Storage::add_models(Array<Loading_Model *> &models, Array<Pair<Loading_Model *, u32>> &result)
 {
+	MEMORY_TAG_SCOPE(MEMORY_TAG_ASSETS);
 	result.resize(models.count);
 
 	for (u32 i = 0; i < models.count; i++) {
@@ -220,10 +193,10 @@ void Model_Storage::add_models(Array<Loading_Model *> &models, Array<Pair<Loadin
 			continue;
 		}
 
-		Pair<Render_Model *, u32> *temp = NULL;
-		if (render_models_table.get(model_string_id, temp)) {
+		Pair<Render_Model *, u32> render_model_info;
+		if (render_models_table.get(model_string_id, render_model_info)) {
 			print("[Mesh storage] Info: {} mesh has already been placed in the mesh storage.", loading_model->get_pretty_name());
-			result.push({ loading_model, temp->second });
+			result.push({ loading_model, render_model_info.second });
 			continue;
 		}
 
@@ -246,6 +219,7 @@ void Model_Storage::add_models(Array<Loading_Model *> &models, Array<Pair<Loadin
 
 void Model_Storage::upload_models_in_gpu()
 {
+	MEMORY_TAG_SCOPE(MEMORY_TAG_ASSETS);
 	Render_Device *render_device = Engine::get_render_system()->render_device;
 	Render_System *render_sys = Engine::get_render_system();
 
@@ -294,7 +268,7 @@ void Model_Storage::upload_models_in_gpu()
 	}
 
 	if (!unified_vertex_buffer || (unified_vertex_buffer->size() < (u64)unified_vertex_list.get_size())) {
-		DELETE_PTR(unified_vertex_buffer);
+		render_sys->safe_delete(unified_vertex_buffer);
 		Buffer_Desc buffer_desc;
 		buffer_desc.count = unified_vertex_list.count;
 		buffer_desc.stride = unified_vertex_list.stride;
@@ -305,7 +279,7 @@ void Model_Storage::upload_models_in_gpu()
 	}
 
 	if (!unified_index_buffer || (unified_index_buffer->size() < (u64)unified_index_list.get_size())) {
-		DELETE_PTR(unified_index_buffer);
+		render_sys->safe_delete(unified_index_buffer);
 		Buffer_Desc buffer_desc;
 		buffer_desc.count = unified_index_list.count;
 		buffer_desc.stride = unified_index_list.stride;
@@ -316,7 +290,7 @@ void Model_Storage::upload_models_in_gpu()
 	}
 
 	if (!mesh_instance_buffer || (mesh_instance_buffer->size() < (u64)unified_mesh_instances_list.get_size())) {
-		DELETE_PTR(mesh_instance_buffer);
+		render_sys->safe_delete(mesh_instance_buffer);
 		Buffer_Desc buffer_desc;
 		buffer_desc.count = unified_mesh_instances_list.count;
 		buffer_desc.stride = unified_mesh_instances_list.stride;
@@ -331,7 +305,7 @@ Texture *Model_Storage::find_texture_or_get_default(String &texture_file_name, S
 {
 	if (!texture_file_name.is_empty()) {
 		Texture *texture = NULL;
-		String_Id texture_string_id = fast_hash(texture_file_name);
+		String_Id texture_string_id = intern_string(texture_file_name);
 
 		if (textures_table.get(texture_string_id, texture)) {
 			return texture;
@@ -345,8 +319,9 @@ Texture *Model_Storage::find_texture_or_get_default(String &texture_file_name, S
 		build_full_path_to_texture_file(texture_file_name, paths[1]);
 
 		for (u32 i = 0; i < paths.count; i++) {
-			Texture *texture = create_texture_from_file(paths[i]);
+			texture = create_texture_from_file(paths[i]);
 			if (texture) {
+				textures_table.set(texture_string_id, texture);
 				return texture;
 			}
 		}
@@ -396,7 +371,7 @@ void Render_World::init(Engine *engine)
 	float grid_depth = grid_size.depth;
 	grid_size *= 0.5f;
 
-	voxel_matrix = XMMatrixOrthographicOffCenterLH(-grid_size.width, grid_size.width, -grid_size.height, grid_size.height, 1.0f, grid_depth + 1.0f);
+	voxel_matrix = make_orthographic_off_center_matrix(-grid_size.width, grid_size.width, -grid_size.height, grid_size.height, 1.0f, grid_depth + 1.0f);
 
 	if (!rendering_view.is_entity_camera_set()) {
 		error("Render Camera was not initialized. There is no a view for rendering.");
@@ -442,10 +417,12 @@ void Render_World::release_render_entities_resources()
 	shadow_cascade_ranges.clear();
 	lights.clear();
 
+	render_entity_transforms.free();
 	render_entity_world_matrices.clear();
 	cascaded_view_projection_matrices.clear();
 
 	game_render_entities.clear();
+	render_entity_table.clear();
 
 	cascaded_shadows_list.clear();
 	cascaded_shadows_info_list.clear();
@@ -461,16 +438,24 @@ void Render_World::update()
 	//update_global_illumination();
 }
 
+// Render entities are updated in batches on all job threads. A batch writes only its own transforms and world matrices.
 void Render_World::update_render_entities()
 {
-	Render_Entity *render_entity = NULL;
-	For(game_render_entities, render_entity) {
-		Entity *entity = game_world->get_entity(render_entity->entity_id);
-		render_entity_world_matrices[render_entity->world_matrix_idx] = get_world_matrix(entity);
+	render_entity_transforms.resize(game_render_entities.count);
+
+	Job_Function update_batch = [](void *data, u32 first_index, u32 last_index) {
+		Render_World *render_world = (Render_World *)data;
+		render_world->update_world_matrices(first_index, last_index);
+	};
+	Job_Counter counter;
+	for (u32 first_index = 0; first_index < game_render_entities.count; first_index += WORLD_MATRIX_BATCH_SIZE) {
+		u32 last_index = math::min(first_index + WORLD_MATRIX_BATCH_SIZE, game_render_entities.count);
+		run_job(update_batch, (void *)this, first_index, last_index, &counter);
 	}
+	wait_for_counter(&counter);
 
 	if (!world_matrices_buffer || (world_matrices_buffer->size() < (u64)render_entity_world_matrices.get_size())) {
-		DELETE_PTR(world_matrices_buffer);
+		render_sys->safe_delete(world_matrices_buffer);
 		Buffer_Desc buffer_desc;
 		buffer_desc.count = render_entity_world_matrices.count;
 		buffer_desc.stride = render_entity_world_matrices.stride;
@@ -481,6 +466,31 @@ void Render_World::update_render_entities()
 	}
 }
 
+// Transforms of a batch are copied from entities to SoA streams and made into world matrices while they are still in the cache.
+// Cameras are rare, their matrices are made by the kernel too and then replaced with the inverse of the view matrix.
+void Render_World::update_world_matrices(u32 first_index, u32 last_index)
+{
+	Render_Entity *render_entities = game_render_entities.items;
+	u32 camera_count = 0;
+	for (u32 i = first_index; i < last_index; i++) {
+		assert(render_entities[i].world_matrix_idx == i);
+
+		Entity *entity = game_world->get_entity(render_entities[i].entity_id);
+		render_entity_transforms.set(i, entity->position, entity->orientation, entity->scaling);
+		if (entity->type == ENTITY_TYPE_CAMERA) {
+			camera_count++;
+		}
+	}
+	make_world_matrices(&render_entity_transforms, first_index, last_index, render_entity_world_matrices.items);
+
+	for (u32 i = first_index; (i < last_index) && (camera_count > 0); i++) {
+		if (render_entities[i].entity_id.type == ENTITY_TYPE_CAMERA) {
+			render_entity_world_matrices[i] = get_world_matrix(game_world->get_entity(render_entities[i].entity_id));
+			camera_count--;
+		}
+	}
+}
+
 void Render_World::update_global_illumination()
 {
 	Vector3 voxel_ceil_size = voxel_grid.ceil_size.to_vector3();
@@ -548,7 +558,7 @@ void Render_World::upload_lights()
 		}
 	}
 	if (!lights_buffer || (lights_buffer->size() < (u64)lights.get_size())) {
-		DELETE_PTR(world_matrices_buffer);
+		render_sys->safe_delete(lights_buffer);
 		Buffer_Desc buffer_desc;
 		buffer_desc.count = lights.count;
 		buffer_desc.stride = lights.stride;
@@ -559,7 +569,7 @@ void Render_World::upload_lights()
 	}
 
 	if (!cascaded_shadows_info_buffer || (cascaded_shadows_info_buffer->size() < (u64)cascaded_shadows_info_list.get_size())) {
-		DELETE_PTR(cascaded_shadows_info_buffer);
+		render_sys->safe_delete(cascaded_shadows_info_buffer);
 		Buffer_Desc buffer_desc;
 		buffer_desc.count = cascaded_shadows_info_list.count;
 		buffer_desc.stride = cascaded_shadows_info_list.stride;
@@ -570,6 +580,42 @@ void Render_World::upload_lights()
 	}
 }
 
+// Called on the main thread when the render thread may be recording the previous frame from another render frame.
+void Render_World::make_render_frame(Render_Frame *render_frame)
+{
+	render_frame->jittering_tile_size = jittering_tile_size;
+	render_frame->jittering_filter_size = jittering_filter_size;
+	render_frame->jittering_scaling = jittering_scaling;
+	render_frame->jittering_samples = jittering_samples;
+
+	render_frame->world_matrices_buffer = world_matrices_buffer;
+	render_frame->mesh_instance_buffer = model_storage.mesh_instance_buffer;
+	render_frame->unified_vertex_buffer = model_storage.unified_vertex_buffer;
+	render_frame->unified_index_buffer = model_storage.unified_index_buffer;
+	render_frame->lights_buffer = lights_buffer;
+	render_frame->cascaded_shadows_info_buffer = cascaded_shadows_info_buffer;
+	render_frame->cascaded_view_projection_matrices_buffer = casded_view_projection_matrices_buffer;
+
+	render_frame->render_entities.reset();
+	Render_Entity *render_entity = NULL;
+	For(game_render_entities, render_entity) {
+		Render_Entity_Draw render_entity_draw;
+		render_entity_draw.mesh_idx = render_entity->mesh_idx;
+		render_entity_draw.world_matrix_idx = render_entity->world_matrix_idx;
+		render_entity_draw.index_count = model_storage.render_models[render_entity->mesh_idx]->mesh.index_count();
+		render_frame->render_entities.push(render_entity_draw);
+	}
+
+	render_frame->shadow_maps.reset();
+	Cascaded_Shadows *cascaded_shadows = NULL;
+	For(cascaded_shadows_list, cascaded_shadows) {
+		Cascaded_Shadow_Map *cascaded_shadow_map = NULL;
+		For(cascaded_shadows->cascaded_shadow_maps, cascaded_shadow_map) {
+			render_frame->shadow_maps.push({ cascaded_shadow_map->viewport, cascaded_shadow_map->view_projection_matrix });
+		}
+	}
+}
+
 void Render_World::add_render_entity(Entity_Id entity_id, u32 mesh_idx, void *args)
 {
 	Render_Entity render_entity;
@@ -577,22 +623,44 @@ void Render_World::add_render_entity(Entity_Id entity_id, u32 mesh_idx, void *ar
 	render_entity.mesh_idx = mesh_idx;
 	render_entity.world_matrix_idx = render_entity_world_matrices.push(Matrix4());
 
-	game_render_entities.push(render_entity);
+	u32 render_entity_index = game_render_entities.push(render_entity);
+	render_entity_table.set(make_entity_key(entity_id), render_entity_index);
 }
 
-u32 Render_World::delete_render_entity(Entity_Id entity_id)
+// Render entities and world matrices are kept in the same order. The last render entity
+// is moved in place of the deleted one, its old index is returned in moved_render_entity_index.
+bool Render_World::delete_render_entity(Entity_Id entity_id, u32 *render_entity_index, u32 *moved_render_entity_index)
 {
-	u32 render_entity_index;
-	find_render_entity(&game_render_entities, entity_id, &render_entity_index);
-	game_render_entities.remove(render_entity_index);
+	u64 entity_key = make_entity_key(entity_id);
+	if (!render_entity_table.get(entity_key, *render_entity_index)) {
+		return false;
+	}
+	u32 index = *render_entity_index;
+	assert(game_render_entities[index].world_matrix_idx == index);
+
+	render_entity_table.remove(entity_key);
+	game_render_entities.swap_remove(index);
+	render_entity_world_matrices.swap_remove(index);
+
+	*moved_render_entity_index = game_render_entities.count;
+	if (index < game_render_entities.count) {
+		Render_Entity *moved_render_entity = &game_render_entities[index];
+		moved_render_entity->world_matrix_idx = index;
+		render_entity_table[make_entity_key(moved_render_entity->entity_id)] = index;
+	}
+	return true;
+}
 
-	for (u32 i = 0; i < game_render_entities.count; i++) {
-		Render_Entity *render_entity = &game_render_entities[i];
-		if (render_entity->entity_id.index > entity_id.index) {
-			render_entity->entity_id.index -= 1;
+Render_Entity *Render_World::find_render_entity(Entity_Id entity_id, u32 *render_entity_index)
+{
+	u32 index = 0;
+	if (render_entity_table.get(make_entity_key(entity_id), index)) {
+		if (render_entity_index) {
+			*render_entity_index = index;
 		}
+		return &game_render_entities[index];
 	}
-	return render_entity_index;
+	return NULL;
 }
 
 void Render_World::update_shadows()
@@ -646,23 +714,20 @@ void Render_World::update_shadows()
 			//radius = std::floor(radius);
 			//radius *= r;
 
-			Matrix4 projection_matrix = XMMatrixOrthographicOffCenterLH(-radius, radius, -radius, radius, -5000.0f, 5000.0f);
+			Matrix4 projection_matrix = make_orthographic_off_center_matrix(-radius, radius, -radius, radius, -5000.0f, 5000.0f);
 
 			cascaded_shadow_map->view_projection_matrix = light_view_matrix * projection_matrix;
 
-			XMMATRIX shadowMatrix = XMLoadFloat4x4(&cascaded_shadow_map->view_projection_matrix);
-			XMVECTOR shadowOrigin = XMVectorSet(0.0f, 0.0f, 0.0f, 1.0f);
-			shadowOrigin = XMVector4Transform(shadowOrigin, shadowMatrix);
-			shadowOrigin = XMVectorScale(shadowOrigin, (float)CASCADE_SIZE / 2.0f);
+			// The origin of the light space is snapped to shadow map texels, shadows don't shimmer when the camera moves.
+			Vector4 shadow_origin = Vector4(0.0f, 0.0f, 0.0f, 1.0f) * cascaded_shadow_map->view_projection_matrix;
+			shadow_origin *= (float)CASCADE_SIZE / 2.0f;
 
-			XMVECTOR roundedOrigin = XMVectorRound(shadowOrigin);
-			XMVECTOR roundOffset = XMVectorSubtract(roundedOrigin, shadowOrigin);
-			roundOffset = XMVectorScale(roundOffset, 2.0f / (float)CASCADE_SIZE);
-			roundOffset = XMVectorSetZ(roundOffset, 0.0f);
-			roundOffset = XMVectorSetW(roundOffset, 0.0f);
+			Vector4 round_offset = (round(shadow_origin) - shadow_origin) * (2.0f / (float)CASCADE_SIZE);
+			round_offset.z = 0.0f;
+			round_offset.w = 0.0f;
 
 			Matrix4 matrix = cascaded_shadow_map->view_projection_matrix;
-			Vector4 vector = roundOffset;
+			Vector4 vector = round_offset;
 			vector.x += matrix.m[3][0];
 			vector.y += matrix.m[3][1];
 			vector.z += matrix.m[3][2];
@@ -674,7 +739,7 @@ void Render_World::update_shadows()
 	}
 
 	//if (!casded_view_projection_matrices_buffer || (casded_view_projection_matrices_buffer->size() < (u64)cascaded_view_projection_matrices.get_size())) {
-		DELETE_PTR(casded_view_projection_matrices_buffer);
+		render_sys->safe_delete(casded_view_projection_matrices_buffer);
 		Buffer_Desc buffer_desc;
 		//buffer_desc.usage = RESOURCE_USAGE_UPLOAD;
 		buffer_desc.count = cascaded_view_projection_matrices.count;
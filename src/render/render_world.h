@@ -16,6 +16,7 @@
 #include "../libs/math/vector.h"
 #include "../libs/math/matrix.h"
 #include "../libs/math/structures.h"
+#include "../libs/math/transform_batch.h"
 #include "../libs/structures/array.h"
 #include "../libs/structures/hash_table.h"
 
@@ -27,6 +28,7 @@ typedef u32 Render_Entity_Idx;
 const u32 CASCADE_COUNT = 3;
 const u32 SHADOW_ATLAS_SIZE = 8192;
 const u32 CASCADE_SIZE = 1024;
+const u32 WORLD_MATRIX_BATCH_SIZE = 2048;
 
 struct Render_Entity {
 	u32 world_matrix_idx;
@@ -35,7 +37,6 @@ struct Render_Entity {
 };
 
 Matrix4 get_world_matrix(Entity *entity);
-Render_Entity *find_render_entity(Array<Render_Entity> *render_entities, Entity_Id entity_id, u32 *index = NULL);
 
 struct GPU_Material {
 	u32 normal_idx;
@@ -190,10 +191,12 @@ struct Render_World {
 
 	Bounding_Sphere world_bounding_sphere;
 
+	Transform_Streams render_entity_transforms;
 	Array<Matrix4> render_entity_world_matrices;
 	Array<Matrix4> cascaded_view_projection_matrices;
 
 	Array<Render_Entity> game_render_entities;
+	Hash_Table<u64, u32> render_entity_table;
 
 	Array<Cascaded_Shadows> cascaded_shadows_list;
 	Array<GPU_Cascaded_Shadows_Info> cascaded_shadows_info_list;
@@ -224,12 +227,15 @@ struct Render_World {
 	void update();
 	void update_shadows();
 	void update_render_entities();
+	void update_world_matrices(u32 first_index, u32 last_index);
 	void update_global_illumination();
 
 	void upload_lights();
+	void make_render_frame(Render_Frame *render_frame);
 
 	void add_render_entity(Entity_Id entity_id, u32 mesh_idx, void *args = NULL);
-	u32 delete_render_entity(Entity_Id entity_id);
+	bool delete_render_entity(Entity_Id entity_id, u32 *render_entity_index, u32 *moved_render_entity_index);
+	Render_Entity *find_render_entity(Entity_Id entity_id, u32 *render_entity_index = NULL);
 
 	void set_rendering_view(Entity_Id camera_id);
 
@@ -4,6 +4,27 @@
 
 #define TRUN_ON_RECT_CLIPPING 1
 
+enum Primitive_Shape {
+	PRIMITIVE_SHAPE_OUTLINE = 1,
+	PRIMITIVE_SHAPE_RECT,
+	PRIMITIVE_SHAPE_TEXTURE,
+	PRIMITIVE_SHAPE_LINE
+};
+
+// Primitives are cached by a shape and a size. Both are packed in a 64 bit key:
+// 4 bits for the shape and the rest for four 15 bit values or two 30 bit values.
+inline u64 make_primitive_hash(Primitive_Shape shape, u32 value1, u32 value2, u32 value3, u32 value4)
+{
+	const u64 mask = 0x7fff;
+	return ((u64)shape << 60) | ((value1 & mask) << 45) | ((value2 & mask) << 30) | ((value3 & mask) << 15) | (value4 & mask);
+}
+
+inline u64 make_primitive_hash(Primitive_Shape shape, u32 value1, u32 value2)
+{
+	const u64 mask = 0x3fffffff;
+	return ((u64)shape << 60) | ((value1 & mask) << 30) | (value2 & mask);
+}
+
 inline void from_win32_screen_space(u32 screen_width, u32 screen_height, const Point_s32 &win32_point, Point_s32 &normal_point)
 {
 	normal_point.x = win32_point.x - (screen_width / 2);
@@ -183,7 +204,7 @@ void Render_Primitive_List::get_clip_rect(Rect_s32 *rect)
 
 void Render_Primitive_List::add_outlines(int x, int y, int width, int height, const Color &color, float outline_width, u32 rounding, u32 flags)
 {
-	String hash = String((int)width) + String((int)height) + String((int)outline_width) + String("outline");
+	u64 hash = make_primitive_hash(PRIMITIVE_SHAPE_OUTLINE, (u32)width, (u32)height, (u32)outline_width, 0);
 
 	Vector2 position = { (float)x, (float)y };
 	Matrix4 transform_matrix = make_translation_matrix(&position);
@@ -276,7 +297,7 @@ void Render_Primitive_List::add_rect(float x, float y, float width, float height
 	////////////////////////////////////////////////////////////
 	//// &Note I am not sure that chache works for primitives //
 	////////////////////////////////////////////////////////////
-	String hash = String((int)width) + String((int)height) + String((int)rounding) + String((int)flags);
+	u64 hash = make_primitive_hash(PRIMITIVE_SHAPE_RECT, (u32)width, (u32)height, rounding, flags);
 
 	Vector2 position = { (float)x, (float)y };
 	Matrix4 transform_matrix = make_translation_matrix(&position);
@@ -310,7 +331,7 @@ void Render_Primitive_List::add_texture(Rect_s32 *rect, Texture *resource)
 
 void Render_Primitive_List::add_texture(int x, int y, int width, int height, Texture *resource)
 {
-	String hash = String(width + height);
+	u64 hash = make_primitive_hash(PRIMITIVE_SHAPE_TEXTURE, (u32)width, (u32)height);
 
 	Vector2 position = { (float)x, (float)y };
 	Matrix4 transform_matrix = make_translation_matrix(&position);
@@ -356,7 +377,7 @@ void Render_Primitive_List::add_line(const Point_s32 &first_point, const Point_s
 	Vector2 temp1 = first_point.to_vector2();
 	Vector2 temp2 = second_point.to_vector2();
 	float line_width = (float)find_distance(temp1, temp2);
-	String hash = String(line_width + thickness);
+	u64 hash = make_primitive_hash(PRIMITIVE_SHAPE_LINE, (u32)(line_width * 64.0f), (u32)(thickness * 64.0f));
 
 	Primitive_2D *primitive = make_or_find_primitive(transform_matrix, render_2d->default_texture, color, hash);
 	if (!primitive) {
@@ -372,7 +393,7 @@ void Render_Primitive_List::add_line(const Point_s32 &first_point, const Point_s
 	render_2d->add_primitive(primitive);
 }
 
-Primitive_2D *Render_Primitive_List::make_or_find_primitive(Matrix4 &transform_matrix, Texture *texture, const Color &color, String &primitve_hash)
+Primitive_2D *Render_Primitive_List::make_or_find_primitive(Matrix4 &transform_matrix, Texture *texture, const Color &color, u64 primitve_hash)
 {
 	Render_Primitive_2D render_primitive;
 	render_primitive.color.value = color.value;
@@ -488,6 +509,30 @@ void Render_2D::prepare_for_rendering(Render_Device *render_device)
 	}
 }
 
+// Moves the draw lists of the frame in the render frame, gui fills them again for the next frame.
+void Render_2D::make_render_frame(Render_Frame *render_frame)
+{
+	render_frame->draws_2d.reset();
+
+	Render_Primitive_List *list = NULL;
+	For(draw_list, list) {
+		Render_Primitive_2D *render_primitive = NULL;
+		For(list->render_primitives, render_primitive) {
+			Render_2D_Draw draw;
+			draw.index_count = render_primitive->primitive->indices.count;
+			draw.index_offset = render_primitive->primitive->index_offset;
+			draw.vertex_offset = render_primitive->primitive->vertex_offset;
+			draw.color = render_primitive->color;
+			draw.clip_rect = render_primitive->clip_rect;
+			draw.transform_matrix = render_primitive->transform_matrix;
+			draw.texture_descriptor = render_primitive->texture->shader_resource_descriptor();
+			render_frame->draws_2d.push(draw);
+		}
+		list->render_primitives.reset();
+	}
+	draw_list.reset();
+}
+
 void Render_Font::init(Render_2D *render_2d, Font *font)
 {
 	assert(font);
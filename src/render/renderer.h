@@ -13,6 +13,7 @@
 #include "../libs/math/structures.h"
 #include "../libs/structures/array.h"
 #include "../libs/structures/hash_table.h"
+#include "../libs/structures/dense_hash_table.h"
 
 struct Primitive_2D {
 	//Vars is set by Render_2D
@@ -90,10 +91,11 @@ struct Render_Primitive_List {
 
 	void add_line(const Point_s32 &first_point, const Point_s32 &second_point, const Color &color, float thicknesss = 0.5f);
 
-	Primitive_2D *make_or_find_primitive(Matrix4 &transform_matx, Texture *texture, const Color &color, String &primitve_hash);
+	Primitive_2D *make_or_find_primitive(Matrix4 &transform_matx, Texture *texture, const Color &color, u64 primitve_hash);
 };
 
 struct Render_System;
+struct Render_Frame;
 
 struct Render_2D {
 	~Render_2D();
@@ -110,8 +112,8 @@ struct Render_2D {
 
 	Array<Primitive_2D *> primitives;
 	Array<Render_Primitive_List *> draw_list;
-	Hash_Table<String, Primitive_2D *> lookup_table;
-	Hash_Table<String, Render_Font *> render_fonts;
+	Hash_Table<u64, Primitive_2D *> lookup_table;
+	Dense_Hash_Table<String, Render_Font *> render_fonts;
 
 	void init(Render_System *render_sys);
 	void add_primitive(Primitive_2D *primitive);
@@ -119,6 +121,7 @@ struct Render_2D {
 	Render_Font *get_render_font(Font *font);
 
 	void prepare_for_rendering(Render_Device *render_device);
+	void make_render_frame(Render_Frame *render_frame);
 };
 
 struct Render_3D {
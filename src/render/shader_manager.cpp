@@ -9,6 +9,7 @@
 #include "../sys/utils.h"
 #include "../libs/os/path.h"
 #include "../libs/os/file.h"
+#include "../libs/os/async_io.h"
 //#include "../render/render_api.h"
 
 using Microsoft::WRL::ComPtr;
@@ -278,20 +279,34 @@ void Shader_Manager::init()
 		print("Shader_Manager::init: Load and create shaders.");
 	}
 
+	// All shader files are read at once, a shader is created from its bytecode while the next files are being read.
+	Async_IO_Request *read_requests = new Async_IO_Request[file_names.count];
+	Array<Async_IO_Request *> submitted_requests;
 	for (u32 i = 0; i < file_names.count; i++) {
-		String path_to_shader_file;
-		build_full_path_to_shader_file(file_names[i], path_to_shader_file);
+		String shader_name;
+		get_shader_name_from_file(file_names[i].c_str(), shader_name);
+		if (find_shader_in_shader_table(shader_name)) {
+			build_full_path_to_shader_file(file_names[i], read_requests[i].full_path);
+			read_requests[i].priority = ASYNC_IO_PRIORITY_HIGH;
+			submitted_requests.push(&read_requests[i]);
+		}
+	}
+	submit_async_io(submitted_requests.items, submitted_requests.count);
 
+	for (u32 i = 0; i < file_names.count; i++) {
 		String shader_name;
 		get_shader_name_from_file(file_names[i].c_str(), shader_name);
 
 		Shader *shader = find_shader_in_shader_table(shader_name);
 		if (shader) {
-			u8 *bytecode = NULL;
-			s32 bytecode_size = 0;
-			bytecode = (u8 *)read_entire_file(path_to_shader_file, "rb", &bytecode_size);
-			if (!bytecode || (bytecode_size == 0)) {
-				print("Shader_Manager::init: Failed to read shader byte code from {}.", &path_to_shader_file);
+			Async_IO_Request *read_request = &read_requests[i];
+			wait_for_async_io(read_request);
+
+			u8 *bytecode = read_request->buffer;
+			s32 bytecode_size = (s32)read_request->transferred_size;
+			if (!read_request->succeeded() || !bytecode || (bytecode_size == 0)) {
+				print("Shader_Manager::init: Failed to read shader byte code from {}.", &read_request->full_path);
+				DELETE_ARRAY(read_request->buffer);
 				continue;
 			}
 			Shader_Type shader_type;
@@ -339,6 +354,7 @@ void Shader_Manager::init()
 			print("Shader_Manager::init: The shader table doesn't have a shader entiry with name {}.", &shader_name);
 		}
 	}
+	DELETE_ARRAY(read_requests);
 }
 
 void Shader_Manager::reload(void *arg)
@@ -17,10 +17,12 @@
 #include "../libs/mesh_loader.h"
 #include "../render/render_world.h"
 #include "../collision/collision.h"
+#include "../benchmarks/benchmark.h"
 
 static void load_meshes(Array<String> &mesh_names)
 {
 	begin_profile_task("Load meshes");
+	MEMORY_TAG_SCOPE(MEMORY_TAG_ASSETS);
 	Game_World *game_world = Engine::get_game_world();
 	Render_World *render_world = Engine::get_render_world();
 	Variable_Service *variable_service = Engine::get_variable_service();
@@ -32,42 +34,59 @@ static void load_meshes(Array<String> &mesh_names)
 	models_loading->attach("scaling_value", &loading_options.scaling_value);
 	models_loading->attach("use_scaling_value", &loading_options.use_scaling_value);
 
+	begin_time_stamp();
+
+	Array<Loading_Models_File> files;
+	files.reserve(mesh_names.count);
 	for (u32 i = 0; i < mesh_names.count; i++) {
-		begin_time_stamp();
-
-		String full_path_to_mesh;
-		build_full_path_to_model_file(mesh_names[i], full_path_to_mesh);
-
-		Loading_Models_Info info;
-		Array<Loading_Model *> loaded_models;
-		if (load_models_from_file(full_path_to_mesh, loaded_models, &info, &loading_options)) {
-			Model_Storage *model_storage = render_world->get_model_storage();
-			
-			Array<Pair<Loading_Model *, u32>> result;
-			model_storage->add_models(loaded_models, result);
-
-			begin_profile_task("Make entities for models");
-			for (u32 j = 0; j < result.count; j++) {
-				Pair<Loading_Model *, u32> pair = result[j];
-				u32 mesh_idx = pair.second;
-				Loading_Model *loaded_model = pair.first;
-
-				AABB mesh_AABB = make_AABB(&loaded_model->mesh);
-				assert(loaded_model->instances.count > 0);
-
-				for (u32 k = 0; k < loaded_model->instances.count; k++) {
-					Loading_Model::Transformation transformation = loaded_model->instances[k];
-					Entity_Id entity_id = game_world->make_entity(transformation.scaling, transformation.rotation, transformation.translation);
-					game_world->attach_AABB(entity_id, &mesh_AABB);
-					render_world->add_render_entity(entity_id, mesh_idx);
-				}
+		build_full_path_to_model_file(mesh_names[i], files[i].full_path);
+	}
+	load_models_from_files(files, &loading_options);
+
+	// The models of all files are added to the model storage at once, so the unified buffers are uploaded once.
+	Array<Loading_Model *> loaded_models;
+	Loading_Models_File *file = NULL;
+	For(files, file) {
+		if (file->loaded) {
+			merge(&loaded_models, &file->models);
+		}
+	}
+
+	if (!loaded_models.is_empty()) {
+		Model_Storage *model_storage = render_world->get_model_storage();
+
+		Array<Pair<Loading_Model *, u32>> result;
+		model_storage->add_models(loaded_models, result);
+
+		begin_profile_task("Make entities for models");
+		for (u32 j = 0; j < result.count; j++) {
+			Pair<Loading_Model *, u32> pair = result[j];
+			u32 mesh_idx = pair.second;
+			Loading_Model *loaded_model = pair.first;
+
+			AABB mesh_AABB = make_AABB(&loaded_model->mesh);
+			assert(loaded_model->instances.count > 0);
+
+			for (u32 k = 0; k < loaded_model->instances.count; k++) {
+				Loading_Model::Transformation transformation = loaded_model->instances[k];
+				Entity_Id entity_id = game_world->make_entity(transformation.scaling, transformation.rotation, transformation.translation);
+				game_world->attach_AABB(entity_id, &mesh_AABB);
+				render_world->add_render_entity(entity_id, mesh_idx);
 			}
-			end_profile_task();
-			free_memory(&loaded_models);
-			
-			print("load_meshes: {} was loaded in game and render world for {}ms", mesh_names[i].c_str(), delta_time_in_milliseconds());
 		}
+		end_profile_task();
+		free_memory(&loaded_models);
 	}
+	u32 loaded_file_count = 0;
+	For(files, file) {
+		if (file->loaded) {
+			loaded_file_count++;
+			print("load_meshes: {} was loaded in game and render world.", file->full_path);
+		} else {
+			print("load_meshes: Failed to load {}.", file->full_path);
+		}
+	}
+	print("load_meshes: {} of {} files were loaded for {}ms", loaded_file_count, mesh_names.count, delta_time_in_milliseconds());
 	end_profile_task();
 }
 
@@ -142,11 +161,103 @@ static void add_command(const char *command_name, void (*procedure)(Array<String
 	commands.push(command);
 }
 
+static void benchmark_queues(Array<String> &command_args)
+{
+	Benchmark_Suite suite;
+	run_queue_benchmarks(&suite);
+}
+
+static void benchmark_mesh_loading(Array<String> &command_args)
+{
+	Benchmark_Suite suite;
+	if (command_args.is_empty() || command_args.first().is_empty()) {
+		run_mesh_loader_benchmarks(&suite, "Sponza.gltf");
+	} else {
+		run_mesh_loader_benchmarks(&suite, command_args.first());
+	}
+}
+
+// The same benchmarks as the standalone benchmark executable runs, an argument filters them by name.
+static void run_benchmarks(Array<String> &command_args)
+{
+	Benchmark_Suite suite;
+	if (!(command_args.is_empty() || command_args.first().is_empty())) {
+		suite.filter = command_args.first();
+	}
+	run_core_benchmarks(&suite);
+	if (suite.filter && suite.results.is_empty()) {
+		print("run_benchmarks: No benchmark name has '{}'.", suite.filter);
+	}
+}
+
+static void start_profiling(Array<String> &command_args)
+{
+	start_profile_capture();
+	print("start_profiling: The profile capture was started.");
+}
+
+static void stop_profiling(Array<String> &command_args)
+{
+	if (!is_profile_capture_running()) {
+		print("stop_profiling: The profile capture is not running.");
+		return;
+	}
+	stop_profile_capture();
+
+	const char *file_name = "profile_capture.json";
+	if (!(command_args.is_empty() || command_args.first().is_empty())) {
+		file_name = command_args.first();
+	}
+	String full_path = join_paths(get_base_path(), file_name);
+	write_profile_capture_to_chrome_trace(full_path);
+}
+
+static void print_frame_tasks(Array<String> &command_args)
+{
+	Engine::get_instance()->frame_task_graph.print_report();
+}
+
+static void print_frame_stats(Array<String> &command_args)
+{
+	Engine::get_instance()->frame_stats.print_summaries();
+}
+
+static void write_frame_stats_to_csv(Array<String> &command_args)
+{
+	const char *file_name = "frame_stats.csv";
+	if (!(command_args.is_empty() || command_args.first().is_empty())) {
+		file_name = command_args.first();
+	}
+	String full_path = join_paths(get_base_path(), file_name);
+	Engine::get_instance()->frame_stats.write_csv(full_path);
+}
+
+static void print_memory_tags(Array<String> &command_args)
+{
+	print_memory_stats();
+}
+
+static void toggle_performance_displaying(Array<String> &command_args)
+{
+	Engine *engine = Engine::get_instance();
+	engine->show_performance = !engine->show_performance;
+}
+
 void init_commands()
 {
 	add_command("load mesh", load_meshes);
 	add_command("load level", load_level);
 	add_command("create level", create_level);
+	add_command("benchmark queues", benchmark_queues);
+	add_command("benchmark mesh loading", benchmark_mesh_loading);
+	add_command("benchmarks", run_benchmarks);
+	add_command("frame tasks", print_frame_tasks);
+	add_command("profile start", start_profiling);
+	add_command("profile stop", stop_profiling);
+	add_command("frame stats", print_frame_stats);
+	add_command("frame stats csv", write_frame_stats_to_csv);
+	add_command("show performance", toggle_performance_displaying);
+	add_command("memory stats", print_memory_tags);
 }
 
 void run_command(const char *command_name, Array<String> &command_args)
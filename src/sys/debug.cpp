@@ -3,7 +3,6 @@
 #include <windows.h>
 
 #include "sys.h"
-#include "../libs/structures/hash_table.h"
 
 
 char *get_error_message_from_error_code(DWORD error_code)
@@ -21,20 +20,7 @@ char *get_error_message_from_error_code(DWORD error_code)
 	if ((len > 2) && (error_message[len - 2] == '\r')) {
 		error_message[len - 2] = '\0';
 	}
-	return _strdup(error_message);
-}
-
-bool is_string_unique(const char *string)
-{
-	//@Note: Use set data struct when it will be implemented.
-	static Hash_Table<int, u8> unique_string;
-
-	int key = fast_hash(string);
-	if (!unique_string.key_in_table(key)) {
-		unique_string.set(fast_hash(string), 0);
-		return true;
-	}
-	return false;
+	return to_string(error_message);
 }
 
 void report_hresult_error(const char *file, u32 line, HRESULT hr, const char *expr)
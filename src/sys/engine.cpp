@@ -1,6 +1,8 @@
 #include <assert.h>
 
+#include "sys.h"
 #include "engine.h"
+#include "jobs.h"
 #include "commands.h"
 #include "profiling.h"
 #include "../gui/gui.h"
@@ -8,6 +10,7 @@
 #include "../libs/os/path.h"
 #include "../libs/os/file.h"
 #include "../libs/os/event.h"
+#include "../libs/os/async_io.h"
 #include "../libs/mesh_loader.h"
 #include "../win32/win_time.h"
 
@@ -20,40 +23,56 @@
 static Engine *engine = NULL;
 
 static Font *performance_font = NULL;
-//static Render_Primitive_List render_list;
+static Render_Primitive_List performance_render_list;
 
 static const String DEFAULT_LEVEL_NAME = "unnamed_level";
 static const String LEVEL_EXTENSION = ".hl";
+static const u64 FRAME_ARENA_SIZE = megabytes_to_bytes(4);
+
+static void init_frame_task_graph(Engine *engine);
 
 static void init_performance_displaying()
 {
 	performance_font = engine->font_manager.get_font("consola", 14);
 	if (!performance_font) {
-		assert(false);
+		print("init_performance_displaying: The font for displaying performance was not found.");
+		return;
 	}
-	//Render_Font *render_font = engine->render_sys.render_2d.get_render_font(performance_font);
-	//render_list = Render_Primitive_List(&engine->render_sys.render_2d, performance_font, render_font);
+	Render_Font *render_font = engine->render_sys.render_2d.get_render_font(performance_font);
+	performance_render_list = Render_Primitive_List(&engine->render_sys.render_2d, performance_font, render_font);
 }
 
-static void display_performance(s64 fps, s64 frame_time)
+// Shows the frame times of the frames before the current one in the top right corner of the window.
+static void display_performance(Frame_Stats *frame_stats)
 {
-	char *test = format("Fps", fps);
-	char *test2 = format("Frame time {} ms", frame_time);
-	u32 text_width = performance_font->get_text_width(test2);
-
-	//s32 x = Render_System::screen_width - text_width - 10;
-	//render_list.add_text(x, 5, test);
-	//render_list.add_text(x, 20, test2);
-
-	free_string(test);
-	free_string(test2);
-
-	//engine->render_sys.render_2d.add_render_primitive_list(&render_list);
+	if (!performance_font || (frame_stats->series_count == 0)) {
+		return;
+	}
+	Frame_Time_Summary summary;
+	frame_stats->get_summary(0, &summary);
+	float frame_time = frame_stats->get_last_time(0);
+
+	char lines[3][64];
+	format_to(lines[0], sizeof(lines[0]), "Fps {}", (frame_time > 0.0f) ? (s32)(1000.0f / frame_time) : 0);
+	format_to(lines[1], sizeof(lines[1]), "Frame time {} ms", frame_time);
+	format_to(lines[2], sizeof(lines[2]), "Avg {} ms, p99 {} ms", summary.average, summary.p99);
+
+	s32 y = 5;
+	for (u32 i = 0; i < ARRAY_SIZE(lines); i++) {
+		s32 x = (s32)engine->render_sys.window.width - (s32)performance_font->get_text_width(lines[i]) - 10;
+		performance_render_list.add_text(x, y, lines[i]);
+		y += 15;
+	}
+	engine->render_sys.render_2d.add_render_primitive_list(&performance_render_list);
 }
 
 void Engine::init_base()
 {
 	engine = this;
+	frame_arena.init(FRAME_ARENA_SIZE);
+	init_profiler();
+	init_job_system();
+	init_async_io();
 	init_os_path();
 	init_commands();
 	var_service.load("all.variables");
@@ -71,24 +90,39 @@ void Engine::init(Win32_Window *window)
 
 	test();
 
-	font_manager.init();
+	{
+		MEMORY_TAG_SCOPE(MEMORY_TAG_ASSETS);
+		font_manager.init();
+	}
 
 	Variable_Service *rendering_settings = var_service.find_namespace("rendering");
 	ATTACH(rendering_settings, vsync);
 	ATTACH(rendering_settings, windowed);
 	ATTACH(rendering_settings, back_buffer_count);
 
-	shader_manager.init();
-
-	render_sys.init(window, &var_service);
+	{
+		MEMORY_TAG_SCOPE(MEMORY_TAG_ASSETS);
+		shader_manager.init();
+	}
+	{
+		MEMORY_TAG_SCOPE(MEMORY_TAG_RENDER);
+		render_sys.init(window, &var_service);
+	}
+	{
+		MEMORY_TAG_SCOPE(MEMORY_TAG_GUI);
+		gui::init_gui(this);
 
-	gui::init_gui(this);
-	
-	// The editor dependence on render system because it uses the window size for initializing gui.
-	editor.init(this);
-	
-	game_world.init();
-	render_world.init(this);
+		// The editor dependence on render system because it uses the window size for initializing gui.
+		editor.init(this);
+	}
+	{
+		MEMORY_TAG_SCOPE(MEMORY_TAG_WORLD);
+		game_world.init();
+	}
+	{
+		MEMORY_TAG_SCOPE(MEMORY_TAG_RENDER);
+		render_world.init(this);
+	}
 
 	init_commands();
 	Array<String> temp;
@@ -101,50 +135,157 @@ void Engine::init(Win32_Window *window)
 	render_world.upload_lights();
 
 	file_tracking_sys.add_directory("hlsl", make_member_callback<Shader_Manager>(&shader_manager, &Shader_Manager::reload));
+
+	init_performance_displaying();
+	frame_stats.init();
+	init_frame_task_graph(this);
 }
 
-#include "sys.h"
+static void run_event_loop_task(void *data)
+{
+	pump_events();
+	run_event_loop();
+}
 
-void Engine::frame()
+static void handle_gui_events_task(void *data)
 {
-	begin_profile_frame("Frame");
+	MEMORY_TAG_SCOPE(MEMORY_TAG_GUI);
+	gui::handle_events();
+}
 
-	static s64 fps = 60;
-	static s64 frame_time = 1000;
+static void handle_editor_events_task(void *data)
+{
+	MEMORY_TAG_SCOPE(MEMORY_TAG_GUI);
+	((Engine *)data)->editor.handle_events();
+}
 
-	s64 start_time = milliseconds_counter();
-	s64 ticks_counter = cpu_ticks_counter();
+static void update_editor_task(void *data)
+{
+	MEMORY_TAG_SCOPE(MEMORY_TAG_GUI);
+	((Engine *)data)->editor.update();
+}
 
-	pump_events();
-	run_event_loop();
+static void update_file_tracking_task(void *data)
+{
+	MEMORY_TAG_SCOPE(MEMORY_TAG_ASSETS);
+	((Engine *)data)->file_tracking_sys.update();
+}
 
-	gui::handle_events();
+static void update_rendering_view_task(void *data)
+{
+	MEMORY_TAG_SCOPE(MEMORY_TAG_RENDER);
+	Engine *engine = (Engine *)data;
+	engine->render_world.rendering_view.update(&engine->game_world);
+}
 
-	editor.handle_events();
-	editor.update();
-	
-	file_tracking_sys.update();
-	
-	render_world.update();
+static void update_render_entities_task(void *data)
+{
+	MEMORY_TAG_SCOPE(MEMORY_TAG_RENDER);
+	((Engine *)data)->render_world.update_render_entities();
+}
+
+static void update_shadows_task(void *data)
+{
+	MEMORY_TAG_SCOPE(MEMORY_TAG_RENDER);
+	((Engine *)data)->render_world.update_shadows();
+}
 
+static void render_editor_task(void *data)
+{
+	MEMORY_TAG_SCOPE(MEMORY_TAG_GUI);
 #if DRAW_TEST_GUI
 	draw_test_gui();
 #else
-	editor.render();
+	((Engine *)data)->editor.render();
 #endif
-	render_sys.render();
+}
 
+static void display_performance_task(void *data)
+{
+	MEMORY_TAG_SCOPE(MEMORY_TAG_GUI);
+	Engine *engine = (Engine *)data;
+	if (engine->show_performance) {
+		display_performance(&engine->frame_stats);
+	}
+}
+
+static void render_task(void *data)
+{
+	MEMORY_TAG_SCOPE(MEMORY_TAG_RENDER);
+	((Engine *)data)->render_sys.render();
+}
+
+static void clear_event_queue_task(void *data)
+{
 	clear_event_queue();
+}
+
+// The stages are added in the order in which they used to run one after another.
+// The window, gui and the editor keep their state for the main thread, so they are main thread tasks.
+static void init_frame_task_graph(Engine *engine)
+{
+	Frame_Task_Graph *graph = &engine->frame_task_graph;
+	const u32 EDITOR_WRITES = FRAME_RESOURCE_EDITOR | FRAME_RESOURCE_GUI | FRAME_RESOURCE_GAME_WORLD | FRAME_RESOURCE_RENDER_WORLD | FRAME_RESOURCE_FRAME_ARENA;
+	const u32 RENDER_READS = FRAME_RESOURCE_RENDER_WORLD | FRAME_RESOURCE_RENDERING_VIEW | FRAME_RESOURCE_WORLD_MATRICES | FRAME_RESOURCE_SHADOW_CASCADES | FRAME_RESOURCE_RENDER_2D | FRAME_RESOURCE_SHADERS;
+
+	graph->add_task("Event loop", run_event_loop_task, engine, 0, FRAME_RESOURCE_EVENTS, true);
+	graph->add_task("Gui events", handle_gui_events_task, engine, FRAME_RESOURCE_EVENTS, FRAME_RESOURCE_GUI, true);
+	graph->add_task("Editor events", handle_editor_events_task, engine, FRAME_RESOURCE_EVENTS | FRAME_RESOURCE_RENDERING_VIEW, EDITOR_WRITES, true);
+	graph->add_task("Editor update", update_editor_task, engine, FRAME_RESOURCE_EVENTS | FRAME_RESOURCE_RENDERING_VIEW, EDITOR_WRITES, true);
+	graph->add_task("File tracking", update_file_tracking_task, engine, 0, FRAME_RESOURCE_FILE_TRACKING | FRAME_RESOURCE_SHADERS, false);
+	graph->add_task("Rendering view", update_rendering_view_task, engine, FRAME_RESOURCE_GAME_WORLD, FRAME_RESOURCE_RENDERING_VIEW, false);
+	graph->add_task("Render entities", update_render_entities_task, engine, FRAME_RESOURCE_GAME_WORLD | FRAME_RESOURCE_RENDER_WORLD, FRAME_RESOURCE_WORLD_MATRICES | FRAME_RESOURCE_RENDER_DEVICE, false);
+	graph->add_task("Shadows", update_shadows_task, engine, FRAME_RESOURCE_RENDER_WORLD | FRAME_RESOURCE_RENDERING_VIEW, FRAME_RESOURCE_SHADOW_CASCADES | FRAME_RESOURCE_RENDER_DEVICE, false);
+	// The editor uploads lights from its windows.
+	graph->add_task("Editor render", render_editor_task, engine, FRAME_RESOURCE_EVENTS | FRAME_RESOURCE_GAME_WORLD, EDITOR_WRITES | FRAME_RESOURCE_RENDER_2D | FRAME_RESOURCE_RENDER_DEVICE, true);
+	graph->add_task("Performance", display_performance_task, engine, 0, FRAME_RESOURCE_RENDER_2D, true);
+	// Hands a copy of the frame over to the render thread, which records and presents it while the next frame runs.
+	graph->add_task("Render", render_task, engine, RENDER_READS, FRAME_RESOURCE_RENDER_DEVICE, true);
+	graph->add_task("Clear event queue", clear_event_queue_task, engine, 0, FRAME_RESOURCE_EVENTS, true);
+	graph->build();
+}
+
+// The render passes are timed on the render thread, so their times are from the frame before.
+static void record_frame_stats(Engine *engine, float frame_time)
+{
+	Frame_Stats *frame_stats = &engine->frame_stats;
+	frame_stats->record(FRAME_STATS_GROUP_FRAME, "Frame", frame_time);
+
+	Frame_Task_Graph *graph = &engine->frame_task_graph;
+	for (u32 i = 0; i < graph->task_count; i++) {
+		frame_stats->record(FRAME_STATS_GROUP_STAGE, graph->tasks[i].name, graph->report.task_times[i]);
+	}
+	Render_System *render_sys = &engine->render_sys;
+	Render_Frame_Timings *render_frame_timings = &render_sys->last_frame_timings;
+	frame_stats->record(FRAME_STATS_GROUP_FRAME, "Render thread frame", render_frame_timings->frame_time);
+	frame_stats->record(FRAME_STATS_GROUP_STAGE, "Render thread recording", render_frame_timings->recording_time);
+	for (u32 i = 0; (i < render_frame_timings->pass_times.count) && (i < render_sys->render_pass_submissions.count); i++) {
+		frame_stats->record(FRAME_STATS_GROUP_RENDER_PASS, render_sys->render_pass_submissions[i].render_pass->name, render_frame_timings->pass_times[i]);
+	}
+	frame_stats->end_frame();
+}
 
-	fps = cpu_ticks_per_second() / (cpu_ticks_counter() - ticks_counter);
-	frame_time = milliseconds_counter() - start_time;
+void Engine::frame()
+{
+	begin_profile_frame("Frame");
+
+	s64 ticks_counter = cpu_ticks_counter();
+
+	frame_task_graph.execute();
+	write_console_text();
+
+	frame_arena.end_frame();
+
+	float frame_time = (float)(cpu_ticks_counter() - ticks_counter) * 1000.0f / (float)cpu_ticks_per_second();
+	record_frame_stats(this, frame_time);
+	end_memory_frame();
 	
 	end_profile_frame();
 }
 
 void Engine::shutdown()
 {
-	render_sys.flush();
+	render_sys.shutdown();
 
 	if (current_level_name.is_empty()) {
 		int counter = 0;
@@ -165,6 +306,10 @@ void Engine::shutdown()
 	//save_game_and_render_world_in_level(current_level_name, &game_world, &render_world);
 	gui::shutdown();
 	var_service.shutdown();
+	frame_stats.shutdown();
+	shutdown_async_io();
+	shutdown_job_system();
+	frame_arena.shutdown();
 }
 
 void Engine::set_current_level_name(const String &level_name)
@@ -213,3 +358,8 @@ Variable_Service *Engine::get_variable_service()
 {
 	return &engine->var_service;
 }
+
+Frame_Arena *Engine::get_frame_arena()
+{
+	return &engine->frame_arena;
+}
@@ -2,6 +2,8 @@
 #define ENGINE_H
 
 #include "vars.h"
+#include "task_graph.h"
+#include "frame_stats.h"
 #include "file_tracking.h"
 #include "../gui/editor.h"
 #include "../game/world.h"
@@ -13,6 +15,7 @@
 
 #include "../libs/str.h"
 #include "../libs/number_types.h"
+#include "../libs/memory/frame_arena.h"
 
 struct Engine {
 	struct Swap_Chain_Present {
@@ -21,6 +24,7 @@ struct Engine {
 	} swap_chain_present;
 
 	bool is_initialized = false;
+	bool show_performance = false;
 	String current_level_name;
 	
 	Editor editor;
@@ -31,6 +35,9 @@ struct Engine {
 	Render_World render_world;
 	Font_Manager font_manager;
 	Shader_Manager shader_manager;
+	Frame_Arena frame_arena;
+	Frame_Task_Graph frame_task_graph;
+	Frame_Stats frame_stats;
 
 	void init_base();
 	void init(Win32_Window *window);
@@ -48,6 +55,7 @@ struct Engine {
 	static Render_System *get_render_system();
 	static Font_Manager *get_font_manager();
 	static Variable_Service *get_variable_service();
+	static Frame_Arena *get_frame_arena();
 };
 
 #endif
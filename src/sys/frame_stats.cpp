@@ -0,0 +1,229 @@
+#include <assert.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sys.h"
+#include "frame_stats.h"
+
+static const char *FRAME_STATS_GROUP_NAMES[] = { "frame", "stage", "pass" };
+
+static int compare_times(const void *first, const void *second)
+{
+	float first_time = *(const float *)first;
+	float second_time = *(const float *)second;
+	return (first_time > second_time) - (first_time < second_time);
+}
+
+// One more row than kept frames for the frame which is being recorded.
+static const u32 FRAME_STATS_ROW_COUNT = FRAME_STATS_FRAME_COUNT + 1;
+
+inline u32 get_frame_row(u64 frame_number)
+{
+	return (u32)(frame_number % FRAME_STATS_ROW_COUNT);
+}
+
+// The nearest rank percentile of sorted times.
+inline float get_percentile(Array<float> &sorted_times, float percentile)
+{
+	u32 rank = (u32)ceilf(percentile * (float)sorted_times.count);
+	return sorted_times[(rank > 0) ? rank - 1 : 0];
+}
+
+Frame_Stats::~Frame_Stats()
+{
+	shutdown();
+}
+
+void Frame_Stats::init()
+{
+	assert(!times);
+
+	times = new float[FRAME_STATS_ROW_COUNT * FRAME_STATS_MAX_SERIES_COUNT];
+	memset((void *)times, 0, sizeof(float) * FRAME_STATS_ROW_COUNT * FRAME_STATS_MAX_SERIES_COUNT);
+	sorted_times.reserve(FRAME_STATS_FRAME_COUNT);
+	sorted_times.reset();
+	series_count = 0;
+	frame_number = 0;
+}
+
+void Frame_Stats::shutdown()
+{
+	DELETE_ARRAY(times);
+	series_count = 0;
+	frame_number = 0;
+}
+
+// Series over FRAME_STATS_MAX_SERIES_COUNT are not recorded. A series recorded twice in a frame gets the sum of the times.
+void Frame_Stats::record(Frame_Stats_Group group, const char *name, float milliseconds)
+{
+	assert(times);
+	assert(name);
+
+	s32 series_index = find_series(group, name);
+	if (series_index < 0) {
+		if (series_count >= FRAME_STATS_MAX_SERIES_COUNT) {
+			return;
+		}
+		series_index = (s32)series_count++;
+		series[series_index].group = group;
+		series[series_index].name = name;
+		series[series_index].first_frame = frame_number;
+	}
+	times[get_frame_row(frame_number) * FRAME_STATS_MAX_SERIES_COUNT + series_index] += milliseconds;
+}
+
+void Frame_Stats::end_frame()
+{
+	frame_number++;
+	memset((void *)&times[get_frame_row(frame_number) * FRAME_STATS_MAX_SERIES_COUNT], 0, sizeof(float) * FRAME_STATS_MAX_SERIES_COUNT);
+}
+
+s32 Frame_Stats::find_series(Frame_Stats_Group group, const char *name)
+{
+	for (u32 i = 0; i < series_count; i++) {
+		if ((series[i].group == group) && ((series[i].name == name) || !strcmp(series[i].name, name))) {
+			return (s32)i;
+		}
+	}
+	return -1;
+}
+
+u32 Frame_Stats::get_frame_count(u32 series_index)
+{
+	assert(series_index < series_count);
+
+	u64 frame_count = frame_number - series[series_index].first_frame;
+	return (frame_count < FRAME_STATS_FRAME_COUNT) ? (u32)frame_count : FRAME_STATS_FRAME_COUNT;
+}
+
+float Frame_Stats::get_last_time(u32 series_index)
+{
+	if (get_frame_count(series_index) == 0) {
+		return 0.0f;
+	}
+	return times[get_frame_row(frame_number - 1) * FRAME_STATS_MAX_SERIES_COUNT + series_index];
+}
+
+bool Frame_Stats::get_summary(u32 series_index, Frame_Time_Summary *summary)
+{
+	assert(summary);
+
+	u32 frame_count = get_frame_count(series_index);
+	if (frame_count == 0) {
+		*summary = Frame_Time_Summary();
+		return false;
+	}
+	sorted_times.reset();
+	float total_time = 0.0f;
+	for (u64 frame = frame_number - frame_count; frame < frame_number; frame++) {
+		float time = times[get_frame_row(frame) * FRAME_STATS_MAX_SERIES_COUNT + series_index];
+		sorted_times.push(time);
+		total_time += time;
+	}
+	qsort((void *)sorted_times.items, sorted_times.count, sizeof(float), compare_times);
+
+	summary->frame_count = frame_count;
+	summary->min = sorted_times.first();
+	summary->average = total_time / (float)frame_count;
+	summary->p50 = get_percentile(sorted_times, 0.50f);
+	summary->p95 = get_percentile(sorted_times, 0.95f);
+	summary->p99 = get_percentile(sorted_times, 0.99f);
+	summary->max = sorted_times.last();
+	return true;
+}
+
+bool Frame_Stats::get_histogram(u32 series_index, Frame_Time_Histogram *histogram)
+{
+	assert(histogram);
+
+	*histogram = Frame_Time_Histogram();
+	memset((void *)histogram->bucket_frame_counts, 0, sizeof(histogram->bucket_frame_counts));
+
+	u32 frame_count = get_frame_count(series_index);
+	for (u64 frame = frame_number - frame_count; frame < frame_number; frame++) {
+		float time = times[get_frame_row(frame) * FRAME_STATS_MAX_SERIES_COUNT + series_index];
+		u32 bucket = 0;
+		while ((bucket < (FRAME_STATS_HISTOGRAM_BUCKET_COUNT - 1)) && (time > FRAME_STATS_HISTOGRAM_LIMITS[bucket])) {
+			bucket++;
+		}
+		histogram->bucket_frame_counts[bucket]++;
+	}
+	histogram->frame_count = frame_count;
+	return frame_count > 0;
+}
+
+void Frame_Stats::print_summaries()
+{
+	print("Frame stats for the last {} frames, times in milliseconds (min / avg / p50 / p95 / p99 / max):", (frame_number < FRAME_STATS_FRAME_COUNT) ? frame_number : FRAME_STATS_FRAME_COUNT);
+	Frame_Time_Summary summary;
+	for (u32 i = 0; i < series_count; i++) {
+		if (get_summary(i, &summary)) {
+			print("  {} {}: {} / {} / {} / {} / {} / {}", FRAME_STATS_GROUP_NAMES[series[i].group], series[i].name, summary.min, summary.average, summary.p50, summary.p95, summary.p99, summary.max);
+		}
+	}
+	for (u32 i = 0; i < series_count; i++) {
+		Frame_Time_Histogram histogram;
+		if ((series[i].group != FRAME_STATS_GROUP_FRAME) || !get_histogram(i, &histogram)) {
+			continue;
+		}
+		print("Histogram of {}:", series[i].name);
+		for (u32 j = 0; j < FRAME_STATS_HISTOGRAM_BUCKET_COUNT; j++) {
+			if (j < (FRAME_STATS_HISTOGRAM_BUCKET_COUNT - 1)) {
+				print("  <= {}ms: {}", FRAME_STATS_HISTOGRAM_LIMITS[j], histogram.bucket_frame_counts[j]);
+			} else {
+				print("  > {}ms: {}", FRAME_STATS_HISTOGRAM_LIMITS[j - 1], histogram.bucket_frame_counts[j]);
+			}
+		}
+	}
+}
+
+// A row for every kept frame from the oldest one, a column for every series. A series which didn't exist in a frame has an empty cell.
+bool Frame_Stats::write_csv(const char *full_path)
+{
+	assert(full_path);
+
+	FILE *file = NULL;
+#ifdef _WIN32
+	if (fopen_s(&file, full_path, "w")) {
+		file = NULL;
+	}
+#else
+	file = fopen(full_path, "w");
+#endif
+	if (!file) {
+		print("Frame_Stats::write_csv: Failed to open {}.", full_path);
+		return false;
+	}
+	fputs("frame", file);
+	for (u32 i = 0; i < series_count; i++) {
+		fprintf(file, ",\"%s:", FRAME_STATS_GROUP_NAMES[series[i].group]);
+		for (const char *c = series[i].name; *c; c++) {
+			if (*c == '"') {
+				fputc('"', file);
+			}
+			fputc(*c, file);
+		}
+		fputc('"', file);
+	}
+	fputc('\n', file);
+
+	u64 frame_count = (frame_number < FRAME_STATS_FRAME_COUNT) ? frame_number : FRAME_STATS_FRAME_COUNT;
+	for (u64 frame = frame_number - frame_count; frame < frame_number; frame++) {
+		fprintf(file, "%llu", (unsigned long long)frame);
+		float *frame_times = &times[get_frame_row(frame) * FRAME_STATS_MAX_SERIES_COUNT];
+		for (u32 i = 0; i < series_count; i++) {
+			if (frame < series[i].first_frame) {
+				fputc(',', file);
+			} else {
+				fprintf(file, ",%.3f", frame_times[i]);
+			}
+		}
+		fputc('\n', file);
+	}
+	fclose(file);
+
+	print("Frame_Stats::write_csv: {} frames were written to {}.", frame_count, full_path);
+	return true;
+}
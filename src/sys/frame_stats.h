@@ -0,0 +1,72 @@
+#ifndef FRAME_STATS_H
+#define FRAME_STATS_H
+
+#include "utils.h"
+#include "../libs/number_types.h"
+#include "../libs/structures/array.h"
+
+const u32 FRAME_STATS_FRAME_COUNT = 1024;
+const u32 FRAME_STATS_MAX_SERIES_COUNT = 48;
+const u32 FRAME_STATS_HISTOGRAM_BUCKET_COUNT = 12;
+
+// Upper limits of the histogram buckets in milliseconds, the last bucket has no upper limit.
+const float FRAME_STATS_HISTOGRAM_LIMITS[FRAME_STATS_HISTOGRAM_BUCKET_COUNT - 1] = { 4.0f, 8.0f, 12.0f, 16.7f, 20.0f, 25.0f, 33.3f, 50.0f, 66.7f, 100.0f, 250.0f };
+
+enum Frame_Stats_Group {
+	FRAME_STATS_GROUP_FRAME,
+	FRAME_STATS_GROUP_STAGE,
+	FRAME_STATS_GROUP_RENDER_PASS
+};
+
+struct Frame_Stats_Series {
+	Frame_Stats_Group group = FRAME_STATS_GROUP_FRAME;
+	const char *name = NULL;
+	u64 first_frame = 0; // The number of the first frame which had the series.
+};
+
+struct Frame_Time_Summary {
+	u32 frame_count = 0;
+	float min = 0.0f;
+	float average = 0.0f;
+	float p50 = 0.0f;
+	float p95 = 0.0f;
+	float p99 = 0.0f;
+	float max = 0.0f;
+};
+
+struct Frame_Time_Histogram {
+	u32 frame_count = 0;
+	u32 bucket_frame_counts[FRAME_STATS_HISTOGRAM_BUCKET_COUNT];
+};
+
+// CPU times of the last FRAME_STATS_FRAME_COUNT frames in milliseconds. A series is the whole frame, a stage of the frame
+// or a render pass, it is added by the first frame which records it and a frame which doesn't record it has 0 for it.
+// Names of series must live as long as the stats. Summaries and histograms cover only frames which were ended.
+struct Frame_Stats {
+	Frame_Stats() {}
+	~Frame_Stats();
+
+	u32 series_count = 0;
+	Frame_Stats_Series series[FRAME_STATS_MAX_SERIES_COUNT];
+
+	u64 frame_number = 0; // The number of the frame which is being recorded.
+	float *times = NULL; // A row of FRAME_STATS_MAX_SERIES_COUNT times for every kept frame and the current one.
+	Array<float> sorted_times;
+
+	DELETE_COPING(Frame_Stats)
+
+	void init();
+	void shutdown();
+	void record(Frame_Stats_Group group, const char *name, float milliseconds);
+	void end_frame();
+
+	s32 find_series(Frame_Stats_Group group, const char *name);
+	u32 get_frame_count(u32 series_index);
+	float get_last_time(u32 series_index);
+	bool get_summary(u32 series_index, Frame_Time_Summary *summary);
+	bool get_histogram(u32 series_index, Frame_Time_Histogram *histogram);
+
+	void print_summaries();
+	bool write_csv(const char *full_path);
+};
+#endif
@@ -0,0 +1,345 @@
+#include <assert.h>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+
+#include "jobs.h"
+#include "sys.h"
+#include "utils.h"
+#include "profiling.h"
+#include "../libs/memory/base.h"
+
+struct Job {
+	Job_Function function = NULL;
+	void *data = NULL;
+	u32 first_index = 0;
+	u32 last_index = 0;
+	Job_Counter *counter = NULL;
+	Memory_Tag memory_tag = MEMORY_TAG_UNTAGGED;
+	std::atomic<bool> in_use = false;
+};
+
+// Chase-Lev work stealing deque with a fixed size ("Correct and Efficient Work-Stealing for Weak Memory Models", Le et al.).
+// The owner thread pushes and pops at the bottom, other threads steal from the top.
+struct Job_Queue {
+	alignas(CACHE_LINE_SIZE) std::atomic<s64> top = 0;
+	alignas(CACHE_LINE_SIZE) std::atomic<s64> bottom = 0;
+	std::atomic<Job *> jobs[JOB_QUEUE_SIZE];
+
+	bool push(Job *job);
+	Job *pop();
+	Job *steal();
+};
+
+bool Job_Queue::push(Job *job)
+{
+	s64 b = bottom.load(std::memory_order_relaxed);
+	s64 t = top.load(std::memory_order_acquire);
+	if ((b - t) >= (s64)JOB_QUEUE_SIZE) {
+		return false;
+	}
+	jobs[b & (JOB_QUEUE_SIZE - 1)].store(job, std::memory_order_relaxed);
+	bottom.store(b + 1, std::memory_order_release);
+	return true;
+}
+
+Job *Job_Queue::pop()
+{
+	s64 b = bottom.load(std::memory_order_relaxed) - 1;
+	bottom.store(b, std::memory_order_seq_cst);
+	s64 t = top.load(std::memory_order_seq_cst);
+
+	if (t > b) {
+		bottom.store(b + 1, std::memory_order_relaxed);
+		return NULL;
+	}
+	Job *job = jobs[b & (JOB_QUEUE_SIZE - 1)].load(std::memory_order_relaxed);
+	if (t == b) {
+		// The last job, a thief can take it at the same time.
+		if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+			job = NULL;
+		}
+		bottom.store(b + 1, std::memory_order_relaxed);
+	}
+	return job;
+}
+
+Job *Job_Queue::steal()
+{
+	s64 t = top.load(std::memory_order_seq_cst);
+	s64 b = bottom.load(std::memory_order_seq_cst);
+	if (t >= b) {
+		return NULL;
+	}
+	Job *job = jobs[t & (JOB_QUEUE_SIZE - 1)].load(std::memory_order_relaxed);
+	if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+		return NULL;
+	}
+	return job;
+}
+
+// A thread takes job structures from its own ring. A job structure is released when the thread which runs the job
+// has read it, if the next structure in the ring is still in use the new job is run at once.
+struct alignas(CACHE_LINE_SIZE) Job_Thread {
+	u32 next_job = 0;
+	u32 random_state = 0;
+	std::atomic<bool> attached = false; // Used only by slots of attached threads.
+	std::thread *thread = NULL;
+	Job_Queue queue;
+	Job jobs[JOB_QUEUE_SIZE];
+};
+
+struct Job_System {
+	bool initialized = false;
+	u32 thread_count = 1;
+	u32 slot_count = 1; // Job threads and slots for attached threads.
+	Job_Thread *threads = NULL;
+
+	std::atomic<bool> stop_workers = false;
+	std::atomic<u32> queued_job_count = 0;
+	std::atomic<u32> sleeping_worker_count = 0;
+	std::mutex sleep_mutex;
+	std::condition_variable wake_up_condition;
+};
+
+static Job_System job_system;
+static thread_local u32 job_thread_index = JOB_INVALID_THREAD_INDEX;
+
+static void execute_job(Job *job)
+{
+	Job_Function function = job->function;
+	void *data = job->data;
+	u32 first_index = job->first_index;
+	u32 last_index = job->last_index;
+	Job_Counter *counter = job->counter;
+	MEMORY_TAG_SCOPE(job->memory_tag);
+	job->in_use.store(false, std::memory_order_release);
+
+	function(data, first_index, last_index);
+	if (counter) {
+		counter->value.fetch_sub(1, std::memory_order_acq_rel);
+	}
+}
+
+static u32 next_random_value(Job_Thread *job_thread)
+{
+	// xorshift32
+	u32 x = job_thread->random_state;
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	job_thread->random_state = x;
+	return x;
+}
+
+static Job *find_job(u32 thread_index)
+{
+	Job_Thread *job_thread = &job_system.threads[thread_index];
+	Job *job = job_thread->queue.pop();
+	if (!job && (job_system.slot_count > 1)) {
+		u32 first_victim = next_random_value(job_thread) % job_system.slot_count;
+		for (u32 i = 0; i < job_system.slot_count; i++) {
+			u32 victim = (first_victim + i) % job_system.slot_count;
+			if ((victim != thread_index) && (job = job_system.threads[victim].queue.steal())) {
+				break;
+			}
+		}
+	}
+	if (job) {
+		job_system.queued_job_count.fetch_sub(1, std::memory_order_seq_cst);
+	}
+	return job;
+}
+
+static void run_worker(u32 thread_index)
+{
+	job_thread_index = thread_index;
+
+	static char thread_names[JOB_MAX_THREAD_COUNT][32];
+	format_to(thread_names[thread_index], sizeof(thread_names[thread_index]), "Job thread {}", thread_index);
+	set_profile_thread_name(thread_names[thread_index]);
+
+	while (!job_system.stop_workers.load(std::memory_order_acquire)) {
+		Job *job = find_job(thread_index);
+		if (job) {
+			execute_job(job);
+			continue;
+		}
+		std::unique_lock<std::mutex> lock(job_system.sleep_mutex);
+		job_system.sleeping_worker_count.fetch_add(1, std::memory_order_seq_cst);
+		job_system.wake_up_condition.wait(lock, []() {
+			return (job_system.queued_job_count.load(std::memory_order_seq_cst) > 0) || job_system.stop_workers.load(std::memory_order_acquire);
+		});
+		job_system.sleeping_worker_count.fetch_sub(1, std::memory_order_seq_cst);
+	}
+}
+
+// If worker_count is 0 there is a worker for every core except the core of the calling thread.
+void init_job_system(u32 worker_count)
+{
+	assert(!job_system.initialized);
+
+	if (worker_count == 0) {
+		u32 core_count = std::thread::hardware_concurrency();
+		worker_count = (core_count > 1) ? (core_count - 1) : 0;
+	}
+	if ((worker_count + 1) > JOB_MAX_THREAD_COUNT) {
+		worker_count = JOB_MAX_THREAD_COUNT - 1;
+	}
+	job_system.thread_count = worker_count + 1;
+	job_system.slot_count = job_system.thread_count + JOB_MAX_ATTACHED_THREAD_COUNT;
+	job_system.threads = new Job_Thread[job_system.slot_count];
+	job_system.stop_workers.store(false, std::memory_order_relaxed);
+	job_system.initialized = true;
+
+	job_thread_index = 0;
+	for (u32 i = 0; i < job_system.slot_count; i++) {
+		job_system.threads[i].random_state = (i + 1) * 0x9E3779B9;
+	}
+	for (u32 i = 1; i < job_system.thread_count; i++) {
+		job_system.threads[i].thread = new std::thread(run_worker, i);
+	}
+	print("init_job_system: The job system was initialized with {} worker threads.", worker_count);
+}
+
+// All jobs must have been waited for.
+void shutdown_job_system()
+{
+	if (!job_system.initialized) {
+		return;
+	}
+	{
+		std::lock_guard<std::mutex> lock(job_system.sleep_mutex);
+		job_system.stop_workers.store(true, std::memory_order_release);
+	}
+	job_system.wake_up_condition.notify_all();
+
+	for (u32 i = 1; i < job_system.thread_count; i++) {
+		job_system.threads[i].thread->join();
+		DELETE_PTR(job_system.threads[i].thread);
+	}
+	DELETE_ARRAY(job_system.threads);
+	job_system.thread_count = 1;
+	job_system.slot_count = 1;
+	job_system.initialized = false;
+	job_thread_index = JOB_INVALID_THREAD_INDEX;
+}
+
+u32 get_job_thread_count()
+{
+	return job_system.thread_count;
+}
+
+u32 get_job_thread_index()
+{
+	return job_thread_index;
+}
+
+// Returns false if the job system is not initialized or all slots for attached threads are taken.
+bool attach_job_thread()
+{
+	assert(job_thread_index == JOB_INVALID_THREAD_INDEX);
+
+	if (!job_system.initialized) {
+		return false;
+	}
+	for (u32 i = job_system.thread_count; i < job_system.slot_count; i++) {
+		bool attached = false;
+		if (job_system.threads[i].attached.compare_exchange_strong(attached, true, std::memory_order_acq_rel)) {
+			job_thread_index = i;
+			return true;
+		}
+	}
+	return false;
+}
+
+// All jobs which the thread has run must have been waited for.
+void detach_job_thread()
+{
+	u32 thread_index = job_thread_index;
+	if (thread_index == JOB_INVALID_THREAD_INDEX) {
+		return;
+	}
+	assert(thread_index >= job_system.thread_count);
+
+	job_system.threads[thread_index].attached.store(false, std::memory_order_release);
+	job_thread_index = JOB_INVALID_THREAD_INDEX;
+}
+
+void run_job(Job_Function function, void *data, Job_Counter *counter)
+{
+	run_job(function, data, 0, 0, counter);
+}
+
+void run_job(Job_Function function, void *data, u32 first_index, u32 last_index, Job_Counter *counter)
+{
+	assert(function);
+
+	u32 thread_index = job_thread_index;
+	if (!job_system.initialized || (thread_index == JOB_INVALID_THREAD_INDEX)) {
+		function(data, first_index, last_index);
+		return;
+	}
+	Job_Thread *job_thread = &job_system.threads[thread_index];
+	Job *job = &job_thread->jobs[job_thread->next_job & (JOB_QUEUE_SIZE - 1)];
+	if (job->in_use.load(std::memory_order_acquire)) {
+		function(data, first_index, last_index);
+		return;
+	}
+	job_thread->next_job++;
+	job->in_use.store(true, std::memory_order_relaxed);
+	job->function = function;
+	job->data = data;
+	job->first_index = first_index;
+	job->last_index = last_index;
+	job->counter = counter;
+	job->memory_tag = get_current_memory_tag();
+
+	if (counter) {
+		counter->value.fetch_add(1, std::memory_order_acq_rel);
+	}
+	// The job is counted before it is pushed, so a thread which steals it never sees the count go below zero.
+	job_system.queued_job_count.fetch_add(1, std::memory_order_seq_cst);
+	if (!job_thread->queue.push(job)) {
+		// The queue is full, the job is run at once.
+		job_system.queued_job_count.fetch_sub(1, std::memory_order_seq_cst);
+		execute_job(job);
+		return;
+	}
+	if (job_system.sleeping_worker_count.load(std::memory_order_seq_cst) > 0) {
+		std::lock_guard<std::mutex> lock(job_system.sleep_mutex);
+		job_system.wake_up_condition.notify_one();
+	}
+}
+
+// The waiting thread runs its own and stolen jobs until the counter gets to zero.
+void wait_for_counter(Job_Counter *counter)
+{
+	assert(counter);
+
+	u32 thread_index = job_thread_index;
+	while (!counter->is_done()) {
+		Job *job = (thread_index != JOB_INVALID_THREAD_INDEX) ? find_job(thread_index) : NULL;
+		if (job) {
+			execute_job(job);
+		} else {
+			std::this_thread::yield();
+		}
+	}
+}
+
+// Runs one job from the queue of the calling thread or a stolen one. Returns false if there was no job to run.
+bool run_queued_job()
+{
+	u32 thread_index = job_thread_index;
+	if (!job_system.initialized || (thread_index == JOB_INVALID_THREAD_INDEX)) {
+		return false;
+	}
+	Job *job = find_job(thread_index);
+	if (job) {
+		execute_job(job);
+		return true;
+	}
+	return false;
+}
@@ -0,0 +1,88 @@
+#ifndef JOBS_H
+#define JOBS_H
+
+#include <atomic>
+
+#include "../libs/number_types.h"
+#include "../libs/structures/array.h"
+
+const u32 JOB_MAX_THREAD_COUNT = 64;
+const u32 JOB_MAX_ATTACHED_THREAD_COUNT = 2;
+const u32 JOB_QUEUE_SIZE = 4096;
+const u32 JOB_INVALID_THREAD_INDEX = UINT32_MAX;
+
+// A job gets its data pointer and a range of indices, jobs made with run_job get an empty range.
+typedef void (*Job_Function)(void *data, u32 first_index, u32 last_index);
+
+// The number of jobs which have not finished yet. A counter must stay alive until wait_for_counter returns.
+struct Job_Counter {
+	std::atomic<u32> value = 0;
+
+	bool is_done();
+};
+
+inline bool Job_Counter::is_done()
+{
+	return value.load(std::memory_order_acquire) == 0;
+}
+
+// Every job thread (the thread which called init_job_system and the worker threads) has its own queue.
+// A thread pushes and pops jobs at the bottom of its queue, idle threads steal jobs from the top
+// of other threads' queues (Chase-Lev deque). A thread waiting for a counter runs jobs instead of sleeping.
+// Jobs pushed from threads which don't belong to the job system are run at once on those threads.
+// A long-lived thread of its own (the render thread) can attach to the job system to get a queue,
+// attached threads get indices from get_job_thread_count() to get_job_thread_count() + JOB_MAX_ATTACHED_THREAD_COUNT - 1.
+void init_job_system(u32 worker_count = 0);
+void shutdown_job_system();
+u32 get_job_thread_count();
+u32 get_job_thread_index();
+bool attach_job_thread();
+void detach_job_thread();
+
+void run_job(Job_Function function, void *data, Job_Counter *counter);
+void run_job(Job_Function function, void *data, u32 first_index, u32 last_index, Job_Counter *counter);
+void wait_for_counter(Job_Counter *counter);
+bool run_queued_job();
+
+// Calls function(index) for every index in [0, count) on all job threads and returns when all calls have finished.
+// A job gets batch_size indices, if batch_size is 0 the range is split into about 4 jobs per thread.
+template <typename Function>
+void parallel_for(u32 count, u32 batch_size, const Function &function)
+{
+	if (count == 0) {
+		return;
+	}
+	if (batch_size == 0) {
+		batch_size = count / (get_job_thread_count() * 4);
+		batch_size = batch_size > 0 ? batch_size : 1;
+	}
+	if ((count <= batch_size) || (get_job_thread_count() < 2)) {
+		for (u32 i = 0; i < count; i++) {
+			function(i);
+		}
+		return;
+	}
+	Job_Function run_batch = [](void *data, u32 first_index, u32 last_index) {
+		const Function *function = (const Function *)data;
+		for (u32 i = first_index; i < last_index; i++) {
+			(*function)(i);
+		}
+	};
+	Job_Counter counter;
+	for (u32 first_index = 0; first_index < count; first_index += batch_size) {
+		u32 last_index = ((count - first_index) > batch_size) ? (first_index + batch_size) : count;
+		run_job(run_batch, (void *)&function, first_index, last_index, &counter);
+	}
+	wait_for_counter(&counter);
+}
+
+// Calls function(&array[index], index) for every item of the array.
+template <typename T, typename Function>
+void parallel_for(Array<T> &array, const Function &function, u32 batch_size = 0)
+{
+	T *items = array.items;
+	parallel_for(array.count, batch_size, [items, &function](u32 index) {
+		function(&items[index], index);
+	});
+}
+#endif
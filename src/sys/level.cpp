@@ -29,15 +29,189 @@
 //	return h;
 //}
 
-inline void load_game_entities(File *level_file, Game_World *game_world)
+// A level file begins with LEVEL_FILE_MAGIC and the version of its layout. Files which were saved before
+// the header was added begin with the entity count. Entities of older versions are converted on load.
+const u32 LEVEL_FILE_MAGIC = 0x4c564c48; // "HLVL"
+
+enum Level_Version : u32 {
+	LEVEL_VERSION_UNVERSIONED = 0,
+	LEVEL_VERSION_ENTITY_GENERATIONS = 1,
+	LEVEL_VERSION_ENTITY_ORIENTATIONS = 2,
+	LEVEL_VERSION_CURRENT = LEVEL_VERSION_ENTITY_ORIENTATIONS
+};
+
+// Entities of unversioned level files, they have no generations and keep rotations as Euler angles.
+struct Level_Entity_Id_V0 {
+	Entity_Type type;
+	u32 index;
+};
+
+// String ids of unversioned level files are 32 bit.
+typedef u32 Level_String_Id_V0;
+
+struct Level_Entity_V0 {
+	u32 idx;
+	Entity_Type type;
+
+	Vector3 scaling;
+	Vector3 rotation;
+	Vector3 position;
+
+	Boudning_Box_Type bounding_box_type;
+	AABB AABB_box;
+};
+
+// Entities of version 1 level files, they keep rotations as Euler angles.
+struct Level_Entity_V1 {
+	u32 idx;
+	u32 generation;
+	Entity_Type type;
+
+	Vector3 scaling;
+	Vector3 rotation;
+	Vector3 position;
+
+	Boudning_Box_Type bounding_box_type;
+	AABB AABB_box;
+};
+
+// The fields of the derived entities are the same in all versions, only the base entity changes.
+template <typename Base>
+struct Level_Light : Base {
+	Light_Type light_type;
+
+	float range;
+	float radius;
+
+	Vector3 color;
+	Vector3 direction;
+};
+
+template <typename Base>
+struct Level_Geometry_Entity : Base {
+	Level_Geometry_Entity() {}
+	Geometry_Type geometry_type;
+	union {
+		Box box;
+		Grid grid;
+		Sphere sphere;
+	};
+};
+
+template <typename Base>
+struct Level_Camera : Base {
+	Vector3 up;
+	Vector3 target;
+};
+
+// Slots of a slot map start with generation 1, so converted entities get the ids which new entities would get.
+inline void convert_level_entity(Level_Entity_V0 *level_entity, Entity *entity)
+{
+	entity->idx = level_entity->idx;
+	entity->generation = 1;
+	entity->type = level_entity->type;
+	entity->scaling = level_entity->scaling;
+	entity->orientation = make_quaternion(level_entity->rotation.x, level_entity->rotation.y, level_entity->rotation.z);
+	entity->position = level_entity->position;
+	entity->bounding_box_type = level_entity->bounding_box_type;
+	entity->AABB_box = level_entity->AABB_box;
+}
+
+inline void convert_level_entity(Level_Entity_V1 *level_entity, Entity *entity)
+{
+	entity->idx = level_entity->idx;
+	entity->generation = level_entity->generation;
+	entity->type = level_entity->type;
+	entity->scaling = level_entity->scaling;
+	entity->orientation = make_quaternion(level_entity->rotation.x, level_entity->rotation.y, level_entity->rotation.z);
+	entity->position = level_entity->position;
+	entity->bounding_box_type = level_entity->bounding_box_type;
+	entity->AABB_box = level_entity->AABB_box;
+}
+
+template <typename Base>
+inline void convert_level_entity(Level_Light<Base> *level_light, Light *light)
+{
+	convert_level_entity((Base *)level_light, (Entity *)light);
+	light->light_type = level_light->light_type;
+	light->range = level_light->range;
+	light->radius = level_light->radius;
+	light->color = level_light->color;
+	light->direction = level_light->direction;
+}
+
+template <typename Base>
+inline void convert_level_entity(Level_Geometry_Entity<Base> *level_geometry_entity, Geometry_Entity *geometry_entity)
+{
+	convert_level_entity((Base *)level_geometry_entity, (Entity *)geometry_entity);
+	geometry_entity->geometry_type = level_geometry_entity->geometry_type;
+	switch (level_geometry_entity->geometry_type) {
+		case GEOMETRY_TYPE_BOX:
+			geometry_entity->box = level_geometry_entity->box;
+			break;
+		case GEOMETRY_TYPE_GRID:
+			geometry_entity->grid = level_geometry_entity->grid;
+			break;
+		case GEOMETRY_TYPE_SPHERE:
+			geometry_entity->sphere = level_geometry_entity->sphere;
+			break;
+	}
+}
+
+template <typename Base>
+inline void convert_level_entity(Level_Camera<Base> *level_camera, Camera *camera)
+{
+	convert_level_entity((Base *)level_camera, (Entity *)camera);
+	camera->up = level_camera->up;
+	camera->target = level_camera->target;
+}
+
+template <typename Level_Entity, typename T>
+inline void read_level_entities(File *level_file, u32 count, Array<T> *entities)
+{
+	if (count > 0) {
+		Array<Level_Entity> level_entities;
+		level_entities.reserve(count);
+		level_file->read((void *)level_entities.items, level_entities.get_size());
+
+		entities->reserve(count);
+		for (u32 i = 0; i < count; i++) {
+			convert_level_entity(&level_entities[i], &entities->items[i]);
+		}
+	}
+}
+
+template <typename Level_Entity, typename T>
+inline void read_level_entities(File *level_file, Array<T> *entities)
+{
+	u32 count = 0;
+	level_file->read(&count);
+	read_level_entities<Level_Entity>(level_file, count, entities);
+}
+
+// The entity count of an unversioned file has already been read in place of the header.
+inline void load_game_entities(File *level_file, u32 version, u32 entity_count, Game_World *game_world)
 {
 	assert(level_file);
 	assert(game_world);
 
-	level_file->read(&game_world->entities);
-	level_file->read(&game_world->lights);
-	level_file->read(&game_world->geometry_entities);
-	level_file->read(&game_world->cameras);
+	if (version == LEVEL_VERSION_UNVERSIONED) {
+		read_level_entities<Level_Entity_V0>(level_file, entity_count, &game_world->entities);
+		read_level_entities<Level_Light<Level_Entity_V0>>(level_file, &game_world->lights);
+		read_level_entities<Level_Geometry_Entity<Level_Entity_V0>>(level_file, &game_world->geometry_entities);
+		read_level_entities<Level_Camera<Level_Entity_V0>>(level_file, &game_world->cameras);
+	} else if (version == LEVEL_VERSION_ENTITY_GENERATIONS) {
+		read_level_entities<Level_Entity_V1>(level_file, &game_world->entities);
+		read_level_entities<Level_Light<Level_Entity_V1>>(level_file, &game_world->lights);
+		read_level_entities<Level_Geometry_Entity<Level_Entity_V1>>(level_file, &game_world->geometry_entities);
+		read_level_entities<Level_Camera<Level_Entity_V1>>(level_file, &game_world->cameras);
+	} else {
+		level_file->read(&game_world->entities);
+		level_file->read(&game_world->lights);
+		level_file->read(&game_world->geometry_entities);
+		level_file->read(&game_world->cameras);
+	}
+	game_world->rebuild_slot_maps();
 }
 
 inline void load_saved_meshes(File *level_file, Render_World *render_world)
@@ -89,14 +263,25 @@ inline void load_saved_meshes(File *level_file, Render_World *render_world)
 	}
 }
 
-inline void init_render_world(File *level_file, Game_World *game_world, Render_World *render_world)
+inline void init_render_world(File *level_file, u32 version, Game_World *game_world, Render_World *render_world)
 {
 	assert(level_file);
 	assert(game_world);
 	assert(render_world);
 
 	Array<Pair<Entity_Id, String_Id>> level_render_entities;
-	level_file->read(&level_render_entities);
+	if (version == LEVEL_VERSION_UNVERSIONED) {
+		Array<Pair<Level_Entity_Id_V0, Level_String_Id_V0>> unversioned_render_entities;
+		level_file->read(&unversioned_render_entities);
+		for (u32 i = 0; i < unversioned_render_entities.count; i++) {
+			Level_Entity_Id_V0 *entity_id = &unversioned_render_entities[i].first;
+			// The old 32 bit hashes can't be turned into the new ids, the value is only widened.
+			String_Id mesh_name_id = (String_Id)unversioned_render_entities[i].second;
+			level_render_entities.push(Pair<Entity_Id, String_Id>(Entity_Id(entity_id->type, entity_id->index, 1), mesh_name_id));
+		}
+	} else {
+		level_file->read(&level_render_entities);
+	}
 
 	for (u32 i = 0; i < level_render_entities.count; i++) {
 		Pair<Entity_Id, String_Id> *entity = &level_render_entities[i];
@@ -176,9 +361,19 @@ void init_game_and_render_world_from_level(const char *level_name, Game_World *g
 
 	File level_file;
 	if (level_file.open(full_path_to_level_file, FILE_MODE_READ, FILE_OPEN_EXISTING)) {
-		load_game_entities(&level_file, game_world);
+		u32 version = LEVEL_VERSION_UNVERSIONED;
+		u32 magic_or_entity_count = 0;
+		level_file.read(&magic_or_entity_count);
+		if (magic_or_entity_count == LEVEL_FILE_MAGIC) {
+			level_file.read(&version);
+		}
+		if (version > LEVEL_VERSION_CURRENT) {
+			print("init_game_and_render_world_from_level: {} has the level version {}, the engine supports versions up to {}.", level_name, version, (u32)LEVEL_VERSION_CURRENT);
+			return;
+		}
+		load_game_entities(&level_file, version, magic_or_entity_count, game_world);
 		load_saved_meshes(&level_file, render_world);
-		init_render_world(&level_file, game_world, render_world);
+		init_render_world(&level_file, version, game_world, render_world);
 	}
 }
 
@@ -191,6 +386,10 @@ void save_game_and_render_world_in_level(const char *level_name, Game_World *gam
 
 	File level_file;
 	if (level_file.open(full_path_to_level_file, FILE_MODE_WRITE, FILE_CREATE_ALWAYS)) {
+		u32 magic = LEVEL_FILE_MAGIC;
+		u32 version = LEVEL_VERSION_CURRENT;
+		level_file.write(&magic);
+		level_file.write(&version);
 		save_game_entities(&level_file, game_world);
 		//save_loaded_mesh_names(&level_file, render_world->model_storage.loaded_models_files);
 		save_render_entities(&level_file, render_world);
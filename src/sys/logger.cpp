@@ -0,0 +1,311 @@
+#include <stdio.h>
+#include <assert.h>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <condition_variable>
+
+#include "sys.h"
+#include "logger.h"
+#include "profiling.h"
+#include "../libs/string_id.h"
+#include "../libs/structures/concurrent_queue.h"
+
+const u32 LOG_RING_CAPACITY = 4096;
+const u32 LOG_DEDUP_CACHE_SIZE = 256;
+const u32 LOG_FLUSH_INTERVAL_MS = 10;
+
+// Remembers the last LOG_DEDUP_CACHE_SIZE unique texts, so a message printed every frame is written once
+// and the memory used for it doesn't grow as it did with a set of all printed texts.
+struct Log_Dedup_Cache {
+	struct Entry {
+		String_Id text_id = EMPTY_STRING_ID;
+		u64 last_use = 0;
+	};
+	u64 use_counter = 0;
+	Entry entries[LOG_DEDUP_CACHE_SIZE];
+
+	bool contains_or_add(const char *text, u32 text_len);
+};
+
+// Returns true if the text is in the cache, otherwise the text takes the place of the least recently used entry.
+bool Log_Dedup_Cache::contains_or_add(const char *text, u32 text_len)
+{
+	String_Id text_id = make_string_id(text, text_len);
+	use_counter++;
+
+	Entry *oldest_entry = &entries[0];
+	for (u32 i = 0; i < LOG_DEDUP_CACHE_SIZE; i++) {
+		if (entries[i].text_id == text_id) {
+			entries[i].last_use = use_counter;
+			return true;
+		}
+		if (entries[i].last_use < oldest_entry->last_use) {
+			oldest_entry = &entries[i];
+		}
+	}
+	oldest_entry->text_id = text_id;
+	oldest_entry->last_use = use_counter;
+	return false;
+}
+
+struct Logger {
+	std::atomic<bool> running = false;
+	std::atomic<bool> stop_thread = false;
+	std::atomic<bool> thread_finished = false;
+	std::atomic<bool> wake_up_requested = false;
+	std::atomic<u8> level = LOG_LEVEL_VERBOSE;
+	std::atomic<u64> flush_request_count = 0;
+	std::atomic<u64> completed_flush_count = 0;
+	std::atomic<u64> dropped_record_count = 0;
+
+	FILE *file = NULL;
+	std::thread *thread = NULL;
+	std::mutex wake_up_mutex;
+	std::condition_variable wake_up_condition;
+
+	// Guards the batch, the dedup cache and the file. Records are written under it
+	// by the logger thread or, when the logger is not running, by the thread which prints.
+	std::mutex write_mutex;
+	Format_Buffer batch;
+	Log_Dedup_Cache dedup_cache;
+
+	MPMC_Queue<Log_Record> ring;
+
+	// The console window belongs to the main thread and sending text to it from the logger thread blocks
+	// until the main thread processes the message. While the main thread waits for workers which wait for the logger,
+	// that never happens, so the logger thread only queues console text and the main thread writes it.
+	bool defer_console_text = false;
+	std::thread::id main_thread_id;
+	std::mutex console_text_mutex;
+	Format_Buffer console_text;
+};
+
+static Logger logger;
+
+static const char *get_log_level_prefix(Log_Level level)
+{
+	switch (level) {
+		case LOG_LEVEL_WARNING:
+			return "[Warning] ";
+		case LOG_LEVEL_ERROR:
+			return "[Error] ";
+		case LOG_LEVEL_VERBOSE:
+		case LOG_LEVEL_INFO:
+		default:
+			break;
+	}
+	return NULL;
+}
+
+static void add_record_to_batch(Log_Record *record)
+{
+	const char *text = record->long_text ? record->long_text : record->text;
+	u32 text_len = record->long_text ? (u32)strlen(record->long_text) : record->len;
+
+	if (!(record->flags & LOG_RECORD_UNIQUE) || !logger.dedup_cache.contains_or_add(text, text_len)) {
+		const char *prefix = get_log_level_prefix(record->level);
+		if (prefix) {
+			logger.batch.append(prefix, (u32)strlen(prefix));
+		}
+		logger.batch.append(text, text_len);
+		if (record->flags & LOG_RECORD_NEW_LINE) {
+			logger.batch.append('\n');
+		}
+	}
+	DELETE_ARRAY(record->long_text);
+}
+
+static void add_dropped_record_count_to_batch()
+{
+	u64 dropped_record_count = logger.dropped_record_count.exchange(0, std::memory_order_acq_rel);
+	if (dropped_record_count > 0) {
+		format_to(&logger.batch, "[Warning] {} log records were dropped, the log ring was full.\n", dropped_record_count);
+	}
+}
+
+// One write to the console and the file for a whole batch. Appending text to the console edit control
+// is the slow part of printing and it used to be done for every message on the thread which printed.
+static void write_batch()
+{
+	if (logger.batch.len == 0) {
+		return;
+	}
+	const char *text = logger.batch.c_str();
+	if (logger.defer_console_text) {
+		std::lock_guard<std::mutex> lock(logger.console_text_mutex);
+		logger.console_text.append(text, logger.batch.len);
+	} else {
+		append_text_to_console_buffer(text, false);
+	}
+	if (logger.file) {
+		fwrite(text, 1, logger.batch.len, logger.file);
+		fflush(logger.file);
+	}
+	logger.batch.len = 0;
+}
+
+static void write_ring_records()
+{
+	std::lock_guard<std::mutex> lock(logger.write_mutex);
+
+	Log_Record record;
+	u32 record_count = 0;
+	while (logger.ring.pop(record)) {
+		add_record_to_batch(&record);
+		if (++record_count == LOG_RING_CAPACITY) {
+			write_batch();
+			record_count = 0;
+		}
+	}
+	add_dropped_record_count_to_batch();
+	write_batch();
+}
+
+static void run_logger_thread()
+{
+	set_profile_thread_name("Logger thread");
+	while (true) {
+		bool stop = logger.stop_thread.load(std::memory_order_acquire);
+		u64 flush_request = logger.flush_request_count.load(std::memory_order_acquire);
+
+		write_ring_records();
+		logger.completed_flush_count.store(flush_request, std::memory_order_release);
+		if (stop) {
+			break;
+		}
+		std::unique_lock<std::mutex> lock(logger.wake_up_mutex);
+		logger.wake_up_condition.wait_for(lock, std::chrono::milliseconds(LOG_FLUSH_INTERVAL_MS), []() {
+			return logger.wake_up_requested.load(std::memory_order_acquire) || logger.stop_thread.load(std::memory_order_acquire);
+		});
+		logger.wake_up_requested.store(false, std::memory_order_relaxed);
+	}
+	logger.thread_finished.store(true, std::memory_order_release);
+}
+
+static void wake_up_logger_thread()
+{
+	if (!logger.wake_up_requested.exchange(true, std::memory_order_acq_rel)) {
+		logger.wake_up_condition.notify_one();
+	}
+}
+
+// The logger thread never waits for other threads, so waiting for it can't deadlock.
+template <typename Predicate>
+static void wait_for_logger_thread(Predicate is_done)
+{
+	while (!is_done()) {
+		std::this_thread::yield();
+	}
+}
+
+bool init_logger(const char *log_file_name, bool defer_console_text)
+{
+	assert(!logger.running);
+
+	logger.defer_console_text = defer_console_text;
+	logger.main_thread_id = std::this_thread::get_id();
+
+	if (log_file_name && fopen_s(&logger.file, log_file_name, "w")) {
+		logger.file = NULL;
+		print("init_logger: Failed to open the log file {}.", log_file_name);
+	}
+	logger.ring.init(LOG_RING_CAPACITY);
+	logger.stop_thread.store(false, std::memory_order_relaxed);
+	logger.thread_finished.store(false, std::memory_order_relaxed);
+	logger.thread = new std::thread(run_logger_thread);
+	logger.running.store(true, std::memory_order_release);
+	return logger.file != NULL;
+}
+
+// Records which are pushed by other threads while the logger is being shut down are written by the final pass.
+void shutdown_logger()
+{
+	if (!logger.running) {
+		return;
+	}
+	logger.stop_thread.store(true, std::memory_order_release);
+	wake_up_logger_thread();
+	wait_for_logger_thread([]() { return logger.thread_finished.load(std::memory_order_acquire); });
+	logger.thread->join();
+	DELETE_PTR(logger.thread);
+
+	logger.running.store(false, std::memory_order_release);
+	write_ring_records();
+	write_console_text();
+
+	std::lock_guard<std::mutex> lock(logger.write_mutex);
+	logger.defer_console_text = false;
+	if (logger.file) {
+		fclose(logger.file);
+		logger.file = NULL;
+	}
+}
+
+// Waits until all records which were pushed before the call are written. On the main thread the queued
+// console text is written too.
+void flush_logger()
+{
+	if (!logger.running) {
+		return;
+	}
+	u64 flush_request = logger.flush_request_count.fetch_add(1, std::memory_order_acq_rel) + 1;
+	wake_up_logger_thread();
+	wait_for_logger_thread([flush_request]() {
+		return (logger.completed_flush_count.load(std::memory_order_acquire) >= flush_request) || logger.thread_finished.load(std::memory_order_acquire);
+	});
+	write_console_text();
+}
+
+// The text is taken out of the queue under the lock and sent to the console without it,
+// so the logger thread doesn't wait while the console is updated.
+void write_console_text()
+{
+	if (std::this_thread::get_id() != logger.main_thread_id) {
+		return;
+	}
+	char *text = NULL;
+	{
+		std::lock_guard<std::mutex> lock(logger.console_text_mutex);
+		if (logger.console_text.len > 0) {
+			text = logger.console_text.copy();
+			logger.console_text.len = 0;
+		}
+	}
+	if (text) {
+		append_text_to_console_buffer(text, false);
+		DELETE_ARRAY(text);
+	}
+}
+
+void set_log_level(Log_Level level)
+{
+	logger.level.store(level, std::memory_order_relaxed);
+}
+
+bool is_log_level_enabled(Log_Level level)
+{
+	return level >= logger.level.load(std::memory_order_relaxed);
+}
+
+void push_log_record(Log_Record *record)
+{
+	if (logger.running.load(std::memory_order_acquire)) {
+		// A thread which prints must not wait for the logger thread, so if the ring is full the record is dropped
+		// and the logger thread writes how many records were dropped.
+		if (!logger.ring.push(std::move(*record))) {
+			DELETE_ARRAY(record->long_text);
+			logger.dropped_record_count.fetch_add(1, std::memory_order_relaxed);
+			wake_up_logger_thread();
+			return;
+		}
+		if ((record->level == LOG_LEVEL_ERROR) || (logger.ring.count() > (LOG_RING_CAPACITY / 2))) {
+			wake_up_logger_thread();
+		}
+	} else {
+		std::lock_guard<std::mutex> lock(logger.write_mutex);
+		add_record_to_batch(record);
+		write_batch();
+	}
+}
@@ -0,0 +1,70 @@
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include "../libs/str.h"
+#include "../libs/number_types.h"
+
+// Verbose messages are compiled out of release builds.
+#ifndef LOG_VERBOSE_ENABLED
+#ifdef _DEBUG
+#define LOG_VERBOSE_ENABLED 1
+#else
+#define LOG_VERBOSE_ENABLED 0
+#endif
+#endif
+
+enum Log_Level : u8 {
+	LOG_LEVEL_VERBOSE,
+	LOG_LEVEL_INFO,
+	LOG_LEVEL_WARNING,
+	LOG_LEVEL_ERROR
+};
+
+const u8 LOG_RECORD_NEW_LINE = 0x1;
+const u8 LOG_RECORD_UNIQUE = 0x2; // The record is written only if the same text was not written recently.
+
+const u32 LOG_RECORD_TEXT_SIZE = 244;
+
+// A record is 256 bytes, text which doesn't fit in it is placed on the heap and freed by the logger thread.
+struct Log_Record {
+	char *long_text = NULL;
+	Log_Level level = LOG_LEVEL_INFO;
+	u8 flags = 0;
+	u16 len = 0;
+	char text[LOG_RECORD_TEXT_SIZE];
+};
+
+// The logger thread writes records to the console and to the log file. Records are passed to it
+// through a lock-free ring, so print costs a format and a push for the calling thread.
+// Before init_logger and after shutdown_logger records are written on the calling thread.
+// If the console is a window of the main thread, defer_console_text makes the logger thread queue
+// console text and the main thread writes it with write_console_text every frame.
+bool init_logger(const char *log_file_name, bool defer_console_text = false);
+void shutdown_logger();
+void flush_logger();
+void write_console_text();
+void set_log_level(Log_Level level);
+bool is_log_level_enabled(Log_Level level);
+void push_log_record(Log_Record *record);
+
+template <typename... Args>
+void write_log(Log_Level level, u8 flags, const Args &... args)
+{
+	if (!is_log_level_enabled(level)) {
+		return;
+	}
+	Log_Record record;
+	record.level = level;
+	record.flags = flags;
+
+	Format_Buffer buffer(record.text, LOG_RECORD_TEXT_SIZE);
+	format_to(&buffer, args...);
+	if (buffer.truncated) {
+		Format_Buffer long_buffer;
+		format_to(&long_buffer, args...);
+		record.long_text = long_buffer.copy();
+	}
+	record.len = (u16)buffer.len;
+	push_log_record(&record);
+}
+#endif
@@ -0,0 +1,118 @@
+#ifndef PLATFORM_H
+#define PLATFORM_H
+
+// The engine is built by MSVC for Windows. Tools which use only the core libraries (the benchmarks) are built
+// on other platforms too, for them the MSVC functions which the core libraries call are made from standard ones.
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <wchar.h>
+
+typedef int errno_t;
+typedef long HRESULT;
+typedef unsigned long DWORD;
+
+#define FAILED(hr) (((HRESULT)(hr)) < 0)
+#define __forceinline inline __attribute__((always_inline))
+#define __debugbreak() __builtin_trap()
+#define strtok_s strtok_r
+#define _sprintf_p snprintf
+
+inline errno_t fopen_s(FILE **file, const char *file_name, const char *mode)
+{
+	*file = fopen(file_name, mode);
+	return *file ? 0 : 1;
+}
+
+inline errno_t strcat_s(char *destination, size_t destination_size, const char *source)
+{
+	size_t destination_len = strlen(destination);
+	size_t source_len = strlen(source);
+	if ((destination_len + source_len + 1) > destination_size) {
+		return 1;
+	}
+	memcpy(destination + destination_len, source, source_len + 1);
+	return 0;
+}
+
+inline errno_t mbstowcs_s(size_t *converted_count, wchar_t *destination, size_t destination_size, const char *source, size_t count)
+{
+	size_t result = mbstowcs(destination, source, (count < destination_size) ? count : destination_size - 1);
+	if (result == (size_t)-1) {
+		return 1;
+	}
+	destination[result] = L'\0';
+	if (converted_count) {
+		*converted_count = result + 1;
+	}
+	return 0;
+}
+
+// Writes a number in the radix from 2 to 36 like _i64toa_s, a negative number gets a minus only in the radix 10.
+inline errno_t integer_to_string(unsigned long long number, bool negative, char *buffer, size_t buffer_size, int radix)
+{
+	if ((radix < 2) || (radix > 36) || (buffer_size == 0)) {
+		return 1;
+	}
+	char digits[66];
+	unsigned int digit_count = 0;
+	do {
+		unsigned int digit = (unsigned int)(number % (unsigned long long)radix);
+		digits[digit_count++] = (char)((digit < 10) ? ('0' + digit) : ('a' + digit - 10));
+		number /= (unsigned long long)radix;
+	} while (number > 0);
+
+	size_t len = digit_count + (negative ? 1 : 0);
+	if ((len + 1) > buffer_size) {
+		buffer[0] = '\0';
+		return 1;
+	}
+	char *c = buffer;
+	if (negative) {
+		*c++ = '-';
+	}
+	while (digit_count > 0) {
+		*c++ = digits[--digit_count];
+	}
+	*c = '\0';
+	return 0;
+}
+
+inline errno_t signed_integer_to_string(long long number, char *buffer, size_t buffer_size, int radix)
+{
+	if ((radix == 10) && (number < 0)) {
+		return integer_to_string(0ull - (unsigned long long)number, true, buffer, buffer_size, radix);
+	}
+	return integer_to_string((unsigned long long)number, false, buffer, buffer_size, radix);
+}
+
+inline errno_t _itoa_s(int number, char *buffer, size_t buffer_size, int radix)
+{
+	return (radix == 10) ? signed_integer_to_string(number, buffer, buffer_size, radix) : integer_to_string((unsigned int)number, false, buffer, buffer_size, radix);
+}
+
+inline errno_t _ltoa_s(long number, char *buffer, size_t buffer_size, int radix)
+{
+	return (radix == 10) ? signed_integer_to_string(number, buffer, buffer_size, radix) : integer_to_string((unsigned long)number, false, buffer, buffer_size, radix);
+}
+
+inline errno_t _ultoa_s(unsigned long number, char *buffer, size_t buffer_size, int radix)
+{
+	return integer_to_string(number, false, buffer, buffer_size, radix);
+}
+
+inline errno_t _i64toa_s(long long number, char *buffer, size_t buffer_size, int radix)
+{
+	return signed_integer_to_string(number, buffer, buffer_size, radix);
+}
+
+inline errno_t _ui64toa_s(unsigned long long number, char *buffer, size_t buffer_size, int radix)
+{
+	return integer_to_string(number, false, buffer, buffer_size, radix);
+}
+#endif
+
+#endif
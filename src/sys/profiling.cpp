@@ -1,6 +1,10 @@
-#include "profiling.h"
+#include <assert.h>
+#include <stdio.h>
+#include <chrono>
+#include <mutex>
 
-#include "../win32/win_time.h"
+#include "sys.h"
+#include "profiling.h"
 
 #ifdef VTUNE_PROFILING
 static __itt_domain *domain = NULL;
@@ -14,20 +18,196 @@ __itt_domain *get_default_domain()
 }
 #endif
 
-static s64 time_stamp = 0;
+std::atomic<bool> profile_capture_running = false;
+thread_local Profile_Thread_Buffer *profile_thread_buffer = NULL;
+
+struct Profiler {
+	std::atomic<u32> thread_count = 0;
+	std::atomic<Profile_Thread_Buffer *> first_buffer = NULL;
+
+	std::atomic<u32> capture_index = 0;
+	u64 capture_start_ticks = 0;
+	u64 capture_end_ticks = 0;
+};
+
+static Profiler profiler;
+
+// Buffers are pushed to the front of the list with a compare and swap, the list is never shortened.
+Profile_Thread_Buffer *register_profile_thread()
+{
+	assert(!profile_thread_buffer);
+
+	Profile_Thread_Buffer *buffer = new Profile_Thread_Buffer();
+	buffer->thread_id = profiler.thread_count.fetch_add(1, std::memory_order_relaxed) + 1;
+	buffer->next = profiler.first_buffer.load(std::memory_order_relaxed);
+	while (!profiler.first_buffer.compare_exchange_weak(buffer->next, buffer, std::memory_order_release, std::memory_order_relaxed)) {
+	}
+	profile_thread_buffer = buffer;
+	return buffer;
+}
+
+// A thread starts its part of a new capture from the beginning of its buffer when it records the first zone of the capture.
+void record_profile_zone(Profile_Thread_Buffer *buffer, Profile_Zone *zone)
+{
+	u32 capture_index = profiler.capture_index.load(std::memory_order_relaxed);
+	if (buffer->capture_index.load(std::memory_order_relaxed) != capture_index) {
+		buffer->zone_count.store(0, std::memory_order_relaxed);
+		buffer->dropped_zone_count = 0;
+		buffer->capture_index.store(capture_index, std::memory_order_relaxed);
+	}
+	u32 zone_count = buffer->zone_count.load(std::memory_order_relaxed);
+	if (zone_count >= PROFILE_THREAD_ZONE_COUNT) {
+		buffer->dropped_zone_count++;
+		return;
+	}
+	buffer->zones[zone_count] = *zone;
+	buffer->zone_count.store(zone_count + 1, std::memory_order_release);
+}
+
+#ifdef PROFILE_TICKS_RDTSC
+static u64 calibrate_profile_ticks()
+{
+	using namespace std::chrono;
+
+	const double CALIBRATION_SECONDS = 0.02;
+	steady_clock::time_point start_time = steady_clock::now();
+	u64 start_ticks = profile_ticks();
+	double seconds = 0.0;
+	while (seconds < CALIBRATION_SECONDS) {
+		seconds = duration<double>(steady_clock::now() - start_time).count();
+	}
+	u64 end_ticks = profile_ticks();
+	return (u64)((double)(end_ticks - start_ticks) / seconds);
+}
+#endif
+
+u64 profile_ticks_per_second()
+{
+#ifdef PROFILE_TICKS_RDTSC
+	static u64 ticks_per_second = calibrate_profile_ticks();
+#else
+	static u64 ticks_per_second = 1000000000;
+#endif
+	return ticks_per_second;
+}
+
+void init_profiler()
+{
+	profile_ticks_per_second();
+	set_profile_thread_name("Main thread");
+}
+
+// The name must live as long as the program.
+void set_profile_thread_name(const char *name)
+{
+	Profile_Thread_Buffer *buffer = profile_thread_buffer ? profile_thread_buffer : register_profile_thread();
+	buffer->thread_name = name;
+}
+
+void start_profile_capture()
+{
+	profiler.capture_index.fetch_add(1, std::memory_order_relaxed);
+	profiler.capture_start_ticks = profile_ticks();
+	profile_capture_running.store(true, std::memory_order_release);
+}
+
+void stop_profile_capture()
+{
+	profile_capture_running.store(false, std::memory_order_release);
+	profiler.capture_end_ticks = profile_ticks();
+}
+
+bool is_profile_capture_running()
+{
+	return profile_capture_running.load(std::memory_order_relaxed);
+}
+
+static void write_json_string(FILE *file, const char *string)
+{
+	fputc('"', file);
+	for (const char *c = string ? string : "Unnamed"; *c; c++) {
+		if ((*c == '"') || (*c == '\\')) {
+			fputc('\\', file);
+		}
+		fputc(*c, file);
+	}
+	fputc('"', file);
+}
+
+// Zones are written as complete events ("ph":"X") with microsecond timestamps from the start of the capture,
+// the file can be opened in chrome://tracing or Perfetto. Must not be called while a new capture is being started.
+bool write_profile_capture_to_chrome_trace(const char *full_path)
+{
+	assert(full_path);
+
+	FILE *file = NULL;
+#ifdef _WIN32
+	if (fopen_s(&file, full_path, "w")) {
+		file = NULL;
+	}
+#else
+	file = fopen(full_path, "w");
+#endif
+	if (!file) {
+		print("write_profile_capture_to_chrome_trace: Failed to open {}.", full_path);
+		return false;
+	}
+	double microseconds_per_tick = 1000000.0 / (double)profile_ticks_per_second();
+	u32 capture_index = profiler.capture_index.load(std::memory_order_relaxed);
+	u64 capture_start_ticks = profiler.capture_start_ticks;
+
+	u32 total_zone_count = 0;
+	u32 total_dropped_zone_count = 0;
+	bool first_event = true;
+	fputs("{\"traceEvents\":[\n", file);
+
+	for (Profile_Thread_Buffer *buffer = profiler.first_buffer.load(std::memory_order_acquire); buffer; buffer = buffer->next) {
+		if (buffer->thread_name) {
+			fputs(first_event ? "" : ",\n", file);
+			fprintf(file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":", buffer->thread_id);
+			write_json_string(file, buffer->thread_name);
+			fputs("}}", file);
+			first_event = false;
+		}
+		u32 zone_count = buffer->zone_count.load(std::memory_order_acquire);
+		if (buffer->capture_index.load(std::memory_order_relaxed) != capture_index) {
+			continue;
+		}
+		for (u32 i = 0; i < zone_count; i++) {
+			Profile_Zone *zone = &buffer->zones[i];
+			double start = (zone->start_ticks > capture_start_ticks) ? (double)(zone->start_ticks - capture_start_ticks) * microseconds_per_tick : 0.0;
+			double duration = (double)(zone->end_ticks - zone->start_ticks) * microseconds_per_tick;
+
+			fputs(first_event ? "" : ",\n", file);
+			fputs("{\"name\":", file);
+			write_json_string(file, zone->name);
+			fprintf(file, ",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}", buffer->thread_id, start, duration);
+			first_event = false;
+		}
+		total_zone_count += zone_count;
+		total_dropped_zone_count += buffer->dropped_zone_count;
+	}
+	fputs("\n]}\n", file);
+	fclose(file);
+
+	print("write_profile_capture_to_chrome_trace: {} zones were written to {}, {} zones didn't fit in thread buffers.", total_zone_count, full_path, total_dropped_zone_count);
+	return true;
+}
+
+static std::chrono::steady_clock::time_point time_stamp;
 
 void begin_time_stamp()
 {
-	time_stamp = milliseconds_counter();
+	time_stamp = std::chrono::steady_clock::now();
 }
 
 s64 delta_time_in_milliseconds()
 {
-	return milliseconds_counter() - time_stamp;
+	return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - time_stamp).count();
 }
 
 s64 delta_time_in_fps()
 {
-	return s64();
+	s64 microseconds = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - time_stamp).count();
+	return (microseconds > 0) ? (1000 * 1000) / microseconds : 0;
 }
-
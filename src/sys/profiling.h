@@ -1,43 +1,149 @@
 #ifndef PROFILING_H
 #define PROFILING_H
 
+#include <atomic>
+
+// Ticks are read from the timestamp counter on x86, whose frequency profile_ticks_per_second calibrates,
+// and are nanoseconds of steady_clock on other CPUs.
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define PROFILE_TICKS_RDTSC
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define PROFILE_TICKS_RDTSC
+#else
+#include <chrono>
+#endif
+
 #include "../libs/number_types.h"
 
 #ifdef VTUNE_PROFILING
 #include <ittnotify.h>
 __itt_domain *get_default_domain();
-__forceinline void begin_profile_frame(const char *name)
-{
-	__itt_frame_begin_v3(get_default_domain(), NULL);
-}
-__forceinline void end_profile_frame()
+#endif
+
+const u32 PROFILE_ZONE_STACK_SIZE = 64;
+const u32 PROFILE_THREAD_ZONE_COUNT = 1 << 15;
+
+struct Profile_Zone {
+	const char *name = NULL;
+	u64 start_ticks = 0;
+	u64 end_ticks = 0;
+};
+
+// Zones of one thread. Only the owner thread writes the buffer, a zone is published by the release store of zone_count
+// when the zone ends, so a thread which reads the buffer never sees a zone which is being written.
+// Buffers are never freed, a buffer of a finished thread stays in the capture.
+struct Profile_Thread_Buffer {
+	u32 thread_id = 0;
+	const char *thread_name = NULL;
+	Profile_Thread_Buffer *next = NULL;
+
+	u32 zone_stack_depth = 0;
+	Profile_Zone zone_stack[PROFILE_ZONE_STACK_SIZE];
+
+	std::atomic<u32> capture_index = 0;
+	std::atomic<u32> zone_count = 0;
+	u32 dropped_zone_count = 0;
+	Profile_Zone zones[PROFILE_THREAD_ZONE_COUNT];
+};
+
+extern std::atomic<bool> profile_capture_running;
+extern thread_local Profile_Thread_Buffer *profile_thread_buffer;
+
+Profile_Thread_Buffer *register_profile_thread();
+void record_profile_zone(Profile_Thread_Buffer *buffer, Profile_Zone *zone);
+
+inline u64 profile_ticks()
 {
-	__itt_frame_end_v3(get_default_domain(), NULL);
+#ifdef PROFILE_TICKS_RDTSC
+	return __rdtsc();
+#else
+	return (u64)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
 }
-__forceinline void begin_profile_task(const char *task_name)
+
+// Zones are nested on a thread, begin_profile_zone and end_profile_zone must be called in pairs.
+// Zones are kept only while a capture is running, outside of it a zone costs two reads of the timestamp counter.
+inline void begin_profile_zone(const char *name)
 {
-	__itt_task_begin(get_default_domain(), __itt_null, __itt_null, __itt_string_handle_create(task_name));
+	Profile_Thread_Buffer *buffer = profile_thread_buffer ? profile_thread_buffer : register_profile_thread();
+	if (buffer->zone_stack_depth < PROFILE_ZONE_STACK_SIZE) {
+		Profile_Zone *zone = &buffer->zone_stack[buffer->zone_stack_depth];
+		zone->name = name;
+		zone->start_ticks = profile_ticks();
+	}
+	buffer->zone_stack_depth++;
 }
-__forceinline void end_profile_task()
+
+inline void end_profile_zone()
 {
-	__itt_task_end(get_default_domain());
+	Profile_Thread_Buffer *buffer = profile_thread_buffer;
+	if (!buffer || (buffer->zone_stack_depth == 0)) {
+		return;
+	}
+	buffer->zone_stack_depth--;
+	if ((buffer->zone_stack_depth < PROFILE_ZONE_STACK_SIZE) && profile_capture_running.load(std::memory_order_relaxed)) {
+		Profile_Zone *zone = &buffer->zone_stack[buffer->zone_stack_depth];
+		zone->end_ticks = profile_ticks();
+		record_profile_zone(buffer, zone);
+	}
 }
-#else
-__forceinline void begin_profile_frame(const char *name) 
+
+struct Profile_Scope {
+	Profile_Scope(const char *name) { begin_profile_zone(name); }
+	~Profile_Scope() { end_profile_zone(); }
+};
+
+#define PROFILE_SCOPE_1(x, y) x##y
+#define PROFILE_SCOPE_2(x, y) PROFILE_SCOPE_1(x, y)
+#define PROFILE_SCOPE(name) Profile_Scope PROFILE_SCOPE_2(_profile_scope_, __COUNTER__)(name)
+
+inline void begin_profile_frame(const char *name)
 {
+#ifdef VTUNE_PROFILING
+	__itt_frame_begin_v3(get_default_domain(), NULL);
+#endif
+	begin_profile_zone(name);
 }
-__forceinline void end_profile_frame() 
+
+inline void end_profile_frame()
 {
+	end_profile_zone();
+#ifdef VTUNE_PROFILING
+	__itt_frame_end_v3(get_default_domain(), NULL);
+#endif
 }
-__forceinline void begin_profile_task(const char *name)
+
+inline void begin_profile_task(const char *task_name)
 {
+#ifdef VTUNE_PROFILING
+	__itt_task_begin(get_default_domain(), __itt_null, __itt_null, __itt_string_handle_create(task_name));
+#endif
+	begin_profile_zone(task_name);
 }
-__forceinline void end_profile_task()
+
+inline void end_profile_task()
 {
-}
+	end_profile_zone();
+#ifdef VTUNE_PROFILING
+	__itt_task_end(get_default_domain());
 #endif
+}
+
+// The timestamp counter is calibrated once against the steady clock, init_profiler does it at startup
+// so that the first capture doesn't wait for it.
+void init_profiler();
+u64 profile_ticks_per_second();
+void set_profile_thread_name(const char *name);
+
+void start_profile_capture();
+void stop_profile_capture();
+bool is_profile_capture_running();
+bool write_profile_capture_to_chrome_trace(const char *full_path);
+
 void begin_time_stamp();
 s64 delta_time_in_milliseconds();
 s64 delta_time_in_fps();
 
-#endif
\ No newline at end of file
+#endif
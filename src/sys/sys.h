@@ -1,12 +1,17 @@
 #ifndef SYS_H
 #define SYS_H
 
-#include <windows.h>
-
+#include "platform.h"
+#include "logger.h"
 #include "../libs/str.h"
-#include "../win32/win_console.h"
 #include "../libs/number_types.h"
 
+#ifdef _WIN32
+#include "../win32/win_console.h"
+#else
+void append_text_to_console_buffer(const char *text, bool move_to_next_line);
+#endif
+
 #define ASSERT_MSG(expr, str_msg) (assert((expr) && (str_msg)))
 
 void report_info(const char *info_message);
@@ -19,47 +24,60 @@ inline void simple_print(const char *string)
 }
 
 template <typename... Args>
-void print(Args... args)
+void print(const Args &... args)
 {
-	char *formatted_string = format(args...);
-	append_text_to_console_buffer(formatted_string, true);
-	if (formatted_string) { delete formatted_string; }
+	write_log(LOG_LEVEL_INFO, LOG_RECORD_NEW_LINE, args...);
 }
 
 template <typename... Args>
-void print_same_line(Args... args)
+void print_same_line(const Args &... args)
 {
-	char *formatted_string = format(args...);
-	append_text_to_console_buffer(formatted_string, false);
-	if (formatted_string) { delete formatted_string; }
+	write_log(LOG_LEVEL_INFO, 0, args...);
 }
 
-bool is_string_unique(const char *string);
+template <typename... Args>
+void print_verbose(const Args &... args)
+{
+#if LOG_VERBOSE_ENABLED
+	write_log(LOG_LEVEL_VERBOSE, LOG_RECORD_NEW_LINE, args...);
+#endif
+}
+
+template <typename... Args>
+void print_warning(const Args &... args)
+{
+	write_log(LOG_LEVEL_WARNING, LOG_RECORD_NEW_LINE, args...);
+}
+
+template <typename... Args>
+void print_error(const Args &... args)
+{
+	write_log(LOG_LEVEL_ERROR, LOG_RECORD_NEW_LINE, args...);
+}
 
+// Prints a message once, it is used for messages from code which runs every frame.
 template <typename... Args>
-void loop_print(Args... args)
+void loop_print(const Args &... args)
 {
-	char *formatted_string = format(args...);
-	if (is_string_unique(formatted_string)) {
-		append_text_to_console_buffer(formatted_string, true);
-	}
-	if (formatted_string) { delete formatted_string; }
+	write_log(LOG_LEVEL_INFO, LOG_RECORD_NEW_LINE | LOG_RECORD_UNIQUE, args...);
 }
 
 template <typename... Args>
-void info(Args... args)
+void info(const Args &... args)
 {
-	char *formatted_string = format(args...);
-	report_info(formatted_string);
-	if (formatted_string) { delete formatted_string; }
+	Format_Buffer buffer;
+	format_to(&buffer, args...);
+	report_info(buffer.c_str());
 }
 
 template <typename... Args>
-void error(Args... args)
+void error(const Args &... args)
 {
-	char *formatted_string = format(args...);
-	report_error(formatted_string);
-	if (formatted_string) { delete formatted_string; }
+	Format_Buffer buffer;
+	format_to(&buffer, args...);
+	print_error(buffer.c_str());
+	flush_logger();
+	report_error(buffer.c_str());
 }
 
 #endif
@@ -0,0 +1,172 @@
+#include <assert.h>
+#include <thread>
+
+#include "sys.h"
+#include "jobs.h"
+#include "profiling.h"
+#include "task_graph.h"
+#include "../win32/win_time.h"
+
+void Frame_Task_Graph::add_task(const char *name, Frame_Task_Function function, void *data, u32 reads, u32 writes, bool main_thread)
+{
+	assert(name);
+	assert(function);
+	assert(task_count < FRAME_TASK_MAX_COUNT);
+
+	Frame_Task *task = &tasks[task_count++];
+	task->name = name;
+	task->function = function;
+	task->data = data;
+	task->reads = reads;
+	task->writes = writes;
+	task->main_thread = main_thread;
+}
+
+void Frame_Task_Graph::build()
+{
+	for (u32 i = 0; i < task_count; i++) {
+		Frame_Task *task = &tasks[i];
+		task->dependencies = 0;
+		task->dependents = 0;
+
+		for (u32 j = 0; j < i; j++) {
+			Frame_Task *earlier_task = &tasks[j];
+			if ((earlier_task->writes & (task->reads | task->writes)) || (earlier_task->reads & task->writes)) {
+				task->dependencies |= 1 << j;
+				earlier_task->dependents |= 1 << i;
+			}
+		}
+	}
+	ready_main_thread_tasks.init(FRAME_TASK_MAX_COUNT);
+}
+
+static u32 count_bits(u32 value)
+{
+	u32 count = 0;
+	for (; value; value &= value - 1) {
+		count++;
+	}
+	return count;
+}
+
+static void run_frame_task_job(void *data, u32 first_index, u32 last_index)
+{
+	Frame_Task_Graph *graph = (Frame_Task_Graph *)data;
+	graph->run_task(first_index);
+}
+
+void Frame_Task_Graph::schedule_task(u32 task_index)
+{
+	if (tasks[task_index].main_thread) {
+		bool result = ready_main_thread_tasks.push(task_index);
+		assert(result);
+	} else {
+		run_job(run_frame_task_job, (void *)this, task_index, task_index + 1, NULL);
+	}
+}
+
+// The thread which finishes the last dependency of a task schedules it.
+void Frame_Task_Graph::run_task(u32 task_index)
+{
+	Frame_Task *task = &tasks[task_index];
+	task->start_ticks = cpu_ticks_counter();
+	begin_profile_zone(task->name);
+	task->function(task->data);
+	end_profile_zone();
+	task->end_ticks = cpu_ticks_counter();
+
+	for (u32 dependents = task->dependents; dependents; dependents &= dependents - 1) {
+		u32 dependent_index = 0;
+		while (!(dependents & (1 << dependent_index))) {
+			dependent_index++;
+		}
+		if (tasks[dependent_index].unfinished_dependency_count.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+			schedule_task(dependent_index);
+		}
+	}
+	finished_task_count.fetch_add(1, std::memory_order_release);
+}
+
+// Must be called on the main thread, it runs main thread tasks and helps the job threads with other tasks.
+void Frame_Task_Graph::execute()
+{
+	finished_task_count.store(0, std::memory_order_relaxed);
+	for (u32 i = 0; i < task_count; i++) {
+		tasks[i].unfinished_dependency_count.store(count_bits(tasks[i].dependencies), std::memory_order_relaxed);
+	}
+	for (u32 i = 0; i < task_count; i++) {
+		if (!tasks[i].dependencies) {
+			schedule_task(i);
+		}
+	}
+	while (finished_task_count.load(std::memory_order_acquire) < task_count) {
+		u32 task_index = 0;
+		if (ready_main_thread_tasks.pop(task_index)) {
+			run_task(task_index);
+		} else if (!run_queued_job()) {
+			std::this_thread::yield();
+		}
+	}
+	make_report();
+}
+
+void Frame_Task_Graph::make_report()
+{
+	if (task_count == 0) {
+		return;
+	}
+	float milliseconds_per_tick = 1000.0f / (float)cpu_ticks_per_second();
+
+	// Tasks were added in an order in which they can run serially, so the dependencies of a task are always before it.
+	float path_times[FRAME_TASK_MAX_COUNT];
+	u32 path_previous_tasks[FRAME_TASK_MAX_COUNT];
+	s64 first_start_ticks = tasks[0].start_ticks;
+	s64 last_end_ticks = tasks[0].end_ticks;
+	u32 critical_path_end = 0;
+
+	report.total_task_time = 0.0f;
+	for (u32 i = 0; i < task_count; i++) {
+		Frame_Task *task = &tasks[i];
+		report.task_times[i] = (float)(task->end_ticks - task->start_ticks) * milliseconds_per_tick;
+		report.total_task_time += report.task_times[i];
+
+		path_times[i] = 0.0f;
+		path_previous_tasks[i] = UINT32_MAX;
+		for (u32 j = 0; j < i; j++) {
+			if ((task->dependencies & (1 << j)) && (path_times[j] > path_times[i])) {
+				path_times[i] = path_times[j];
+				path_previous_tasks[i] = j;
+			}
+		}
+		path_times[i] += report.task_times[i];
+		if (path_times[i] > path_times[critical_path_end]) {
+			critical_path_end = i;
+		}
+		first_start_ticks = (task->start_ticks < first_start_ticks) ? task->start_ticks : first_start_ticks;
+		last_end_ticks = (task->end_ticks > last_end_ticks) ? task->end_ticks : last_end_ticks;
+	}
+	report.frame_time = (float)(last_end_ticks - first_start_ticks) * milliseconds_per_tick;
+	report.critical_path_time = path_times[critical_path_end];
+
+	u32 reversed_path[FRAME_TASK_MAX_COUNT];
+	u32 path_length = 0;
+	for (u32 i = critical_path_end; i != UINT32_MAX; i = path_previous_tasks[i]) {
+		reversed_path[path_length++] = i;
+	}
+	report.critical_path_length = path_length;
+	for (u32 i = 0; i < path_length; i++) {
+		report.critical_path[i] = reversed_path[path_length - i - 1];
+	}
+}
+
+void Frame_Task_Graph::print_report()
+{
+	print("Frame task graph: frame {}ms, critical path {}ms, all tasks {}ms on {} job threads.", report.frame_time, report.critical_path_time, report.total_task_time, get_job_thread_count());
+	for (u32 i = 0; i < task_count; i++) {
+		print("  {} {}ms{}", tasks[i].name, report.task_times[i], tasks[i].main_thread ? " (main thread)" : "");
+	}
+	print("Critical path:");
+	for (u32 i = 0; i < report.critical_path_length; i++) {
+		print("  {}", tasks[report.critical_path[i]].name);
+	}
+}
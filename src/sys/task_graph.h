@@ -0,0 +1,83 @@
+#ifndef TASK_GRAPH_H
+#define TASK_GRAPH_H
+
+#include <atomic>
+
+#include "../libs/number_types.h"
+#include "../libs/structures/concurrent_queue.h"
+
+const u32 FRAME_TASK_MAX_COUNT = 32;
+
+// The engine data which frame tasks read and write.
+enum Frame_Resource : u32 {
+	FRAME_RESOURCE_EVENTS = 0x1,
+	FRAME_RESOURCE_GUI = 0x2,
+	FRAME_RESOURCE_EDITOR = 0x4,
+	FRAME_RESOURCE_FRAME_ARENA = 0x8,
+	FRAME_RESOURCE_FILE_TRACKING = 0x10,
+	FRAME_RESOURCE_SHADERS = 0x20,
+	FRAME_RESOURCE_GAME_WORLD = 0x40,
+	FRAME_RESOURCE_RENDER_WORLD = 0x80,
+	FRAME_RESOURCE_RENDERING_VIEW = 0x100,
+	FRAME_RESOURCE_WORLD_MATRICES = 0x200,
+	FRAME_RESOURCE_SHADOW_CASCADES = 0x400,
+	FRAME_RESOURCE_RENDER_2D = 0x800,
+	FRAME_RESOURCE_RENDER_DEVICE = 0x1000
+};
+
+typedef void (*Frame_Task_Function)(void *data);
+
+struct Frame_Task {
+	const char *name = NULL;
+	Frame_Task_Function function = NULL;
+	void *data = NULL;
+	u32 reads = 0;
+	u32 writes = 0;
+	bool main_thread = false; // The task uses the window or other state which belongs to the main thread.
+
+	u32 dependencies = 0; // Bit i is set if the task must wait for task i.
+	u32 dependents = 0;
+	std::atomic<u32> unfinished_dependency_count = 0;
+
+	s64 start_ticks = 0;
+	s64 end_ticks = 0;
+};
+
+struct Frame_Task_Graph_Report {
+	float frame_time = 0.0f; // Milliseconds from the start of the first task to the end of the last one.
+	float critical_path_time = 0.0f;
+	float total_task_time = 0.0f;
+	float task_times[FRAME_TASK_MAX_COUNT];
+	u32 critical_path_length = 0;
+	u32 critical_path[FRAME_TASK_MAX_COUNT]; // Task indices from the first task to the last one.
+};
+
+// Tasks are added in the order in which the frame ran them serially. A task depends on every earlier task
+// which writes something it reads or writes, or reads something it writes. Tasks without dependencies
+// between them run at the same time on the job threads, tasks marked as main thread tasks run only on the thread
+// which calls execute. After a frame the graph measures the longest chain of dependent tasks (the critical path),
+// the frame can't be shorter than it however many cores there are.
+struct Frame_Task_Graph {
+	Frame_Task_Graph() {}
+	~Frame_Task_Graph() {}
+
+	u32 task_count = 0;
+	Frame_Task tasks[FRAME_TASK_MAX_COUNT];
+
+	std::atomic<u32> finished_task_count = 0;
+	MPMC_Queue<u32> ready_main_thread_tasks;
+
+	Frame_Task_Graph_Report report;
+
+	DELETE_COPING(Frame_Task_Graph)
+
+	void add_task(const char *name, Frame_Task_Function function, void *data, u32 reads, u32 writes, bool main_thread);
+	void build();
+	void execute();
+	void print_report();
+
+	void schedule_task(u32 task_index);
+	void run_task(u32 task_index);
+	void make_report();
+};
+#endif
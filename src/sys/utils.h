@@ -2,7 +2,7 @@
 #define UTILS_H
 
 #include <stdlib.h>
-#include <windows.h>
+#include "platform.h"
 
 #include "../libs/number_types.h"
 
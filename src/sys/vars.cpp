@@ -273,6 +273,7 @@ void Variable_Service::bind_boolean(const char *variable_name, const char *strin
 
     Variable_Binding *binding = new Variable_Binding();
     binding->name = variable_name;
+    binding->name_id = intern_string(variable_name);
     binding->rvalue.type = BOOLEAN_VALUE;
     binding->rvalue.boolean = !strcmp(string, "true") ? true : false;
     bindings.push(binding);
@@ -285,6 +286,7 @@ void Variable_Service::bind_integer(const char *variable_name, const char *strin
 
     Variable_Binding *binding = new Variable_Binding();
     binding->name = variable_name;
+    binding->name_id = intern_string(variable_name);
     binding->rvalue.type = INTEGER_VALUE;
     binding->rvalue.integer = (s32)atoi(string);
     bindings.push(binding);
@@ -297,6 +299,7 @@ void Variable_Service::bind_float(const char *variable_name, const char *string)
 
     Variable_Binding *binding = new Variable_Binding();
     binding->name = variable_name;
+    binding->name_id = intern_string(variable_name);
     binding->rvalue.type = FLOAT_VALUE;
     binding->rvalue.real = (float)atof(string);
     bindings.push(binding);
@@ -310,6 +313,7 @@ void Variable_Service::bind_string(const char *variable_name, const char *string
 
     Variable_Binding *binding = new Variable_Binding();
     binding->name = variable_name;
+    binding->name_id = intern_string(variable_name);
     binding->rvalue.type = STRING_VALUE;
     binding->rvalue.string = copy_string(string, 1, (u32)strlen(string) - 1);
     bindings.push(binding);
@@ -319,8 +323,9 @@ Variable_Binding *Variable_Service::find_binding(const char *name)
 {
     assert(name);
 
+    String_Id name_id = make_string_id(name);
     for (u32 i = 0; i < bindings.count; i++) {
-        if (bindings[i]->name == name) {
+        if (bindings[i]->name_id == name_id) {
             return bindings[i];
         }
     }
@@ -331,8 +336,9 @@ Variable_Service *Variable_Service::find_namespace(const char *name)
 {
     assert(name);
 
+    String_Id name_id = make_string_id(name);
     for (u32 i = 0; i < namespaces.count; i++) {
-        if (namespaces[i]->namespace_name == name) {
+        if (namespaces[i]->namespace_id == name_id) {
             return namespaces[i];
         }
     }
@@ -387,6 +393,7 @@ void Variable_Service::parse(const char *data)
 {
     assert(data);
     namespace_name = "base_namespace";
+    namespace_id = intern_string(namespace_name);
 
     u32 line_number = 0;
     char *text = (char *)data;
@@ -403,6 +410,7 @@ void Variable_Service::parse(const char *data)
             if (parse_variable_directory_name(line, namespace_name)) {
                 service = new Variable_Service();
                 service->namespace_name = namespace_name;
+                service->namespace_id = intern_string(namespace_name);
                 namespaces.push(service);
             } else {
                 report_error(line_number, line, "Not valid a directory name. The directory name must contain only [a-zA-Z_] symbols.");
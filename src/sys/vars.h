@@ -28,6 +28,7 @@ struct Rvalue {
 };
 
 struct Variable_Binding {
+    String_Id name_id = EMPTY_STRING_ID;
     String name;
     Rvalue rvalue;
 };
@@ -36,6 +37,7 @@ struct Variable_Service {
     Variable_Service();
     ~Variable_Service();
 
+    String_Id namespace_id = EMPTY_STRING_ID;
     String namespace_name;
     Array<Variable_Binding *> bindings;
     Array<Variable_Service *> namespaces;
@@ -10,12 +10,28 @@
 
 static bool run_engine = true;
 
+static void run_engine_loop(HINSTANCE hinstance, int cmd_show);
+
 int WINAPI wWinMain(HINSTANCE hinstance, HINSTANCE prev_instance, PWSTR cmd_line, int cmd_show)
 {
 	if (!create_console(hinstance)) {
 		info("Faield to create win32 console.");
 	}
+	init_logger("hades.log", true);
+#if MEMORY_LEAK_REPORT
+	start_memory_leak_tracking();
+#endif
+	run_engine_loop(hinstance, cmd_show);
+#if MEMORY_LEAK_REPORT
+	// The engine is destroyed here, so everything it didn't free is reported.
+	report_memory_leaks();
+#endif
+	shutdown_logger();
+	return 0;
+}
 
+static void run_engine_loop(HINSTANCE hinstance, int cmd_show)
+{
 	Engine engine;
 	engine.init_base();
 	Variable_Service *system = engine.var_service.find_namespace("system");
@@ -44,7 +60,6 @@ int WINAPI wWinMain(HINSTANCE hinstance, HINSTANCE prev_instance, PWSTR cmd_line
 	}
 
 	engine.shutdown();
-	return 0;
 }
 
 LRESULT CALLBACK Win32_Window::procedure(HWND hwnd, UINT message, WPARAM wparam, LPARAM lparam)
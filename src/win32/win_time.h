@@ -15,7 +15,7 @@ inline s64 cpu_ticks_counter()
 	return ticks.QuadPart;
 }
 
-inline s64 cpu_ticks_per_second()
+inline s64 query_cpu_ticks_per_second()
 {
 	LARGE_INTEGER count_ticks_per_second;
 	if (!QueryPerformanceFrequency(&count_ticks_per_second)) {
@@ -23,7 +23,13 @@ inline s64 cpu_ticks_per_second()
 		return 0;
 	}
 	return count_ticks_per_second.QuadPart;
+}
 
+// The frequency is fixed at system boot, so it is queried once.
+inline s64 cpu_ticks_per_second()
+{
+	static s64 ticks_per_second = query_cpu_ticks_per_second();
+	return ticks_per_second;
 }
 
 inline s64 microseconds_counter()